@@ -101,5 +101,7 @@ void MyApp::draw(const Context& context) {
 
 int main() {
   graph3d_log_level = 3;
-  MyApp().start();
+  const bool success = MyApp().start();
+  G3D_PROFILE_EXPORT("graph3d_trace.json");
+  return success ? 0 : 1;
 }
\ No newline at end of file
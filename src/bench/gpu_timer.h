@@ -0,0 +1,82 @@
+#ifndef GRAPH3D_BENCH_GPU_TIMER_H_
+#define GRAPH3D_BENCH_GPU_TIMER_H_
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace graph3d {
+namespace bench {
+
+// Tiempo de GPU por frame con queries GL_TIME_ELAPSED. Los resultados se leen varios frames
+// después, cuando ya están disponibles, para no frenar al CPU esperando a la GPU
+class GpuTimer {
+ private:
+  static constexpr uint32_t capacity = 8;
+
+  GLuint queries[capacity] = {};
+  uint64_t issued = 0, collected = 0;
+  bool running = false;
+
+  std::vector<double> g_samples;
+
+ public:
+  GpuTimer& operator=(const GpuTimer&) = delete;
+  GpuTimer(const GpuTimer&) = delete;
+  GpuTimer() {}
+
+  ~GpuTimer() {
+    if (queries[0]) glDeleteQueries(capacity, queries);
+  }
+
+ public:
+  void begin() {
+    if (!queries[0]) glGenQueries(capacity, queries);
+    // Con el ring lleno hay que esperar al más viejo
+    if (issued - collected == capacity) collect(true);
+
+    glBeginQuery(GL_TIME_ELAPSED, queries[issued % capacity]);
+    running = true;
+  }
+
+  void end() {
+    if (!running) return;
+    glEndQuery(GL_TIME_ELAPSED);
+    running = false;
+    issued++;
+    collect(false);
+  }
+
+  /// Lee los resultados disponibles (o todos, esperando)
+  void collect(bool wait) {
+    while (collected < issued) {
+      const GLuint query = queries[collected % capacity];
+      if (!wait) {
+        GLint available = 0;
+        glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) return;
+      }
+
+      GLuint64 elapsed = 0;
+      glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed);
+      g_samples.push_back(elapsed / 1e6);
+      collected++;
+
+      if (wait && issued - collected < capacity) return;
+    }
+  }
+
+  void finish() {
+    end();
+    while (collected < issued) collect(true);
+  }
+
+  /// Milisegundos por frame, en orden
+  const std::vector<double>& samples() const { return g_samples; }
+};
+
+}  // namespace bench
+}  // namespace graph3d
+
+#endif
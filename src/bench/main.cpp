@@ -0,0 +1,184 @@
+// graph3d_bench: escenas sintéticas en modo headless, con barrido de parámetros.
+//
+//   graph3d_bench --objects 100,1000 --lights 1,8 --viewports 1,4 --frames 300 --output results.jsonl
+//   graph3d_bench ... --baseline baseline.jsonl --threshold 0.1
+//   graph3d_bench ... --software --images out   (rasterizador por software; guarda out/bench_<o>_<l>_<v>.png)
+//
+// Sale con 1 si falla una corrida y con 2 si alguna métrica empeora más que `threshold` contra el baseline.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <bench/results.h>
+#include <bench/scene.h>
+
+using namespace graph3d::bench;
+
+namespace {
+
+struct Options {
+  std::vector<uint32_t> objects{100, 1000};
+  std::vector<uint32_t> lights{1, 8};
+  std::vector<uint32_t> viewports{1};
+  uint32_t frames = 120, warmup = 10, seed = 1;
+  int width = 800, height = 600;
+
+  std::string output = "graph3d_bench.jsonl";
+  std::string baseline;
+  double threshold = .1;
+  std::vector<std::string> metrics{"cpuP50Ms", "gpuP50Ms", "drawCalls"};
+
+  bool software = false;
+  std::string images;
+};
+
+std::vector<std::string> split(const std::string& value) {
+  std::vector<std::string> parts;
+  std::stringstream stream(value);
+  for (std::string part; std::getline(stream, part, ',');)
+    if (!part.empty()) parts.push_back(part);
+  return parts;
+}
+
+std::vector<uint32_t> parseList(const std::string& value) {
+  std::vector<uint32_t> numbers;
+  for (const std::string& part : split(value)) numbers.push_back(static_cast<uint32_t>(std::strtoul(part.c_str(), nullptr, 10)));
+  return numbers;
+}
+
+void usage() {
+  std::cerr << "Uso: graph3d_bench [opciones]\n"
+               "  --objects N,...     objetos por escena (100,1000)\n"
+               "  --lights N,...      luces puntuales, hasta 32 (1,8)\n"
+               "  --viewports N,...   viewports por ventana (1)\n"
+               "  --frames N          frames medidos (120)\n"
+               "  --warmup N          frames descartados al inicio (10)\n"
+               "  --size WxH          tamaño de la ventana (800x600)\n"
+               "  --seed N            semilla de la escena (1)\n"
+               "  --output PATH       resultados en JSON lines (graph3d_bench.jsonl)\n"
+               "  --baseline PATH     resultados guardados contra los que comparar\n"
+               "  --threshold X       empeoramiento tolerado, 0.1 = 10% (0.1)\n"
+               "  --metrics A,...     métricas comparadas (cpuP50Ms,gpuP50Ms,drawCalls)\n"
+               "  --software          rasterizar en CPU; el tiempo de CPU incluye el render\n"
+               "  --images DIR        guardar el último frame de cada escena en DIR\n";
+}
+
+bool parse(int argc, char** argv, Options& options) {
+  for (int i = 1; i < argc; i++) {
+    const std::string arg = argv[i];
+    if (arg == "--help" || arg == "-h") return false;
+    if (arg == "--software") {
+      options.software = true;
+      continue;
+    }
+    if (i + 1 >= argc) {
+      std::cerr << "Falta el valor de " << arg << '\n';
+      return false;
+    }
+
+    const std::string value = argv[++i];
+    if (arg == "--objects")
+      options.objects = parseList(value);
+    else if (arg == "--lights")
+      options.lights = parseList(value);
+    else if (arg == "--viewports")
+      options.viewports = parseList(value);
+    else if (arg == "--frames")
+      options.frames = static_cast<uint32_t>(std::strtoul(value.c_str(), nullptr, 10));
+    else if (arg == "--warmup")
+      options.warmup = static_cast<uint32_t>(std::strtoul(value.c_str(), nullptr, 10));
+    else if (arg == "--seed")
+      options.seed = static_cast<uint32_t>(std::strtoul(value.c_str(), nullptr, 10));
+    else if (arg == "--size") {
+      if (std::sscanf(value.c_str(), "%dx%d", &options.width, &options.height) != 2) {
+        std::cerr << "Tamaño invalido: " << value << '\n';
+        return false;
+      }
+    } else if (arg == "--output")
+      options.output = value;
+    else if (arg == "--baseline")
+      options.baseline = value;
+    else if (arg == "--threshold")
+      options.threshold = std::strtod(value.c_str(), nullptr);
+    else if (arg == "--metrics")
+      options.metrics = split(value);
+    else if (arg == "--images")
+      options.images = value;
+    else {
+      std::cerr << "Opcion desconocida: " << arg << '\n';
+      return false;
+    }
+  }
+  return options.frames > 0 && !options.objects.empty() && !options.lights.empty() && !options.viewports.empty();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options options;
+  if (!parse(argc, argv, options)) {
+    usage();
+    return 1;
+  }
+
+  std::ofstream output(options.output, std::ios::out | std::ios::trunc);
+  if (!output.is_open()) {
+    std::cerr << "No se pudo abrir " << options.output << '\n';
+    return 1;
+  }
+
+  std::vector<BenchResult> results;
+  bool header = false;
+
+  for (uint32_t objects : options.objects) {
+    for (uint32_t lights : options.lights) {
+      for (uint32_t viewports : options.viewports) {
+        const BenchConfig config{objects, lights, viewports};
+        const std::string image =
+            options.images.empty() ? std::string()
+                                   : options.images + "/bench_" + std::to_string(objects) + "_" +
+                                         std::to_string(lights) + "_" + std::to_string(viewports) + ".png";
+        SyntheticScene scene(config, options.frames, options.warmup, options.width, options.height, options.seed,
+                             options.software, image);
+        if (!scene.start()) return 1;
+
+        if (!header) {
+          writeHeader(output, scene.renderer());
+          header = true;
+        }
+
+        const BenchResult result = scene.result();
+        writeResult(output, result);
+        output.flush();
+        results.push_back(result);
+
+        std::printf("objects=%-6u lights=%-3u viewports=%-3u cpu p50 %8.3f ms  gpu p50 %8.3f ms  draw calls %8.0f\n",
+                    objects, lights, viewports, result.get("cpuP50Ms"), result.get("gpuP50Ms"),
+                    result.get("drawCalls"));
+      }
+    }
+  }
+
+  if (options.baseline.empty()) return 0;
+
+  const std::vector<BenchResult> baseline = readResults(options.baseline);
+  if (baseline.empty()) {
+    std::cerr << "No se pudo leer el baseline " << options.baseline << '\n';
+    return 1;
+  }
+
+  const std::vector<Regression> regressions = compare(results, baseline, options.metrics, options.threshold);
+  for (const Regression& regression : regressions)
+    std::printf("REGRESION objects=%u lights=%u viewports=%u %s: %.4f -> %.4f (%+.1f%%)\n", regression.config.objects,
+                regression.config.lights, regression.config.viewports, regression.metric.c_str(), regression.baseline,
+                regression.current, (regression.current / regression.baseline - 1) * 100);
+
+  if (regressions.empty()) std::printf("Sin regresiones contra %s\n", options.baseline.c_str());
+  return regressions.empty() ? 0 : 2;
+}
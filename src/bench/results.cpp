@@ -0,0 +1,129 @@
+#include <bench/results.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+
+namespace graph3d {
+namespace bench {
+
+void BenchResult::set(const std::string& name, double value) {
+  for (auto& entry : values) {
+    if (entry.first == name) {
+      entry.second = value;
+      return;
+    }
+  }
+  values.emplace_back(name, value);
+}
+
+double BenchResult::get(const std::string& name, double fallback) const {
+  for (const auto& entry : values)
+    if (entry.first == name) return entry.second;
+  return fallback;
+}
+
+Distribution summarize(std::vector<double> samples) {
+  Distribution result;
+  if (samples.empty()) return result;
+
+  std::sort(samples.begin(), samples.end());
+  double sum = 0;
+  for (double sample : samples) sum += sample;
+
+  const auto percentile = [&samples](double p) {
+    return samples[std::min(samples.size() - 1, static_cast<size_t>(std::ceil(p * samples.size())) - 1)];
+  };
+
+  result.mean = sum / samples.size();
+  result.p50 = percentile(.5);
+  result.p95 = percentile(.95);
+  result.max = samples.back();
+  return result;
+}
+
+void addDistribution(BenchResult& result, const std::string& prefix, const Distribution& distribution) {
+  result.set(prefix + "MeanMs", distribution.mean);
+  result.set(prefix + "P50Ms", distribution.p50);
+  result.set(prefix + "P95Ms", distribution.p95);
+  result.set(prefix + "MaxMs", distribution.max);
+}
+
+void writeHeader(std::ostream& out, const std::string& renderer) {
+  out << "{\"benchmark\":\"graph3d_bench\",\"version\":1,\"renderer\":\"";
+  for (char c : renderer) {
+    if (c == '"' || c == '\\') out << '\\';
+    out << c;
+  }
+  out << "\"}\n";
+}
+
+void writeResult(std::ostream& out, const BenchResult& result) {
+  out << std::setprecision(6) << "{\"objects\":" << result.config.objects << ",\"lights\":" << result.config.lights
+      << ",\"viewports\":" << result.config.viewports;
+  for (const auto& entry : result.values) out << ",\"" << entry.first << "\":" << entry.second;
+  out << "}\n";
+}
+
+std::vector<BenchResult> readResults(const std::string& path) {
+  std::vector<BenchResult> results;
+  std::ifstream file(path);
+  std::string line;
+
+  while (std::getline(file, line)) {
+    if (line.find("\"objects\":") == std::string::npos) continue;
+
+    BenchResult result;
+    // "clave":número, separados por comas; lo que no sea número se saltea
+    for (size_t pos = line.find('"'); pos != std::string::npos; pos = line.find('"', pos)) {
+      const size_t end = line.find('"', pos + 1);
+      if (end == std::string::npos) break;
+      if (end + 1 >= line.size() || line[end + 1] != ':') {
+        pos = end + 1;
+        continue;
+      }
+
+      const std::string name = line.substr(pos + 1, end - pos - 1);
+      const char* begin = line.c_str() + end + 2;
+      char* parsed;
+      const double value = std::strtod(begin, &parsed);
+      pos = parsed - line.c_str();
+      if (parsed == begin) continue;
+
+      if (name == "objects")
+        result.config.objects = static_cast<uint32_t>(value);
+      else if (name == "lights")
+        result.config.lights = static_cast<uint32_t>(value);
+      else if (name == "viewports")
+        result.config.viewports = static_cast<uint32_t>(value);
+      else
+        result.set(name, value);
+    }
+    results.push_back(result);
+  }
+  return results;
+}
+
+std::vector<Regression> compare(const std::vector<BenchResult>& current, const std::vector<BenchResult>& baseline,
+                                const std::vector<std::string>& metrics, double threshold) {
+  std::vector<Regression> regressions;
+  for (const BenchResult& result : current) {
+    auto reference = std::find_if(baseline.begin(), baseline.end(),
+                                  [&result](const BenchResult& other) { return other.config == result.config; });
+    if (reference == baseline.end()) continue;
+
+    for (const std::string& metric : metrics) {
+      const double before = reference->get(metric), after = result.get(metric);
+      // Sin dato en alguno de los dos (por ejemplo, sin timer de GPU): no se compara
+      if (before <= 0 || after < 0) continue;
+      if (after > before * (1 + threshold)) regressions.push_back({result.config, metric, before, after});
+    }
+  }
+  return regressions;
+}
+
+}  // namespace bench
+}  // namespace graph3d
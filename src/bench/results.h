@@ -0,0 +1,63 @@
+#ifndef GRAPH3D_BENCH_RESULTS_H_
+#define GRAPH3D_BENCH_RESULTS_H_
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace graph3d {
+namespace bench {
+
+struct BenchConfig {
+  uint32_t objects = 0;
+  uint32_t lights = 0;
+  uint32_t viewports = 0;
+
+  bool operator==(const BenchConfig& other) const {
+    return objects == other.objects && lights == other.lights && viewports == other.viewports;
+  }
+};
+
+// Un resultado por configuración. Los valores son planos (una clave, un número) para que
+// comparar contra un baseline no necesite un parser de JSON completo
+struct BenchResult {
+  BenchConfig config;
+  std::vector<std::pair<std::string, double>> values;
+
+  void set(const std::string& name, double value);
+  /// `fallback` si no existe
+  double get(const std::string& name, double fallback = -1) const;
+};
+
+struct Distribution {
+  double mean = 0, p50 = 0, p95 = 0, max = 0;
+};
+
+Distribution summarize(std::vector<double> samples);
+
+/// Agrega `<prefijo>MeanMs`, `<prefijo>P50Ms`, `<prefijo>P95Ms` y `<prefijo>MaxMs`
+void addDistribution(BenchResult& result, const std::string& prefix, const Distribution& distribution);
+
+/// JSON lines: una línea de encabezado y una por resultado
+void writeHeader(std::ostream& out, const std::string& renderer);
+void writeResult(std::ostream& out, const BenchResult& result);
+
+/// Lee lo que escribió writeResult, ignorando el encabezado. Vacío si no se pudo abrir
+std::vector<BenchResult> readResults(const std::string& path);
+
+struct Regression {
+  BenchConfig config;
+  std::string metric;
+  double baseline, current;
+};
+
+/// Métricas de `current` que superan a las del baseline en más de `threshold` (0.1 = 10%)
+std::vector<Regression> compare(const std::vector<BenchResult>& current, const std::vector<BenchResult>& baseline,
+                                const std::vector<std::string>& metrics, double threshold);
+
+}  // namespace bench
+}  // namespace graph3d
+
+#endif
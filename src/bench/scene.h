@@ -0,0 +1,214 @@
+#ifndef GRAPH3D_BENCH_SCENE_H_
+#define GRAPH3D_BENCH_SCENE_H_
+
+#include <graph3d.h>
+
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <bench/gpu_timer.h>
+#include <bench/results.h>
+#include <opengl/primitives.h>
+#include <util/image_writer.h>
+
+namespace graph3d {
+namespace bench {
+
+// Escena sintética reproducible: `objects` esferas y cubos en una grilla, `lights` luces puntuales
+// y `viewports` viewports sobre la misma ventana headless. Corre warmup + frames frames y se cierra.
+// Con `software` rasteriza en CPU; `image` guarda el último frame en PNG, para comparar con el otro renderer
+class SyntheticScene : public ::Graph3D, public opengl::drawer {
+ private:
+  static constexpr uint32_t maxLights = 32;
+
+  BenchConfig config;
+  uint32_t frames, warmup;
+  uint32_t seed;
+  bool useSoftware;
+  std::string image;
+
+  std::vector<opengl::Viewport*> viewports;
+  std::vector<entity::Object*> objects;
+  std::vector<glm::vec3> albedos;
+  std::vector<glm::vec3> lightPositions, lightColors;
+  std::vector<std::string> lightUniforms;
+
+  uint64_t frame = 0;
+  GpuTimer timer;
+
+  std::string g_renderer;
+  std::vector<double> cpuTimes, drawCalls, triangles, culled, jobUtilization;
+  int64_t bufferMemory = 0, textureMemory = 0;
+
+ public:
+  SyntheticScene(const BenchConfig& config, uint32_t frames, uint32_t warmup, int width, int height,
+                 uint32_t seed = 1, bool useSoftware = false, const std::string& image = "")
+      : ::Graph3D(width, height, "graph3d_bench"),
+        config(config),
+        frames(frames),
+        warmup(warmup),
+        seed(seed),
+        useSoftware(useSoftware),
+        image(image) {}
+
+ protected:
+  void setup() override {
+    headless = true;
+    software = useSoftware;
+    frameLimit = warmup + frames;
+  }
+
+  void configure() override {
+    addShaderFolder("resources/shaders");
+
+    // Grilla de viewports lo más cuadrada posible
+    opengl::Window* window = getContext().window;
+    const uint32_t count = std::max<uint32_t>(config.viewports, 1);
+    const uint32_t columns = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(count))));
+    const uint32_t rows = (count + columns - 1) / columns;
+
+    for (uint32_t i = 0; i < count; i++) {
+      opengl::Viewport* viewport = i ? window->createViewport(i) : (opengl::Viewport*)window->mainViewport;
+      const glm::vec2 min(static_cast<float>(i % columns) / columns, static_cast<float>(i / columns) / rows);
+      viewport->resizer = util::Resizer(min, min + glm::vec2(1.f / columns, 1.f / rows));
+      viewport->backgroundColor = glm::vec4(.1f, .1f, .1f, 1.f);
+      viewport->depthTesting = true;
+      viewport->attachDrawer(this);
+      viewports.push_back(viewport);
+    }
+  }
+
+  void preinitialize() override {
+    loadShader("bench");
+    addModel("bench_sphere", new opengl::Model({opengl::createSphere(.5f, 12, 24)}));
+    addModel("bench_cube", new opengl::Model({opengl::createCube(.8f)}));
+  }
+
+  void initialize() override {
+    g_renderer = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+    if (opengl::isSoftware())
+      g_renderer = "graph3d software (" + std::to_string(software::Rasterizer::getInstance().threads()) + " hilos)";
+
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<float> unit(0.f, 1.f);
+
+    const uint32_t side = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(config.objects))));
+    const float spacing = std::min(1.5f, 80.f / std::max<uint32_t>(side, 1));
+
+    objects.reserve(config.objects);
+    albedos.reserve(config.objects);
+    for (uint32_t i = 0; i < config.objects; i++) {
+      entity::Object* object = createObject("bench_" + std::to_string(i));
+      object->setModel(i % 2 ? "bench_cube" : "bench_sphere");
+      object->position = glm::vec3((i % side - side / 2.f) * spacing, 0.f, -3.f - (i / side) * spacing);
+      objects.push_back(object);
+      albedos.emplace_back(unit(random), unit(random), unit(random));
+    }
+
+    const uint32_t lightCount = std::min(config.lights, maxLights);
+    for (uint32_t i = 0; i < lightCount; i++) {
+      lightPositions.emplace_back((unit(random) - .5f) * side * spacing, 2.f + unit(random) * 3.f,
+                                  -3.f - unit(random) * side * spacing);
+      lightColors.emplace_back(unit(random), unit(random), unit(random));
+      lightUniforms.push_back("lights[" + std::to_string(i) + "].position");
+      lightUniforms.push_back("lights[" + std::to_string(i) + "].color");
+    }
+
+    // Todas las cámaras miran a la grilla desde un poco más arriba, corridas entre sí
+    float offset = 0;
+    for (opengl::Viewport* viewport : viewports) {
+      entity::Camera* camera = viewport->camera;
+      camera->position = glm::vec3(offset, 3.f, 2.f);
+      camera->g_pitch = -20.f;
+      camera->updateRotation();
+      offset += .5f;
+    }
+
+    onFrame(&SyntheticScene::frameEnd, this);
+    timer.begin();
+  }
+
+ public:
+  void draw(const Context& context) override {
+    useShader("bench");
+    opengl::Shader* shader = context.shader;
+
+    shader->set("lightCount", static_cast<int>(lightPositions.size()));
+    for (size_t i = 0; i < lightPositions.size(); i++) {
+      shader->set(lightUniforms[i * 2].c_str(), lightPositions[i]);
+      shader->set(lightUniforms[i * 2 + 1].c_str(), lightColors[i]);
+    }
+
+    for (size_t i = 0; i < objects.size(); i++) {
+      shader->set("albedo", albedos[i]);
+      drawObject(objects[i]);
+    }
+  }
+
+  BenchResult result() const {
+    BenchResult result;
+    result.config = config;
+    result.set("frames", static_cast<double>(cpuTimes.size()));
+    addDistribution(result, "cpu", summarize(cpuTimes));
+
+    // Las queries de los frames de warmup también se descartan
+    const std::vector<double>& gpu = timer.samples();
+    if (gpu.size() > warmup)
+      addDistribution(result, "gpu", summarize(std::vector<double>(gpu.begin() + warmup, gpu.end())));
+
+    result.set("drawCalls", summarize(drawCalls).mean);
+    result.set("triangles", summarize(triangles).mean);
+    result.set("culledObjects", summarize(culled).mean);
+    result.set("jobUtilization", summarize(jobUtilization).mean);
+    result.set("bufferMemory", static_cast<double>(bufferMemory));
+    result.set("textureMemory", static_cast<double>(textureMemory));
+    return result;
+  }
+
+  const std::string& renderer() const { return g_renderer; }
+
+ private:
+  void frameEnd(const util::MetricsSnapshot& snapshot) {
+    timer.end();
+    if (++frame < warmup + frames)
+      timer.begin();
+    else {
+      timer.finish();
+      if (!image.empty()) saveImage();
+    }
+
+    if (frame <= warmup) return;
+    cpuTimes.push_back(snapshot.frameTime * 1000);
+    drawCalls.push_back(static_cast<double>(snapshot.counters[util::G3D_COUNTER_DRAW_CALLS]));
+    triangles.push_back(static_cast<double>(snapshot.counters[util::G3D_COUNTER_TRIANGLES]));
+    culled.push_back(static_cast<double>(snapshot.counters[util::G3D_COUNTER_CULLED_OBJECTS]));
+    bufferMemory = snapshot.gauges[util::G3D_GAUGE_BUFFER_MEMORY];
+    textureMemory = snapshot.gauges[util::G3D_GAUGE_TEXTURE_MEMORY];
+
+    // Promedio entre los hilos del sistema de jobs
+    const std::vector<util::WorkerStats> jobs = getJobStats();
+    double utilization = 0;
+    for (const util::WorkerStats& worker : jobs) utilization += worker.utilization;
+    jobUtilization.push_back(jobs.empty() ? 0 : utilization / jobs.size());
+  }
+
+  void saveImage() {
+    opengl::Window* window = getContext().window;
+    const util::dimension size = window->size;
+    std::vector<uint8_t> pixels(static_cast<size_t>(size.width) * size.height * 4);
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, window->framebuffer);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, size.width, size.height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    if (!util::writePNG(image, size.width, size.height, 4, pixels.data(), static_cast<size_t>(size.width) * 4))
+      std::fprintf(stderr, "No se pudo escribir %s\n", image.c_str());
+  }
+};
+
+}  // namespace bench
+}  // namespace graph3d
+
+#endif
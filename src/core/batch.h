@@ -0,0 +1,50 @@
+#ifndef GRAPH3D_CORE_BATCH_H_
+#define GRAPH3D_CORE_BATCH_H_
+
+#include <cstdint>
+#include <string>
+
+#include <glm/vec3.hpp>
+
+#include <opengl/capture.h>
+#include <util/dimension.h>
+
+namespace graph3d {
+namespace opengl {
+class Viewport;
+}
+
+struct CameraPose {
+  glm::vec3 position{0, 0, 0};
+  float yaw = -90.f, pitch = 0.f, zoom = 45.f;
+
+  // Vacío = según el patrón de BatchSettings::capture.output
+  std::string output;
+};
+
+struct BatchSettings {
+  // Tamaño de cada imagen
+  util::dimension size{800, 600};
+
+  // Imágenes por frame: se dibujan como tiles de un atlas y se leen de una sola vez
+  uint32_t columns = 1, rows = 1;
+
+  // Formato y destino de las imágenes
+  opengl::CaptureSettings capture;
+
+  // De dónde se toman los drawers, las luces y el borrado. nullptr = el viewport del contexto
+  opengl::Viewport* source = nullptr;
+};
+
+struct BatchStats {
+  uint64_t images = 0;
+  uint64_t frames = 0;
+  double seconds = 0;
+  double imagesPerSecond = 0;
+
+  opengl::CaptureStats capture;
+};
+
+}  // namespace graph3d
+
+#endif
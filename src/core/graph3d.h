@@ -9,12 +9,21 @@
 
 #include <GLFW/glfw3.h>
 
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
 #include <ctime>
+#include <functional>
 #include <initializer_list>
+#include <memory>
 #include <string>
+#include <vector>
 
+#include <core/batch.h>
 #include <core/context.h>
 #include <core/context_type.h>
+#include <core/replay.h>
 #include <entity/camera.h>
 #include <entity/light.h>
 #include <entity/lights/area.h>
@@ -22,11 +31,19 @@
 #include <entity/lights/point.h>
 #include <entity/lights/spotlight.h>
 #include <entity/object.h>
+#include <opengl/capture.h>
+#include <opengl/framebuffer.h>
 #include <opengl/opengl.h>
 #include <opengl/shader.h>
+#include <opengl/software_surface.h>
 #include <opengl/window.h>
+#include <util/allocations.h>
+#include <util/jobs.h>
 #include <util/logger.h>
+#include <util/metrics.h>
 #include <util/pipe.h>
+#include <util/profiler.h>
+#include <util/recording.h>
 #include <util/resources.h>
 #include <util/sleep.h>
 
@@ -45,6 +62,10 @@ class Graph3D : public opengl::OpenGL {
 
   double deltaTime, targetTime;
   int g_fps;
+  double g_loadBudget = 4;
+  uint64_t g_frameLimit = 0;
+
+  std::vector<std::function<void(const util::MetricsSnapshot&)>> frameSubscribers;
 
   std::map<std::string, entity::Object*> scene;
   std::vector<entity::Camera*> cameras;
@@ -52,11 +73,17 @@ class Graph3D : public opengl::OpenGL {
 
  public:
   Graph3D() : targetTime(1. / g_fps), opengl::OpenGL() {
+    // Los hilos arrancan acá, y el hilo que crea el motor queda como hilo principal de los jobs
+    util::JobSystem& jobs = util::JobSystem::getInstance();
+    G3D_LOG(2, "> Sistema de jobs: " << jobs.threads() << " hilos");
+
     onContextChange(&Graph3D::contextChangeListener, this);
     bindPipes();
   }
 
   ~Graph3D() {
+    util::Recorder::stop();
+
     for (auto& entry : scene) delete entry.second;
     scene.clear();
 
@@ -69,20 +96,24 @@ class Graph3D : public opengl::OpenGL {
 
  protected:
   void createContext(const int width, const int height, const char* title, bool fullscreen) {
-    util::log("> Crear Contexto", 1);
+    G3D_LOG(1, "> Crear Contexto");
+    // G3D_RECORD graba la sesión sin tocar la aplicación, igual que G3D_HEADLESS
+    if (const char* path = std::getenv("G3D_RECORD")) startRecording(path);
+    initBackend();
 
-    util::log("> Asociar Ventana al contexto actual", 3);
+    G3D_LOG(3, "> Asociar Ventana al contexto actual");
     context.setWindow(createWindow(width, height, title, fullscreen));
-    util::log("> Asociar Monitor al contexto actual", 3);
+    G3D_LOG(3, "> Asociar Monitor al contexto actual");
     context.setMonitor(((opengl::Window*)context.window)->monitor);
-    util::log("> Asociar Viewport al contexto actual", 3);
+    G3D_LOG(3, "> Asociar Viewport al contexto actual");
     context.setViewport(((opengl::Window*)context.window)->mainViewport);
-    util::log("> Asociar Delta Time al contexto actual", 3);
+    G3D_LOG(3, "> Asociar Delta Time al contexto actual");
     context.setDeltaTime(&deltaTime);
 
-    glfwMakeContextCurrent(context.window.operator->().ref);
+    context.window.operator->().makeCurrent();
+    initialize();
 
-    util::log("  < Crear Contexto", 1);
+    G3D_LOG(1, "  < Crear Contexto");
   }
 
   void preConfiguration() { initGLAD(); }
@@ -93,7 +124,11 @@ class Graph3D : public opengl::OpenGL {
   Context& getContext() { return context; }
 
  public:
-  entity::Object* createObject(const std::string& alias) { return (scene[alias] = new entity::Object()); }
+  entity::Object* createObject(const std::string& alias) {
+    entity::Object* object = scene[alias] = new entity::Object();
+    if (util::Recorder* recorder = util::Recorder::active()) recorder->createObject(object, alias);
+    return object;
+  }
 
   entity::Camera* createCamera(glm::vec3 position, glm::vec3 up, float yaw, float pitch) {
     entity::Camera* camera = new entity::Camera(position, up, yaw, pitch);
@@ -101,24 +136,428 @@ class Graph3D : public opengl::OpenGL {
     return camera;
   }
 
-  void drawObject(std::string object) { draw(scene[object]); }
+  /// Jobs del motor: lo que necesite GL va con runOnMainThread(), que se vacía al empezar cada frame
+  util::JobSystem& getJobs() { return util::JobSystem::getInstance(); }
+
+  void drawObject(const std::string& object) { draw(scene[object]); }
 
   inline void drawObject(entity::Object* object) { draw(object); }
 
+  /// Cierra todas las ventanas: el main loop termina al empezar el próximo frame
+  void close() { closeWindows(); }
+
+ public:
+  // Dibuja la escena una vez por pose, fuera de pantalla y sin esperar al swap ni al sleep del main loop.
+  // Las imágenes se leen de forma asíncrona y se escriben en otro hilo.
+  // Va después de cargar la escena (en initialize(), por ejemplo); seguido de close() se saltea el modo interactivo
+  BatchStats renderBatch(const std::vector<CameraPose>& poses, const BatchSettings& settings = BatchSettings()) {
+    G3D_PROFILE_SCOPE("Graph3D::renderBatch");
+    G3D_LOG(1, "> Render en lote: " << poses.size() << " imagenes");
+    util::Recorder::pause_scope pause;
+    const auto start = std::chrono::steady_clock::now();
+
+    const int width = settings.size.width, height = settings.size.height;
+    const uint32_t columns = std::max<uint32_t>(settings.columns, 1), rows = std::max<uint32_t>(settings.rows, 1);
+    const uint32_t perFrame = columns * rows;
+
+    opengl::Viewport* source = settings.source ? settings.source : context.g_viewport;
+    opengl::Viewport* previous = context.g_viewport;
+
+    util::dimension atlasSize(width * columns, height * rows);
+    opengl::Framebuffer atlas(atlasSize);
+    std::unique_ptr<opengl::SoftwareSurface> surface;
+    if (opengl::isSoftware()) surface.reset(new opengl::SoftwareSurface(atlasSize));
+
+    // Viewport propio, así el del usuario no cambia de tamaño ni de cámara
+    opengl::Viewport viewport(&atlasSize);
+    viewport.drawers = source->drawers;
+    viewport.lights = source->lights;
+    viewport.g_clearMask = source->g_clearMask;
+    viewport.clearColor = source->clearColor;
+
+    entity::Camera camera(G3D_ZERO, G3D_UP, -90.f, 0.f);
+    viewport.camera = &camera;
+    context.setViewport(&viewport);
+
+    opengl::CaptureSettings captureSettings = settings.capture;
+    captureSettings.ringSize = std::max<uint32_t>(captureSettings.ringSize, 2);
+
+    BatchStats stats;
+    {
+      opengl::FrameCapture capture(captureSettings);
+      std::vector<opengl::CaptureTile> tiles;
+      tiles.reserve(perFrame);
+
+      for (size_t next = 0; next < poses.size();) {
+        G3D_PROFILE_SCOPE("Graph3D::batchFrame");
+        const auto frameStart = std::chrono::steady_clock::now();
+        atlas.bind();
+        if (surface) surface->bind();
+        tiles.clear();
+
+        for (uint32_t tile = 0; tile < perFrame && next < poses.size(); tile++, next++) {
+          const CameraPose& pose = poses[next];
+          camera.position = pose.position;
+          camera.g_yaw = pose.yaw;
+          camera.g_pitch = pose.pitch;
+          camera.g_zoom = pose.zoom;
+          camera.updateRotation();
+
+          opengl::CaptureTile& entry = tiles.emplace_back();
+          entry.x = (tile % columns) * width;
+          entry.y = (tile / columns) * height;
+          entry.width = width;
+          entry.height = height;
+          entry.output = pose.output;
+
+          viewport.g_bounds = util::bounds(util::dimension(entry.x, entry.y),
+                                           util::dimension(entry.x + width, entry.y + height));
+          viewport.draw(context);
+        }
+
+        if (surface) surface->present(atlas.id());
+
+        // Sólo las filas ocupadas del atlas
+        const int usedRows = static_cast<int>((tiles.size() + columns - 1) / columns);
+        capture.capture(atlas.id(), 0, 0, atlasSize.width, usedRows * height, tiles);
+        stats.frames++;
+
+        util::Metrics::getInstance().endFrame(
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - frameStart).count());
+      }
+
+      capture.finish();
+      stats.capture = capture.stats();
+    }
+
+    context.setViewport(previous);
+
+    stats.images = stats.capture.written;
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    stats.imagesPerSecond = stats.seconds > 0 ? stats.images / stats.seconds : 0;
+
+    G3D_LOG(1, "  < Render en lote: " << stats.images << " imagenes en " << stats.seconds << " s ("
+                                      << stats.imagesPerSecond << " img/s)");
+    return stats;
+  }
+
+ public:
+  // Graba el stream de comandos en `path` hasta stopRecording (util/recording.h).
+  // Lo que ya estaba cargado o creado se graba primero, así se puede empezar en cualquier momento
+  bool startRecording(const std::string& path) {
+    if (!util::Recorder::start(path)) return false;
+    util::Recorder& recorder = *util::Recorder::active();
+
+    util::ResourceManager& resources = util::ResourceManager::getInstance();
+    for (util::ResourceType type : {util::G3D_RESOURCE_SHADER, util::G3D_RESOURCE_MODEL, util::G3D_RESOURCE_TEXTURE})
+      for (const std::string& folder : resources.getFolders(type)) recorder.folder(type, folder);
+
+    for (const auto& entry : shaderPrograms) recorder.loadShader(entry.first);
+    for (const auto& entry : models) recordModel(recorder, entry.first, *entry.second);
+    for (const auto& entry : scene) recorder.createObject(entry.second, entry.first);
+    return true;
+  }
+
+  void stopRecording() { util::Recorder::stop(); }
+
+  // Reproduce una grabación lo más rápido posible: sin sleep, sin swap y con ventanas y viewports propios.
+  // Cada frame se mide por separado y se puede comparar con el tiempo que tardó al grabarse.
+  // Las carpetas de recursos de la grabación se resuelven contra el directorio de trabajo actual
+  ReplayStats replay(const std::string& path, const ReplaySettings& settings = ReplaySettings()) {
+    G3D_PROFILE_SCOPE("Graph3D::replay");
+    G3D_LOG(1, "> Reproducir grabacion: " << path);
+    util::CommandReader reader(path);
+
+    // Una reproducción no se graba a sí misma
+    util::Recorder::pause_scope pause;
+
+    // Los ids de la grabación empiezan en 1
+    std::vector<entity::Object*> objects(1, nullptr);
+    std::vector<entity::Camera*> replayCameras(1, nullptr);
+    std::vector<opengl::Window*> replayWindows(1, nullptr);
+    std::vector<opengl::Viewport*> replayViewports(1, nullptr);
+    std::vector<opengl::Window*> viewportWindows(1, nullptr);
+
+    opengl::Window* mainWindow = context.g_window;
+    const util::dimension mainSize = mainWindow->size;
+    opengl::Viewport* previous = context.g_viewport;
+    opengl::Window* current = nullptr;
+
+    ReplayStats stats;
+    util::Command command;
+    const auto start = std::chrono::steady_clock::now();
+
+    for (uint32_t pass = 0; pass < std::max<uint32_t>(settings.passes, 1); pass++) {
+      if (pass) reader.rewind();
+      auto frameStart = std::chrono::steady_clock::now();
+      double loadTime = 0;
+
+      while (reader.next(command)) {
+        switch (command.type) {
+          case util::G3D_CMD_FOLDER:
+          case util::G3D_CMD_LOAD_SHADER:
+          case util::G3D_CMD_LOAD_MODEL:
+          case util::G3D_CMD_MODEL_DATA: {
+            if (pass) break;
+            const auto loadStart = std::chrono::steady_clock::now();
+            replayLoad(command);
+            loadTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - loadStart).count();
+            break;
+          }
+          case util::G3D_CMD_CREATE_OBJECT: {
+            entity::Object*& object = replaySlot(objects, command.id, path, "Objeto");
+            if (!object)
+              object = createObject("replay:" + (command.name.empty() ? std::to_string(command.id) : command.name));
+            break;
+          }
+          case util::G3D_CMD_SET_MODEL:
+            replayEntry(objects, command.id, path, "Objeto")->setModel(command.name);
+            break;
+          case util::G3D_CMD_TRANSFORM:
+            std::memcpy(glm::value_ptr(replayEntry(objects, command.id, path, "Objeto")->transformation), command.data,
+                        sizeof(glm::mat4));
+            break;
+          case util::G3D_CMD_CAMERA: {
+            entity::Camera*& camera = replaySlot(replayCameras, command.id, path, "Camara");
+            if (!camera) camera = createCamera(G3D_ZERO, G3D_UP, -90.f, 0.f);
+            camera->g_pos = glm::make_vec3(command.data);
+            const glm::mat3 rotation = glm::make_mat3(command.data + 3);
+            for (int i = 0; i < 3; i++) camera->transformation[i] = glm::vec4(rotation[i], 0);
+            camera->g_zoom = command.data[12];
+            break;
+          }
+          case util::G3D_CMD_WINDOW: {
+            const util::dimension size(command.values[0], command.values[1]);
+            opengl::Window*& window = replaySlot(replayWindows, command.id, path, "Ventana");
+            if (!window)
+              window = command.id == 1 ? mainWindow : createWindow(size.width, size.height, "3DGraph replay");
+            window->size = size;
+            break;
+          }
+          case util::G3D_CMD_VIEWPORT: {
+            opengl::Window* window = replayEntry(replayWindows, command.window, path, "Ventana");
+            opengl::Viewport*& viewport = replaySlot(replayViewports, command.id, path, "Viewport");
+            // Viewports nuevos, así no se llama a los drawers de la aplicación
+            if (!viewport) viewport = window->createViewport(command.zindex);
+            replaySlot(viewportWindows, command.id, path, "Viewport") = window;
+
+            viewport->zindex = command.zindex;
+            viewport->g_bounds = util::bounds(util::dimension(command.values[0], command.values[1]),
+                                              util::dimension(command.values[0] + command.values[2],
+                                                              command.values[1] + command.values[3]));
+            viewport->g_clearMask = command.mask;
+            viewport->clearColor = glm::make_vec4(command.data);
+            if (command.camera < replayCameras.size() && replayCameras[command.camera])
+              viewport->camera = replayCameras[command.camera];
+            else if (!viewport->camera)
+              viewport->camera = createCamera(G3D_ZERO, G3D_UP, -90.f, 0.f);
+            break;
+          }
+          case util::G3D_CMD_BEGIN_VIEWPORT: {
+            opengl::Viewport* viewport = replayEntry(replayViewports, command.id, path, "Viewport");
+            if (current != viewportWindows[command.id]) {
+              current = viewportWindows[command.id];
+              current->makeCurrent();
+            }
+            context.setViewport(viewport);
+            viewport->draw(context);
+            break;
+          }
+          case util::G3D_CMD_USE_SHADER:
+            useShader(command.name, command.keywords);
+            break;
+          case util::G3D_CMD_UNIFORM:
+            if (activeShader) replayUniform(*activeShader, command);
+            break;
+          case util::G3D_CMD_DRAW:
+            draw(replayEntry(objects, command.id, path, "Objeto"));
+            break;
+          case util::G3D_CMD_FRAME: {
+            streamTextures();
+            for (opengl::Window* window : replayWindows)
+              if (window) window->present();
+            if (settings.finish) glFinish();
+            const auto now = std::chrono::steady_clock::now();
+
+            ReplayFrame& frame = stats.frames.emplace_back();
+            frame.pass = pass;
+            frame.frame = command.frame;
+            frame.recordedTime = command.time;
+            frame.time = std::chrono::duration<double>(now - frameStart).count() - loadTime;
+            stats.loadSeconds += loadTime;
+
+            util::Metrics& metrics = util::Metrics::getInstance();
+            metrics.endFrame(frame.time);
+            const util::MetricsSnapshot snapshot = metrics.snapshot();
+            frame.drawCalls = snapshot.counters[util::G3D_COUNTER_DRAW_CALLS];
+            frame.triangles = snapshot.counters[util::G3D_COUNTER_TRIANGLES];
+
+            frameStart = std::chrono::steady_clock::now();
+            loadTime = 0;
+            break;
+          }
+        }
+      }
+    }
+
+    stats.seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() - stats.loadSeconds;
+
+    // La ventana del contexto vuelve a como estaba; las ventanas y los viewports propios se cierran
+    for (opengl::Viewport* viewport : replayViewports)
+      if (viewport) viewport->close();
+    for (opengl::Window* window : replayWindows)
+      if (window && window != mainWindow) window->close();
+    mainWindow->size = mainSize;
+    mainWindow->makeCurrent();
+    context.setViewport(previous);
+
+    G3D_LOG(1, "  < Reproducir grabacion: " << stats.frames.size() << " frames en " << stats.seconds << " s");
+    return stats;
+  }
+
+ public:
+  /// Métricas del último frame completo
+  util::MetricsSnapshot getMetrics() const { return util::Metrics::getInstance().snapshot(); }
+
+  /// Uso de cada hilo del sistema de jobs en el último frame completo (el 0 es el principal)
+  std::vector<util::WorkerStats> getJobStats() const { return util::JobSystem::getInstance().stats(); }
+
+  /// Escribe las métricas en `path` (JSON lines) cada `period` frames
+  bool exportMetrics(const std::string& path, uint32_t period = 60) {
+    return util::Metrics::getInstance().exportTo(path, period);
+  }
+
+  /// Se llama al terminar cada frame del main loop, con sus métricas
+  template <typename Parent>
+  void onFrame(void (Parent::*func)(const util::MetricsSnapshot&), Parent* parent) {
+    frameSubscribers.push_back([func, parent](const util::MetricsSnapshot& snapshot) { (parent->*func)(snapshot); });
+  }
+
  private:
   int getFps() { return g_fps; }
 
   const int& setFps(const int& fps) {
-    util::log("> Modificar FPS", 4);
+    G3D_LOG(4, "> Modificar FPS");
     g_fps = fps;
     targetTime = 1. / fps;
-    util::log("  < Modificar FPS", 4);
+    G3D_LOG(4, "  < Modificar FPS");
     return fps;
   }
 
+  bool getHeadless() { return opengl::isHeadless(); }
+
+  // Sólo tiene efecto antes de crear el contexto (por ejemplo, en setup())
+  const bool& setHeadless(const bool& headless) {
+    opengl::currentBackend() = headless ? opengl::G3D_BACKEND_HEADLESS : opengl::G3D_BACKEND_GLFW;
+    return headless;
+  }
+
+  bool getSoftware() { return opengl::isSoftware(); }
+
+  // Sólo tiene efecto antes de crear el contexto (por ejemplo, en setup())
+  const bool& setSoftware(const bool& software) {
+    opengl::currentRenderer() = software ? opengl::G3D_RENDERER_SOFTWARE : opengl::G3D_RENDERER_GL;
+    return software;
+  }
+
+  double getLoadBudget() { return g_loadBudget; }
+
+  uint64_t getTextureBudget() { return opengl::TextureCache::getInstance().budget(); }
+
+  const uint64_t& setTextureBudget(const uint64_t& textureBudget) {
+    opengl::TextureCache::getInstance().setBudget(static_cast<size_t>(textureBudget));
+    return textureBudget;
+  }
+
+  const double& setLoadBudget(const double& loadBudget) { return g_loadBudget = loadBudget; }
+
+  std::string getCookCache() { return util::CookCache::getInstance().directory(); }
+
+  const std::string& setCookCache(const std::string& cookCache) {
+    util::CookCache::getInstance().setDirectory(cookCache);
+    return cookCache;
+  }
+
+  bool getTextureCompression() { return opengl::TextureCache::getInstance().compression(); }
+
+  const bool& setTextureCompression(const bool& textureCompression) {
+    opengl::TextureCache::getInstance().setCompression(textureCompression);
+    return textureCompression;
+  }
+
+  bool getTextureStreaming() { return opengl::TextureCache::getInstance().streaming(); }
+
+  const bool& setTextureStreaming(const bool& textureStreaming) {
+    opengl::TextureCache::getInstance().setStreaming(textureStreaming);
+    return textureStreaming;
+  }
+
+  bool getHotReload() { return hotReloadEnabled(); }
+
+  const bool& setHotReload(const bool& hotReload) {
+    enableHotReload(hotReload);
+    return hotReload;
+  }
+
+  uint64_t getTextureUploadBudget() { return opengl::TextureCache::getInstance().uploadBudget(); }
+
+  const uint64_t& setTextureUploadBudget(const uint64_t& textureUploadBudget) {
+    opengl::TextureCache::getInstance().setUploadBudget(static_cast<size_t>(textureUploadBudget));
+    return textureUploadBudget;
+  }
+
+  util::MipFilter getMipFilter() { return opengl::TextureCache::getInstance().mipFilter(); }
+
+  const util::MipFilter& setMipFilter(const util::MipFilter& mipFilter) {
+    opengl::TextureCache::getInstance().setMipFilter(mipFilter);
+    return mipFilter;
+  }
+
+  uint64_t getFrameLimit() { return g_frameLimit; }
+
+  const uint64_t& setFrameLimit(const uint64_t& frameLimit) { return g_frameLimit = frameLimit; }
+
  public:
   util::copy_pipe<int, Graph3D, &getFps, &setFps> fps;
 
+  /// Renderizar sin sistema de ventanas (EGL), en framebuffers
+  util::copy_pipe<bool, Graph3D, &getHeadless, &setHeadless> headless;
+
+  /// Rasterizar en CPU (software/rasterizer.h) en lugar de dibujar con el driver
+  util::copy_pipe<bool, Graph3D, &getSoftware, &setSoftware> software;
+
+  /// Cantidad de frames tras la cual se cierran todas las ventanas. 0 = sin límite
+  util::copy_pipe<uint64_t, Graph3D, &getFrameLimit, &setFrameLimit> frameLimit;
+
+  /// Milisegundos por frame para subir a GL los modelos de loadModelAsync y, aparte, para compilar variantes de
+  /// shaders (siempre se avanza al menos una parte)
+  util::copy_pipe<double, Graph3D, &getLoadBudget, &setLoadBudget> loadBudget;
+
+  /// Bytes de texturas que la caché mantiene cargadas (512 MiB por defecto). Al pasarse, libera primero las que no se
+  /// usan y después los mipmaps de más detalle de las que hace rato no se ven
+  util::copy_pipe<uint64_t, Graph3D, &getTextureBudget, &setTextureBudget> textureBudget;
+
+  /// Carpeta de los recursos cocinados: mallas .g3dmesh y texturas comprimidas. Vacía = no cocinar nada
+  util::copy_pipe<std::string, Graph3D, &getCookCache, &setCookCache> cookCache;
+
+  /// Comprimir a BCn las texturas sin comprimir (se cocinan en segundo plano y se usan desde la próxima carga)
+  util::copy_pipe<bool, Graph3D, &getTextureCompression, &setTextureCompression> textureCompression;
+
+  /// Subir de cada textura sólo los mipmaps chicos y el resto a medida que se vean de cerca (G3D_TEXTURE_STREAMING=0
+  /// para desactivarlo). Se aplica a las texturas que se carguen desde ahora
+  util::copy_pipe<bool, Graph3D, &getTextureStreaming, &setTextureStreaming> textureStreaming;
+
+  /// Bytes de mipmaps que se suben por frame con el streaming de texturas (8 MiB por defecto, siempre al menos uno)
+  util::copy_pipe<uint64_t, Graph3D, &getTextureUploadBudget, &setTextureUploadBudget> textureUploadBudget;
+
+  /// Filtro de los mipmaps que se generan al cargar texturas (G3D_MIP_BOX por defecto)
+  util::copy_pipe<util::MipFilter, Graph3D, &getMipFilter, &setMipFilter> mipFilter;
+
+  /// Volver a cargar los programas de shaders y los modelos cuando cambian sus archivos, sin cortar el frame: se
+  /// sigue dibujando con la versión anterior hasta que la nueva está lista (G3D_HOT_RELOAD=1 para activarlo)
+  util::copy_pipe<bool, Graph3D, &getHotReload, &setHotReload> hotReload;
+
  private:
   /// Implementación
   void contextChangeListener(ContextType type, void* data) {
@@ -139,33 +578,185 @@ class Graph3D : public opengl::OpenGL {
   }
 
   void mainLoop() {
-    util::log("> Main Loop", 1);
+    G3D_LOG(1, "> Main Loop");
     time_t startTime, lastTime = time(0);
     double elapsedTime, timePool = 0;
+    uint64_t frames = 0;
 
     while (shouldRun()) {
-      util::log("> Ejecutar Main Loop", 10);
+      G3D_PROFILE_SCOPE("Graph3D::frame");
+      const auto frameStart = std::chrono::steady_clock::now();
+      G3D_LOG(10, "> Ejecutar Main Loop");
       startTime = time(0);
       deltaTime = difftime(startTime, lastTime);
       timePool += targetTime;
 
+      util::JobSystem::getInstance().runMainThreadJobs();
+      reloadResources(g_loadBudget / 1000);
+      uploadModels(g_loadBudget / 1000);
+      compileShaders(g_loadBudget / 1000);
       OpenGL::draw(context);
-      glfwPollEvents();
+      streamTextures();
+      {
+        G3D_ALLOC_TAG("pollEvents");
+        pollEvents();
+      }
+
+      const double frameTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - frameStart).count();
+      util::Metrics::getInstance().endFrame(frameTime);
+      util::JobSystem::getInstance().endFrame();
+      if (util::Recorder* recorder = util::Recorder::active()) recorder->endFrame(frameTime);
+      if (!frameSubscribers.empty()) {
+        const util::MetricsSnapshot snapshot = util::Metrics::getInstance().snapshot();
+        for (const auto& func : frameSubscribers) func(snapshot);
+      }
+      G3D_ALLOC_END_FRAME();
+
+      if (g_frameLimit && ++frames >= g_frameLimit) closeWindows();
 
       elapsedTime = difftime(time(0), startTime);
       timePool -= elapsedTime;
       lastTime = startTime;
 
-      if (timePool > 0) {
-        util::log("> Dormir", 20);
+      if (timePool > 0 && !opengl::isHeadless()) {
+        G3D_LOG(20, "> Dormir");
         util::sleep(static_cast<int32_t>(timePool * 1000));
       }
     }
-    util::log("  < Main Loop", 1);
+    G3D_LOG(1, "  < Main Loop");
+  }
+
+ private:
+  void replayLoad(const util::Command& command) {
+    switch (command.type) {
+      case util::G3D_CMD_FOLDER:
+        util::addResourceFolder(static_cast<util::ResourceType>(command.kind), command.name);
+        break;
+      case util::G3D_CMD_LOAD_SHADER:
+        if (shaderPrograms.find(command.name) == shaderPrograms.end()) loadShader(command.name);
+        break;
+      case util::G3D_CMD_LOAD_MODEL:
+        if (models.find(command.name) == models.end()) loadModel(command.name);
+        break;
+      case util::G3D_CMD_MODEL_DATA: {
+        std::vector<opengl::Mesh> meshes;
+        for (const util::MeshData& data : command.meshes) {
+          if (data.vertexSize != sizeof(opengl::Vertex))
+            throw exceptions::exception(
+                "ERR014", exceptions::format(exceptions::ERR014, command.name.c_str()),
+                exceptions::format("Vertices de %u bytes; esta version usa %u", data.vertexSize,
+                                   static_cast<uint32_t>(sizeof(opengl::Vertex))));
+
+          std::vector<opengl::Vertex> vertices(data.vertices.size() / sizeof(opengl::Vertex));
+          if (!vertices.empty()) std::memcpy(vertices.data(), data.vertices.data(), data.vertices.size());
+          meshes.emplace_back(std::move(vertices), std::vector<unsigned int>(data.indices.begin(), data.indices.end()),
+                              std::vector<opengl::Texture>());
+        }
+        addModel(command.name, new opengl::Model(std::move(meshes)));
+        break;
+      }
+      default:
+        break;
+    }
+  }
+
+  // Un comando que usa un id que la grabación nunca creó: está rota o truncada
+  template <typename T>
+  static T* replayEntry(const std::vector<T*>& entries, uint32_t id, const std::string& path, const char* kind) {
+    if (id >= entries.size() || !entries[id])
+      throw exceptions::exception("ERR014", exceptions::format(exceptions::ERR014, path.c_str()),
+                                  exceptions::format("%s %u usado sin crearlo", kind, id));
+    return entries[id];
+  }
+
+  // El Recorder da los ids en orden (el siguiente es el tamaño actual de la tabla): uno mucho más grande sólo
+  // puede venir de una grabación rota, y no se reserva memoria por él
+  template <typename T>
+  static T*& replaySlot(std::vector<T*>& entries, uint32_t id, const std::string& path, const char* kind) {
+    static constexpr size_t margin = 64;
+    if (id >= entries.size()) {
+      if (id > entries.size() + margin)
+        throw exceptions::exception("ERR014", exceptions::format(exceptions::ERR014, path.c_str()),
+                                    exceptions::format("%s %u fuera de rango", kind, id));
+      entries.resize(id + 1, nullptr);
+    }
+    return entries[id];
+  }
+
+  static void replayUniform(opengl::Shader& shader, const util::Command& command) {
+    const char* name = command.name.c_str();
+    const float* f = command.data;
+    GLint i[4];
+    GLuint u[4];
+    std::memcpy(i, f, sizeof(i));
+    std::memcpy(u, f, sizeof(u));
+
+    switch (static_cast<util::UniformType>(command.kind)) {
+      case util::G3D_UNIFORM_FLOAT:
+        shader.set(name, f[0]);
+        break;
+      case util::G3D_UNIFORM_INT:
+        shader.set(name, i[0]);
+        break;
+      case util::G3D_UNIFORM_UINT:
+        shader.set(name, u[0]);
+        break;
+      case util::G3D_UNIFORM_VEC2:
+        shader.set(name, glm::make_vec2(f));
+        break;
+      case util::G3D_UNIFORM_VEC3:
+        shader.set(name, glm::make_vec3(f));
+        break;
+      case util::G3D_UNIFORM_VEC4:
+        shader.set(name, glm::make_vec4(f));
+        break;
+      case util::G3D_UNIFORM_IVEC2:
+        shader.set(name, i[0], i[1]);
+        break;
+      case util::G3D_UNIFORM_IVEC3:
+        shader.set(name, i[0], i[1], i[2]);
+        break;
+      case util::G3D_UNIFORM_IVEC4:
+        shader.set(name, i[0], i[1], i[2], i[3]);
+        break;
+      case util::G3D_UNIFORM_UVEC2:
+        shader.set(name, u[0], u[1]);
+        break;
+      case util::G3D_UNIFORM_UVEC3:
+        shader.set(name, u[0], u[1], u[2]);
+        break;
+      case util::G3D_UNIFORM_UVEC4:
+        shader.set(name, u[0], u[1], u[2], u[3]);
+        break;
+      case util::G3D_UNIFORM_MAT2:
+        shader.set(name, glm::make_mat2(f));
+        break;
+      case util::G3D_UNIFORM_MAT3:
+        shader.set(name, glm::make_mat3(f));
+        break;
+      case util::G3D_UNIFORM_MAT4:
+        shader.set(name, glm::make_mat4(f));
+        break;
+      default:
+        break;
+    }
   }
 
  private:
-  void bindPipes() { fps.setParent(this); }
+  void bindPipes() {
+    fps.setParent(this);
+    headless.setParent(this);
+    software.setParent(this);
+    frameLimit.setParent(this);
+    loadBudget.setParent(this);
+    textureBudget.setParent(this);
+    cookCache.setParent(this);
+    textureCompression.setParent(this);
+    textureStreaming.setParent(this);
+    textureUploadBudget.setParent(this);
+    mipFilter.setParent(this);
+    hotReload.setParent(this);
+  }
 };
 
 }  // namespace graph3d
@@ -0,0 +1,39 @@
+#ifndef GRAPH3D_CORE_REPLAY_H_
+#define GRAPH3D_CORE_REPLAY_H_
+
+#include <cstdint>
+#include <vector>
+
+namespace graph3d {
+
+struct ReplaySettings {
+  // Espera a la GPU al final de cada frame, así el tiempo incluye el render y no sólo el envío de comandos
+  bool finish = true;
+
+  // Veces que se reproduce la grabación. Las cargas y la creación de objetos sólo se hacen en la primera
+  uint32_t passes = 1;
+};
+
+struct ReplayFrame {
+  uint32_t pass = 0;
+  uint64_t frame = 0;
+
+  // Duración del frame al grabarlo y al reproducirlo, en segundos (sin contar las cargas)
+  double recordedTime = 0;
+  double time = 0;
+
+  uint64_t drawCalls = 0;
+  uint64_t triangles = 0;
+};
+
+struct ReplayStats {
+  std::vector<ReplayFrame> frames;
+
+  // Cargas de recursos, medidas aparte de los frames
+  double loadSeconds = 0;
+  double seconds = 0;
+};
+
+}  // namespace graph3d
+
+#endif
@@ -13,6 +13,8 @@
 #include <util/bounds.h>
 
 namespace graph3d {
+class Graph3D;
+
 namespace entity {
 
 enum class Space { World, Camera };
@@ -20,6 +22,8 @@ enum class Space { World, Camera };
 // Si bien es técnicamente una entidad,
 // era mas sencillo reescribir toda las funcionalidades para adaptarlas a la cámara
 class Camera : public Entity {
+  friend class graph3d::Graph3D;
+
  private:
   template <Space>
   struct type {};
@@ -4,6 +4,8 @@
 #include <entity/entity.h>
 
 namespace graph3d {
+class Graph3D;
+
 namespace opengl {
 class OpenGL;
 }
@@ -11,6 +13,7 @@ class OpenGL;
 namespace entity {
 class Object : public Entity {
   friend class graph3d::opengl::OpenGL;
+  friend class graph3d::Graph3D;
 
  private:
   std::string modelAlias;
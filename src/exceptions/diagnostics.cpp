@@ -0,0 +1,99 @@
+#include <exceptions/diagnostics.h>
+
+#include <util/logger.h>
+
+namespace graph3d {
+namespace exceptions {
+
+bool diagnostics::report(const char* code, const std::string& description, const std::string& message) {
+  const auto now = std::chrono::steady_clock::now();
+  std::string key = std::string(code) + '\n' + description;
+
+  std::lock_guard<std::mutex> lock(mutex);
+  auto it = reports.find(key);
+
+  if (it == reports.end()) {
+    diagnostic& entry = reports[key];
+    entry.code = code;
+    entry.description = description;
+    entry.message = message;
+    entry.count = 1;
+    entry.first = entry.last = entry.lastPrinted = now;
+    order.push_back(std::move(key));
+
+    print(entry);
+    return true;
+  }
+
+  diagnostic& entry = it->second;
+  entry.count++;
+  entry.suppressed++;
+  entry.last = now;
+
+  if (now - entry.lastPrinted >= interval) {
+    printSuppressed(entry);
+    entry.suppressed = 0;
+    entry.lastPrinted = now;
+  }
+
+  return false;
+}
+
+void diagnostics::setInterval(std::chrono::steady_clock::duration interval) {
+  std::lock_guard<std::mutex> lock(mutex);
+  this->interval = interval;
+}
+
+void diagnostics::flushSuppressed() {
+  std::lock_guard<std::mutex> lock(mutex);
+  for (const std::string& key : order) {
+    diagnostic& entry = reports[key];
+    if (!entry.suppressed) continue;
+
+    printSuppressed(entry);
+    entry.suppressed = 0;
+    entry.lastPrinted = std::chrono::steady_clock::now();
+  }
+}
+
+void diagnostics::clear() {
+  std::lock_guard<std::mutex> lock(mutex);
+  reports.clear();
+  order.clear();
+}
+
+std::vector<diagnostic> diagnostics::entries() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  std::vector<diagnostic> result;
+  result.reserve(order.size());
+  for (const std::string& key : order) result.push_back(reports.at(key));
+  return result;
+}
+
+uint64_t diagnostics::count(const std::string& code) const {
+  std::lock_guard<std::mutex> lock(mutex);
+  uint64_t total = 0;
+  for (const auto& entry : reports)
+    if (entry.second.code == code) total += entry.second.count;
+  return total;
+}
+
+void diagnostics::print(const diagnostic& entry) {
+  util::logger::line_scope line;
+  line.stream() << "/* ** WARNING ** */\n"
+                << "Code: " << entry.code << '\n'
+                << "Error: " << entry.description << '\n'
+                << (entry.message.empty() ? "" : entry.message + '\n')
+                << " -- --------------------------------------------------- -- ";
+  line.commit();
+}
+
+void diagnostics::printSuppressed(const diagnostic& entry) {
+  util::logger::line_scope line;
+  line.stream() << "/* ** WARNING ** */ " << entry.code << ": " << entry.description << " (suprimido "
+                << entry.suppressed << (entry.suppressed == 1 ? " vez)" : " veces)");
+  line.commit();
+}
+
+}  // namespace exceptions
+}  // namespace graph3d
@@ -0,0 +1,70 @@
+#ifndef GRAPH3D_EXCEPTIONS_DIAGNOSTICS_H
+#define GRAPH3D_EXCEPTIONS_DIAGNOSTICS_H
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace graph3d {
+namespace exceptions {
+
+struct diagnostic {
+  std::string code, description, message;
+
+  // Veces que se reportó, y cuántas de ellas no se imprimieron desde el último aviso
+  uint64_t count = 0;
+  uint64_t suppressed = 0;
+
+  std::chrono::steady_clock::time_point first, last, lastPrinted;
+};
+
+// Canal central de avisos. Un mismo código con la misma descripción se imprime una vez;
+// las repeticiones se cuentan y se resumen como mucho una vez por intervalo
+class diagnostics {
+ public:
+  /// Singleton
+  static diagnostics& getInstance() {
+    static diagnostics instance;
+    return instance;
+  }
+
+ private:
+  mutable std::mutex mutex;
+  std::unordered_map<std::string, diagnostic> reports;
+  std::vector<std::string> order;
+  std::chrono::steady_clock::duration interval = std::chrono::seconds(5);
+
+  diagnostics() {}
+
+ public:
+  diagnostics& operator=(const diagnostics&) = delete;
+  diagnostics(const diagnostics&) = delete;
+
+  /// Devuelve true si el aviso se imprimió
+  bool report(const char* code, const std::string& description, const std::string& message = std::string());
+
+  void setInterval(std::chrono::steady_clock::duration interval);
+
+  /// Imprime el resumen de todo lo suprimido que quede pendiente
+  void flushSuppressed();
+
+  void clear();
+
+ public:
+  /// Consultas
+  std::vector<diagnostic> entries() const;
+  uint64_t count(const std::string& code) const;
+  bool has(const std::string& code) const { return count(code) > 0; }
+
+ private:
+  static void print(const diagnostic& entry);
+  static void printSuppressed(const diagnostic& entry);
+};
+
+}  // namespace exceptions
+}  // namespace graph3d
+
+#endif
@@ -4,6 +4,8 @@
 #include <iostream>
 #include <sstream>
 
+#include <util/logger.h>
+
 namespace graph3d {
 namespace exceptions {
 class exception : public std::exception {
@@ -14,7 +16,13 @@ class exception : public std::exception {
   exception(const char* errCode, const std::string description, const std::string message = std::string())
       : errCode(errCode), description(description), message(message) {}
 
+  const char *code() const { return errCode; }
+  const std::string &getDescription() const { return description; }
+  const std::string &getMessage() const { return message; }
+
   virtual void print() const {
+    // Lo que ya estaba encolado en el logger sale antes que el aviso
+    util::logger::flush();
     std::cerr << "/* ** Exception Ocurred ** */\n"
               << "Code: " << errCode << '\n'
               << "Error: " << description << '\n'
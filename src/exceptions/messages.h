@@ -11,6 +11,17 @@ static const char* WAR001 = "No se definio ninguna carpeta de %ss";
 static const char* WAR002 = "No se encontro el archivo %s";
 static const char* WAR003 = "No se encontro la carpeta %s";
 static const char* WAR004 = "No se encontraron shaders en la carpeta %s. No se cargara el shader.";
+static const char* WAR005 = "No se pudo cargar la textura %s";
+static const char* WAR006 = "No se pudo escribir la captura en %s";
+static const char* WAR007 = "No se pudo abrir el archivo de grabacion %s";
+static const char* WAR008 = "El renderer por software no tiene un kernel para el shader %s. Se dibujara en blanco";
+static const char* WAR009 = "No se pudo cargar el modelo %s en segundo plano";
+static const char* WAR010 = "No se pudo escribir la malla precocinada %s";
+static const char* WAR011 = "No se pudo escribir la textura comprimida %s";
+static const char* WAR012 = "No se pudo montar el paquete de recursos %s";
+static const char* WAR013 = "No se pudo compilar la variante %s de los shaders %s";
+static const char* WAR014 = "No se pudo recargar %s. Se sigue usando la version anterior";
+static const char* WAR015 = "Se dibuja un objeto con el modelo %s, que no esta cargado. No se dibujara";
 
 /// Errors
 static const char* ERR001 = "No se pudo leer el shader %s";
@@ -25,6 +36,15 @@ static const char* ERR006_2 = "Monitor solicitado: %d\nCantidad de Monitores: %d
 
 
 static const char* ERR010 = "Se solicitó un shader que no está cargado: %s";
+static const char* ERR011 = "Un frame estable reservo memoria %llu veces (%llu bytes)";
+static const char* ERR011_2 = "Presupuesto por frame: %llu reservas, %llu bytes (0 = sin limite)";
+static const char* ERR012 = "No se pudo crear el contexto headless (%s)";
+static const char* ERR012_2 = "Codigo de error de EGL: 0x%x";
+static const char* ERR013 = "Un framebuffer fuera de pantalla esta incompleto (0x%x)";
+static const char* ERR014 = "No se puede reproducir la grabacion %s";
+static const char* ERR014_2 = "Version de la grabacion: %u. Version soportada: %u";
+static const char* ERR015 = "No se puede cargar la malla precocinada %s";
+static const char* ERR016 = "Inclusion circular (o demasiado profunda) del shader %s";
 /// Internal Interface
 const std::string format(const char* const zcFormat, ...);
 
@@ -4,6 +4,9 @@
 #include <iostream>
 #include <sstream>
 
+#include <exceptions/diagnostics.h>
+#include <util/logger.h>
+
 namespace graph3d {
 namespace exceptions {
 class warning {
@@ -11,20 +14,23 @@ class warning {
   const char *errCode;
 
  public:
+  // Los avisos pasan por el canal de diagnósticos, que descarta las repeticiones
   warning(const char* errCode, const std::string description, const std::string message = std::string())
       : errCode(errCode), description(description), message(message) {
-    print();
+    diagnostics::getInstance().report(errCode, this->description, this->message);
   }
 
   virtual void print() const {
-    std::clog << "/* ** WARNING ** */\n"
-              << "Code: " << errCode << '\n'
-              << "Error: " << description << '\n'
-              << (message.empty() ? "" : message + '\n')
-              << " -- --------------------------------------------------- -- \n";
+    util::logger::line_scope line;
+    line.stream() << "/* ** WARNING ** */\n"
+                  << "Code: " << errCode << '\n'
+                  << "Error: " << description << '\n'
+                  << (message.empty() ? "" : message + '\n')
+                  << " -- --------------------------------------------------- -- ";
+    line.commit();
   }
 };
 }  // namespace exceptions
 }  // namespace graph3d
 
-#endif
\ No newline at end of file
+#endif
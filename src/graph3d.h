@@ -5,9 +5,12 @@
 #include <initializer_list>
 #include <iostream>
 #include <string>
+#include <vector>
 
 #include <core/graph3d.h>
+#include <exceptions/diagnostics.h>
 #include <util/logger.h>
+#include <util/profiler.h>
 
 class Graph3D : public graph3d::Graph3D {
   int width;
@@ -21,43 +24,66 @@ class Graph3D : public graph3d::Graph3D {
       : width(width), height(height), title(title), fullscreen(fullscreen), graph3d::Graph3D() {}
 
  public:
-  void start() {
+  /// Devuelve false si el ciclo de vida terminó por una excepción
+  bool start() {
+    bool success = false;
     try {
       runLifecycle();
+      success = true;
     } catch (graph3d::exceptions::exception ex) {
       ex.print();
     } catch (std::exception ex) {
+      graph3d::util::logger::flush();
       std::cerr << "/* ** Uncaught Exception Ocurred ** */\n"
                 << "Error: " << ex.what() << '\n'
                 << " -- --------------------------------------- -- \n";
     }
+    graph3d::exceptions::diagnostics::getInstance().flushSuppressed();
+    graph3d::util::logger::flush();
+    return success;
   }
 
  private:
   void runLifecycle() {
-    graph3d::util::log("> Hola", 1);
+    G3D_PROFILE_SCOPE("Graph3D::runLifecycle");
+    G3D_LOG(1, "> Hola");
 
-    graph3d::util::log("> Setup", 2);
-    setup();
-    graph3d::util::log("  < Setup", 2);
+    G3D_LOG(2, "> Setup");
+    {
+      G3D_PROFILE_SCOPE("Graph3D::setup");
+      setup();
+    }
+    G3D_LOG(2, "  < Setup");
 
-    createContext(width, height, title, fullscreen);
+    {
+      G3D_PROFILE_SCOPE("Graph3D::createContext");
+      createContext(width, height, title, fullscreen);
+    }
 
-    graph3d::util::log("> Configuracion", 2);
-    preConfiguration();
-    configure();
-    postConfiguration();
-    graph3d::util::log("  < Configuracion", 2);
+    G3D_LOG(2, "> Configuracion");
+    {
+      G3D_PROFILE_SCOPE("Graph3D::configure");
+      preConfiguration();
+      configure();
+      postConfiguration();
+    }
+    G3D_LOG(2, "  < Configuracion");
 
-    graph3d::util::log("> Pre Inicializacion", 2);
-    preinitialize();
-    graph3d::util::log("> Inicializacion", 2);
-    initialize();
-    graph3d::util::log("  < Inicializacion", 2);
+    G3D_LOG(2, "> Pre Inicializacion");
+    {
+      G3D_PROFILE_SCOPE("Graph3D::preinitialize");
+      preinitialize();
+    }
+    G3D_LOG(2, "> Inicializacion");
+    {
+      G3D_PROFILE_SCOPE("Graph3D::initialize");
+      initialize();
+    }
+    G3D_LOG(2, "  < Inicializacion");
 
     mainLoop();
 
-    graph3d::util::log("  < Adios", 1);
+    G3D_LOG(1, "  < Adios");
   }
 
  protected:
@@ -107,11 +133,19 @@ class Graph3D : public graph3d::Graph3D {
     graph3d::Graph3D::loadShader(std::forward<const std::string &>(shader));
   }
 
+  // Los modelos se importan y decodifican en paralelo; vuelve cuando están todos subidos
   void loadModels(const std::initializer_list<std::string> &&models) {
-    for (const std::string &model : models) loadModel(model);
+    std::vector<graph3d::opengl::AsyncModel> loads;
+    for (const std::string &model : models) loads.push_back(loadModelAsync(model));
+    for (const graph3d::opengl::AsyncModel &load : loads) waitModel(load);
   }
   void loadModel(const std::string &&model) { loadModel(model); }
   void loadModel(const std::string &model) { graph3d::Graph3D::loadModel(std::forward<const std::string &>(model)); }
+
+  /// Vuelve enseguida; el modelo se sube en los próximos frames (ver loadBudget)
+  graph3d::opengl::AsyncModel loadModelAsync(const std::string &model) {
+    return graph3d::Graph3D::loadModelAsync(model);
+  }
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,308 @@
+// Benchmarks de las partes del motor que corren en CPU. Este es el único archivo del
+// microbench que incluye headers del motor (util/resources.h define funciones no inline)
+
+#include <cmath>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <assimp/postprocess.h>
+#include <assimp/scene.h>
+#include <assimp/Importer.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <entity/camera.h>
+#include <entity/object.h>
+#include <microbench/harness.h>
+#include <opengl/model.h>
+#include <opengl/primitives.h>
+#include <opengl/shader.h>
+#include <software/rasterizer.h>
+#include <util/cook_cache.h>
+#include <util/jobs.h>
+#include <util/resources.h>
+
+using namespace graph3d;
+using graph3d::microbench::doNotOptimize;
+
+namespace {
+
+// Carpetas de recursos temporales, con un OBJ generado y una carpeta de shaders vacía. La caché de cocinados
+// queda apagada, así model/import_obj mide la importación con assimp y no la lectura del .g3dmesh
+struct Fixture {
+  std::filesystem::path root = std::filesystem::temp_directory_path() / "graph3d_microbench";
+  std::string objName = "sphere.obj";
+  std::string cookedName = "sphere.g3dmesh";
+
+  static Fixture& getInstance() {
+    static Fixture instance;
+    return instance;
+  }
+
+  /// El mismo OBJ cocinado al lado del original. Se cocina la primera vez que se pide
+  const std::string& cookedModel() {
+    if (!cooked) cooked = opengl::Model::cook(objName, (root / "models" / cookedName).generic_string());
+    return cookedName;
+  }
+
+ private:
+  bool cooked = false;
+
+  Fixture() {
+    for (const char* folder : {"a", "b", "models"}) std::filesystem::create_directories(root / folder);
+    writeSphere(root / "models" / objName, 64, 128);
+
+    // El archivo buscado está en la última carpeta, como el peor caso de la búsqueda lineal
+    for (const char* folder : {"a", "b", "models"})
+      util::addResourceFolder(util::G3D_RESOURCE_MODEL, (root / folder).generic_string());
+
+    util::CookCache::getInstance().setDirectory("");
+  }
+
+  static void writeSphere(const std::filesystem::path& path, int rings, int segments) {
+    std::ofstream out(path);
+    const float pi = 3.14159265358979f;
+    for (int ring = 0; ring <= rings; ring++) {
+      for (int segment = 0; segment <= segments; segment++) {
+        const float phi = pi * ring / rings, theta = 2 * pi * segment / segments;
+        const float x = std::sin(phi) * std::cos(theta), y = std::cos(phi), z = std::sin(phi) * std::sin(theta);
+        out << "v " << x << ' ' << y << ' ' << z << "\nvn " << x << ' ' << y << ' ' << z << "\nvt "
+            << static_cast<float>(segment) / segments << ' ' << static_cast<float>(ring) / rings << '\n';
+      }
+    }
+    for (int ring = 0; ring < rings; ring++) {
+      for (int segment = 0; segment < segments; segment++) {
+        const int a = ring * (segments + 1) + segment + 1, b = a + segments + 1;
+        out << "f " << a << '/' << a << '/' << a << ' ' << b << '/' << b << '/' << b << ' ' << a + 1 << '/' << a + 1
+            << '/' << a + 1 << "\nf " << b << '/' << b << '/' << b << ' ' << b + 1 << '/' << b + 1 << '/' << b + 1
+            << ' ' << a + 1 << '/' << a + 1 << '/' << a + 1 << '\n';
+      }
+    }
+  }
+};
+
+}  // namespace
+
+/// Model
+
+G3D_MICROBENCH(modelImport, "model/import_obj") {
+  Fixture& fixture = Fixture::getInstance();
+  state.resetTimer();
+  for (uint64_t i = 0; i < state.iterations(); i++) {
+    opengl::Model model(fixture.objName);
+    doNotOptimize(model.meshes.size());
+  }
+}
+
+G3D_MICROBENCH(modelLoadCooked, "model/load_cooked") {
+  Fixture& fixture = Fixture::getInstance();
+  const std::string& name = fixture.cookedModel();
+  state.resetTimer();
+  for (uint64_t i = 0; i < state.iterations(); i++) {
+    opengl::Model model(name);
+    doNotOptimize(model.meshes.size());
+  }
+}
+
+G3D_MICROBENCH(modelProcessMesh, "model/process_mesh") {
+  Fixture& fixture = Fixture::getInstance();
+  Assimp::Importer importer;
+  const aiScene* scene = importer.ReadFile((fixture.root / "models" / fixture.objName).generic_string(),
+                                           aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_CalcTangentSpace);
+  state.resetTimer();
+  for (uint64_t i = 0; i < state.iterations(); i++) {
+    opengl::Model model(scene, fixture.root.generic_string());
+    doNotOptimize(model.meshes.size());
+  }
+}
+
+/// Entity
+
+G3D_MICROBENCH(entityMove, "entity/move") {
+  entity::Object object;
+  for (uint64_t i = 0; i < state.iterations(); i++) object.move(glm::vec3(.001f, 0, 0));
+  doNotOptimize(object);
+}
+
+G3D_MICROBENCH(entityRotateAxis, "entity/rotate_axis") {
+  entity::Object object;
+  for (uint64_t i = 0; i < state.iterations(); i++) object.rotate(glm::vec3(0, 1, 0), .001f);
+  doNotOptimize(object);
+}
+
+G3D_MICROBENCH(entityRotateQuat, "entity/rotate_quat") {
+  entity::Object object;
+  const glm::quat rotation = glm::angleAxis(.001f, glm::vec3(0, 1, 0));
+  for (uint64_t i = 0; i < state.iterations(); i++) object.rotate(rotation);
+  doNotOptimize(object);
+}
+
+G3D_MICROBENCH(entityRotateAround, "entity/rotate_around") {
+  entity::Object object;
+  object.position = glm::vec3(1, 0, 0);
+  for (uint64_t i = 0; i < state.iterations(); i++) object.rotateAround(glm::vec3(0, 1, 0), .001f, glm::vec3(0));
+  doNotOptimize(object);
+}
+
+/// Camera
+
+G3D_MICROBENCH(cameraUpdateRotation, "camera/update_rotation") {
+  entity::Camera camera(glm::vec3(0), glm::vec3(0, 1, 0), -90.f, 0.f);
+  for (uint64_t i = 0; i < state.iterations(); i++) {
+    camera.g_yaw += .01f;
+    camera.updateRotation();
+  }
+  doNotOptimize(camera);
+}
+
+G3D_MICROBENCH(cameraView, "camera/view") {
+  entity::Camera camera(glm::vec3(0, 1, 3), glm::vec3(0, 1, 0), -90.f, -10.f);
+  for (uint64_t i = 0; i < state.iterations(); i++) {
+    const glm::mat4 view = camera.view;
+    doNotOptimize(view);
+  }
+}
+
+/// util::pipe
+
+G3D_MICROBENCH(pipeRead, "pipe/copy_pipe_read") {
+  entity::Object object;
+  for (uint64_t i = 0; i < state.iterations(); i++) {
+    const glm::vec3 position = object.position;
+    doNotOptimize(position);
+  }
+}
+
+G3D_MICROBENCH(pipeWrite, "pipe/copy_pipe_write") {
+  entity::Object object;
+  glm::vec3 position(0);
+  for (uint64_t i = 0; i < state.iterations(); i++) {
+    position.x += 1;
+    object.position = position;
+  }
+  doNotOptimize(object);
+}
+
+// Referencia: el mismo dato leído sin pipe
+G3D_MICROBENCH(pipeDirect, "pipe/direct_read") {
+  glm::mat4 transformation(1);
+  for (uint64_t i = 0; i < state.iterations(); i++) {
+    doNotOptimize(transformation);
+    const glm::vec3 position = transformation[3];
+    doNotOptimize(position);
+  }
+}
+
+/// ResourceManager
+
+G3D_MICROBENCH(resourceFilePath, "resources/file_path") {
+  Fixture& fixture = Fixture::getInstance();
+  state.resetTimer();
+  for (uint64_t i = 0; i < state.iterations(); i++) {
+    const std::filesystem::path path = util::getResourceFilePath(util::G3D_RESOURCE_MODEL, fixture.objName);
+    doNotOptimize(path);
+  }
+}
+
+G3D_MICROBENCH(resourceFolderPath, "resources/folder_path") {
+  Fixture::getInstance();
+  state.resetTimer();
+  for (uint64_t i = 0; i < state.iterations(); i++) {
+    const std::filesystem::path path = util::getResourceFolderPath(util::G3D_RESOURCE_MODEL, "models");
+    doNotOptimize(path);
+  }
+}
+
+/// Shader::set, con GL de mentira
+
+G3D_MICROBENCH(shaderSetInt, "shader/set_int") {
+  opengl::Shader shader;
+  for (uint64_t i = 0; i < state.iterations(); i++) shader.set("texture_diffuse1", static_cast<int>(i));
+}
+
+G3D_MICROBENCH(shaderSetVec3, "shader/set_vec3") {
+  opengl::Shader shader;
+  const glm::vec3 value(1, 2, 3);
+  for (uint64_t i = 0; i < state.iterations(); i++) shader.set("lights[0].position", value);
+}
+
+G3D_MICROBENCH(shaderSetMat4, "shader/set_mat4") {
+  opengl::Shader shader;
+  const glm::mat4 value(1);
+  for (uint64_t i = 0; i < state.iterations(); i++) shader.set("projection", value);
+}
+
+/// Sistema de jobs
+
+G3D_MICROBENCH(jobsRunWait, "jobs/run_wait") {
+  util::JobSystem& jobs = util::JobSystem::getInstance();
+  for (uint64_t i = 0; i < state.iterations(); i++) {
+    util::JobCounter counter;
+    jobs.run([] {}, &counter);
+    jobs.wait(counter);
+  }
+}
+
+G3D_MICROBENCH(jobsParallelFor, "jobs/parallel_for_4096") {
+  util::JobSystem& jobs = util::JobSystem::getInstance();
+  std::vector<float> values(4096, 1.f);
+  for (uint64_t i = 0; i < state.iterations(); i++)
+    jobs.parallelFor(
+        static_cast<uint32_t>(values.size()), [&values](uint32_t j) { values[j] = std::sqrt(values[j]); }, 256);
+  doNotOptimize(values[0]);
+}
+
+/// Rasterizador por software: una pasada de 512x512 con 64 esferas por iteración
+
+namespace {
+
+void rasterSpheres(microbench::State& state, software::Kernel kernel) {
+  const opengl::Mesh sphere = opengl::createSphere(.4f);
+  software::VertexStream stream;
+  stream.data = sphere.vertices.data();
+  stream.count = static_cast<uint32_t>(sphere.vertices.size());
+  stream.stride = sizeof(opengl::Vertex);
+  stream.position = offsetof(opengl::Vertex, Position);
+  stream.normal = offsetof(opengl::Vertex, Normal);
+  stream.texCoords = offsetof(opengl::Vertex, TexCoords);
+
+  software::ShadeState shading;
+  shading.kernel = kernel;
+  shading.albedo = glm::vec3(.8f, .6f, .4f);
+  shading.lightCount = 4;
+  for (uint32_t i = 0; i < shading.lightCount; i++) {
+    shading.lightPositions[i] = glm::vec3(i * 2.f - 3.f, 3.f, 2.f);
+    shading.lightColors[i] = glm::vec3(1.f);
+  }
+
+  const glm::mat4 viewProjection = glm::perspective(glm::radians(60.f), 1.f, .1f, 100.f) *
+                                   glm::lookAt(glm::vec3(0, 0, 8), glm::vec3(0), glm::vec3(0, 1, 0));
+  std::vector<glm::mat4> models;
+  for (int y = 0; y < 8; y++)
+    for (int x = 0; x < 8; x++)
+      models.push_back(glm::translate(glm::mat4(1), glm::vec3(x - 3.5f, y - 3.5f, 0)));
+
+  software::Target target(512, 512);
+  software::Rasterizer& rasterizer = software::Rasterizer::getInstance();
+  rasterizer.setTarget(&target);
+  state.resetTimer();
+  for (uint64_t i = 0; i < state.iterations(); i++) {
+    rasterizer.begin(0, 0, 512, 512, true, software::G3D_CLEAR_COLOR | software::G3D_CLEAR_DEPTH);
+    for (const glm::mat4& model : models)
+      rasterizer.draw(stream, sphere.indices.data(), static_cast<uint32_t>(sphere.indices.size()), model,
+                      viewProjection, shading);
+    rasterizer.flush();
+    doNotOptimize(target.pixels()[0]);
+  }
+  rasterizer.release(&target);
+}
+
+}  // namespace
+
+G3D_MICROBENCH(softwareRasterFlat, "software/raster_flat") { rasterSpheres(state, software::G3D_KERNEL_NONE); }
+
+G3D_MICROBENCH(softwareRasterLights, "software/raster_point_lights") {
+  rasterSpheres(state, software::G3D_KERNEL_POINT_LIGHTS);
+}
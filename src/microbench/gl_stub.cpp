@@ -0,0 +1,63 @@
+#include <microbench/gl_stub.h>
+
+#include <glad/glad.h>
+
+#include <cstring>
+
+namespace graph3d {
+namespace microbench {
+
+namespace {
+
+GLuint lastName = 0;
+
+void* APIENTRY stubNoop() { return nullptr; }
+
+const GLubyte* APIENTRY stubGetString(GLenum name) {
+  static const char version[] = "4.3.0 graph3d stub";
+  static const char empty[] = "";
+  return reinterpret_cast<const GLubyte*>(name == GL_VERSION ? version : empty);
+}
+
+// glad falla si no hay ninguna extensión, así que se informa una
+void APIENTRY stubGetIntegerv(GLenum name, GLint* data) { *data = name == GL_NUM_EXTENSIONS ? 1 : 0; }
+
+const GLubyte* APIENTRY stubGetStringi(GLenum, GLuint) {
+  return reinterpret_cast<const GLubyte*>("GL_GRAPH3D_stub");
+}
+
+void APIENTRY stubGetShaderiv(GLuint, GLenum, GLint* params) { *params = GL_TRUE; }
+
+void APIENTRY stubGenNames(GLsizei count, GLuint* names) {
+  for (GLsizei i = 0; i < count; i++) names[i] = ++lastName;
+}
+
+GLuint APIENTRY stubCreateObject() { return ++lastName; }
+
+GLuint APIENTRY stubCreateShader(GLenum) { return ++lastName; }
+
+// Una ubicación distinta por nombre no hace falta: sólo se mide el costo de pedirla
+GLint APIENTRY stubGetUniformLocation(GLuint, const GLchar* name) { return static_cast<GLint>(name[0]); }
+
+void* stubLoader(const char* name) {
+  if (!std::strcmp(name, "glGetString")) return reinterpret_cast<void*>(&stubGetString);
+  if (!std::strcmp(name, "glGetIntegerv")) return reinterpret_cast<void*>(&stubGetIntegerv);
+  if (!std::strcmp(name, "glGetStringi")) return reinterpret_cast<void*>(&stubGetStringi);
+  if (!std::strcmp(name, "glGetShaderiv") || !std::strcmp(name, "glGetProgramiv"))
+    return reinterpret_cast<void*>(&stubGetShaderiv);
+  if (!std::strcmp(name, "glGenBuffers") || !std::strcmp(name, "glGenVertexArrays") ||
+      !std::strcmp(name, "glGenTextures") || !std::strcmp(name, "glGenFramebuffers") ||
+      !std::strcmp(name, "glGenRenderbuffers") || !std::strcmp(name, "glGenQueries"))
+    return reinterpret_cast<void*>(&stubGenNames);
+  if (!std::strcmp(name, "glCreateProgram")) return reinterpret_cast<void*>(&stubCreateObject);
+  if (!std::strcmp(name, "glCreateShader")) return reinterpret_cast<void*>(&stubCreateShader);
+  if (!std::strcmp(name, "glGetUniformLocation")) return reinterpret_cast<void*>(&stubGetUniformLocation);
+  return reinterpret_cast<void*>(&stubNoop);
+}
+
+}  // namespace
+
+bool loadStubGL() { return gladLoadGLLoader(stubLoader); }
+
+}  // namespace microbench
+}  // namespace graph3d
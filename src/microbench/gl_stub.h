@@ -0,0 +1,15 @@
+#ifndef GRAPH3D_MICROBENCH_GL_STUB_H_
+#define GRAPH3D_MICROBENCH_GL_STUB_H_
+
+namespace graph3d {
+namespace microbench {
+
+// Carga en glad funciones que no hacen nada, para medir el lado CPU del código que llama a GL
+// sin contexto ni driver. Todas las funciones que no tienen un stub propio comparten una sola
+// que devuelve 0: vale en ABIs donde quien llama limpia la pila (x86-64, ARM64), no en Win32 x86
+bool loadStubGL();
+
+}  // namespace microbench
+}  // namespace graph3d
+
+#endif
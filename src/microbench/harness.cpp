@@ -0,0 +1,82 @@
+#include <microbench/harness.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+
+namespace graph3d {
+namespace microbench {
+
+std::vector<Benchmark>& getBenchmarks() {
+  static std::vector<Benchmark> benchmarks;
+  return benchmarks;
+}
+
+static double measure(const Benchmark& benchmark, uint64_t iterations) {
+  State state(iterations);
+  benchmark.func(state);
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - state.start()).count();
+}
+
+Result run(const Benchmark& benchmark, double minTime, uint32_t samples) {
+  Result result;
+  result.name = benchmark.name;
+
+  // Duplicar hasta pasar el décimo del tiempo buscado, y después extrapolar
+  uint64_t iterations = 1;
+  double elapsed = measure(benchmark, iterations);
+  while (elapsed < minTime / 10 && iterations < (1ull << 40)) {
+    iterations *= 2;
+    elapsed = measure(benchmark, iterations);
+  }
+  if (elapsed < minTime)
+    iterations = std::max<uint64_t>(iterations, static_cast<uint64_t>(iterations * minTime / std::max(elapsed, 1e-9)));
+
+  std::vector<double> nsPerOp;
+  for (uint32_t i = 0; i < std::max<uint32_t>(samples, 1); i++)
+    nsPerOp.push_back(measure(benchmark, iterations) * 1e9 / iterations);
+  std::sort(nsPerOp.begin(), nsPerOp.end());
+
+  result.iterations = iterations;
+  result.nsPerOp = nsPerOp[nsPerOp.size() / 2];
+  result.minNsPerOp = nsPerOp.front();
+  result.maxNsPerOp = nsPerOp.back();
+  return result;
+}
+
+void writeResult(std::ostream& out, const Result& result) {
+  out << std::setprecision(6) << "{\"name\":\"" << result.name << "\",\"nsPerOp\":" << result.nsPerOp
+      << ",\"minNsPerOp\":" << result.minNsPerOp << ",\"maxNsPerOp\":" << result.maxNsPerOp
+      << ",\"iterations\":" << result.iterations << "}\n";
+}
+
+static double readNumber(const std::string& line, const char* key) {
+  const size_t pos = line.find(key);
+  return pos == std::string::npos ? -1 : std::strtod(line.c_str() + pos + std::char_traits<char>::length(key), nullptr);
+}
+
+std::vector<Result> readResults(const std::string& path) {
+  std::vector<Result> results;
+  std::ifstream file(path);
+  std::string line;
+
+  while (std::getline(file, line)) {
+    const size_t begin = line.find("\"name\":\"");
+    if (begin == std::string::npos) continue;
+    const size_t end = line.find('"', begin + 8);
+    if (end == std::string::npos) continue;
+
+    Result result;
+    result.name = line.substr(begin + 8, end - begin - 8);
+    result.nsPerOp = readNumber(line, "\"nsPerOp\":");
+    result.minNsPerOp = readNumber(line, "\"minNsPerOp\":");
+    result.maxNsPerOp = readNumber(line, "\"maxNsPerOp\":");
+    result.iterations = static_cast<uint64_t>(readNumber(line, "\"iterations\":"));
+    results.push_back(result);
+  }
+  return results;
+}
+
+}  // namespace microbench
+}  // namespace graph3d
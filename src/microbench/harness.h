@@ -0,0 +1,79 @@
+#ifndef GRAPH3D_MICROBENCH_HARNESS_H_
+#define GRAPH3D_MICROBENCH_HARNESS_H_
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace graph3d {
+namespace microbench {
+
+class State {
+ private:
+  uint64_t g_iterations;
+  std::chrono::steady_clock::time_point g_start;
+
+ public:
+  explicit State(uint64_t iterations) : g_iterations(iterations), g_start(std::chrono::steady_clock::now()) {}
+
+  uint64_t iterations() const { return g_iterations; }
+
+  /// Descarta el tiempo de preparación: se llama justo antes del loop medido
+  void resetTimer() { g_start = std::chrono::steady_clock::now(); }
+  std::chrono::steady_clock::time_point start() const { return g_start; }
+};
+
+typedef void (*bench_func_t)(State&);
+
+struct Benchmark {
+  const char* name;
+  bench_func_t func;
+};
+
+std::vector<Benchmark>& getBenchmarks();
+
+struct Registration {
+  Registration(const char* name, bench_func_t func) { getBenchmarks().push_back({name, func}); }
+};
+
+// Evita que el compilador descarte un valor calculado en el loop medido
+template <typename T>
+inline void doNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : "r,m"(value) : "memory");
+#else
+  static volatile const void* sink;
+  sink = &value;
+#endif
+}
+
+struct Result {
+  std::string name;
+  uint64_t iterations = 0;
+
+  // Mediana, mínimo y máximo de las muestras
+  double nsPerOp = 0, minNsPerOp = 0, maxNsPerOp = 0;
+};
+
+/// Ajusta las iteraciones hasta que una muestra dure `minTime` segundos y toma `samples` muestras
+Result run(const Benchmark& benchmark, double minTime, uint32_t samples);
+
+/// JSON lines, una línea por benchmark
+void writeResult(std::ostream& out, const Result& result);
+std::vector<Result> readResults(const std::string& path);
+
+}  // namespace microbench
+}  // namespace graph3d
+
+#define G3D_MICROBENCH_CONCAT_IMPL(a, b) a##b
+#define G3D_MICROBENCH_CONCAT(a, b) G3D_MICROBENCH_CONCAT_IMPL(a, b)
+
+// G3D_MICROBENCH(entityMove, "entity/move") { for (uint64_t i = 0; i < state.iterations(); i++) ... }
+#define G3D_MICROBENCH(func, name)                                                                  \
+  static void func(::graph3d::microbench::State& state);                                           \
+  static ::graph3d::microbench::Registration G3D_MICROBENCH_CONCAT(g3d_microbench_, func)(name, &func); \
+  static void func(::graph3d::microbench::State& state)
+
+#endif
@@ -0,0 +1,106 @@
+// graph3d_microbench: benchmarks del lado CPU del motor, sin contexto de GL.
+//
+//   graph3d_microbench --filter entity/ --output micro.jsonl
+//   graph3d_microbench --baseline micro_baseline.jsonl --threshold 0.15
+//
+// Sale con 2 si algún benchmark es más lento que en el baseline por más de `threshold`.
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <microbench/gl_stub.h>
+#include <microbench/harness.h>
+
+using namespace graph3d::microbench;
+
+int main(int argc, char** argv) {
+  std::string filter, output = "graph3d_microbench.jsonl", baselinePath;
+  double minTime = .05, threshold = .15;
+  uint32_t samples = 5;
+  bool list = false;
+
+  for (int i = 1; i < argc; i++) {
+    const std::string arg = argv[i];
+    if (arg == "--list") {
+      list = true;
+      continue;
+    }
+    if (i + 1 >= argc || arg == "--help" || arg == "-h") {
+      std::cerr << "Uso: graph3d_microbench [--list] [--filter TEXTO] [--samples N] [--min-time SEGUNDOS]\n"
+                   "                          [--output PATH] [--baseline PATH] [--threshold X]\n";
+      return 1;
+    }
+
+    const std::string value = argv[++i];
+    if (arg == "--filter")
+      filter = value;
+    else if (arg == "--samples")
+      samples = static_cast<uint32_t>(std::strtoul(value.c_str(), nullptr, 10));
+    else if (arg == "--min-time")
+      minTime = std::strtod(value.c_str(), nullptr);
+    else if (arg == "--output")
+      output = value;
+    else if (arg == "--baseline")
+      baselinePath = value;
+    else if (arg == "--threshold")
+      threshold = std::strtod(value.c_str(), nullptr);
+    else {
+      std::cerr << "Opcion desconocida: " << arg << '\n';
+      return 1;
+    }
+  }
+
+  if (list) {
+    for (const Benchmark& benchmark : getBenchmarks()) std::printf("%s\n", benchmark.name);
+    return 0;
+  }
+
+  if (!loadStubGL()) {
+    std::cerr << "No se pudieron cargar las funciones de GL de prueba\n";
+    return 1;
+  }
+
+  std::ofstream file(output, std::ios::out | std::ios::trunc);
+  if (!file.is_open()) {
+    std::cerr << "No se pudo abrir " << output << '\n';
+    return 1;
+  }
+
+  std::vector<Result> results;
+  for (const Benchmark& benchmark : getBenchmarks()) {
+    if (!filter.empty() && std::string(benchmark.name).find(filter) == std::string::npos) continue;
+
+    const Result result = run(benchmark, minTime, samples);
+    writeResult(file, result);
+    results.push_back(result);
+    std::printf("%-28s %14.2f ns/op  (min %.2f, max %.2f, %llu iteraciones)\n", result.name.c_str(), result.nsPerOp,
+                result.minNsPerOp, result.maxNsPerOp, static_cast<unsigned long long>(result.iterations));
+  }
+
+  if (baselinePath.empty()) return 0;
+
+  const std::vector<Result> baseline = readResults(baselinePath);
+  if (baseline.empty()) {
+    std::cerr << "No se pudo leer el baseline " << baselinePath << '\n';
+    return 1;
+  }
+
+  int regressions = 0;
+  for (const Result& result : results) {
+    for (const Result& reference : baseline) {
+      if (reference.name != result.name || reference.nsPerOp <= 0) continue;
+      if (result.nsPerOp > reference.nsPerOp * (1 + threshold)) {
+        std::printf("REGRESION %s: %.2f -> %.2f ns/op (%+.1f%%)\n", result.name.c_str(), reference.nsPerOp,
+                    result.nsPerOp, (result.nsPerOp / reference.nsPerOp - 1) * 100);
+        regressions++;
+      }
+    }
+  }
+
+  if (!regressions) std::printf("Sin regresiones contra %s\n", baselinePath.c_str());
+  return regressions ? 2 : 0;
+}
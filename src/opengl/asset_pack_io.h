@@ -0,0 +1,85 @@
+#ifndef GRAPH3D_OPENGL_ASSET_PACK_IO_H_
+#define GRAPH3D_OPENGL_ASSET_PACK_IO_H_
+
+// Archivos de assimp leídos con util::MappedFile, para importar modelos que están dentro de un paquete de recursos
+// (util/asset_pack.h). Los archivos que el modelo referencia (un .mtl, por ejemplo) se buscan igual, en el paquete
+// o sueltos. También sirve para los modelos sueltos, para saber qué archivos leyó assimp.
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <assimp/IOStream.hpp>
+#include <assimp/IOSystem.hpp>
+
+#include <util/asset_pack.h>
+#include <util/mapped_file.h>
+
+namespace graph3d {
+namespace opengl {
+
+class MappedIOStream : public Assimp::IOStream {
+  std::shared_ptr<util::MappedFile> file;
+  size_t position = 0;
+
+ public:
+  explicit MappedIOStream(std::shared_ptr<util::MappedFile> file) : file(std::move(file)) {}
+
+  size_t Read(void *buffer, size_t size, size_t count) override {
+    if (size == 0) return 0;
+    count = std::min(count, (file->size() - position) / size);
+    std::memcpy(buffer, file->data() + position, size * count);
+    position += size * count;
+    return count;
+  }
+
+  size_t Write(const void *, size_t, size_t) override { return 0; }
+
+  aiReturn Seek(size_t offset, aiOrigin origin) override {
+    size_t target = offset;
+    if (origin == aiOrigin_CUR) target = position + offset;
+    if (origin == aiOrigin_END) target = file->size() - offset;
+    if (target > file->size()) return aiReturn_FAILURE;
+    position = target;
+    return aiReturn_SUCCESS;
+  }
+
+  size_t Tell() const override { return position; }
+  size_t FileSize() const override { return file->size(); }
+  void Flush() override {}
+};
+
+class AssetPackIOSystem : public Assimp::IOSystem {
+  std::vector<std::string> *opened;
+
+ public:
+  /// Con `opened`, anota ahí la ruta de cada archivo que se pudo abrir
+  explicit AssetPackIOSystem(std::vector<std::string> *opened = nullptr) : opened(opened) {}
+
+  bool Exists(const char *path) const override {
+    std::string name;
+    if (std::shared_ptr<util::AssetPack> pack = util::AssetPack::find(path, name)) return pack->contains(name);
+    std::error_code error;
+    return std::filesystem::exists(path, error);
+  }
+
+  char getOsSeparator() const override { return '/'; }
+
+  Assimp::IOStream *Open(const char *path, const char *mode = "rb") override {
+    if (std::strchr(mode, 'w') || std::strchr(mode, 'a')) return nullptr;
+    std::shared_ptr<util::MappedFile> file = util::MappedFile::open(path);
+    if (!file) return nullptr;
+    if (opened) opened->push_back(path);
+    return new MappedIOStream(std::move(file));
+  }
+
+  void Close(Assimp::IOStream *stream) override { delete stream; }
+};
+
+}  // namespace opengl
+}  // namespace graph3d
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef GRAPH3D_OPENGL_BACKEND_H_
+#define GRAPH3D_OPENGL_BACKEND_H_
+
+namespace graph3d {
+namespace opengl {
+
+// G3D_BACKEND_GLFW: ventanas reales con un contexto GLFW por ventana.
+// G3D_BACKEND_HEADLESS: un único contexto EGL sin superficie, y cada ventana es un framebuffer
+enum Backend { G3D_BACKEND_GLFW, G3D_BACKEND_HEADLESS };
+
+// Se elige antes de crear el contexto y no cambia después
+inline Backend& currentBackend() {
+  static Backend backend = G3D_BACKEND_GLFW;
+  return backend;
+}
+
+inline bool isHeadless() { return currentBackend() == G3D_BACKEND_HEADLESS; }
+
+// G3D_RENDERER_GL: los draws los hace el driver.
+// G3D_RENDERER_SOFTWARE: los triángulos se rasterizan en CPU (software/rasterizer.h) y GL sólo presenta la imagen.
+// Es independiente del backend, aunque lo normal es combinarlo con el headless en máquinas sin GPU
+enum Renderer { G3D_RENDERER_GL, G3D_RENDERER_SOFTWARE };
+
+// Igual que el backend: se elige antes de crear el contexto
+inline Renderer& currentRenderer() {
+  static Renderer renderer = G3D_RENDERER_GL;
+  return renderer;
+}
+
+inline bool isSoftware() { return currentRenderer() == G3D_RENDERER_SOFTWARE; }
+
+}  // namespace opengl
+}  // namespace graph3d
+
+#endif
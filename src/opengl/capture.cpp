@@ -0,0 +1,278 @@
+#include <opengl/capture.h>
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <string>
+
+#include <exceptions/messages.h>
+#include <exceptions/warning.h>
+#include <util/image_writer.h>
+#include <util/logger.h>
+#include <util/profiler.h>
+
+#ifdef _WIN32
+#define popen _popen
+#define pclose _pclose
+#endif
+
+namespace graph3d {
+namespace opengl {
+
+namespace {
+
+// El patrón lo escribe el usuario: no pasa por printf. Sólo se reemplaza la primera conversión entera
+// (%u, %d, %i con flags '0' o '-' y ancho, como "%05u"); "%%" es un '%' y cualquier otro '%' queda tal cual
+std::string framePath(const std::string& pattern, uint64_t index) {
+  std::string path;
+  bool replaced = false;
+  for (size_t i = 0; i < pattern.size(); i++) {
+    if (pattern[i] != '%') {
+      path.push_back(pattern[i]);
+      continue;
+    }
+    if (i + 1 < pattern.size() && pattern[i + 1] == '%') {
+      path.push_back('%');
+      i++;
+      continue;
+    }
+
+    size_t end = i + 1;
+    bool zero = false, left = false;
+    for (; end < pattern.size() && (pattern[end] == '0' || pattern[end] == '-'); end++) {
+      if (pattern[end] == '0') zero = true;
+      if (pattern[end] == '-') left = true;
+    }
+    size_t width = 0;
+    for (; end < pattern.size() && std::isdigit(static_cast<unsigned char>(pattern[end])) && width < 64; end++)
+      width = width * 10 + (pattern[end] - '0');
+    const bool integer = end < pattern.size() && (pattern[end] == 'u' || pattern[end] == 'd' || pattern[end] == 'i');
+    if (replaced || !integer) {
+      path.push_back('%');
+      continue;
+    }
+
+    const std::string number = std::to_string(index);
+    const std::string padding(width > number.size() ? width - number.size() : 0, zero && !left ? '0' : ' ');
+    path.append(left ? number + padding : padding + number);
+    replaced = true;
+    i = end;
+  }
+  return path;
+}
+
+}  // namespace
+
+FrameCapture::FrameCapture(const CaptureSettings& settings)
+    : settings(settings), ring(std::max<uint32_t>(settings.ringSize, 1)) {
+  G3D_LOG(3, "> Iniciar captura: " << settings.output);
+  for (slot& entry : ring) glGenBuffers(1, &entry.pbo);
+
+  if (settings.format == G3D_CAPTURE_PIPE) {
+#ifdef _WIN32
+    pipe = popen(settings.output.c_str(), "wb");
+#else
+    pipe = popen(settings.output.c_str(), "w");
+#endif
+    if (!pipe) exceptions::warning("WAR006", exceptions::format(exceptions::WAR006, settings.output.c_str()));
+  }
+
+  worker = std::thread(&FrameCapture::run, this);
+}
+
+FrameCapture::~FrameCapture() {
+  finish();
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  wake.notify_one();
+  worker.join();
+
+  for (slot& entry : ring) glDeleteBuffers(1, &entry.pbo);
+  if (pipe) pclose(pipe);
+
+  const CaptureStats result = stats();
+  G3D_LOG(3, "  < Captura terminada: " << result.written << " frames escritos, " << result.dropped
+                                       << " descartados, " << result.failed << " con error");
+}
+
+void FrameCapture::capture(GLuint framebuffer, int x, int y, int width, int height) {
+  static const std::vector<CaptureTile> whole;
+  capture(framebuffer, x, y, width, height, whole);
+}
+
+void FrameCapture::capture(GLuint framebuffer, int x, int y, int width, int height,
+                           const std::vector<CaptureTile>& tiles) {
+  G3D_PROFILE_SCOPE("FrameCapture::capture");
+  const auto begin = std::chrono::steady_clock::now();
+
+  collect(false);
+
+  slot& entry = ring[next];
+  if (entry.state != SLOT_FREE) {
+    if (settings.dropFrames) {
+      g_stats.dropped += tiles.empty() ? 1 : tiles.size();
+      frame += tiles.empty() ? 1 : tiles.size();
+      return;
+    }
+    // El más viejo del ring es justamente el que toca reutilizar
+    if (entry.state == SLOT_READING) map(entry);
+    release(entry, true);
+  }
+
+  const size_t size = static_cast<size_t>(width) * height * 4;
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, entry.pbo);
+  if (size > entry.capacity) {
+    glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+    entry.capacity = size;
+  }
+
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+  glReadBuffer(framebuffer ? GL_COLOR_ATTACHMENT0 : GL_BACK);
+  glPixelStorei(GL_PACK_ALIGNMENT, 4);
+  glReadPixels(x, y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+  entry.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  entry.width = width;
+  entry.height = height;
+  entry.frame = frame;
+  entry.tiles = tiles;
+  frame += tiles.empty() ? 1 : tiles.size();
+  entry.state = SLOT_READING;
+  next = (next + 1) % ring.size();
+
+  g_stats.captured++;
+  const double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+  g_stats.mainThreadTime += elapsed;
+  g_stats.maxMainThreadTime = std::max(g_stats.maxMainThreadTime, elapsed);
+}
+
+void FrameCapture::finish() {
+  G3D_PROFILE_SCOPE("FrameCapture::finish");
+  collect(true);
+}
+
+CaptureStats FrameCapture::stats() const {
+  CaptureStats result = g_stats;
+  result.written = written.load(std::memory_order_relaxed);
+  result.failed = failed.load(std::memory_order_relaxed);
+  return result;
+}
+
+// Recorre el ring del más viejo al más nuevo. Las fences terminan en orden, así que
+// el primer frame que no está listo corta la recorrida
+void FrameCapture::collect(bool wait) {
+  for (size_t i = 0; i < ring.size(); i++) {
+    slot& entry = ring[(next + i) % ring.size()];
+
+    if (entry.state == SLOT_READING) {
+      if (!wait) {
+        const GLenum status = glClientWaitSync(entry.fence, 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) break;
+      }
+      map(entry);
+    }
+
+    if (entry.state == SLOT_WRITING) release(entry, wait);
+  }
+}
+
+void FrameCapture::map(slot& entry) {
+  while (true) {
+    const GLenum status = glClientWaitSync(entry.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+    if (status != GL_TIMEOUT_EXPIRED) break;
+  }
+  glDeleteSync(entry.fence);
+  entry.fence = nullptr;
+
+  // El buffer queda mapeado mientras el worker lo escribe; ningún comando de GL lo usa hasta liberarlo
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, entry.pbo);
+  entry.pixels = static_cast<const uint8_t*>(
+      glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(entry.width) * entry.height * 4,
+                       GL_MAP_READ_BIT));
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+  entry.written.store(false, std::memory_order_relaxed);
+  entry.state = SLOT_WRITING;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    queue.push_back(&entry);
+  }
+  wake.notify_one();
+}
+
+void FrameCapture::release(slot& entry, bool wait) {
+  if (!entry.written.load(std::memory_order_acquire)) {
+    if (!wait) return;
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [&entry] { return entry.written.load(std::memory_order_acquire); });
+  }
+
+  if (entry.pixels) {
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, entry.pbo);
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  }
+
+  entry.pixels = nullptr;
+  entry.state = SLOT_FREE;
+}
+
+void FrameCapture::run() {
+  while (true) {
+    slot* entry;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      wake.wait(lock, [this] { return stopping || !queue.empty(); });
+      if (queue.empty()) return;
+      entry = queue.front();
+      queue.pop_front();
+    }
+
+    if (entry->tiles.empty()) {
+      CaptureTile whole;
+      whole.width = entry->width;
+      whole.height = entry->height;
+      (write(*entry, whole, entry->frame) ? written : failed).fetch_add(1, std::memory_order_relaxed);
+    } else {
+      for (size_t i = 0; i < entry->tiles.size(); i++)
+        (write(*entry, entry->tiles[i], entry->frame + i) ? written : failed).fetch_add(1, std::memory_order_relaxed);
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      entry->written.store(true, std::memory_order_release);
+    }
+    done.notify_all();
+  }
+}
+
+bool FrameCapture::write(const slot& entry, const CaptureTile& tile, uint64_t index) {
+  G3D_PROFILE_SCOPE("FrameCapture::write");
+  if (!entry.pixels) return false;
+
+  const size_t stride = static_cast<size_t>(entry.width) * 4;
+  const uint8_t* pixels = entry.pixels + tile.y * stride + tile.x * 4;
+  std::string path;
+  bool ok;
+
+  if (settings.format == G3D_CAPTURE_PIPE) {
+    path = settings.output;
+    ok = pipe && util::writeRaw(pipe, tile.width, tile.height, 4, pixels, stride);
+  } else {
+    path = tile.output.empty() ? framePath(settings.output, index) : tile.output;
+    if (settings.format == G3D_CAPTURE_PNG)
+      ok = util::writePNG(path, tile.width, tile.height, 4, pixels, stride);
+    else
+      ok = util::writeRaw(path, tile.width, tile.height, 4, pixels, stride);
+  }
+
+  if (!ok) exceptions::warning("WAR006", exceptions::format(exceptions::WAR006, path.c_str()));
+  return ok;
+}
+
+}  // namespace opengl
+}  // namespace graph3d
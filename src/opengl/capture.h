@@ -0,0 +1,130 @@
+#ifndef GRAPH3D_OPENGL_CAPTURE_H_
+#define GRAPH3D_OPENGL_CAPTURE_H_
+
+#include <glad/glad.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace graph3d {
+namespace opengl {
+
+enum CaptureFormat { G3D_CAPTURE_PNG, G3D_CAPTURE_RAW, G3D_CAPTURE_PIPE };
+
+struct CaptureSettings {
+  CaptureFormat format = G3D_CAPTURE_PNG;
+
+  // Patrón con el número de frame en la primera conversión entera ("frames/%05u.png"; "%%" es un '%'). No pasa
+  // por printf: cualquier otra secuencia con '%' queda tal cual. Con G3D_CAPTURE_PIPE es el comando del
+  // encoder, que recibe los frames RGBA de arriba hacia abajo por stdin
+  // (ej: "ffmpeg -f rawvideo -pix_fmt rgba -s 800x600 -i - out.mp4")
+  std::string output = "frame_%05u.png";
+
+  // Frames en vuelo. Cada uno se lee de la GPU recién cuando su fence terminó
+  uint32_t ringSize = 3;
+
+  // Si el ring está lleno porque la GPU o el disco no dan abasto: false espera, true descarta el frame
+  bool dropFrames = false;
+};
+
+// Una imagen dentro de la región capturada (coordenadas relativas a la región)
+struct CaptureTile {
+  int x = 0, y = 0;
+  int width = 0, height = 0;
+
+  // Vacío = según el patrón de CaptureSettings::output
+  std::string output;
+};
+
+struct CaptureStats {
+  uint64_t captured = 0;
+
+  // Imágenes; puede haber varias por captura
+  uint64_t written = 0;
+  uint64_t dropped = 0;
+  uint64_t failed = 0;
+
+  // Tiempo del hilo principal dentro de capture(), en milisegundos
+  double mainThreadTime = 0;
+  double maxMainThreadTime = 0;
+};
+
+// Captura de frames sin frenar el render: glReadPixels escribe en un ring de pixel buffers,
+// que se mapean cuando su fence terminó y se escriben a disco (o al encoder) en otro hilo.
+// Todos los métodos se llaman con el contexto de la ventana capturada como actual
+class FrameCapture {
+ private:
+  enum slot_state { SLOT_FREE, SLOT_READING, SLOT_WRITING };
+
+  struct slot {
+    GLuint pbo = 0;
+    GLsync fence = nullptr;
+    size_t capacity = 0;
+
+    uint32_t width = 0, height = 0;
+    uint64_t frame = 0;
+    const uint8_t* pixels = nullptr;
+
+    // Vacío = la región entera es una sola imagen
+    std::vector<CaptureTile> tiles;
+
+    slot_state state = SLOT_FREE;
+    std::atomic<bool> written{false};
+  };
+
+ private:
+  CaptureSettings settings;
+
+  std::vector<slot> ring;
+  size_t next = 0;
+  uint64_t frame = 0;
+
+  std::FILE* pipe = nullptr;
+
+  std::thread worker;
+  std::mutex mutex;
+  std::condition_variable wake, done;
+  std::deque<slot*> queue;
+  bool stopping = false;
+
+  CaptureStats g_stats;
+  std::atomic<uint64_t> written{0}, failed{0};
+
+ public:
+  FrameCapture& operator=(const FrameCapture&) = delete;
+  FrameCapture(const FrameCapture&) = delete;
+
+  explicit FrameCapture(const CaptureSettings& settings);
+  ~FrameCapture();
+
+ public:
+  /// Encola la lectura de la región del framebuffer. Va después de dibujar y antes del swap
+  void capture(GLuint framebuffer, int x, int y, int width, int height);
+
+  /// Una sola lectura de la región, escrita como una imagen por tile
+  void capture(GLuint framebuffer, int x, int y, int width, int height, const std::vector<CaptureTile>& tiles);
+
+  /// Espera a que todos los frames pendientes estén escritos
+  void finish();
+
+  CaptureStats stats() const;
+
+ private:
+  void collect(bool wait);
+  void map(slot& entry);
+  void release(slot& entry, bool wait);
+  void run();
+  bool write(const slot& entry, const CaptureTile& tile, uint64_t index);
+};
+
+}  // namespace opengl
+}  // namespace graph3d
+
+#endif
@@ -0,0 +1,352 @@
+#ifndef GRAPH3D_OPENGL_COOKED_H_
+#define GRAPH3D_OPENGL_COOKED_H_
+
+// Mallas precocinadas (.g3dmesh): los vértices y los índices como quedan después de assimp, listos para GL.
+//
+// El archivo se mapea en memoria y glBufferData lee directo del mapeo, sin vectores intermedios. El mapeo queda
+// vivo con las mallas (el renderer por software y las grabaciones leen de ahí), pero sólo ocupa páginas del
+// archivo, que el sistema puede descartar. La primera carga de un modelo lo importa con assimp y lo cocina en la
+// carpeta de util::CookCache, con el hash del archivo original como nombre; las siguientes lo encuentran ahí.
+// Los otros archivos que leyó assimp (el .mtl de un .obj, por ejemplo) van en el .g3dmesh con su hash: si alguno
+// cambió, se vuelve a cocinar.
+//
+// Formato, con el mismo layout que en memoria (little-endian): CookedHeader y las secciones que indica, cada una
+// alineada a 8 bytes (los vértices, a 16):
+//   mallas        CookedMesh[meshCount]
+//   texturas      CookedTexture[textureCount]
+//   por malla     uint32_t[meshTextureCount]: las texturas de cada malla, como posiciones en la tabla anterior
+//   fuentes       CookedSource[sourceCount]
+//   strings       tipos y rutas de las texturas y rutas de las fuentes, sin terminador
+//   vértices      Vertex[vertexCount]
+//   índices       uint32_t[indexCount], relativos a los vértices de su malla
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include <exceptions/messages.h>
+#include <opengl/mesh.h>
+#include <opengl/model_data.h>
+#include <util/cook_cache.h>
+#include <util/hash.h>
+#include <util/mapped_file.h>
+#include <util/profiler.h>
+
+namespace graph3d {
+namespace opengl {
+
+static constexpr uint32_t cookedMeshVersion = 2;
+static const char *const cookedMeshExtension = ".g3dmesh";
+
+struct CookedHeader {
+  char magic[4];         // "G3DM"
+  uint32_t version;      // cookedMeshVersion
+  uint64_t sourceHash;   // util::hash64 del archivo original
+  uint32_t vertexSize;   // sizeof(Vertex): con otro layout el archivo no sirve
+  uint32_t meshCount;
+  uint32_t textureCount;
+  uint32_t meshTextureCount;
+  float boundsMin[3];
+  float boundsMax[3];
+  uint64_t meshesOffset, texturesOffset, meshTexturesOffset;
+  uint64_t stringsOffset, stringsSize;
+  uint64_t verticesOffset, vertexCount;
+  uint64_t indicesOffset, indexCount;
+  uint64_t sourcesOffset, sourceCount;
+  uint64_t fileSize;
+};
+
+struct CookedMesh {
+  uint32_t firstVertex, vertexCount;
+  uint32_t firstIndex, indexCount;
+  uint32_t firstTexture, textureCount;
+};
+
+struct CookedTexture {
+  uint32_t typeOffset, typeSize;
+  uint32_t pathOffset, pathSize;
+};
+
+struct CookedSource {
+  uint64_t hash;
+  uint32_t pathOffset, pathSize;
+};
+
+static_assert(sizeof(CookedHeader) == 152, "CookedHeader es parte del formato");
+static_assert(sizeof(CookedMesh) == 24 && sizeof(CookedTexture) == 16, "CookedMesh y CookedTexture son del formato");
+static_assert(sizeof(CookedSource) == 16, "CookedSource es parte del formato");
+static_assert(std::is_trivially_copyable<Vertex>::value, "Los vértices se escriben y se leen tal cual");
+
+inline bool isCooked(const std::string &path) {
+  const size_t size = std::strlen(cookedMeshExtension);
+  return path.size() >= size && path.compare(path.size() - size, size, cookedMeshExtension) == 0;
+}
+
+/// Hash del contenido de `path`, o 0 si no se puede leer
+inline uint64_t hashFile(const std::string &path) {
+  G3D_PROFILE_SCOPE("hashFile");
+  std::shared_ptr<util::MappedFile> file = util::MappedFile::open(path);
+  return file ? util::hash64(file->data(), file->size()) : 0;
+}
+
+/// Escribe `data` en `path`. Primero va a un temporal, así otra carga nunca ve un archivo a medias.
+/// Devuelve false si no se pudo escribir
+inline bool writeCooked(const std::string &path, const ModelData &data, uint64_t sourceHash) {
+  G3D_PROFILE_SCOPE("writeCooked");
+  CookedHeader header{};
+  std::memcpy(header.magic, "G3DM", 4);
+  header.version = cookedMeshVersion;
+  header.sourceHash = sourceHash;
+  header.vertexSize = sizeof(Vertex);
+  for (int i = 0; i < 3; i++) {
+    header.boundsMin[i] = data.boundsMin[i];
+    header.boundsMax[i] = data.boundsMax[i];
+  }
+
+  std::vector<CookedTexture> textures;
+  std::string strings;
+  textures.reserve(data.textures.size());
+  for (const TextureData &texture : data.textures) {
+    textures.push_back({static_cast<uint32_t>(strings.size()), static_cast<uint32_t>(texture.type.size()),
+                        static_cast<uint32_t>(strings.size() + texture.type.size()),
+                        static_cast<uint32_t>(texture.path.size())});
+    strings += texture.type;
+    strings += texture.path;
+  }
+
+  std::vector<CookedSource> sources;
+  sources.reserve(data.sources.size());
+  for (const SourceData &source : data.sources) {
+    sources.push_back({source.hash, static_cast<uint32_t>(strings.size()), static_cast<uint32_t>(source.path.size())});
+    strings += source.path;
+  }
+
+  // Las mallas pueden venir de vectores o de otro .g3dmesh
+  std::vector<CookedMesh> meshes;
+  std::vector<uint32_t> meshTextures;
+  meshes.reserve(data.meshes.size());
+  for (const MeshData &mesh : data.meshes) {
+    const uint64_t vertexCount = mesh.mapped.storage ? mesh.mapped.vertexCount : mesh.vertices.size();
+    const uint64_t indexCount = mesh.mapped.storage ? mesh.mapped.indexCount : mesh.indices.size();
+    if (header.vertexCount + vertexCount > std::numeric_limits<uint32_t>::max() ||
+        header.indexCount + indexCount > std::numeric_limits<uint32_t>::max())
+      return false;
+
+    meshes.push_back({static_cast<uint32_t>(header.vertexCount), static_cast<uint32_t>(vertexCount),
+                      static_cast<uint32_t>(header.indexCount), static_cast<uint32_t>(indexCount),
+                      static_cast<uint32_t>(meshTextures.size()), static_cast<uint32_t>(mesh.textures.size())});
+    meshTextures.insert(meshTextures.end(), mesh.textures.begin(), mesh.textures.end());
+    header.vertexCount += vertexCount;
+    header.indexCount += indexCount;
+  }
+
+  header.meshCount = static_cast<uint32_t>(meshes.size());
+  header.textureCount = static_cast<uint32_t>(textures.size());
+  header.meshTextureCount = static_cast<uint32_t>(meshTextures.size());
+  header.sourceCount = sources.size();
+
+  auto align = [](uint64_t offset, uint64_t alignment) { return (offset + alignment - 1) / alignment * alignment; };
+  header.meshesOffset = align(sizeof(CookedHeader), 8);
+  header.texturesOffset = align(header.meshesOffset + meshes.size() * sizeof(CookedMesh), 8);
+  header.meshTexturesOffset = align(header.texturesOffset + textures.size() * sizeof(CookedTexture), 8);
+  header.sourcesOffset = align(header.meshTexturesOffset + meshTextures.size() * sizeof(uint32_t), 8);
+  header.stringsOffset = align(header.sourcesOffset + sources.size() * sizeof(CookedSource), 8);
+  header.stringsSize = strings.size();
+  header.verticesOffset = align(header.stringsOffset + strings.size(), 16);
+  header.indicesOffset = align(header.verticesOffset + header.vertexCount * sizeof(Vertex), 8);
+  header.fileSize = header.indicesOffset + header.indexCount * sizeof(uint32_t);
+
+  std::error_code error;
+  const std::filesystem::path target(path);
+  if (target.has_parent_path()) std::filesystem::create_directories(target.parent_path(), error);
+  const std::string temp = path + ".tmp" + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+
+  {
+    std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) return false;
+
+    uint64_t written = 0;
+    auto write = [&](uint64_t offset, const void *bytes, uint64_t size) {
+      static const char zeros[16] = {};
+      out.write(zeros, static_cast<std::streamsize>(offset - written));
+      if (size) out.write(static_cast<const char *>(bytes), static_cast<std::streamsize>(size));
+      written = offset + size;
+    };
+
+    write(0, &header, sizeof(header));
+    write(header.meshesOffset, meshes.data(), meshes.size() * sizeof(CookedMesh));
+    write(header.texturesOffset, textures.data(), textures.size() * sizeof(CookedTexture));
+    write(header.meshTexturesOffset, meshTextures.data(), meshTextures.size() * sizeof(uint32_t));
+    write(header.sourcesOffset, sources.data(), sources.size() * sizeof(CookedSource));
+    write(header.stringsOffset, strings.data(), strings.size());
+    for (size_t i = 0; i < data.meshes.size(); i++) {
+      const MeshData &mesh = data.meshes[i];
+      const Vertex *vertices = mesh.mapped.storage ? mesh.mapped.vertices : mesh.vertices.data();
+      const uint64_t offset = header.verticesOffset + uint64_t(meshes[i].firstVertex) * sizeof(Vertex);
+      write(offset, vertices, uint64_t(meshes[i].vertexCount) * sizeof(Vertex));
+    }
+    for (size_t i = 0; i < data.meshes.size(); i++) {
+      const MeshData &mesh = data.meshes[i];
+      const unsigned int *indices = mesh.mapped.storage ? mesh.mapped.indices : mesh.indices.data();
+      const uint64_t offset = header.indicesOffset + uint64_t(meshes[i].firstIndex) * sizeof(uint32_t);
+      write(offset, indices, uint64_t(meshes[i].indexCount) * sizeof(uint32_t));
+    }
+    write(header.fileSize, nullptr, 0);
+
+    if (!out.good()) {
+      out.close();
+      std::filesystem::remove(temp, error);
+      return false;
+    }
+  }
+
+  std::filesystem::rename(temp, target, error);
+  if (error) {
+    std::filesystem::remove(temp, error);
+    return false;
+  }
+  return true;
+}
+
+/// Lee el .g3dmesh de `path` en `data`, con las mallas apuntando al archivo mapeado. Con `sourceHash` distinto
+/// de 0, el archivo tiene que haberse cocinado de un original con ese hash y los otros archivos que leyó assimp,
+/// buscados desde data.directory, no pueden haber cambiado. Si no se puede usar, devuelve false y explica por qué
+/// en `error`. data.directory queda como estaba
+inline bool readCooked(const std::string &path, ModelData &data, uint64_t sourceHash, std::string &error) {
+  G3D_PROFILE_SCOPE("readCooked");
+  std::shared_ptr<util::MappedFile> file = util::MappedFile::open(path);
+  if (!file) {
+    error = "no se pudo abrir";
+    return false;
+  }
+
+  const unsigned char *bytes = file->data();
+  const uint64_t size = file->size();
+  CookedHeader header;
+  if (size < sizeof(header)) {
+    error = "archivo truncado";
+    return false;
+  }
+  std::memcpy(&header, bytes, sizeof(header));
+
+  if (std::memcmp(header.magic, "G3DM", 4) != 0) {
+    error = "no es un .g3dmesh";
+    return false;
+  }
+  if (header.version != cookedMeshVersion || header.vertexSize != sizeof(Vertex)) {
+    error = exceptions::format("version %u (soportada: %u)", header.version, cookedMeshVersion);
+    return false;
+  }
+  if (sourceHash && header.sourceHash != sourceHash) {
+    error = "se cocino de otro archivo";
+    return false;
+  }
+
+  // Cada sección entra en el archivo y está alineada para leerla en el lugar
+  auto fits = [size](uint64_t offset, uint64_t count, uint64_t element, uint64_t alignment) {
+    return offset % alignment == 0 && offset <= size && count <= (size - offset) / element;
+  };
+  if (header.fileSize != size || !fits(header.meshesOffset, header.meshCount, sizeof(CookedMesh), 8) ||
+      !fits(header.texturesOffset, header.textureCount, sizeof(CookedTexture), 8) ||
+      !fits(header.meshTexturesOffset, header.meshTextureCount, sizeof(uint32_t), 8) ||
+      !fits(header.sourcesOffset, header.sourceCount, sizeof(CookedSource), 8) ||
+      !fits(header.stringsOffset, header.stringsSize, 1, 1) ||
+      !fits(header.verticesOffset, header.vertexCount, sizeof(Vertex), 16) ||
+      !fits(header.indicesOffset, header.indexCount, sizeof(uint32_t), 8)) {
+    error = "archivo truncado o corrupto";
+    return false;
+  }
+
+  const CookedMesh *meshes = reinterpret_cast<const CookedMesh *>(bytes + header.meshesOffset);
+  const CookedTexture *textures = reinterpret_cast<const CookedTexture *>(bytes + header.texturesOffset);
+  const uint32_t *meshTextures = reinterpret_cast<const uint32_t *>(bytes + header.meshTexturesOffset);
+  const CookedSource *sources = reinterpret_cast<const CookedSource *>(bytes + header.sourcesOffset);
+  const char *strings = reinterpret_cast<const char *>(bytes + header.stringsOffset);
+  const Vertex *vertices = reinterpret_cast<const Vertex *>(bytes + header.verticesOffset);
+  const uint32_t *indices = reinterpret_cast<const uint32_t *>(bytes + header.indicesOffset);
+
+  ModelData result;
+  result.directory = data.directory;
+  result.boundsMin = glm::vec3(header.boundsMin[0], header.boundsMin[1], header.boundsMin[2]);
+  result.boundsMax = glm::vec3(header.boundsMax[0], header.boundsMax[1], header.boundsMax[2]);
+
+  result.textures.resize(header.textureCount);
+  for (uint32_t i = 0; i < header.textureCount; i++) {
+    const CookedTexture &texture = textures[i];
+    if (uint64_t(texture.typeOffset) + texture.typeSize > header.stringsSize ||
+        uint64_t(texture.pathOffset) + texture.pathSize > header.stringsSize) {
+      error = "archivo corrupto";
+      return false;
+    }
+    result.textures[i].type.assign(strings + texture.typeOffset, texture.typeSize);
+    result.textures[i].path.assign(strings + texture.pathOffset, texture.pathSize);
+  }
+
+  result.sources.resize(header.sourceCount);
+  for (uint64_t i = 0; i < header.sourceCount; i++) {
+    const CookedSource &source = sources[i];
+    if (uint64_t(source.pathOffset) + source.pathSize > header.stringsSize) {
+      error = "archivo corrupto";
+      return false;
+    }
+    result.sources[i].path.assign(strings + source.pathOffset, source.pathSize);
+    result.sources[i].hash = source.hash;
+    if (sourceHash && hashFile(data.directory + '/' + result.sources[i].path) != source.hash) {
+      error = "cambio " + result.sources[i].path;
+      return false;
+    }
+  }
+
+  // Los índices se revisan una vez acá: un índice fuera de la malla haría leer fuera del archivo al renderer
+  // por software. Las páginas que se tocan son las mismas que lee la subida a GL enseguida
+  result.meshes.resize(header.meshCount);
+  for (uint32_t i = 0; i < header.meshCount; i++) {
+    const CookedMesh &mesh = meshes[i];
+    if (uint64_t(mesh.firstVertex) + mesh.vertexCount > header.vertexCount ||
+        uint64_t(mesh.firstIndex) + mesh.indexCount > header.indexCount ||
+        uint64_t(mesh.firstTexture) + mesh.textureCount > header.meshTextureCount) {
+      error = "archivo corrupto";
+      return false;
+    }
+
+    const uint32_t *meshIndices = indices + mesh.firstIndex;
+    for (uint32_t j = 0; j < mesh.indexCount; j++) {
+      if (meshIndices[j] >= mesh.vertexCount) {
+        error = "indice fuera de la malla";
+        return false;
+      }
+    }
+
+    MeshData &target = result.meshes[i];
+    target.mapped.vertices = vertices + mesh.firstVertex;
+    target.mapped.vertexCount = mesh.vertexCount;
+    target.mapped.indices = meshIndices;
+    target.mapped.indexCount = mesh.indexCount;
+    target.mapped.storage = file;
+
+    target.textures.assign(meshTextures + mesh.firstTexture, meshTextures + mesh.firstTexture + mesh.textureCount);
+    for (uint32_t texture : target.textures) {
+      if (texture >= header.textureCount) {
+        error = "archivo corrupto";
+        return false;
+      }
+    }
+  }
+
+  data = std::move(result);
+  return true;
+}
+
+}  // namespace opengl
+}  // namespace graph3d
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef GRAPH3D_OPENGL_FRAMEBUFFER_H_
+#define GRAPH3D_OPENGL_FRAMEBUFFER_H_
+
+#include <glad/glad.h>
+
+#include <exceptions/exception.h>
+#include <exceptions/messages.h>
+#include <util/dimension.h>
+
+namespace graph3d {
+namespace opengl {
+
+// Framebuffer fuera de pantalla: color RGBA8 y depth/stencil en renderbuffers
+class Framebuffer {
+ private:
+  GLuint g_id = 0, colorBuffer = 0, depthBuffer = 0;
+  util::dimension g_size;
+
+ public:
+  Framebuffer& operator=(const Framebuffer&) = delete;
+  Framebuffer(const Framebuffer&) = delete;
+
+  explicit Framebuffer(const util::dimension& size) : g_size(size) {
+    glGenFramebuffers(1, &g_id);
+    glGenRenderbuffers(1, &colorBuffer);
+    glGenRenderbuffers(1, &depthBuffer);
+    resize(size);
+  }
+
+  ~Framebuffer() {
+    glDeleteFramebuffers(1, &g_id);
+    glDeleteRenderbuffers(1, &colorBuffer);
+    glDeleteRenderbuffers(1, &depthBuffer);
+  }
+
+ public:
+  GLuint id() const { return g_id; }
+  const util::dimension& size() const { return g_size; }
+
+  /// Lo deja enlazado como GL_FRAMEBUFFER
+  void resize(const util::dimension& size) {
+    g_size = size;
+
+    glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, size.width, size.height);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, size.width, size.height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, g_id);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+
+    const GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    if (status != GL_FRAMEBUFFER_COMPLETE)
+      throw exceptions::exception("ERR013", exceptions::format(exceptions::ERR013, status));
+  }
+
+  void bind() const { glBindFramebuffer(GL_FRAMEBUFFER, g_id); }
+};
+
+}  // namespace opengl
+}  // namespace graph3d
+
+#endif
@@ -0,0 +1,145 @@
+#include <opengl/headless.h>
+
+#include <cstring>
+#include <string>
+
+#include <exceptions/exception.h>
+#include <exceptions/messages.h>
+#include <util/logger.h>
+
+#ifdef G3D_HEADLESS_SUPPORT
+#define EGL_NO_X11
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+namespace graph3d {
+namespace opengl {
+
+#ifdef G3D_HEADLESS_SUPPORT
+
+static bool hasExtension(const char* extensions, const char* name) {
+  if (!extensions) return false;
+  const size_t length = std::strlen(name);
+  for (const char* it = std::strstr(extensions, name); it; it = std::strstr(it + length, name))
+    if ((it == extensions || it[-1] == ' ') && (it[length] == ' ' || it[length] == '\0')) return true;
+  return false;
+}
+
+// Surfaceless de Mesa primero (llvmpipe y GPUs con Mesa), después el primer dispositivo EGL
+// (drivers propietarios) y por último el display por defecto
+static EGLDisplay openDisplay() {
+  const char* clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+  auto getPlatformDisplay =
+      reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+
+  if (getPlatformDisplay) {
+    if (hasExtension(clientExtensions, "EGL_MESA_platform_surfaceless")) {
+      G3D_LOG(3, "> Usar plataforma EGL surfaceless");
+      EGLDisplay display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+      if (display != EGL_NO_DISPLAY) return display;
+    }
+
+    auto queryDevices = reinterpret_cast<PFNEGLQUERYDEVICESEXTPROC>(eglGetProcAddress("eglQueryDevicesEXT"));
+    if (queryDevices && hasExtension(clientExtensions, "EGL_EXT_platform_device")) {
+      EGLDeviceEXT device;
+      EGLint count = 0;
+      if (queryDevices(1, &device, &count) && count > 0) {
+        G3D_LOG(3, "> Usar dispositivo EGL");
+        EGLDisplay display = getPlatformDisplay(EGL_PLATFORM_DEVICE_EXT, device, nullptr);
+        if (display != EGL_NO_DISPLAY) return display;
+      }
+    }
+  }
+
+  return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+}
+
+static void fail(const char* step) {
+  throw exceptions::exception("ERR012", exceptions::format(exceptions::ERR012, step),
+                              exceptions::format(exceptions::ERR012_2, eglGetError()));
+}
+
+void HeadlessDevice::create() {
+  if (context) return;
+  G3D_LOG(2, "> Crear contexto headless");
+
+  EGLDisplay eglDisplay = openDisplay();
+  if (eglDisplay == EGL_NO_DISPLAY) fail("eglGetDisplay");
+
+  EGLint major, minor;
+  if (!eglInitialize(eglDisplay, &major, &minor)) fail("eglInitialize");
+  display = eglDisplay;
+
+  if (!eglBindAPI(EGL_OPENGL_API)) fail("eglBindAPI");
+
+  const EGLint configAttribs[] = {EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+                                  EGL_RED_SIZE,     8,               EGL_GREEN_SIZE,      8,
+                                  EGL_BLUE_SIZE,    8,               EGL_ALPHA_SIZE,      8,
+                                  EGL_DEPTH_SIZE,   24,              EGL_STENCIL_SIZE,    8,
+                                  EGL_NONE};
+  EGLConfig config;
+  EGLint configCount = 0;
+  if (!eglChooseConfig(eglDisplay, configAttribs, &config, 1, &configCount) || configCount == 0)
+    fail("eglChooseConfig");
+
+  const EGLint contextAttribs[] = {EGL_CONTEXT_MAJOR_VERSION,
+                                   4,
+                                   EGL_CONTEXT_MINOR_VERSION,
+                                   3,
+                                   EGL_CONTEXT_OPENGL_PROFILE_MASK,
+                                   EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+                                   EGL_NONE};
+  EGLContext eglContext = eglCreateContext(eglDisplay, config, EGL_NO_CONTEXT, contextAttribs);
+  if (eglContext == EGL_NO_CONTEXT) fail("eglCreateContext");
+  context = eglContext;
+
+  // Todo se dibuja en framebuffers propios; la superficie sólo hace falta si el driver no acepta ninguna
+  EGLSurface eglSurface = EGL_NO_SURFACE;
+  if (!hasExtension(eglQueryString(eglDisplay, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context")) {
+    const EGLint surfaceAttribs[] = {EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE};
+    eglSurface = eglCreatePbufferSurface(eglDisplay, config, surfaceAttribs);
+    if (eglSurface == EGL_NO_SURFACE) fail("eglCreatePbufferSurface");
+  }
+  surface = eglSurface;
+
+  makeCurrent();
+  G3D_LOG(2, "  < Crear contexto headless");
+}
+
+void HeadlessDevice::destroy() {
+  if (!display) return;
+
+  eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+  if (surface) eglDestroySurface(display, surface);
+  if (context) eglDestroyContext(display, context);
+  eglTerminate(display);
+
+  display = context = surface = nullptr;
+}
+
+void HeadlessDevice::makeCurrent() const {
+  if (!eglMakeCurrent(display, surface, surface, context)) fail("eglMakeCurrent");
+}
+
+void* HeadlessDevice::getProcAddress(const char* name) {
+  return reinterpret_cast<void*>(eglGetProcAddress(name));
+}
+
+#else
+
+void HeadlessDevice::create() {
+  throw exceptions::exception("ERR012", exceptions::format(exceptions::ERR012, "EGL"),
+                              "3DGraph se compilo sin soporte headless");
+}
+
+void HeadlessDevice::destroy() {}
+
+void HeadlessDevice::makeCurrent() const {}
+
+void* HeadlessDevice::getProcAddress(const char*) { return nullptr; }
+
+#endif
+
+}  // namespace opengl
+}  // namespace graph3d
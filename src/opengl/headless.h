@@ -0,0 +1,44 @@
+#ifndef GRAPH3D_OPENGL_HEADLESS_H_
+#define GRAPH3D_OPENGL_HEADLESS_H_
+
+namespace graph3d {
+namespace opengl {
+
+// Contexto OpenGL sin sistema de ventanas (EGL), para renderizar en servidores sin display.
+// Con Mesa funciona sobre llvmpipe, sin GPU
+class HeadlessDevice {
+ public:
+  /// Singleton
+  static HeadlessDevice& getInstance() {
+    static HeadlessDevice instance;
+    return instance;
+  }
+
+ private:
+  // EGLDisplay, EGLContext y EGLSurface; opacos para no incluir EGL en los headers
+  void* display = nullptr;
+  void* context = nullptr;
+  void* surface = nullptr;
+
+  HeadlessDevice() {}
+
+ public:
+  HeadlessDevice& operator=(const HeadlessDevice&) = delete;
+  HeadlessDevice(const HeadlessDevice&) = delete;
+  ~HeadlessDevice() { destroy(); }
+
+ public:
+  /// Crea el contexto y lo hace actual. Lanza ERR012 si no se puede
+  void create();
+  void destroy();
+  void makeCurrent() const;
+
+  bool isCreated() const { return context; }
+
+  static void* getProcAddress(const char* name);
+};
+
+}  // namespace opengl
+}  // namespace graph3d
+
+#endif
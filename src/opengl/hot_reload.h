@@ -0,0 +1,156 @@
+#ifndef GRAPH3D_OPENGL_HOT_RELOAD_H_
+#define GRAPH3D_OPENGL_HOT_RELOAD_H_
+
+// Recarga en caliente: qué archivos cambiaron en disco y qué programas de shaders y modelos dependen de ellos.
+//
+// Cada programa o modelo registra sus archivos con track() (un programa, su carpeta, sus etapas y lo que incluyen;
+// un modelo, su archivo y sus texturas) y se vigila la carpeta de cada uno con util::FileWatcher. Los avisos llegan
+// en el hilo del watcher y sólo anotan la ruta; take() los junta en el hilo principal, entre frames. Un editor
+// puede escribir un archivo en varios pasos: una ruta se entrega recién cuando pasó `quiet` sin avisos nuevos.
+//
+// Lo que está dentro de un paquete de recursos no se vigila.
+
+#include <chrono>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <util/file_watcher.h>
+
+namespace graph3d {
+namespace opengl {
+
+enum ReloadKind { G3D_RELOAD_SHADER, G3D_RELOAD_MODEL };
+
+class HotReload {
+ public:
+  typedef std::pair<ReloadKind, std::string> target_t;  // Tipo y alias
+
+ private:
+  typedef std::chrono::steady_clock clock_t;
+
+  // Los escribe el hilo del watcher
+  std::mutex mutex;
+  std::map<std::string, clock_t::time_point> changed;  // Ruta -> último aviso
+  bool overflow = false;
+
+  // Sólo el hilo principal
+  std::map<std::string, int> folders;                    // Carpeta vigilada -> id en FileWatcher
+  std::map<target_t, std::vector<std::string>> targets;  // Los archivos de cada uno, como los dio track()
+  std::map<std::string, std::set<target_t>> dependents;  // Ruta normalizada -> quiénes dependen de ella
+
+ public:
+  HotReload() {}
+  HotReload &operator=(const HotReload &) = delete;
+  HotReload(const HotReload &) = delete;
+
+  ~HotReload() {
+    for (const auto &folder : folders) util::FileWatcher::getInstance().unwatch(folder.second);
+  }
+
+  /// `alias` se recarga cuando cambia alguno de `files`. Una carpeta cuenta también por lo que se crea o se borra
+  /// adentro. Reemplaza lo que se había registrado antes para el mismo alias
+  void track(ReloadKind kind, const std::string &alias, const std::vector<std::string> &files) {
+    const target_t target(kind, alias);
+    forget(target);
+    targets[target] = files;
+
+    for (const std::string &file : files) {
+      const std::string path = normal(file);
+      dependents[path].insert(target);
+      std::error_code error;
+      watchFolder(std::filesystem::is_directory(path, error) ? path : parentOf(path));
+    }
+  }
+
+  /// Deja de recargar `alias`
+  void forget(ReloadKind kind, const std::string &alias) { forget(target_t(kind, alias)); }
+
+  /// Los archivos registrados para `alias`, en el orden de track()
+  const std::vector<std::string> &files(ReloadKind kind, const std::string &alias) const {
+    static const std::vector<std::string> none;
+    auto it = targets.find(target_t(kind, alias));
+    return it == targets.end() ? none : it->second;
+  }
+
+  /// Lo que hay que recargar: los que dependen de rutas sin avisos desde hace `quiet` segundos. Con avisos perdidos
+  /// (la cola de inotify se llenó), todo. En `paths` quedan las rutas cambiadas
+  std::set<target_t> take(double quiet, std::vector<std::string> &paths) {
+    std::set<target_t> result;
+    const clock_t::time_point limit =
+        clock_t::now() - std::chrono::duration_cast<clock_t::duration>(std::chrono::duration<double>(quiet));
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (overflow) {
+        overflow = false;
+        changed.clear();
+        for (const auto &target : targets) result.insert(target.first);
+        return result;
+      }
+      for (auto it = changed.begin(); it != changed.end();) {
+        if (it->second > limit) {
+          it++;
+          continue;
+        }
+        paths.push_back(it->first);
+        it = changed.erase(it);
+      }
+    }
+
+    for (const std::string &path : paths) {
+      for (const std::string &key : {path, parentOf(path)}) {
+        auto it = dependents.find(key);
+        if (it != dependents.end()) result.insert(it->second.begin(), it->second.end());
+      }
+    }
+    return result;
+  }
+
+  static std::string normal(const std::string &path) {
+    std::error_code error;
+    std::filesystem::path absolute = std::filesystem::absolute(path, error);
+    std::string normal = (error ? std::filesystem::path(path) : absolute).lexically_normal().generic_string();
+    while (normal.size() > 1 && normal.back() == '/') normal.pop_back();
+    return normal;
+  }
+
+ private:
+  static std::string parentOf(const std::string &path) {
+    const size_t slash = path.find_last_of('/');
+    return slash == std::string::npos ? std::string() : path.substr(0, slash ? slash : 1);
+  }
+
+  void forget(const target_t &target) {
+    auto it = targets.find(target);
+    if (it == targets.end()) return;
+    for (const std::string &file : it->second) {
+      auto dependent = dependents.find(normal(file));
+      if (dependent == dependents.end()) continue;
+      dependent->second.erase(target);
+      if (dependent->second.empty()) dependents.erase(dependent);
+    }
+    targets.erase(it);
+  }
+
+  // Las carpetas quedan vigiladas aunque nadie dependa ya de ellas: son pocas y se sueltan con el HotReload
+  void watchFolder(const std::string &folder) {
+    if (folder.empty() || folders.count(folder)) return;
+    const int id = util::FileWatcher::getInstance().watch(folder, [this, folder](const util::FileEvent &event) {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (event.kind == util::G3D_FILE_OVERFLOW)
+        overflow = true;
+      else
+        changed[event.name.empty() ? folder : folder + '/' + event.name] = clock_t::now();
+    });
+    folders[folder] = id;
+  }
+};
+
+}  // namespace opengl
+}  // namespace graph3d
+
+#endif
@@ -0,0 +1,242 @@
+#ifndef GRAPH3D_OPENGL_LOADER_H_
+#define GRAPH3D_OPENGL_LOADER_H_
+
+// Carga de modelos en segundo plano, en etapas:
+//   1. lectura y parseo con assimp (o del .g3dmesh ya cocinado, opengl/cooked.h), en un job
+//   2. un job por textura para decodificarla, que arrancan cuando termina el parseo
+//   3. subida a GL en el hilo principal, de a una textura o una malla por paso, hasta gastar el presupuesto
+//      de tiempo de cada frame (upload())
+// load() vuelve enseguida con un AsyncModel, para seguir con initialize() mientras los modelos llegan.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <exceptions/messages.h>
+#include <exceptions/warning.h>
+#include <opengl/model.h>
+#include <util/jobs.h>
+#include <util/logger.h>
+#include <util/profiler.h>
+
+namespace graph3d {
+namespace opengl {
+
+enum LoadStatus { G3D_LOAD_PENDING, G3D_LOAD_READY, G3D_LOAD_FAILED };
+
+struct model_load {
+  std::string alias, path;
+  std::atomic<LoadStatus> status{G3D_LOAD_PENDING};
+  std::exception_ptr error;
+
+  // `done` cuenta todos los jobs de la carga; `decoded`, los de las texturas
+  util::JobCounter done, decoded;
+
+  ModelData data;
+  Model* model = nullptr;
+  size_t nextTexture = 0, nextMesh = 0;
+};
+
+// Carga en curso. Se puede copiar y consultar desde cualquier hilo
+class AsyncModel {
+  friend class ModelLoader;
+  std::shared_ptr<model_load> g_load;
+
+  explicit AsyncModel(std::shared_ptr<model_load> load) : g_load(std::move(load)) {}
+
+ public:
+  AsyncModel() {}
+
+  LoadStatus status() const { return g_load ? g_load->status.load(std::memory_order_acquire) : G3D_LOAD_FAILED; }
+  bool ready() const { return status() == G3D_LOAD_READY; }
+  bool failed() const { return status() == G3D_LOAD_FAILED; }
+
+  const std::string& alias() const { return g_load->alias; }
+
+  /// nullptr hasta que esté listo. El dueño es quien registró la carga (OpenGL)
+  Model* model() const { return ready() ? g_load->model : nullptr; }
+};
+
+class ModelLoader {
+ public:
+  typedef std::function<void(const std::string&, Model*)> ready_func_t;
+
+ private:
+  ready_func_t onReady;
+
+  // Cargas sin terminar. Sólo las toca el hilo principal
+  std::vector<std::shared_ptr<model_load>> loads;
+
+  // Decodificadas, esperando su turno para subir
+  std::mutex mutex;
+  std::deque<std::shared_ptr<model_load>> uploads;
+
+ public:
+  ModelLoader& operator=(const ModelLoader&) = delete;
+  ModelLoader(const ModelLoader&) = delete;
+
+  /// `onReady` recibe cada modelo terminado, en el hilo principal
+  explicit ModelLoader(ready_func_t onReady) : onReady(std::move(onReady)) {}
+  ~ModelLoader() { cancel(); }
+
+  /// `path` ya resuelto en las carpetas de recursos
+  AsyncModel load(const std::string& alias, const std::string& path) {
+    G3D_LOG(3, "> Cargar modelo en segundo plano: " << path);
+    std::shared_ptr<model_load> load = std::make_shared<model_load>();
+    load->alias = alias;
+    load->path = path;
+    loads.push_back(load);
+
+    util::JobSystem& jobs = util::JobSystem::getInstance();
+    jobs.run(
+        [this, load, &jobs] {
+          try {
+            load->data = Model::import(load->path);
+          } catch (...) {
+            load->error = std::current_exception();
+            load->status.store(G3D_LOAD_FAILED, std::memory_order_release);
+            return;
+          }
+
+          ModelData& data = load->data;
+          for (size_t i = 0; i < data.textures.size(); i++)
+            jobs.run([load, i] { Model::decodeTexture(load->data.textures[i], load->data.directory); },
+                     &load->decoded, "ModelLoader::decode");
+
+          jobs.after(
+              load->decoded,
+              [this, load] {
+                std::lock_guard<std::mutex> lock(mutex);
+                uploads.push_back(load);
+              },
+              &load->done, "ModelLoader::queue");
+        },
+        &load->done, "ModelLoader::import");
+
+    return AsyncModel(load);
+  }
+
+  /// Sube a GL lo que esté decodificado hasta gastar `budget` segundos (al menos un paso). Sólo desde el hilo
+  /// principal. Devuelve true si quedan cargas sin terminar
+  bool upload(double budget) {
+    if (loads.empty()) return false;
+    G3D_PROFILE_SCOPE("ModelLoader::upload");
+    const auto start = std::chrono::steady_clock::now();
+
+    for (;;) {
+      std::shared_ptr<model_load> load;
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (uploads.empty()) break;
+        load = uploads.front();
+      }
+
+      if (step(*load)) {
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          uploads.pop_front();
+        }
+        finish(load);
+      }
+
+      if (std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() >= budget) break;
+    }
+
+    // Las que fallaron sin que nadie las espere se avisan acá
+    for (size_t i = 0; i < loads.size();) {
+      model_load& load = *loads[i];
+      if (load.status.load(std::memory_order_acquire) == G3D_LOAD_FAILED && load.done.done()) {
+        exceptions::warning("WAR009", exceptions::format(exceptions::WAR009, load.path.c_str()));
+        loads.erase(loads.begin() + i);
+      } else
+        i++;
+    }
+    return !loads.empty();
+  }
+
+  /// Bloquea hasta que `model` esté listo, ayudando con los jobs y subiendo lo que haga falta.
+  /// Si la carga falló, relanza su excepción
+  void wait(const AsyncModel& model) {
+    std::shared_ptr<model_load> load = model.g_load;
+    if (!load) return;
+
+    util::JobSystem::getInstance().wait(load->done);
+    while (load->status.load(std::memory_order_acquire) == G3D_LOAD_PENDING) upload(1e9);
+
+    if (load->status.load(std::memory_order_acquire) == G3D_LOAD_FAILED) {
+      forget(load.get());
+      std::rethrow_exception(load->error);
+    }
+  }
+
+  /// wait() de todas las cargas sin terminar. Relanza el primer error
+  void waitAll() {
+    while (!loads.empty()) wait(AsyncModel(loads.front()));
+  }
+
+  /// Cargas sin terminar
+  size_t pending() const { return loads.size(); }
+
+  /// true si hay una carga sin terminar para `alias`
+  bool loading(const std::string& alias) const {
+    for (const std::shared_ptr<model_load>& load : loads)
+      if (load->alias == alias) return true;
+    return false;
+  }
+
+  /// Espera los jobs en curso y descarta todo lo que no terminó
+  void cancel() {
+    for (const std::shared_ptr<model_load>& load : loads) {
+      try {
+        util::JobSystem::getInstance().wait(load->done);
+      } catch (...) {
+      }
+      if (load->status.load(std::memory_order_acquire) != G3D_LOAD_READY) delete load->model;
+    }
+    loads.clear();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    uploads.clear();
+  }
+
+ private:
+  // Un paso de la subida. Devuelve true cuando el modelo está completo
+  bool step(model_load& load) {
+    if (!load.model) {
+      load.model = new Model();
+      load.model->gammaCorrection = false;
+      load.model->start(load.data);
+    } else if (load.nextTexture < load.data.textures.size())
+      load.model->uploadTexture(load.data.textures[load.nextTexture++]);
+    else if (load.nextMesh < load.data.meshes.size())
+      load.model->uploadMesh(load.data.meshes[load.nextMesh++]);
+
+    return load.nextTexture == load.data.textures.size() && load.nextMesh == load.data.meshes.size();
+  }
+
+  void finish(const std::shared_ptr<model_load>& load) {
+    load->data = ModelData();
+    load->status.store(G3D_LOAD_READY, std::memory_order_release);
+    forget(load.get());
+    G3D_LOG(3, "  < Modelo cargado: " << load->path);
+    onReady(load->alias, load->model);
+  }
+
+  void forget(const model_load* load) {
+    loads.erase(std::remove_if(loads.begin(), loads.end(),
+                               [load](const std::shared_ptr<model_load>& entry) { return entry.get() == load; }),
+                loads.end());
+  }
+};
+
+}  // namespace opengl
+}  // namespace graph3d
+
+#endif
@@ -6,13 +6,21 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <fstream>
 #include <iostream>
+#include <memory>
 #include <sstream>
 #include <string>
 #include <vector>
 
 #include <opengl/shader.h>
+#include <software/image.h>
+#include <software/rasterizer.h>
+#include <util/allocations.h>
+#include <util/metrics.h>
 
 namespace graph3d {
 namespace opengl {
@@ -29,32 +37,115 @@ struct Texture {
   unsigned int id;
   std::string type;
   std::string path;
+  size_t memory = 0;
+
+  // Sólo con el renderer por software: copia en CPU para los kernels
+  std::shared_ptr<const software::Image> image;
+};
+
+// Vértices e índices que no son de la malla, por ejemplo los de un .g3dmesh mapeado en memoria (opengl/cooked.h).
+// `storage` los mantiene vivos mientras exista la malla
+struct MeshBuffers {
+  const Vertex *vertices = nullptr;
+  uint32_t vertexCount = 0;
+  const unsigned int *indices = nullptr;
+  uint32_t indexCount = 0;
+  std::shared_ptr<const void> storage;
 };
 
 class Mesh {
  public:
+  // Vacíos si la malla usa buffers externos: para leer los datos, vertexData() e indexData()
   std::vector<Vertex> vertices;
   std::vector<unsigned int> indices;
   std::vector<Texture> textures;
   unsigned int VAO;
 
-  Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices, std::vector<Texture> textures) {
-    this->vertices = vertices;
-    this->indices = indices;
-    this->textures = textures;
+  Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices, std::vector<Texture> textures)
+      : vertices(std::move(vertices)), indices(std::move(indices)), textures(std::move(textures)) {
+    setupSamplers();
+    setupMesh();
+  }
 
+  // Sin copiar los datos: GL los lee directo de `buffers`
+  Mesh(MeshBuffers buffers, std::vector<Texture> textures)
+      : textures(std::move(textures)), external(std::move(buffers)) {
+    setupSamplers();
     setupMesh();
   }
 
-  void Draw(Shader shader) {
+  const Vertex *vertexData() const { return external.storage ? external.vertices : vertices.data(); }
+  uint32_t vertexCount() const {
+    return external.storage ? external.vertexCount : static_cast<uint32_t>(vertices.size());
+  }
+  const unsigned int *indexData() const { return external.storage ? external.indices : indices.data(); }
+  uint32_t indexCount() const { return external.storage ? external.indexCount : static_cast<uint32_t>(indices.size()); }
+
+  void Draw(const Shader &shader) const {
+    G3D_ALLOC_TAG("Mesh::Draw");
+    for (unsigned int i = 0; i < textures.size(); i++) {
+      glActiveTexture(GL_TEXTURE0 + i);
+      shader.set(samplers[i].c_str(), (int)i);
+      glBindTexture(GL_TEXTURE_2D, textures[i].id);
+    }
+
+    glBindVertexArray(VAO);
+    glDrawElements(GL_TRIANGLES, indexCount(), GL_UNSIGNED_INT, 0);
+    glBindVertexArray(0);
+
+    util::Metrics &metrics = util::Metrics::getInstance();
+    metrics.add(util::G3D_COUNTER_DRAW_CALLS);
+    metrics.add(util::G3D_COUNTER_TRIANGLES, indexCount() / 3);
+    metrics.add(util::G3D_COUNTER_VERTICES, vertexCount());
+    metrics.add(util::G3D_COUNTER_VAO_BINDS);
+    metrics.add(util::G3D_COUNTER_TEXTURE_BINDS, textures.size());
+
+    glActiveTexture(GL_TEXTURE0);
+  }
+
+  // Renderer por software: el mismo draw, con el kernel del shader. La textura i queda en la unidad i, como en Draw
+  void Rasterize(const Shader &shader, const glm::mat4 &model, const glm::mat4 &viewProjection) const {
+    G3D_ALLOC_TAG("Mesh::Rasterize");
+    static constexpr uint32_t maxUnits = 16;
+    const software::Image *units[maxUnits];
+    const uint32_t unitCount = std::min<uint32_t>(static_cast<uint32_t>(textures.size()), maxUnits);
+    for (uint32_t i = 0; i < unitCount; i++) units[i] = textures[i].image.get();
+
+    software::ShadeState state;
+    software::resolve(shader.kernel(), shader.uniforms(), units, unitCount, state);
+
+    software::VertexStream stream;
+    stream.data = vertexData();
+    stream.count = vertexCount();
+    stream.stride = sizeof(Vertex);
+    stream.position = offsetof(Vertex, Position);
+    stream.normal = offsetof(Vertex, Normal);
+    stream.texCoords = offsetof(Vertex, TexCoords);
+    software::Rasterizer::getInstance().draw(stream, indexData(), indexCount(), model, viewProjection, state);
+
+    util::Metrics &metrics = util::Metrics::getInstance();
+    metrics.add(util::G3D_COUNTER_DRAW_CALLS);
+    metrics.add(util::G3D_COUNTER_TRIANGLES, indexCount() / 3);
+    metrics.add(util::G3D_COUNTER_VERTICES, vertexCount());
+  }
+
+ private:
+  unsigned int VBO, EBO;
+  MeshBuffers external;
+
+  // Nombre del sampler de cada textura ("texture_diffuse1", ...), armado una sola vez
+  std::vector<std::string> samplers;
+
+  void setupSamplers() {
     unsigned int diffuseNr = 1;
     unsigned int specularNr = 1;
     unsigned int normalNr = 1;
     unsigned int heightNr = 1;
-    for (unsigned int i = 0; i < textures.size(); i++) {
-      glActiveTexture(GL_TEXTURE0 + i);
+
+    samplers.reserve(textures.size());
+    for (const Texture &texture : textures) {
       std::string number;
-      std::string name = textures[i].type;
+      const std::string &name = texture.type;
       if (name == "texture_diffuse")
         number = std::to_string(diffuseNr++);
       else if (name == "texture_specular")
@@ -64,21 +155,10 @@ class Mesh {
       else if (name == "texture_height")
         number = std::to_string(heightNr++);
 
-      shader.set((name + number).c_str(), (int)i);
-
-      glBindTexture(GL_TEXTURE_2D, textures[i].id);
+      samplers.push_back(name + number);
     }
-
-    glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
-
-    glActiveTexture(GL_TEXTURE0);
   }
 
- private:
-  unsigned int VBO, EBO;
-
   void setupMesh() {
     glGenVertexArrays(1, &VAO);
     glGenBuffers(1, &VBO);
@@ -86,10 +166,10 @@ class Mesh {
 
     glBindVertexArray(VAO);
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, vertexCount() * sizeof(Vertex), vertexData(), GL_STATIC_DRAW);
 
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCount() * sizeof(unsigned int), indexData(), GL_STATIC_DRAW);
 
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
@@ -103,7 +183,15 @@ class Mesh {
     glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Bitangent));
 
     glBindVertexArray(0);
+
+    util::Metrics &metrics = util::Metrics::getInstance();
+    metrics.add(util::G3D_COUNTER_BUFFER_BYTES_UPLOADED, getMemory());
+    metrics.add(util::G3D_GAUGE_MESHES, 1);
+    metrics.add(util::G3D_GAUGE_BUFFER_MEMORY, static_cast<int64_t>(getMemory()));
   }
+
+ public:
+  size_t getMemory() const { return vertexCount() * sizeof(Vertex) + indexCount() * sizeof(unsigned int); }
 };
 }  // namespace opengl
 }  // namespace graph3d
@@ -4,9 +4,14 @@
 #include <glad/glad.h>
 #include <glm/gtc/matrix_transform.hpp>
 
+#include <cstdint>
+#include <filesystem>
 #include <fstream>
+#include <limits>
 #include <iostream>
 #include <map>
+#include <unordered_map>
+#include <memory>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -20,9 +25,16 @@
 #include <exceptions/exception.h>
 #include <exceptions/warning.h>
 
+#include <opengl/asset_pack_io.h>
+#include <opengl/cooked.h>
 #include <opengl/mesh.h>
+#include <opengl/model_data.h>
 #include <opengl/shader.h>
+#include <opengl/texture_cache.h>
 
+#include <util/jobs.h>
+#include <util/metrics.h>
+#include <util/profiler.h>
 #include <util/resources.h>
 
 namespace graph3d {
@@ -32,47 +44,233 @@ class Model {
  public:
   std::vector<Texture> textures_loaded;
 
+  // Referencias a la caché de las texturas de textures_loaded, que se sueltan con el modelo
+  std::vector<TextureRef> cachedTextures;
+
   std::vector<Mesh> meshes;
   std::string directory;
   bool gammaCorrection;
 
-  Model() {}
-  Model(std::string const &path, bool gamma = false) : gammaCorrection(gamma) {
-    loadModel(util::getResourceFilePath(util::G3D_RESOURCE_MODEL, path).generic_string());
+  // Los otros archivos que leyó assimp (un .mtl, por ejemplo), relativos a directory
+  std::vector<std::string> sources;
+
+  // Caja envolvente en espacio de modelo
+  glm::vec3 boundsMin{std::numeric_limits<float>::max()};
+  glm::vec3 boundsMax{std::numeric_limits<float>::lowest()};
+
+  Model() { util::track(util::G3D_GAUGE_MODELS, 1); }
+  Model(std::string const &path, bool gamma = false) : Model() {
+    gammaCorrection = gamma;
+    ModelData data = import(util::getResourceFilePath(util::G3D_RESOURCE_MODEL, path).generic_string());
+    decodeTextures(data, gamma);
+    upload(data);
+  }
+
+  // Escena ya importada con assimp. Las texturas se buscan en `directory`
+  Model(const aiScene *scene, const std::string &directory, bool gamma = false) : Model() {
+    gammaCorrection = gamma;
+    ModelData data = convert(scene, directory);
+    decodeTextures(data, gamma);
+    upload(data);
+  }
+
+  // Modelo armado con mallas ya creadas (por ejemplo, las de opengl/primitives.h)
+  explicit Model(std::vector<Mesh> meshes) : Model() {
+    gammaCorrection = false;
+    this->meshes = std::move(meshes);
+    for (const Mesh &mesh : this->meshes) {
+      const Vertex *vertices = mesh.vertexData();
+      for (uint32_t i = 0; i < mesh.vertexCount(); i++) {
+        boundsMin = glm::min(boundsMin, vertices[i].Position);
+        boundsMax = glm::max(boundsMax, vertices[i].Position);
+      }
+    }
+  }
+
+  ~Model() {
+    util::Metrics &metrics = util::Metrics::getInstance();
+    metrics.add(util::G3D_GAUGE_MODELS, -1);
+    metrics.add(util::G3D_GAUGE_MESHES, -static_cast<int64_t>(meshes.size()));
+    for (const Mesh &mesh : meshes) metrics.add(util::G3D_GAUGE_BUFFER_MEMORY, -static_cast<int64_t>(mesh.getMemory()));
+  }
+
+  bool hasBounds() const { return boundsMin.x <= boundsMax.x; }
+
+  void Draw(const Shader &shader) const {
+    for (const Mesh &mesh : meshes) mesh.Draw(shader);
+  }
+
+  void Rasterize(const Shader &shader, const glm::mat4 &model, const glm::mat4 &viewProjection) const {
+    for (const Mesh &mesh : meshes) mesh.Rasterize(shader, model, viewProjection);
+  }
+
+  /// El modelo se va a ver sobre unos `pixels` de pantalla: pide los mipmaps que hacen falta (opengl/texture_cache.h)
+  void demandTextures(float pixels) const {
+    TextureCache &cache = TextureCache::getInstance();
+    for (const TextureRef &texture : cachedTextures)
+      if (texture) cache.demand(*texture, pixels);
+  }
+
+ public:
+  /// Etapas de la carga. import, convert y decodeTexture no usan GL.
+  /// import lee la malla cocinada del archivo si ya existe (opengl/cooked.h); si no, importa con assimp y la cocina
+  static ModelData import(std::string const &path) {
+    G3D_PROFILE_SCOPE("Model::import");
+    const std::string directory = path.substr(0, path.find_last_of('/'));
+    ModelData data;
+    data.directory = directory;
+    std::string error;
+
+    if (isCooked(path)) {
+      if (!readCooked(path, data, 0, error))
+        throw exceptions::exception("ERR015", exceptions::format(exceptions::ERR015, path.c_str()), error);
+      return data;
+    }
+
+    const uint64_t hash = hashFile(path);
+    const std::string cooked = hash ? util::CookCache::getInstance().pathFor(hash, cookedMeshExtension) : std::string();
+    std::error_code missing;
+    if (!cooked.empty() && std::filesystem::exists(cooked, missing)) {
+      if (readCooked(cooked, data, hash, error)) {
+        G3D_LOG(3, "  > Malla precocinada: " << cooked);
+        return data;
+      }
+      G3D_LOG(3, "  > Se vuelve a cocinar " << path << ": " << error);
+    }
+
+    data = importScene(path, directory);
+    if (!cooked.empty() && !writeCooked(cooked, data, hash))
+      exceptions::warning("WAR010", exceptions::format(exceptions::WAR010, cooked.c_str()));
+    return data;
+  }
+
+  /// Cocina el modelo `path` (en las carpetas de recursos) en `destination`, para distribuir el .g3dmesh en lugar
+  /// del original. Las rutas de las texturas quedan relativas, así que va en la misma carpeta que el original
+  static bool cook(const std::string &path, const std::string &destination) {
+    const std::string source = util::getResourceFilePath(util::G3D_RESOURCE_MODEL, path).generic_string();
+    return writeCooked(destination, import(source), hashFile(source));
+  }
+
+  static ModelData convert(const aiScene *scene, const std::string &directory) {
+    ModelData data;
+    data.directory = directory;
+    std::unordered_map<std::string, uint32_t> textures;
+    processNode(scene->mRootNode, scene, data, textures);
+    return data;
+  }
+
+  /// Cómo se filtran y se guardan las texturas de cada tipo. Con `gamma`, la difusa es sRGB también para GL
+  static TextureUsage textureUsage(const std::string &type, bool gamma) {
+    if (type == "texture_diffuse") return gamma ? G3D_TEXTURE_COLOR_SRGB : G3D_TEXTURE_COLOR;
+    if (type == "texture_normal") return G3D_TEXTURE_NORMAL;
+    return G3D_TEXTURE_DATA;
+  }
+
+  /// Busca la textura en la caché y la decodifica si nadie lo hizo antes
+  static void decodeTexture(TextureData &texture, const std::string &directory, bool gamma = false) {
+    G3D_PROFILE_SCOPE("Model::decodeTexture");
+    TextureCache &cache = TextureCache::getInstance();
+    texture.cached = cache.acquire(directory + '/' + texture.path, textureUsage(texture.type, gamma));
+    if (texture.cached) cache.decode(*texture.cached);
+  }
+
+  /// Las texturas de `data`, repartidas entre los hilos del sistema de jobs
+  static void decodeTextures(ModelData &data, bool gamma = false) {
+    util::JobSystem::getInstance().parallelFor(
+        static_cast<uint32_t>(data.textures.size()),
+        [&data, gamma](uint32_t i) { decodeTexture(data.textures[i], data.directory, gamma); });
+  }
+
+  /// Subida a GL, todo junto o de a partes: primero start(), después cada textura y recién después las mallas
+  void start(const ModelData &data) {
+    directory = data.directory;
+    for (const SourceData &source : data.sources) sources.push_back(source.path);
+    boundsMin = data.boundsMin;
+    boundsMax = data.boundsMax;
+    textures_loaded.reserve(data.textures.size());
+    cachedTextures.reserve(data.textures.size());
+    meshes.reserve(data.meshes.size());
+  }
+
+  // Una textura que no se pudo leer queda en 0, que en GL se lee negra
+  void uploadTexture(TextureData &data) {
+    G3D_PROFILE_SCOPE("Model::uploadTexture");
+    Texture texture;
+    texture.id = 0;
+    texture.type = data.type;
+    texture.path = data.path;
+    if (data.cached) {
+      TextureCache::getInstance().upload(*data.cached);
+      texture.id = data.cached->id;
+      texture.memory = data.cached->memory;
+      texture.image = data.cached->image;
+    }
+    textures_loaded.push_back(texture);
+    cachedTextures.push_back(std::move(data.cached));
+  }
+
+  void uploadMesh(MeshData &data) {
+    G3D_PROFILE_SCOPE("Model::uploadMesh");
+    std::vector<Texture> textures;
+    textures.reserve(data.textures.size());
+    for (uint32_t texture : data.textures) textures.push_back(textures_loaded[texture]);
+    if (data.mapped.storage)
+      meshes.emplace_back(std::move(data.mapped), std::move(textures));
+    else
+      meshes.emplace_back(std::move(data.vertices), std::move(data.indices), std::move(textures));
   }
 
-  void Draw(Shader shader) {
-    for (unsigned int i = 0; i < meshes.size(); i++) meshes[i].Draw(shader);
+  void upload(ModelData &data) {
+    start(data);
+    for (TextureData &texture : data.textures) uploadTexture(texture);
+    for (MeshData &mesh : data.meshes) uploadMesh(mesh);
   }
 
  private:
-  void loadModel(std::string const &path) {
+  // `textures`: posición en data.textures de cada ruta ya vista
+  typedef std::unordered_map<std::string, uint32_t> texture_index_t;
+
+  // data.sources queda con los archivos que abrió assimp además de `path`, para la clave de la malla cocinada y
+  // para la recarga en caliente
+  static ModelData importScene(const std::string &path, const std::string &directory) {
     Assimp::Importer importer;
+    std::vector<std::string> opened;
+    importer.SetIOHandler(new AssetPackIOSystem(&opened));  // Importer lo libera
     const aiScene *scene =
         importer.ReadFile(path, aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_CalcTangentSpace);
 
     if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
       throw exceptions::exception("ERR007", "Error importing model", importer.GetErrorString());
 
-    directory = path.substr(0, path.find_last_of('/'));
-
-    processNode(scene->mRootNode, scene);
+    ModelData data = convert(scene, directory);
+    const std::filesystem::path model = std::filesystem::path(path).lexically_normal();
+    const std::filesystem::path base = std::filesystem::path(directory).lexically_normal();
+    for (const std::string &file : opened) {
+      const std::filesystem::path source = std::filesystem::path(file).lexically_normal();
+      if (source == model) continue;
+      const std::string relative = source.lexically_relative(base).generic_string();
+      bool seen = false;
+      for (const SourceData &other : data.sources) seen = seen || other.path == relative;
+      if (!seen && !relative.empty()) data.sources.push_back({relative, hashFile(source.generic_string())});
+    }
+    return data;
   }
 
-  void processNode(aiNode *node, const aiScene *scene) {
+  static void processNode(aiNode *node, const aiScene *scene, ModelData &data, texture_index_t &textures) {
     for (unsigned int i = 0; i < node->mNumMeshes; i++) {
       aiMesh *mesh = scene->mMeshes[node->mMeshes[i]];
-      meshes.push_back(processMesh(mesh, scene));
+      data.meshes.push_back(processMesh(mesh, scene, data, textures));
     }
     for (unsigned int i = 0; i < node->mNumChildren; i++) {
-      processNode(node->mChildren[i], scene);
+      processNode(node->mChildren[i], scene, data, textures);
     }
   }
 
-  Mesh processMesh(aiMesh *mesh, const aiScene *scene) {
-    std::vector<Vertex> vertices;
-    std::vector<unsigned int> indices;
-    std::vector<Texture> textures;
+  static MeshData processMesh(aiMesh *mesh, const aiScene *scene, ModelData &data, texture_index_t &textures) {
+    MeshData result;
+    std::vector<Vertex> &vertices = result.vertices;
+    std::vector<unsigned int> &indices = result.indices;
+    vertices.reserve(mesh->mNumVertices);
 
     for (unsigned int i = 0; i < mesh->mNumVertices; i++) {
       Vertex vertex;
@@ -82,6 +280,8 @@ class Model {
       vector.y = mesh->mVertices[i].y;
       vector.z = mesh->mVertices[i].z;
       vertex.Position = vector;
+      data.boundsMin = glm::min(data.boundsMin, vector);
+      data.boundsMax = glm::max(data.boundsMax, vector);
 
       vector.x = mesh->mNormals[i].x;
       vector.y = mesh->mNormals[i].y;
@@ -115,79 +315,27 @@ class Model {
 
     aiMaterial *material = scene->mMaterials[mesh->mMaterialIndex];
 
-    std::vector<Texture> diffuseMaps = loadMaterialTextures(material, aiTextureType_DIFFUSE, "texture_diffuse");
-    textures.insert(textures.end(), diffuseMaps.begin(), diffuseMaps.end());
-
-    std::vector<Texture> specularMaps = loadMaterialTextures(material, aiTextureType_SPECULAR, "texture_specular");
-    textures.insert(textures.end(), specularMaps.begin(), specularMaps.end());
-
-    std::vector<Texture> normalMaps = loadMaterialTextures(material, aiTextureType_HEIGHT, "texture_normal");
-    textures.insert(textures.end(), normalMaps.begin(), normalMaps.end());
-
-    std::vector<Texture> heightMaps = loadMaterialTextures(material, aiTextureType_AMBIENT, "texture_height");
-    textures.insert(textures.end(), heightMaps.begin(), heightMaps.end());
+    loadMaterialTextures(material, aiTextureType_DIFFUSE, "texture_diffuse", data, textures, result);
+    loadMaterialTextures(material, aiTextureType_SPECULAR, "texture_specular", data, textures, result);
+    loadMaterialTextures(material, aiTextureType_HEIGHT, "texture_normal", data, textures, result);
+    loadMaterialTextures(material, aiTextureType_AMBIENT, "texture_height", data, textures, result);
 
-    return Mesh(vertices, indices, textures);
+    return result;
   }
 
-  std::vector<Texture> loadMaterialTextures(aiMaterial *mat, aiTextureType type, std::string typeName) {
-    std::vector<Texture> textures;
+  static void loadMaterialTextures(aiMaterial *mat, aiTextureType type, const char *typeName, ModelData &data,
+                                   texture_index_t &textures, MeshData &mesh) {
     for (unsigned int i = 0; i < mat->GetTextureCount(type); i++) {
       aiString str;
       mat->GetTexture(type, i, &str);
-      bool skip = false;
-      for (unsigned int j = 0; j < textures_loaded.size(); j++) {
-        if (std::strcmp(textures_loaded[j].path.data(), str.C_Str()) == 0) {
-          textures.push_back(textures_loaded[j]);
-          skip = true;
-          break;
-        }
-      }
-      if (!skip) {
-        Texture texture;
-        texture.id = TextureFromFile(str.C_Str(), this->directory, gammaCorrection);
-        texture.type = typeName;
-        texture.path = str.C_Str();
-        textures.push_back(texture);
-        textures_loaded.push_back(texture);
+      auto inserted = textures.emplace(str.C_Str(), static_cast<uint32_t>(data.textures.size()));
+      if (inserted.second) {
+        data.textures.emplace_back();
+        data.textures.back().type = typeName;
+        data.textures.back().path = str.C_Str();
       }
+      mesh.textures.push_back(inserted.first->second);
     }
-    return textures;
-  }
-
-  unsigned int TextureFromFile(const char *path, const std::string &directory, bool gamma) {
-    std::string filename = std::string(path);
-    filename = directory + '/' + filename;
-
-    unsigned int textureID;
-    glGenTextures(1, &textureID);
-
-    int width, height, nrComponents;
-    unsigned char *data = stbi_load(filename.c_str(), &width, &height, &nrComponents, 0);
-    if (data) {
-      GLenum format;
-      if (nrComponents == 1)
-        format = GL_RED;
-      else if (nrComponents == 3)
-        format = GL_RGB;
-      else if (nrComponents == 4)
-        format = GL_RGBA;
-
-      glBindTexture(GL_TEXTURE_2D, textureID);
-      glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-      glGenerateMipmap(GL_TEXTURE_2D);
-
-      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-    } else
-      exceptions::warning("WAR001", "Couldn't load texture", ((std::string) "path: " + path).c_str());
-
-    stbi_image_free(data);
-
-    return textureID;
   }
 };
 
@@ -0,0 +1,62 @@
+#ifndef GRAPH3D_OPENGL_MODEL_DATA_H_
+#define GRAPH3D_OPENGL_MODEL_DATA_H_
+
+// Etapas de la carga sin nada de GL, así corren en cualquier hilo (opengl/loader.h):
+// importar con assimp (o leer el .g3dmesh, opengl/cooked.h), decodificar las texturas y, recién en el hilo
+// principal, subir todo
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <opengl/mesh.h>
+#include <opengl/texture_cache.h>
+
+namespace graph3d {
+namespace opengl {
+
+/// Textura de un material. Los píxeles viven en la caché (opengl/texture_cache.h)
+struct TextureData {
+  std::string type;
+  std::string path;
+  TextureRef cached;
+};
+
+/// Otro archivo que leyó assimp al importar el modelo (un .mtl, por ejemplo)
+struct SourceData {
+  std::string path;   // Relativa a ModelData::directory, como las de las texturas
+  uint64_t hash = 0;  // util::hash64 del contenido al importar
+};
+
+struct MeshData {
+  std::vector<Vertex> vertices;
+  std::vector<unsigned int> indices;
+
+  // Si viene de un .g3dmesh, los datos están en el archivo mapeado y los vectores quedan vacíos
+  MeshBuffers mapped;
+
+  // Posiciones en ModelData::textures
+  std::vector<uint32_t> textures;
+};
+
+struct ModelData {
+  std::string directory;
+  std::vector<MeshData> meshes;
+
+  // Sin repetidos: una textura que usan varias mallas se decodifica y se sube una sola vez
+  std::vector<TextureData> textures;
+
+  // Lo que se leyó además del archivo del modelo: la malla cocinada sólo sirve mientras no cambie
+  std::vector<SourceData> sources;
+
+  glm::vec3 boundsMin{std::numeric_limits<float>::max()};
+  glm::vec3 boundsMax{std::numeric_limits<float>::lowest()};
+};
+
+}  // namespace opengl
+}  // namespace graph3d
+
+#endif
@@ -6,17 +6,33 @@
 #include <GLFW/glfw3.h>
 
 #include <glm/glm.hpp>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <set>
 #include <vector>
 
 #include <core/context.h>
 #include <core/context_type.h>
 #include <entity/camera.h>
 #include <entity/object.h>
+#include <opengl/backend.h>
+#include <opengl/headless.h>
+#include <opengl/hot_reload.h>
+#include <opengl/loader.h>
 #include <opengl/model.h>
 #include <opengl/shader.h>
+#include <opengl/texture_cache.h>
 #include <opengl/window.h>
+#include <software/rasterizer.h>
+#include <util/allocations.h>
 #include <util/bounds.h>
+#include <util/frustum.h>
+#include <util/jobs.h>
 #include <util/logger.h>
+#include <util/metrics.h>
+#include <util/recording.h>
 
 namespace graph3d {
 class Graph3D;
@@ -37,25 +53,43 @@ class OpenGL {
   std::map<std::string, Model *> models;
   std::vector<Window *> windows;
 
-  Shader *activeShader;
+  // Los modelos que termina de subir pasan a `models`, como si se hubieran cargado recién
+  ModelLoader loader{[this](const std::string &alias, Model *model) { addModel(alias, model); }};
+
+  Shader *activeShader = nullptr;
+  bool gladLoaded = false;
+
+  // Alias de modelos que se quisieron dibujar sin que nadie los cargue: WAR015 se avisa una sola vez por alias
+  std::set<std::string> missingModels;
+
+  // Recarga en caliente (enableHotReload). El reemplazo de un programa se arma aparte y entra en shaderPrograms
+  // recién cuando compiló; los modelos vuelven a cargarse con `loader` y entran en `models` por addModel()
+  struct shader_reload {
+    std::vector<std::string> files;  // Los que el job vuelve a leer
+    util::JobCounter read;
+    Shader *replacement = nullptr;
+  };
+  static constexpr double reloadQuiet = 0.1;  // Segundos sin cambios antes de recargar, ver HotReload::take
+  std::unique_ptr<HotReload> reloader;
+  std::map<std::string, std::unique_ptr<shader_reload>> shaderReloads;
+  std::map<std::string, std::string> modelFiles;  // Alias -> archivo, de los modelos que se cargaron de disco
 
   std::vector<context_change_func_t> contextChangeSubscribers;
 
  protected:
   /// Constructor
-  OpenGL() {
-    util::log("> Inicializar OpenGL", 2);
-    initGLFW();
-    initialize();
-    util::log("  < Inicializar OpenGL", 2);
-  }
+  OpenGL() {}
 
   /// Destructor
   ~OpenGL() {
-    util::log("> Liberar recursos de OpenGL", 2);
+    G3D_LOG(2, "> Liberar recursos de OpenGL");
 
+    enableHotReload(false);
+    loader.cancel();
     for (auto &entry : models) delete entry.second;
     models.clear();
+    // Las texturas de la caché son de este contexto
+    TextureCache::getInstance().clear();
 
     for (auto &entry : shaderPrograms) delete entry.second;
     shaderPrograms.clear();
@@ -63,8 +97,11 @@ class OpenGL {
     for (Window *window : windows) delete window;
     windows.clear();
 
-    glfwTerminate();
-    util::log("  < Liberar recursos de OpenGL", 2);
+    if (isHeadless())
+      HeadlessDevice::getInstance().destroy();
+    else
+      glfwTerminate();
+    G3D_LOG(2, "  < Liberar recursos de OpenGL");
   }
 
  protected:
@@ -73,33 +110,132 @@ class OpenGL {
  public:
   /// Interfaz
   void addShaderFolder(const std::string &folder) {
-    util::log("> Agregar carpeta de Shaders", 3);
+    G3D_LOG(3, "> Agregar carpeta de Shaders");
     graph3d::util::addResourceFolder(graph3d::util::G3D_RESOURCE_SHADER, folder);
-    util::log("  < Agregar carpeta de Shaders", 3);
+    if (util::Recorder *recorder = util::Recorder::active()) recorder->folder(util::G3D_RESOURCE_SHADER, folder);
+    G3D_LOG(3, "  < Agregar carpeta de Shaders");
   }
 
   void addModelFolder(const std::string &folder) {
-    util::log("> Agregar carpeta de Modelos", 3);
+    G3D_LOG(3, "> Agregar carpeta de Modelos");
     graph3d::util::addResourceFolder(graph3d::util::G3D_RESOURCE_MODEL, folder);
-    util::log("  < Agregar carpeta de Modelos", 3);
+    if (util::Recorder *recorder = util::Recorder::active()) recorder->folder(util::G3D_RESOURCE_MODEL, folder);
+    G3D_LOG(3, "  < Agregar carpeta de Modelos");
   }
 
   void addTextureFolder(const std::string &folder) {
-    util::log("> Agregar carpeta de Texturas", 3);
+    G3D_LOG(3, "> Agregar carpeta de Texturas");
     graph3d::util::addResourceFolder(graph3d::util::G3D_RESOURCE_TEXTURE, folder);
-    util::log("  < Agregar carpeta de Texturas", 3);
+    if (util::Recorder *recorder = util::Recorder::active()) recorder->folder(util::G3D_RESOURCE_TEXTURE, folder);
+    G3D_LOG(3, "  < Agregar carpeta de Texturas");
+  }
+
+  void loadShader(const std::string &shader) {
+    shaderPrograms[shader] = new Shader(shader.c_str());
+    if (reloader) trackShader(shader);
+    if (util::Recorder *recorder = util::Recorder::active()) recorder->loadShader(shader);
+  }
+
+  void loadModel(const std::string &model) {
+    modelFiles[model] = util::getResourceFilePath(util::G3D_RESOURCE_MODEL, model).generic_string();
+    models[model] = new Model(model.c_str());
+    if (reloader) trackModel(model);
+    if (util::Recorder *recorder = util::Recorder::active()) recorder->loadModel(model);
+  }
+
+  /// Carga en segundo plano: el modelo aparece en el frame en que termina de subirse y, hasta entonces,
+  /// los objetos que lo usan no se dibujan. La grabación lo registra recién ahí
+  AsyncModel loadModelAsync(const std::string &model) {
+    const std::string &path = modelFiles[model] =
+        util::getResourceFilePath(util::G3D_RESOURCE_MODEL, model).generic_string();
+    return loader.load(model, path);
+  }
+
+  /// Bloquea hasta que el modelo esté cargado. Relanza el error de la carga
+  void waitModel(const AsyncModel &model) { loader.wait(model); }
+  void waitModels() { loader.waitAll(); }
+
+  /// Sube lo decodificado hasta gastar `budget` segundos. Devuelve true si quedan modelos en camino
+  bool uploadModels(double budget) { return loader.upload(budget); }
+
+  /// Compila variantes de shaders pendientes hasta gastar `budget` segundos entre todos los programas (siempre al
+  /// menos una). Si terminó la variante elegida del programa activo, lo vuelve a ligar. Devuelve true si quedan en
+  /// camino
+  bool compileShaders(double budget) {
+    const std::chrono::steady_clock::time_point deadline = compileDeadline(budget);
+    bool started = false, pending = false;
+    for (auto &entry : shaderPrograms) pending |= entry.second->compileVariants(deadline, started);
+    if (activeShader && activeShader->outdated()) activeShader->use();
+    return pending;
+  }
+
+  /// Recarga en caliente: los programas de shaders y los modelos (con sus texturas) se vuelven a cargar cuando
+  /// cambian sus archivos. Al activarla se vigila todo lo que ya está cargado
+  bool hotReloadEnabled() const { return static_cast<bool>(reloader); }
+  void enableHotReload(bool enabled) {
+    if (enabled == hotReloadEnabled()) return;
+    if (!enabled) {
+      reloader.reset();
+      for (auto &entry : shaderReloads) {
+        util::JobSystem::getInstance().wait(entry.second->read);
+        delete entry.second->replacement;
+      }
+      shaderReloads.clear();
+      return;
+    }
+
+    G3D_LOG(2, "> Recarga en caliente de shaders y modelos");
+    reloader.reset(new HotReload());
+    for (auto &entry : shaderPrograms) trackShader(entry.first);
+    for (auto &entry : models) trackModel(entry.first);
+  }
+
+  /// Recarga lo que cambió en disco. Lo llama el main loop entre frames: hasta que la versión nueva está lista
+  /// (el programa compiló, el modelo se subió) se sigue dibujando con la anterior. Un programa que no compila se
+  /// queda con la versión anterior y avisa (WAR014); un modelo que no carga, como loadModelAsync (WAR009)
+  void reloadResources(double budget) {
+    if (!reloader) return;
+    G3D_PROFILE_SCOPE("OpenGL::reloadResources");
+    std::vector<std::string> paths;
+    for (const HotReload::target_t &target : reloader->take(reloadQuiet, paths)) {
+      if (target.first == G3D_RELOAD_SHADER)
+        reloadShader(target.second);
+      else
+        reloadModel(target.second);
+    }
+    swapShaders(budget);
   }
 
-  void loadShader(const std::string &shader) { shaderPrograms[shader] = new Shader(shader.c_str()); }
+  /// Sube los mipmaps que pidieron los draws del frame. Lo llama el main loop, al terminar de dibujar
+  void streamTextures() { TextureCache::getInstance().stream(); }
 
-  void loadModel(const std::string &model) { models[model] = new Model(model.c_str()); }
+  /// Registra un modelo creado por código. OpenGL pasa a ser su dueño
+  void addModel(const std::string &alias, Model *model) {
+    auto it = models.find(alias);
+    if (it != models.end()) delete it->second;
+    models[alias] = model;
+    if (reloader) trackModel(alias);
+    if (util::Recorder *recorder = util::Recorder::active()) recordModel(*recorder, alias, *model);
+  }
 
  public:
-  void useShader(const std::string &shader) {
+  /// Con `keywords`, la variante del programa con esas palabras clave (Shader::select). Mientras se compila, se dibuja
+  /// con el programa base
+  void useShader(const std::string &shader, const std::vector<std::string> &keywords = {}) {
     if (shaderPrograms.find(shader) == shaderPrograms.end())
       throw exceptions::exception("ERR010", exceptions::format(exceptions::ERR010, shader.c_str()));
     activeShader = shaderPrograms[shader];
+    activeShader->select(keywords);
     activeShader->use();
+    requestContextChange(G3D_CONTEXT_SHADER, activeShader);
+    if (util::Recorder *recorder = util::Recorder::active()) recorder->useShader(shader, keywords);
+  }
+
+  /// Empieza a compilar una variante antes de usarla, así el primer frame que la usa ya la tiene
+  void prepareShader(const std::string &shader, const std::vector<std::string> &keywords) {
+    if (shaderPrograms.find(shader) == shaderPrograms.end())
+      throw exceptions::exception("ERR010", exceptions::format(exceptions::ERR010, shader.c_str()));
+    shaderPrograms[shader]->prepare(keywords);
   }
 
  public:
@@ -115,16 +251,49 @@ class OpenGL {
                                        float pitch = .0f) = 0;
 
   void draw(entity::Object *object) {
+    G3D_ALLOC_TAG("OpenGL::draw");
     Viewport *viewport = getContext().viewport;
     entity::Camera *camera = viewport->camera;
+    // Sin modelo todavía: lo está cargando loadModelAsync. Si nadie lo carga, el alias está mal
+    auto it = models.find(object->modelAlias);
+    if (it == models.end()) {
+      if (!loader.loading(object->modelAlias) && missingModels.insert(object->modelAlias).second)
+        exceptions::warning("WAR015", exceptions::format(exceptions::WAR015, object->modelAlias.c_str()));
+      return;
+    }
+    Model *model = it->second;
 
-    util::bounds bounds = viewport->bounds;
+    if (util::Recorder *recorder = util::Recorder::active()) {
+      recordCamera(*recorder, camera);
+      recorder->draw(object, object->modelAlias, object->transformation);
+    }
+    // Los uniforms del draw los vuelve a poner la reproducción
+    util::Recorder::pause_scope pause;
+
+    util::bounds area = viewport->bounds;
+    glm::mat4 projection = camera->createProjectionMatrix(area);
+    glm::mat4 view = camera->view;
+    const glm::mat4 mvp = projection * view * object->transformation;
+
+    if (model->hasBounds() && !util::intersectsFrustum(mvp, model->boundsMin, model->boundsMax)) {
+      util::count(util::G3D_COUNTER_CULLED_OBJECTS);
+      return;
+    }
+
+    if (isSoftware()) {
+      model->Rasterize(*activeShader, object->transformation, projection * view);
+      return;
+    }
+
+    // Sin caja, como si ocupara todo el viewport
+    const float screen = static_cast<float>(std::max<int>(area.width, area.height));
+    const float extent = model->hasBounds() ? util::projectedExtent(mvp, model->boundsMin, model->boundsMax) : 2;
+    model->demandTextures(extent / 2 * screen);
 
-    glm::mat4 projection = camera->createProjectionMatrix(viewport->bounds);
     activeShader->set("projection", projection);
-    activeShader->set("view", camera->view);
+    activeShader->set("view", view);
     activeShader->set("model", object->transformation);
-    models[object->modelAlias]->Draw(*activeShader);
+    model->Draw(*activeShader);
   }
 
  protected:
@@ -139,12 +308,189 @@ class OpenGL {
  private:
   void drawViewport(const Context &context, const Window &window, Viewport &viewport) {
     requestContextChange(G3D_CONTEXT_VIEWPORT, &viewport);
+
+    if (util::Recorder *recorder = util::Recorder::active()) {
+      recordCamera(*recorder, viewport.camera);
+      recorder->viewport(&window, window.size, &viewport, viewport.zindex, viewport.bounds, viewport.clearMask,
+                         viewport.backgroundColor, viewport.camera);
+    }
+  }
+
+ protected:
+  /// Grabación
+  void recordCamera(util::Recorder &recorder, entity::Camera *camera) {
+    if (!camera) return;
+    const glm::vec3 position = camera->position, right = camera->right, up = camera->up, front = camera->front;
+    recorder.camera(camera, position, glm::mat3(right, up, front), camera->g_zoom);
+  }
+
+  // Los modelos de archivo se vuelven a cargar al reproducir; los creados por código se graban enteros
+  void recordModel(util::Recorder &recorder, const std::string &alias, const Model &model) {
+    if (!model.directory.empty()) {
+      recorder.loadModel(alias);
+      return;
+    }
+
+    std::vector<util::MeshView> meshes;
+    meshes.reserve(model.meshes.size());
+    for (const Mesh &mesh : model.meshes)
+      meshes.push_back({mesh.vertexData(), mesh.vertexCount(), sizeof(Vertex), mesh.indexData(), mesh.indexCount()});
+    recorder.modelData(alias, meshes);
+  }
+
+ private:
+  /// Recarga en caliente
+  void trackShader(const std::string &alias) {
+    reloader->track(G3D_RELOAD_SHADER, alias, shaderPrograms[alias]->files());
+  }
+
+  // El archivo del modelo, los otros que leyó assimp (sus materiales) y sus texturas. Los creados por código no
+  // tienen archivo y no se vigilan
+  void trackModel(const std::string &alias) {
+    auto file = modelFiles.find(alias);
+    auto model = models.find(alias);
+    if (file == modelFiles.end() || model == models.end()) return;
+    std::vector<std::string> files{file->second};
+    for (const std::string &source : model->second->sources) files.push_back(model->second->directory + '/' + source);
+    for (const Texture &texture : model->second->textures_loaded)
+      files.push_back(model->second->directory + '/' + texture.path);
+    reloader->track(G3D_RELOAD_MODEL, alias, files);
+  }
+
+  // Las fuentes se vuelven a leer en un job; el programa nuevo se arma en swapShaders() cuando terminó. Si ya había
+  // una recarga en camino para el mismo programa, se descarta
+  void reloadShader(const std::string &alias) {
+    auto program = shaderPrograms.find(alias);
+    if (program == shaderPrograms.end()) {
+      reloader->forget(G3D_RELOAD_SHADER, alias);
+      return;
+    }
+    G3D_LOG(2, "> Recargar programa de shaders: " << alias);
+
+    std::unique_ptr<shader_reload> &reload = shaderReloads[alias];
+    if (reload) {
+      util::JobSystem::getInstance().wait(reload->read);
+      delete reload->replacement;
+    }
+    reload.reset(new shader_reload());
+    reload->files = program->second->files();
+    ShaderSources &sources = ShaderSources::getInstance();
+    for (const std::string &file : reload->files) sources.invalidate(file);
+
+    auto read = [files = reload->files] {
+      for (const std::string &file : files) ShaderSources::getInstance().read(file);
+    };
+    util::JobSystem &jobs = util::JobSystem::getInstance();
+    if (jobs.threads() > 1)
+      jobs.run(read, &reload->read, "OpenGL::reloadShader");
+    else
+      read();
+  }
+
+  // Hasta cuándo se compila en este frame
+  static std::chrono::steady_clock::time_point compileDeadline(double budget) {
+    return std::chrono::steady_clock::now() +
+           std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(budget));
+  }
+
+  // Con las fuentes ya leídas, arma el programa nuevo con las mismas variantes que el anterior y lo compila sin
+  // esperar. Cuando terminó, reemplaza al anterior si compiló todo lo que el anterior tenía listo
+  void swapShaders(double budget) {
+    const std::chrono::steady_clock::time_point deadline = compileDeadline(budget);
+    bool started = false;
+    for (auto it = shaderReloads.begin(); it != shaderReloads.end();) {
+      shader_reload &reload = *it->second;
+      auto program = shaderPrograms.find(it->first);
+      if (!reload.read.done()) {
+        ++it;
+        continue;
+      }
+      if (program == shaderPrograms.end()) {
+        delete reload.replacement;
+        it = shaderReloads.erase(it);
+        continue;
+      }
+
+      if (!reload.replacement) {
+        try {
+          reload.replacement = new Shader(it->first.c_str(), true);
+        } catch (const exceptions::exception &error) {
+          exceptions::warning("WAR014", exceptions::format(exceptions::WAR014, it->first.c_str()),
+                              error.getDescription() + '\n' + error.getMessage());
+          it = shaderReloads.erase(it);
+          continue;
+        }
+        reload.replacement->inherit(*program->second);
+      }
+      if (reload.replacement->compileVariants(deadline, started)) {
+        ++it;
+        continue;
+      }
+
+      if (reload.replacement->replaces(*program->second)) {
+        // El programa anterior se borra acá: si estaba ligado, el nuevo lo reemplaza antes
+        if (activeShader == program->second) {
+          activeShader = reload.replacement;
+          activeShader->use();
+          requestContextChange(G3D_CONTEXT_SHADER, activeShader);
+        }
+        delete program->second;
+        program->second = reload.replacement;
+        trackShader(it->first);
+        G3D_LOG(2, "  < Programa de shaders recargado: " << it->first);
+      } else
+        delete reload.replacement;
+      it = shaderReloads.erase(it);
+    }
+  }
+
+  // Las texturas se vuelven a leer aunque no hayan cambiado: las que siguen igual tienen el mismo hash y la caché
+  // devuelve la misma entrada. El modelo nuevo reemplaza al anterior en addModel(), cuando terminó de subirse. Sin
+  // hilos de trabajo la carga no avanza hasta que alguien la espere, así que se hace acá mismo
+  void reloadModel(const std::string &alias) {
+    auto file = modelFiles.find(alias);
+    if (file == modelFiles.end() || !models.count(alias)) {
+      reloader->forget(G3D_RELOAD_MODEL, alias);
+      return;
+    }
+    G3D_LOG(2, "> Recargar modelo: " << alias);
+    const std::vector<std::string> &files = reloader->files(G3D_RELOAD_MODEL, alias);
+    for (size_t i = 1; i < files.size(); i++) TextureCache::getInstance().invalidate(files[i]);
+    AsyncModel load = loader.load(alias, file->second);
+    if (util::JobSystem::getInstance().threads() > 1) return;
+    try {
+      loader.wait(load);
+    } catch (const exceptions::exception &error) {
+      exceptions::warning("WAR009", exceptions::format(exceptions::WAR009, file->second.c_str()),
+                          error.getDescription() + '\n' + error.getMessage());
+    }
   }
 
  private:
   /// Implementación
+  // El backend se elige en este punto, así el usuario puede cambiarlo en setup().
+  // Las variables de entorno G3D_HEADLESS y G3D_SOFTWARE fuerzan el modo headless y el renderer por software
+  // sin tocar la aplicación; G3D_HOT_RELOAD (distinta de 0), la recarga en caliente
+  void initBackend() {
+    G3D_LOG(2, "> Inicializar OpenGL");
+    if (std::getenv("G3D_HEADLESS")) currentBackend() = G3D_BACKEND_HEADLESS;
+    if (std::getenv("G3D_SOFTWARE")) currentRenderer() = G3D_RENDERER_SOFTWARE;
+    const char *reload = std::getenv("G3D_HOT_RELOAD");
+    if (reload && *reload && std::strcmp(reload, "0") != 0) enableHotReload(true);
+    if (isSoftware())
+      G3D_LOG(2, "> Renderer por software: " << software::Rasterizer::getInstance().threads() << " hilos");
+
+    if (isHeadless()) {
+      // Las ventanas headless son framebuffers, así que GL tiene que estar cargado antes de crearlas
+      HeadlessDevice::getInstance().create();
+      initGLAD();
+    } else
+      initGLFW();
+    G3D_LOG(2, "  < Inicializar OpenGL");
+  }
+
   void initGLFW() {
-    util::log("> Inicializar GLFW", 2);
+    G3D_LOG(2, "> Inicializar GLFW");
     glfwInit();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
@@ -153,16 +499,30 @@ class OpenGL {
 #ifdef __APPLE__
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
 #endif
-    util::log("  < Inicializar GLFW", 2);
+    G3D_LOG(2, "  < Inicializar GLFW");
   }
 
   void initGLAD() {
-    util::log("> Inicializar GLAD", 2);
-    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) throw exceptions::exception("ERR004", exceptions::ERR004);
-    util::log("  < Inicializar GLAD", 2);
+    if (gladLoaded) return;
+    G3D_LOG(2, "> Inicializar GLAD");
+    GLADloadproc loader =
+        isHeadless() ? (GLADloadproc)HeadlessDevice::getProcAddress : (GLADloadproc)glfwGetProcAddress;
+    if (!gladLoadGLLoader(loader)) throw exceptions::exception("ERR004", exceptions::ERR004);
+    gladLoaded = true;
+    G3D_LOG(2, "  < Inicializar GLAD");
   }
 
-  void initialize() { glfwSwapInterval(1); }
+  void initialize() {
+    if (!isHeadless()) glfwSwapInterval(1);
+  }
+
+  void pollEvents() {
+    if (!isHeadless()) glfwPollEvents();
+  }
+
+  void closeWindows() {
+    for (const Window *window : windows) window->close();
+  }
 
  private:
   bool shouldRun() {
@@ -181,9 +541,9 @@ class OpenGL {
   }
 
   void draw(const Context &context) {
-    util::log("> Dibujar Ventanas", 12);
+    G3D_LOG(12, "> Dibujar Ventanas");
     for (const opengl::Window *window : windows) window->draw(context);
-    util::log("  < Dibujar Ventanas", 12);
+    G3D_LOG(12, "  < Dibujar Ventanas");
   }
 
  public:
@@ -194,7 +554,7 @@ class OpenGL {
 
  private:
   void requestContextChange(ContextType type, void *data) {
-    for (context_change_func_t func : contextChangeSubscribers) func(type, data);
+    for (const context_change_func_t &func : contextChangeSubscribers) func(type, data);
   }
 };
 }  // namespace opengl
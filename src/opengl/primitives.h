@@ -0,0 +1,84 @@
+#ifndef GRAPH3D_OPENGL_PRIMITIVES_H_
+#define GRAPH3D_OPENGL_PRIMITIVES_H_
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include <opengl/mesh.h>
+
+namespace graph3d {
+namespace opengl {
+
+// Mallas generadas por código, sin texturas. Sirven para escenas sintéticas y pruebas
+
+/// Esfera UV centrada en el origen
+inline Mesh createSphere(float radius = 1.f, uint32_t rings = 16, uint32_t segments = 32) {
+  const float pi = 3.14159265358979f;
+  std::vector<Vertex> vertices;
+  std::vector<unsigned int> indices;
+  vertices.reserve((rings + 1) * (segments + 1));
+  indices.reserve(rings * segments * 6);
+
+  for (uint32_t ring = 0; ring <= rings; ring++) {
+    const float v = static_cast<float>(ring) / rings, phi = v * pi;
+    for (uint32_t segment = 0; segment <= segments; segment++) {
+      const float u = static_cast<float>(segment) / segments, theta = u * 2 * pi;
+
+      Vertex vertex;
+      vertex.Normal = glm::vec3(std::sin(phi) * std::cos(theta), std::cos(phi), std::sin(phi) * std::sin(theta));
+      vertex.Position = vertex.Normal * radius;
+      vertex.TexCoords = glm::vec2(u, v);
+      vertex.Tangent = glm::vec3(-std::sin(theta), 0, std::cos(theta));
+      vertex.Bitangent = glm::cross(vertex.Normal, vertex.Tangent);
+      vertices.push_back(vertex);
+    }
+  }
+
+  for (uint32_t ring = 0; ring < rings; ring++) {
+    for (uint32_t segment = 0; segment < segments; segment++) {
+      const unsigned int first = ring * (segments + 1) + segment, second = first + segments + 1;
+      indices.insert(indices.end(), {first, second, first + 1, second, second + 1, first + 1});
+    }
+  }
+
+  return Mesh(std::move(vertices), std::move(indices), {});
+}
+
+/// Cubo de lado `size` centrado en el origen, con normales por cara
+inline Mesh createCube(float size = 1.f) {
+  static const glm::vec3 normals[] = {{1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1}};
+  std::vector<Vertex> vertices;
+  std::vector<unsigned int> indices;
+  vertices.reserve(24);
+  indices.reserve(36);
+
+  const float half = size / 2;
+  for (const glm::vec3& normal : normals) {
+    const glm::vec3 tangent = std::abs(normal.y) > .5f ? glm::vec3(1, 0, 0) : glm::cross(glm::vec3(0, 1, 0), normal);
+    const glm::vec3 bitangent = glm::cross(normal, tangent);
+    const unsigned int base = static_cast<unsigned int>(vertices.size());
+
+    for (int corner = 0; corner < 4; corner++) {
+      const float u = corner == 1 || corner == 2 ? 1.f : 0.f, v = corner >= 2 ? 1.f : 0.f;
+
+      Vertex vertex;
+      vertex.Position = (normal + tangent * (u * 2 - 1) + bitangent * (v * 2 - 1)) * half;
+      vertex.Normal = normal;
+      vertex.TexCoords = glm::vec2(u, v);
+      vertex.Tangent = tangent;
+      vertex.Bitangent = bitangent;
+      vertices.push_back(vertex);
+    }
+    indices.insert(indices.end(), {base, base + 1, base + 2, base, base + 2, base + 3});
+  }
+
+  return Mesh(std::move(vertices), std::move(indices), {});
+}
+
+}  // namespace opengl
+}  // namespace graph3d
+
+#endif
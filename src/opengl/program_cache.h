@@ -0,0 +1,161 @@
+#ifndef GRAPH3D_OPENGL_PROGRAM_CACHE_H_
+#define GRAPH3D_OPENGL_PROGRAM_CACHE_H_
+
+// Programas de shaders ya linkeados (.g3dprog), como los devuelve glGetProgramBinary.
+//
+// El nombre del archivo sale del hash de las fuentes de todas las etapas y del driver (vendor, renderer y
+// versión), en la carpeta de util::CookCache. El primer arranque compila, linkea y guarda el binario; los
+// siguientes lo cargan con glProgramBinary sin compilar nada. Si el driver rechaza el binario (se actualizó, o el
+// archivo está roto) se compila desde las fuentes como siempre y el archivo se reescribe.
+//
+// Formato: ProgramBinaryHeader y, a continuación, los `size` bytes del binario.
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <util/cook_cache.h>
+#include <util/hash.h>
+#include <util/logger.h>
+#include <util/mapped_file.h>
+#include <util/profiler.h>
+
+namespace graph3d {
+namespace opengl {
+
+static constexpr uint32_t programBinaryVersion = 1;
+static const char *const programBinaryExtension = ".g3dprog";
+
+struct ProgramBinaryHeader {
+  char magic[4];        // "G3DB"
+  uint32_t version;     // programBinaryVersion
+  uint64_t sourceHash;  // programSourceHash de las etapas
+  uint64_t driverHash;  // programDriverHash del contexto que lo generó
+  uint32_t format;      // binaryFormat de glGetProgramBinary
+  uint32_t size;
+};
+
+static_assert(sizeof(ProgramBinaryHeader) == 32, "ProgramBinaryHeader es parte del formato");
+
+/// Hash de las etapas de un programa: el tipo y la fuente de cada una, en orden
+template <typename Stages>
+inline uint64_t programSourceHash(const Stages &stages) {
+  uint64_t hash = util::hash64(nullptr, 0);
+  for (const auto &stage : stages) {
+    const uint64_t size = stage.source.size();
+    hash = util::hash64(&stage.type, sizeof(stage.type), hash);
+    hash = util::hash64(&size, sizeof(size), hash);
+    hash = util::hash64(stage.source.data(), stage.source.size(), hash);
+  }
+  return hash;
+}
+
+/// Hash del driver del contexto actual: un binario sólo sirve para el mismo vendor, renderer y versión
+inline uint64_t programDriverHash() {
+  uint64_t hash = util::hash64(nullptr, 0);
+  for (GLenum name : {GL_VENDOR, GL_RENDERER, GL_VERSION, GL_SHADING_LANGUAGE_VERSION}) {
+    const char *value = reinterpret_cast<const char *>(glGetString(name));
+    if (value) hash = util::hash64(value, std::strlen(value) + 1, hash);
+  }
+  return hash;
+}
+
+/// false si el driver no tiene ningún formato de binario (o no se cocina nada): entonces no se usa la caché
+inline bool programBinarySupported() {
+  GLint formats = 0;
+  glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+  return formats > 0 && !util::CookCache::getInstance().directory().empty();
+}
+
+inline std::string programBinaryPath(uint64_t sourceHash, uint64_t driverHash) {
+  const uint64_t key = util::hash64(&driverHash, sizeof(driverHash), sourceHash);
+  return util::CookCache::getInstance().pathFor(key, programBinaryExtension);
+}
+
+/// Carga en `program` el binario guardado para esas fuentes. Devuelve false si no hay, no coincide o el driver
+/// lo rechaza; en ese caso `program` queda sin linkear y se puede compilar y linkear como siempre
+inline bool loadProgramBinary(GLuint program, uint64_t sourceHash, uint64_t driverHash) {
+  G3D_PROFILE_SCOPE("loadProgramBinary");
+  const std::string path = programBinaryPath(sourceHash, driverHash);
+  std::error_code error;
+  if (path.empty() || !std::filesystem::exists(path, error)) return false;
+
+  std::shared_ptr<util::MappedFile> file = util::MappedFile::open(path);
+  if (!file || file->size() < sizeof(ProgramBinaryHeader)) return false;
+  ProgramBinaryHeader header;
+  std::memcpy(&header, file->data(), sizeof(header));
+  if (std::memcmp(header.magic, "G3DB", 4) != 0 || header.version != programBinaryVersion ||
+      header.sourceHash != sourceHash || header.driverHash != driverHash ||
+      header.size != file->size() - sizeof(ProgramBinaryHeader))
+    return false;
+
+  glProgramBinary(program, header.format, file->data() + sizeof(ProgramBinaryHeader),
+                  static_cast<GLsizei>(header.size));
+  GLint success = GL_FALSE;
+  glGetProgramiv(program, GL_LINK_STATUS, &success);
+  if (!success) {
+    G3D_LOG(5, "> El driver rechazó el binario de programa " << path);
+    return false;
+  }
+  return true;
+}
+
+/// Guarda el binario de `program`, ya linkeado. Primero va a un temporal, así otra carga nunca ve un archivo a
+/// medias. Devuelve false si no se pudo
+inline bool saveProgramBinary(GLuint program, uint64_t sourceHash, uint64_t driverHash) {
+  G3D_PROFILE_SCOPE("saveProgramBinary");
+  const std::string path = programBinaryPath(sourceHash, driverHash);
+  GLint length = 0;
+  glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+  if (path.empty() || length <= 0) return false;
+
+  std::vector<char> binary(static_cast<size_t>(length));
+  GLsizei size = 0;
+  GLenum format = 0;
+  glGetProgramBinary(program, length, &size, &format, binary.data());
+  if (size <= 0) return false;
+
+  ProgramBinaryHeader header{};
+  std::memcpy(header.magic, "G3DB", 4);
+  header.version = programBinaryVersion;
+  header.sourceHash = sourceHash;
+  header.driverHash = driverHash;
+  header.format = format;
+  header.size = static_cast<uint32_t>(size);
+
+  std::error_code error;
+  const std::filesystem::path target(path);
+  if (target.has_parent_path()) std::filesystem::create_directories(target.parent_path(), error);
+  const std::string temp = path + ".tmp" + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+  {
+    std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) return false;
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(binary.data(), size);
+    if (!out.good()) {
+      out.close();
+      std::filesystem::remove(temp, error);
+      return false;
+    }
+  }
+
+  std::filesystem::rename(temp, target, error);
+  if (error) {
+    std::filesystem::remove(temp, error);
+    return false;
+  }
+  return true;
+}
+
+}  // namespace opengl
+}  // namespace graph3d
+
+#endif
@@ -3,9 +3,15 @@
 
 #include <glad/glad.h>
 
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <map>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -27,41 +33,90 @@
 #include <exceptions/exception.h>
 #include <exceptions/messages.h>
 #include <exceptions/warning.h>
+#include <opengl/backend.h>
+#include <opengl/headless.h>
+#include <opengl/program_cache.h>
+#include <opengl/shader_source.h>
+#include <software/kernels.h>
+#include <software/uniforms.h>
 #include <util/logger.h>
+#include <util/metrics.h>
+#include <util/profiler.h>
+#include <util/recording.h>
 #include <util/resources.h>
 
 namespace graph3d {
 namespace opengl {
+// GL_KHR_parallel_shader_compile (o la de ARB) no es parte de ninguna versión, así que glad no la carga
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
 class Shader {
  private:
   /// Variables
   bool linked = false;
-  unsigned int ID;
-  std::vector<GLuint> shaders;
+  unsigned int ID;  // El programa que liga use(): el de la variante elegida o, mientras se compila, el base
+  GLuint g_base;
+  std::string g_folder;     // La de Shader(folder), para la recarga en caliente
   std::string shaderNames;  // Used for debugging errors in linking phase
 
+  // Las etapas se leen al agregarlas (con los #include resueltos, ver shader_source.h) y se compilan en link()
+  // y al pedir cada variante, sólo si no hay un binario guardado (program_cache.h)
+  struct stage_source {
+    GLenum type;
+    ShaderSource source;
+    std::filesystem::path filename;
+  };
+  std::vector<stage_source> sources;
+  std::vector<std::string> g_keywords;  // Las de todas las etapas, ordenadas
+
+  enum variant_state { G3D_VARIANT_QUEUED, G3D_VARIANT_COMPILING, G3D_VARIANT_READY, G3D_VARIANT_FAILED };
+  struct program_variant {
+    GLuint program = 0;
+    variant_state state = G3D_VARIANT_QUEUED;
+    std::vector<std::string> keywords;
+    std::vector<GLuint> shaders;  // Hasta que termina el linkeo
+    bool cached = false;          // Se guarda el binario al terminar
+    uint64_t sourceHash = 0, driverHash = 0;
+  };
+  // Por nombre: sus palabras clave, ordenadas y separadas por espacios. "" es el programa base
+  std::map<std::string, program_variant> variants;
+  std::string g_selected;
+  size_t pending = 0;
+
+  // Renderer por software: kernel equivalente al programa y últimos valores de sus uniforms
+  software::Kernel g_kernel = software::G3D_KERNEL_NONE;
+  mutable software::Uniforms g_uniforms;
+
  public:
   /// Constructores
-  Shader() { ID = glCreateProgram(); }
+  Shader() { ID = g_base = glCreateProgram(); }
 
-  Shader(const char *folder) : Shader() {
+  /// Con `deferred`, el programa base se compila como las variantes, sin esperar (ver linkDeferred())
+  Shader(const char *folder, bool deferred = false) : Shader() {
     std::filesystem::path folderPath = util::getResourceFolderPath(util::G3D_RESOURCE_SHADER, folder);
-    util::log("> Cargar programa de shaders: " + folderPath.generic_string(), 3);
-    for (const auto &file : std::filesystem::directory_iterator(folderPath)) {
-      const auto &filepath = file.path();
+    g_folder = folderPath.generic_string();
+    G3D_LOG(3, "> Cargar programa de shaders: " << folderPath.generic_string());
+    g_kernel = software::findKernel(std::filesystem::path(folder).filename().generic_string());
+    if (isSoftware() && g_kernel == software::G3D_KERNEL_NONE)
+      exceptions::warning("WAR008", exceptions::format(exceptions::WAR008, folder));
+    for (const std::filesystem::path &filepath : util::getFolderFiles(folderPath)) {
       if (filepath.has_extension()) {
         const GLenum &type = getType(filepath.extension());
-        if (type != 0) addShader(type, filepath.relative_path());
+        if (type != 0) addShader(type, filepath);
       }
     }
-    util::log("> Linkeo de programa de shaders" + folderPath.generic_string(), 5);
+    G3D_LOG(5, "> Linkeo de programa de shaders" << folderPath.generic_string());
 
-    if (shaders.empty())
+    if (sources.empty())
       exceptions::warning("WAR004", exceptions::format(exceptions::WAR004, folderPath.generic_string().c_str()));
+    else if (deferred)
+      linkDeferred();
     else
       link();
 
-    util::log("  < Cargar programa de shaders: " + folderPath.generic_string(), 3);
+    G3D_LOG(3, "  < Cargar programa de shaders: " << folderPath.generic_string());
   }
 
   Shader(const char *vertexPath, const char *fragmentPath, const char *geometryPath = nullptr) : Shader() {
@@ -70,225 +125,475 @@ class Shader {
     if (geometryPath) addShader(GL_GEOMETRY_SHADER, geometryPath);
   }
 
+  Shader &operator=(const Shader &) = delete;
+  Shader(const Shader &) = delete;
+
+  ~Shader() {
+    for (auto &entry : variants)
+      if (entry.second.program != g_base) glDeleteProgram(entry.second.program);
+    glDeleteProgram(g_base);
+  }
+
   /// Interfaz
   void addShader(GLenum type, const std::filesystem::path &filename) {
-    addShader(type, std::ifstream(filename), filename);
+    sources.push_back({type, ShaderSources::getInstance().expand(filename), filename});
+    const std::vector<std::string> &keywords = sources.back().source.keywords;
+    g_keywords.insert(g_keywords.end(), keywords.begin(), keywords.end());
+    std::sort(g_keywords.begin(), g_keywords.end());
+    g_keywords.erase(std::unique(g_keywords.begin(), g_keywords.end()), g_keywords.end());
+
+    if (!shaderNames.empty()) shaderNames.append(", ");
+    shaderNames.append(filename.u8string());
   }
 
   void addShader(GLenum type, const char *path) {
-    std::filesystem::path filename = path;
-    addShader(type, util::getResourceFile(util::G3D_RESOURCE_SHADER, filename), filename);
+    const std::filesystem::path filename = util::getResourceFilePath(util::G3D_RESOURCE_SHADER, path);
+    addShader(type, filename.empty() ? std::filesystem::path(path) : filename);
   }
 
+  /// Compila y linkea el programa base, sin palabras clave. Es el que se usa mientras se compilan las variantes
   void link() {
-    glLinkProgram(ID);
-    checkLinkingErrors();
-    for (GLuint &shader : shaders) glDeleteShader(shader);
+    G3D_PROFILE_SCOPE("Shader::link");
+    program_variant &base = variants[""];
+    base.program = g_base;
+    if (loadCached(base)) {
+      G3D_LOG(5, "> Programa de shaders desde la caché: " << shaderNames);
+      base.state = G3D_VARIANT_READY;
+    } else {
+      compile(base);
+      finish("", base, true);
+    }
     linked = true;
   }
 
+  /// Como link(), pero el programa base se compila como una variante más, en compileVariants(), y un error no
+  /// lanza excepción: avisa (WAR014) y el programa queda sin usar. Para armar el reemplazo de un programa que ya se
+  /// está usando, sin frenar el frame
+  void linkDeferred() {
+    program_variant &base = variants[""];
+    base.program = g_base;
+    linked = true;
+    if (loadCached(base)) {
+      base.state = G3D_VARIANT_READY;
+      return;
+    }
+    pending++;
+    if (parallelCompile()) compile(base);
+  }
+
   bool isLinked() { return linked; }
 
-  void use() { glUseProgram(ID); }
+  /// true mientras haya algo pendiente en compileVariants()
+  bool compiling() const { return pending > 0; }
+
+  /// Pide las mismas variantes que `previous` y elige la misma que tenía elegida
+  void inherit(const Shader &previous) {
+    for (const auto &entry : previous.variants)
+      if (!entry.first.empty()) request(entry.second.keywords);
+    auto it = previous.variants.find(previous.g_selected);
+    g_selected = it == previous.variants.end() ? std::string() : request(it->second.keywords);
+  }
+
+  /// true si puede reemplazar a `previous`: compiló el programa base y cada variante que `previous` tenía lista
+  bool replaces(const Shader &previous) const {
+    auto base = variants.find("");
+    if (base == variants.end() || base->second.state != G3D_VARIANT_READY) return false;
+    for (const auto &entry : previous.variants) {
+      auto it = variants.find(entry.first);
+      if (entry.second.state == G3D_VARIANT_READY && it != variants.end() && it->second.state != G3D_VARIANT_READY)
+        return false;
+    }
+    return true;
+  }
+
+  /// Los archivos de los que sale el programa: la carpeta (si vino de una), las etapas y lo que incluyen
+  std::vector<std::string> files() const {
+    std::vector<std::string> files;
+    if (!g_folder.empty()) files.push_back(g_folder);
+    for (const stage_source &stage : sources)
+      files.insert(files.end(), stage.source.files.begin(), stage.source.files.end());
+    return files;
+  }
+
+  software::Kernel kernel() const { return g_kernel; }
+  const software::Uniforms &uniforms() const { return g_uniforms; }
+
+  /// Palabras clave de las variantes, como las declaran las etapas con `#pragma g3d_keywords`
+  const std::vector<std::string> &keywords() const { return g_keywords; }
+
+  /// Elige la variante con esas palabras clave; las que el programa no declara se ignoran. La primera vez que se
+  /// pide, la variante empieza a compilarse y, hasta que esté lista, use() liga el programa base
+  void select(const std::vector<std::string> &keywords) { g_selected = request(keywords); }
+
+  /// Empieza a compilar la variante sin elegirla, para tenerla lista cuando se pida
+  void prepare(const std::vector<std::string> &keywords) { request(keywords); }
+
+  /// false mientras la variante elegida se está compilando
+  bool ready() const {
+    auto it = variants.find(g_selected);
+    if (it == variants.end()) return true;
+    return it->second.state != G3D_VARIANT_QUEUED && it->second.state != G3D_VARIANT_COMPILING;
+  }
+
+  /// Avanza las variantes pendientes hasta `deadline`. Con GL_KHR_parallel_shader_compile sólo mira cuáles terminó
+  /// el driver; sin la extensión, compila de a una variante, así el costo se reparte entre frames. El plazo es
+  /// compartido entre programas: con `started` en false se compila una aunque ya haya pasado, y queda en true.
+  /// Devuelve true si quedan variantes en camino
+  bool compileVariants(std::chrono::steady_clock::time_point deadline, bool &started) {
+    if (!pending) return false;
+    G3D_PROFILE_SCOPE("Shader::compileVariants");
+    for (auto &entry : variants) {
+      program_variant &variant = entry.second;
+      if (variant.state == G3D_VARIANT_COMPILING) {
+        GLint done = GL_TRUE;
+        glGetProgramiv(variant.program, GL_COMPLETION_STATUS_KHR, &done);
+        if (done) finish(entry.first, variant, false);
+      } else if (variant.state == G3D_VARIANT_QUEUED) {
+        if (started && std::chrono::steady_clock::now() >= deadline) continue;
+        started = true;
+        compile(variant);
+        finish(entry.first, variant, false);
+      }
+    }
+    return pending > 0;
+  }
+
+  /// true si use() ligaría otro programa que el que ligó la última vez: la variante elegida ya está lista
+  bool outdated() const { return ID != program(g_selected); }
+
+  void use() {
+    util::count(util::G3D_COUNTER_PROGRAM_BINDS);
+    ID = program(g_selected);
+    glUseProgram(ID);
+  }
 
  private:
   /// Implementación
-  void addShader(GLenum type, std::ifstream &&file, const std::filesystem::path &filename) {
-    addShader(type, file, std::forward<const std::filesystem::path &>(filename));
-  }
+  std::string request(const std::vector<std::string> &keywords) {
+    std::vector<std::string> accepted;
+    for (const std::string &keyword : keywords)
+      if (std::binary_search(g_keywords.begin(), g_keywords.end(), keyword)) accepted.push_back(keyword);
+    std::sort(accepted.begin(), accepted.end());
+    accepted.erase(std::unique(accepted.begin(), accepted.end()), accepted.end());
+
+    std::string name;
+    for (const std::string &keyword : accepted) name.append(name.empty() ? "" : " ").append(keyword);
+    if (name.empty() || !linked) return std::string();
+
+    auto inserted = variants.emplace(name, program_variant());
+    if (!inserted.second) return name;
+    program_variant &variant = inserted.first->second;
+    variant.keywords = std::move(accepted);
+    variant.program = glCreateProgram();
+    if (loadCached(variant)) {
+      variant.state = G3D_VARIANT_READY;
+      return name;
+    }
 
-  void addShader(GLenum type, std::ifstream &file, const std::filesystem::path &filename) {
-    std::string src_str;
-    const GLchar *src;
+    G3D_LOG(5, "> Compilar variante " << name << " de " << shaderNames);
+    pending++;
+    if (parallelCompile()) compile(variant);
+    return name;
+  }
+
+  GLuint program(const std::string &name) const {
+    auto it = variants.find(name);
+    return it != variants.end() && it->second.state == G3D_VARIANT_READY ? it->second.program : g_base;
+  }
+
+  // Busca el binario guardado de la variante. Si no está, deja los hashes para guardarlo después de linkear
+  bool loadCached(program_variant &variant) {
+    if (!programBinarySupported()) return false;
+    struct hashed_stage {
+      GLenum type;
+      std::string source;
+    };
+    std::vector<hashed_stage> texts;
+    for (const stage_source &stage : sources)
+      texts.push_back({stage.type, ShaderSources::variant(stage.source, variant.keywords)});
+    variant.cached = true;
+    variant.sourceHash = programSourceHash(texts);
+    variant.driverHash = programDriverHash();
+    return loadProgramBinary(variant.program, variant.sourceHash, variant.driverHash);
+  }
+
+  // Compila las etapas y linkea sin mirar el resultado: con GL_KHR_parallel_shader_compile, el driver lo hace en
+  // sus hilos y finish() recién espera cuando GL_COMPLETION_STATUS_KHR dice que terminó
+  void compile(program_variant &variant) {
+    G3D_PROFILE_SCOPE("Shader::compile");
+    for (const stage_source &stage : sources) {
+      const std::string text = ShaderSources::variant(stage.source, variant.keywords);
+      const GLchar *src = text.c_str();
+      GLuint shader = glCreateShader(stage.type);
+      glShaderSource(shader, 1, &src, NULL);
+      glCompileShader(shader);
+      glAttachShader(variant.program, shader);
+      variant.shaders.push_back(shader);
+    }
+    if (variant.cached) glProgramParameteri(variant.program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glLinkProgram(variant.program);
+    variant.state = G3D_VARIANT_COMPILING;
+  }
 
-    try {
-      std::stringstream stream;
-      file.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+  // Con un error, `strict` lanza la excepción (link()); si no, avisa y la variante nunca se usa
+  void finish(const std::string &name, program_variant &variant, bool strict) {
+    int success;
+    glGetProgramiv(variant.program, GL_LINK_STATUS, &success);
+    if (!strict) pending--;
 
-      stream << file.rdbuf();
-      file.close();
-      src_str = stream.str();
-    } catch (std::ifstream::failure e) {
-      throw exceptions::exception("ERR001", exceptions::format(exceptions::ERR001, filename.generic_string().c_str()),
-                                  e.what());
+    if (!success) {
+      const char *code;
+      std::string description, log;
+      failure(variant, code, description, log);
+      for (GLuint &shader : variant.shaders) glDeleteShader(shader);
+      variant.shaders.clear();
+      variant.state = G3D_VARIANT_FAILED;
+      if (strict) throw exceptions::exception(code, description, log);
+      if (name.empty())
+        exceptions::warning("WAR014", exceptions::format(exceptions::WAR014, shaderNames.c_str()),
+                            description + '\n' + log);
+      else
+        exceptions::warning("WAR013", exceptions::format(exceptions::WAR013, name.c_str(), shaderNames.c_str()),
+                            description + '\n' + log);
+      return;
     }
 
-    src = src_str.c_str();
-
-    GLuint shader = glCreateShader(type);
-    glShaderSource(shader, 1, &src, NULL);
-    glCompileShader(shader);
-    checkCompileErrors(shader, filename);
-    glAttachShader(ID, shader);
-    shaders.push_back(shader);
+    for (GLuint &shader : variant.shaders) glDeleteShader(shader);
+    variant.shaders.clear();
+    variant.state = G3D_VARIANT_READY;
+    if (variant.cached && !saveProgramBinary(variant.program, variant.sourceHash, variant.driverHash))
+      G3D_LOG(5, "> No se pudo guardar el binario del programa de shaders: " << shaderNames);
+  }
+
+  // El error de la primera etapa que no compiló (ERR003) o, si compilaron todas, el del linkeo (ERR002). Con
+  // #include, el log numera los archivos como los #line de shader_source.h: se agrega la lista
+  void failure(const program_variant &variant, const char *&code, std::string &description, std::string &log) const {
+    char buffer[2048];
+    for (size_t i = 0; i < variant.shaders.size() && i < sources.size(); i++) {
+      int success;
+      glGetShaderiv(variant.shaders[i], GL_COMPILE_STATUS, &success);
+      if (success) continue;
+
+      glGetShaderInfoLog(variant.shaders[i], 2048, NULL, buffer);
+      code = "ERR003";
+      const std::string filename = sources[i].filename.relative_path().generic_string();
+      description = exceptions::format(exceptions::ERR003, filename.c_str());
+      log = buffer;
+      const std::vector<std::string> &files = sources[i].source.files;
+      if (files.size() > 1)
+        for (size_t file = 0; file < files.size(); file++) log += std::to_string(file) + ": " + files[file] + '\n';
+      return;
+    }
 
-    if (!shaderNames.empty()) shaderNames.append(", ");
+    glGetProgramInfoLog(variant.program, 2048, NULL, buffer);
+    code = "ERR002";
+    description = exceptions::format(exceptions::ERR002, shaderNames);
+    log = buffer;
+  }
+
+  static bool parallelCompile() {
+    typedef void(APIENTRYP max_threads_func_t)(GLuint count);
+    static const bool supported = [] {
+      for (const char *extension : {"GL_KHR_parallel_shader_compile", "GL_ARB_parallel_shader_compile"}) {
+        if (!hasExtension(extension)) continue;
+        const char *function =
+            extension[3] == 'K' ? "glMaxShaderCompilerThreadsKHR" : "glMaxShaderCompilerThreadsARB";
+        max_threads_func_t maxThreads = reinterpret_cast<max_threads_func_t>(
+            isHeadless() ? HeadlessDevice::getProcAddress(function)
+                         : reinterpret_cast<void *>(glfwGetProcAddress(function)));
+        // Sin límite: el driver usa todos los hilos que quiera
+        if (maxThreads) maxThreads(0xFFFFFFFF);
+        return true;
+      }
+      return false;
+    }();
+    return supported;
+  }
 
-    shaderNames.append(filename.u8string());
+  static bool hasExtension(const char *extension) {
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; i++) {
+      const char *name = reinterpret_cast<const char *>(glGetStringi(GL_EXTENSIONS, i));
+      if (name && std::strcmp(name, extension) == 0) return true;
+    }
+    return false;
   }
 
  public:
   /// Muchos, muchos setters
-  void set(const char *name, const GLfloat &&f1) const { glUniform1f(glGetUniformLocation(ID, name), f1); }
-  void set(const char *name, const GLfloat &f1) const { glUniform1f(glGetUniformLocation(ID, name), f1); }
-
-  void set(const char *name, const GLboolean &&v1) const { glUniform1i(glGetUniformLocation(ID, name), (int)v1); }
-  void set(const char *name, const GLboolean &v1) const { glUniform1i(glGetUniformLocation(ID, name), (int)v1); }
+  void set(const char *name, const GLfloat &&f1) const { set(name, f1); }
+  void set(const char *name, const GLfloat &f1) const {
+    record(name, util::G3D_UNIFORM_FLOAT, &f1);
+    glUniform1f(uniform(name), f1);
+  }
 
-  void set(const char *name, const GLint &&v1) const { glUniform1i(glGetUniformLocation(ID, name), v1); }
-  void set(const char *name, const GLint &v1) const { glUniform1i(glGetUniformLocation(ID, name), v1); }
+  void set(const char *name, const GLboolean &&v1) const { set(name, v1); }
+  void set(const char *name, const GLboolean &v1) const {
+    const GLint value = (int)v1;
+    record(name, util::G3D_UNIFORM_INT, &value);
+    glUniform1i(uniform(name), (int)v1);
+  }
 
-  void set(const char *name, const GLuint &&v1) const { glUniform1ui(glGetUniformLocation(ID, name), v1); }
-  void set(const char *name, const GLuint &v1) const { glUniform1ui(glGetUniformLocation(ID, name), v1); }
+  void set(const char *name, const GLint &&v1) const { set(name, v1); }
+  void set(const char *name, const GLint &v1) const {
+    record(name, util::G3D_UNIFORM_INT, &v1);
+    glUniform1i(uniform(name), v1);
+  }
 
-  void set(const char *name, const GLfloat &&f1, const GLfloat &&f2) const {
-    glUniform2f(glGetUniformLocation(ID, name), f1, f2);
+  void set(const char *name, const GLuint &&v1) const { set(name, v1); }
+  void set(const char *name, const GLuint &v1) const {
+    record(name, util::G3D_UNIFORM_UINT, &v1);
+    glUniform1ui(uniform(name), v1);
   }
+
+  void set(const char *name, const GLfloat &&f1, const GLfloat &&f2) const { set(name, f1, f2); }
   void set(const char *name, const GLfloat &f1, const GLfloat &f2) const {
-    glUniform2f(glGetUniformLocation(ID, name), f1, f2);
+    const GLfloat values[] = {f1, f2};
+    record(name, util::G3D_UNIFORM_VEC2, values);
+    glUniform2f(uniform(name), f1, f2);
   }
 
-  void set(const char *name, const GLboolean &&v1, const GLboolean &&v2) const {
-    glUniform2i(glGetUniformLocation(ID, name), (int)v1, (int)v2);
-  }
+  void set(const char *name, const GLboolean &&v1, const GLboolean &&v2) const { set(name, v1, v2); }
   void set(const char *name, const GLboolean &v1, const GLboolean &v2) const {
-    glUniform2i(glGetUniformLocation(ID, name), (int)v1, (int)v2);
+    const GLint values[] = {(int)v1, (int)v2};
+    record(name, util::G3D_UNIFORM_IVEC2, values);
+    glUniform2i(uniform(name), (int)v1, (int)v2);
   }
 
-  void set(const char *name, const GLint &&v1, const GLint &&v2) const {
-    glUniform2i(glGetUniformLocation(ID, name), v1, v2);
-  }
+  void set(const char *name, const GLint &&v1, const GLint &&v2) const { set(name, v1, v2); }
   void set(const char *name, const GLint &v1, const GLint &v2) const {
-    glUniform2i(glGetUniformLocation(ID, name), v1, v2);
+    const GLint values[] = {v1, v2};
+    record(name, util::G3D_UNIFORM_IVEC2, values);
+    glUniform2i(uniform(name), v1, v2);
   }
 
-  void set(const char *name, const GLuint &&v1, const GLuint &&v2) const {
-    glUniform2ui(glGetUniformLocation(ID, name), v1, v2);
-  }
+  void set(const char *name, const GLuint &&v1, const GLuint &&v2) const { set(name, v1, v2); }
   void set(const char *name, const GLuint &v1, const GLuint &v2) const {
-    glUniform2ui(glGetUniformLocation(ID, name), v1, v2);
+    const GLuint values[] = {v1, v2};
+    record(name, util::G3D_UNIFORM_UVEC2, values);
+    glUniform2ui(uniform(name), v1, v2);
   }
 
   void set(const char *name, const GLfloat &&f1, const GLfloat &&f2, const GLfloat &&f3) const {
-    glUniform3f(glGetUniformLocation(ID, name), f1, f2, f3);
+    set(name, f1, f2, f3);
   }
   void set(const char *name, const GLfloat &f1, const GLfloat &f2, const GLfloat &f3) const {
-    glUniform3f(glGetUniformLocation(ID, name), f1, f2, f3);
+    const GLfloat values[] = {f1, f2, f3};
+    record(name, util::G3D_UNIFORM_VEC3, values);
+    glUniform3f(uniform(name), f1, f2, f3);
   }
 
   void set(const char *name, const GLboolean &&v1, const GLboolean &&v2, const GLboolean &&v3) const {
-    glUniform3i(glGetUniformLocation(ID, name), (int)v1, (int)v2, (int)v3);
+    set(name, v1, v2, v3);
   }
   void set(const char *name, const GLboolean &v1, const GLboolean &v2, const GLboolean &v3) const {
-    glUniform3i(glGetUniformLocation(ID, name), (int)v1, (int)v2, (int)v3);
+    const GLint values[] = {(int)v1, (int)v2, (int)v3};
+    record(name, util::G3D_UNIFORM_IVEC3, values);
+    glUniform3i(uniform(name), (int)v1, (int)v2, (int)v3);
   }
 
-  void set(const char *name, const GLint &&v1, const GLint &&v2, const GLint &&v3) const {
-    glUniform3i(glGetUniformLocation(ID, name), v1, v2, v3);
-  }
+  void set(const char *name, const GLint &&v1, const GLint &&v2, const GLint &&v3) const { set(name, v1, v2, v3); }
   void set(const char *name, const GLint &v1, const GLint &v2, const GLint &v3) const {
-    glUniform3i(glGetUniformLocation(ID, name), v1, v2, v3);
+    const GLint values[] = {v1, v2, v3};
+    record(name, util::G3D_UNIFORM_IVEC3, values);
+    glUniform3i(uniform(name), v1, v2, v3);
   }
 
-  void set(const char *name, const GLuint &&v1, const GLuint &&v2, const GLuint &&v3) const {
-    glUniform3ui(glGetUniformLocation(ID, name), v1, v2, v3);
-  }
+  void set(const char *name, const GLuint &&v1, const GLuint &&v2, const GLuint &&v3) const { set(name, v1, v2, v3); }
   void set(const char *name, const GLuint &v1, const GLuint &v2, const GLuint &v3) const {
-    glUniform3ui(glGetUniformLocation(ID, name), v1, v2, v3);
+    const GLuint values[] = {v1, v2, v3};
+    record(name, util::G3D_UNIFORM_UVEC3, values);
+    glUniform3ui(uniform(name), v1, v2, v3);
   }
 
   void set(const char *name, const GLfloat &&f1, const GLfloat &&f2, const GLfloat &&f3, const GLfloat &&f4) const {
-    glUniform4f(glGetUniformLocation(ID, name), f1, f2, f3, f4);
+    set(name, f1, f2, f3, f4);
   }
   void set(const char *name, const GLfloat &f1, const GLfloat &f2, const GLfloat &f3, const GLfloat &f4) const {
-    glUniform4f(glGetUniformLocation(ID, name), f1, f2, f3, f4);
+    const GLfloat values[] = {f1, f2, f3, f4};
+    record(name, util::G3D_UNIFORM_VEC4, values);
+    glUniform4f(uniform(name), f1, f2, f3, f4);
   }
 
   void set(const char *name, const GLboolean &&v1, const GLboolean &&v2, const GLboolean &&v3,
            const GLboolean &&v4) const {
-    glUniform4i(glGetUniformLocation(ID, name), (int)v1, (int)v2, (int)v3, (int)v4);
+    set(name, v1, v2, v3, v4);
   }
   void set(const char *name, const GLboolean &v1, const GLboolean &v2, const GLboolean &v3, const GLboolean &v4) const {
-    glUniform4i(glGetUniformLocation(ID, name), (int)v1, (int)v2, (int)v3, (int)v4);
+    const GLint values[] = {(int)v1, (int)v2, (int)v3, (int)v4};
+    record(name, util::G3D_UNIFORM_IVEC4, values);
+    glUniform4i(uniform(name), (int)v1, (int)v2, (int)v3, (int)v4);
   }
 
   void set(const char *name, const GLint &&v1, const GLint &&v2, const GLint &&v3, const GLint &&v4) const {
-    glUniform4i(glGetUniformLocation(ID, name), v1, v2, v3, v4);
+    set(name, v1, v2, v3, v4);
   }
   void set(const char *name, const GLint &v1, const GLint &v2, const GLint &v3, const GLint &v4) const {
-    glUniform4i(glGetUniformLocation(ID, name), v1, v2, v3, v4);
+    const GLint values[] = {v1, v2, v3, v4};
+    record(name, util::G3D_UNIFORM_IVEC4, values);
+    glUniform4i(uniform(name), v1, v2, v3, v4);
   }
 
   void set(const char *name, const GLuint &&v1, const GLuint &&v2, const GLuint &&v3, const GLuint &&v4) const {
-    glUniform4ui(glGetUniformLocation(ID, name), v1, v2, v3, v4);
+    set(name, v1, v2, v3, v4);
   }
   void set(const char *name, const GLuint &v1, const GLuint &v2, const GLuint &v3, const GLuint &v4) const {
-    glUniform4ui(glGetUniformLocation(ID, name), v1, v2, v3, v4);
+    const GLuint values[] = {v1, v2, v3, v4};
+    record(name, util::G3D_UNIFORM_UVEC4, values);
+    glUniform4ui(uniform(name), v1, v2, v3, v4);
   }
 
-  void set(const char *name, const glm::vec2 &&value) {
-    glUniform2fv(glGetUniformLocation(ID, name), 1, glm::value_ptr(value));
-  }
+  void set(const char *name, const glm::vec2 &&value) { set(name, value); }
   void set(const char *name, const glm::vec2 &value) {
-    glUniform2fv(glGetUniformLocation(ID, name), 1, glm::value_ptr(value));
+    record(name, util::G3D_UNIFORM_VEC2, glm::value_ptr(value));
+    glUniform2fv(uniform(name), 1, glm::value_ptr(value));
   }
 
-  void set(const char *name, const glm::vec3 &&value) {
-    glUniform3fv(glGetUniformLocation(ID, name), 1, glm::value_ptr(value));
-  }
+  void set(const char *name, const glm::vec3 &&value) { set(name, value); }
   void set(const char *name, const glm::vec3 &value) {
-    glUniform3fv(glGetUniformLocation(ID, name), 1, glm::value_ptr(value));
+    record(name, util::G3D_UNIFORM_VEC3, glm::value_ptr(value));
+    glUniform3fv(uniform(name), 1, glm::value_ptr(value));
   }
 
-  void set(const char *name, const glm::vec4 &&value) {
-    glUniform4fv(glGetUniformLocation(ID, name), 1, glm::value_ptr(value));
-  }
+  void set(const char *name, const glm::vec4 &&value) { set(name, value); }
   void set(const char *name, const glm::vec4 &value) {
-    glUniform4fv(glGetUniformLocation(ID, name), 1, glm::value_ptr(value));
+    record(name, util::G3D_UNIFORM_VEC4, glm::value_ptr(value));
+    glUniform4fv(uniform(name), 1, glm::value_ptr(value));
   }
 
-  void set(const char *name, const glm::mat2x2 &&value) {
-    glUniformMatrix2fv(glGetUniformLocation(ID, name), 1, GL_FALSE, glm::value_ptr(value));
-  }
+  void set(const char *name, const glm::mat2x2 &&value) { set(name, value); }
   void set(const char *name, const glm::mat2x2 &value) {
-    glUniformMatrix2fv(glGetUniformLocation(ID, name), 1, GL_FALSE, glm::value_ptr(value));
+    record(name, util::G3D_UNIFORM_MAT2, glm::value_ptr(value));
+    glUniformMatrix2fv(uniform(name), 1, GL_FALSE, glm::value_ptr(value));
   }
 
-  void set(const char *name, const glm::mat3x3 &&value) {
-    glUniformMatrix3fv(glGetUniformLocation(ID, name), 1, GL_FALSE, glm::value_ptr(value));
-  }
+  void set(const char *name, const glm::mat3x3 &&value) { set(name, value); }
   void set(const char *name, const glm::mat3x3 &value) {
-    glUniformMatrix3fv(glGetUniformLocation(ID, name), 1, GL_FALSE, glm::value_ptr(value));
+    record(name, util::G3D_UNIFORM_MAT3, glm::value_ptr(value));
+    glUniformMatrix3fv(uniform(name), 1, GL_FALSE, glm::value_ptr(value));
   }
 
-  void set(const char *name, const glm::mat4x4 &&value) {
-    glUniformMatrix4fv(glGetUniformLocation(ID, name), 1, GL_FALSE, glm::value_ptr(value));
-  }
+  void set(const char *name, const glm::mat4x4 &&value) { set(name, value); }
   void set(const char *name, const glm::mat4x4 &value) {
-    glUniformMatrix4fv(glGetUniformLocation(ID, name), 1, GL_FALSE, glm::value_ptr(value));
+    record(name, util::G3D_UNIFORM_MAT4, glm::value_ptr(value));
+    glUniformMatrix4fv(uniform(name), 1, GL_FALSE, glm::value_ptr(value));
   }
 
  private:
   /// Funciones internas
-  void checkLinkingErrors() {
-    int success;
-    char log[2048];
-    glGetProgramiv(ID, GL_LINK_STATUS, &success);
-    if (!success) {
-      glGetProgramInfoLog(ID, 2048, NULL, log);
-      throw exceptions::exception("ERR002", exceptions::format(exceptions::ERR002, shaderNames), log);
-    }
-  }
-
-  void checkCompileErrors(const GLuint &shader, const std::filesystem::path &filename) const {
-    int success;
-    char log[2048];
-    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-      glGetShaderInfoLog(shader, 2048, NULL, log);
-      throw exceptions::exception(
-          "ERR003", exceptions::format(exceptions::ERR003, filename.relative_path().generic_string().c_str()), log);
-    }
+  // Con una grabación activa (util/recording.h) el valor queda en el stream de comandos.
+  // Con el renderer por software, además, lo guardan los uniforms que leen los kernels
+  void record(const char *name, util::UniformType type, const void *data) const {
+    if (util::Recorder *recorder = util::Recorder::active()) recorder->uniform(name, type, data);
+    if (isSoftware()) g_uniforms.set(name, type, data);
+  }
+
+  // El renderer por software nunca dibuja con el programa de GL: -1 hace que glUniform* no haga nada
+  GLint uniform(const char *name) const {
+    util::count(util::G3D_COUNTER_UNIFORM_UPLOADS);
+    if (isSoftware()) return -1;
+    return glGetUniformLocation(ID, name);
   }
 
   const GLenum getType(const std::filesystem::path &extension) {
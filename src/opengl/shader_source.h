@@ -0,0 +1,203 @@
+#ifndef GRAPH3D_OPENGL_SHADER_SOURCE_H_
+#define GRAPH3D_OPENGL_SHADER_SOURCE_H_
+
+// Preprocesador de shaders: resuelve los #include y arma la fuente de cada variante.
+//
+// `#include "archivo"` busca el archivo junto al que lo incluye y, si no está ahí, en las carpetas de shaders. Cada
+// archivo se lee una sola vez: ShaderSources guarda el contenido por ruta, así los programas y las variantes que
+// comparten código no vuelven a tocar el disco. Con `#pragma once`, un archivo se incluye una sola vez por etapa.
+//
+// `#pragma g3d_keywords A B C` declara las palabras clave del programa. Una variante es un conjunto de ellas: su
+// fuente es la misma, con un `#define PALABRA 1` por cada una justo después de `#version`.
+//
+// Cada archivo empieza con `#line 1 n`, siendo n su posición en ShaderSource::files, y vuelve a marcarse después
+// de cada #include: los errores del compilador dicen el archivo y la línea originales.
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <exceptions/exception.h>
+#include <exceptions/messages.h>
+#include <util/mapped_file.h>
+#include <util/resources.h>
+
+namespace graph3d {
+namespace opengl {
+
+struct ShaderSource {
+  std::string version;                // La línea de #version del archivo principal, o vacía
+  std::string text;                   // Con los #include resueltos y sin el #version
+  std::vector<std::string> files;     // El archivo de cada número de #line
+  std::vector<std::string> keywords;  // Las de #pragma g3d_keywords, ordenadas y sin repetir
+};
+
+class ShaderSources {
+ public:
+  /// Singleton
+  static ShaderSources &getInstance() {
+    static ShaderSources instance;
+    return instance;
+  }
+
+ private:
+  static constexpr int maxDepth = 32;
+
+  std::mutex mutex;
+  std::map<std::string, std::shared_ptr<const std::string>> g_files;
+
+  ShaderSources() {}
+
+ public:
+  ShaderSources &operator=(const ShaderSources &) = delete;
+  ShaderSources(const ShaderSources &) = delete;
+
+  /// Contenido de `path`, suelto o dentro de un paquete. nullptr si no existe o está vacío
+  std::shared_ptr<const std::string> read(const std::string &path) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      auto it = g_files.find(path);
+      if (it != g_files.end()) return it->second;
+    }
+
+    std::shared_ptr<util::MappedFile> file = util::MappedFile::open(path);
+    if (!file) return nullptr;
+    std::shared_ptr<const std::string> text =
+        std::make_shared<const std::string>(reinterpret_cast<const char *>(file->data()), file->size());
+    std::lock_guard<std::mutex> lock(mutex);
+    return g_files.emplace(path, std::move(text)).first->second;
+  }
+
+  /// Olvida el contenido guardado de `path` (o de todos, sin argumento): se vuelve a leer la próxima vez
+  void invalidate(const std::string &path) {
+    std::lock_guard<std::mutex> lock(mutex);
+    g_files.erase(path);
+  }
+  void invalidate() {
+    std::lock_guard<std::mutex> lock(mutex);
+    g_files.clear();
+  }
+
+  /// Lee `filename` con todos sus #include
+  ShaderSource expand(const std::filesystem::path &filename) {
+    ShaderSource source;
+    std::set<std::string> once;
+    std::vector<std::string> stack;
+    append(source, filename.generic_string(), once, stack);
+    std::sort(source.keywords.begin(), source.keywords.end());
+    source.keywords.erase(std::unique(source.keywords.begin(), source.keywords.end()), source.keywords.end());
+    return source;
+  }
+
+  /// Fuente de la variante con esas palabras clave
+  static std::string variant(const ShaderSource &source, const std::vector<std::string> &keywords) {
+    std::string text;
+    text.reserve(source.version.size() + source.text.size() + keywords.size() * 24 + 1);
+    if (!source.version.empty()) text.append(source.version).append("\n");
+    for (const std::string &keyword : keywords) text.append("#define ").append(keyword).append(" 1\n");
+    return text.append(source.text);
+  }
+
+ private:
+  void append(ShaderSource &source, const std::string &path, std::set<std::string> &once,
+              std::vector<std::string> &stack) {
+    const std::string includer = stack.empty() ? std::string() : stack.back();
+    if (std::find(stack.begin(), stack.end(), path) != stack.end() || stack.size() >= maxDepth)
+      throw exceptions::exception("ERR016", exceptions::format(exceptions::ERR016, path.c_str()),
+                                  exceptions::format("incluido desde %s", includer.c_str()));
+
+    std::shared_ptr<const std::string> text = read(path);
+    if (!text)
+      throw exceptions::exception("ERR001", exceptions::format(exceptions::ERR001, path.c_str()),
+                                  includer.empty() ? "no existe, está vacío o no se puede abrir"
+                                                   : exceptions::format("incluido desde %s", includer.c_str()));
+
+    const std::string index = std::to_string(source.files.size());
+    source.files.push_back(path);
+    stack.push_back(path);
+    source.text.append("#line 1 ").append(index).append("\n");
+
+    size_t line = 1;
+    for (size_t start = 0; start < text->size(); line++) {
+      size_t end = text->find('\n', start);
+      if (end == std::string::npos) end = text->size();
+      const std::string current = text->substr(start, end - start);
+      start = end + 1;
+
+      std::string directive, argument;
+      if (parseDirective(current, directive, argument)) {
+        if (directive == "version" && stack.size() == 1 && source.version.empty()) {
+          source.version = current;
+          source.text.append("\n");
+          continue;
+        }
+        if (directive == "pragma" && argument == "once") {
+          once.insert(path);
+          source.text.append("\n");
+          continue;
+        }
+        if (directive == "pragma" && argument.compare(0, 12, "g3d_keywords") == 0) {
+          addKeywords(source, argument.substr(12));
+          source.text.append("\n");
+          continue;
+        }
+        if (directive == "include") {
+          const std::string included = resolve(path, argument);
+          if (!once.count(included)) append(source, included, once, stack);
+          source.text.append("#line ").append(std::to_string(line + 1)).append(" ").append(index).append("\n");
+          continue;
+        }
+      }
+      source.text.append(current).append("\n");
+    }
+    stack.pop_back();
+  }
+
+  // "#  include  <x>" -> ("include", "<x>"). Las líneas que no son directivas devuelven false
+  static bool parseDirective(const std::string &line, std::string &directive, std::string &argument) {
+    size_t i = line.find_first_not_of(" \t");
+    if (i == std::string::npos || line[i] != '#') return false;
+    i = line.find_first_not_of(" \t", i + 1);
+    if (i == std::string::npos) return false;
+    size_t end = i;
+    while (end < line.size() && std::isalpha(static_cast<unsigned char>(line[end]))) end++;
+    directive = line.substr(i, end - i);
+    const size_t first = line.find_first_not_of(" \t\r", end);
+    const size_t last = line.find_last_not_of(" \t\r");
+    argument = first == std::string::npos ? std::string() : line.substr(first, last - first + 1);
+    return true;
+  }
+
+  // Junto al archivo que lo incluye o, si no está ahí, en las carpetas de shaders
+  std::string resolve(const std::string &includer, const std::string &argument) {
+    std::string name = argument;
+    const bool quoted = name.size() >= 2 && name.front() == '"' && name.back() == '"';
+    const bool angled = name.size() >= 2 && name.front() == '<' && name.back() == '>';
+    if (quoted || angled) name = name.substr(1, name.size() - 2);
+
+    const std::filesystem::path local = (std::filesystem::path(includer).parent_path() / name).lexically_normal();
+    if (read(local.generic_string())) return local.generic_string();
+    const std::filesystem::path found = util::getResourceFilePath(util::G3D_RESOURCE_SHADER, name);
+    return (found.empty() ? local : found.lexically_normal()).generic_string();
+  }
+
+  static void addKeywords(ShaderSource &source, const std::string &list) {
+    size_t start = 0;
+    while ((start = list.find_first_not_of(" \t\r", start)) != std::string::npos) {
+      const size_t end = std::min(list.find_first_of(" \t\r", start), list.size());
+      source.keywords.push_back(list.substr(start, end - start));
+      start = end;
+    }
+  }
+};
+
+}  // namespace opengl
+}  // namespace graph3d
+
+#endif
@@ -0,0 +1,92 @@
+#ifndef GRAPH3D_OPENGL_SOFTWARE_SURFACE_H_
+#define GRAPH3D_OPENGL_SOFTWARE_SURFACE_H_
+
+#include <glad/glad.h>
+
+#include <software/rasterizer.h>
+#include <software/target.h>
+#include <util/dimension.h>
+#include <util/metrics.h>
+#include <util/profiler.h>
+
+namespace graph3d {
+namespace opengl {
+
+// Renderer por software: la imagen que dibuja el rasterizador, y una textura para copiarla a un framebuffer
+// de GL (el de una ventana, o cualquier otro) así las capturas y el swap funcionan igual que con GL.
+// Los objetos de GL se crean recién en el primer present(), cuando seguro hay un contexto con GL cargado
+class SoftwareSurface {
+ private:
+  software::Target g_target;
+  GLuint texture = 0, readFramebuffer = 0;
+  uint32_t textureWidth = 0, textureHeight = 0;
+
+ public:
+  SoftwareSurface& operator=(const SoftwareSurface&) = delete;
+  SoftwareSurface(const SoftwareSurface&) = delete;
+
+  explicit SoftwareSurface(const util::dimension& size) : g_target(size.width, size.height) {}
+
+  ~SoftwareSurface() {
+    software::Rasterizer::getInstance().release(&g_target);
+    if (texture) {
+      glDeleteTextures(1, &texture);
+      glDeleteFramebuffers(1, &readFramebuffer);
+    }
+  }
+
+ public:
+  software::Target& target() { return g_target; }
+
+  void resize(const util::dimension& size) {
+    software::Rasterizer& rasterizer = software::Rasterizer::getInstance();
+    if (rasterizer.target() == &g_target) rasterizer.flush();
+    g_target.resize(size.width, size.height);
+  }
+
+  /// Las próximas pasadas del rasterizador dibujan acá
+  void bind() { software::Rasterizer::getInstance().setTarget(&g_target); }
+
+  /// Termina lo pendiente y copia la imagen a `framebuffer`, que queda enlazado como GL_FRAMEBUFFER
+  void present(GLuint framebuffer) {
+    G3D_PROFILE_SCOPE("SoftwareSurface::present");
+    software::Rasterizer& rasterizer = software::Rasterizer::getInstance();
+    if (rasterizer.target() == &g_target) rasterizer.flush();
+
+    const uint32_t width = g_target.width(), height = g_target.height();
+    if (!texture) {
+      glGenTextures(1, &texture);
+      glGenFramebuffers(1, &readFramebuffer);
+    }
+
+    glBindTexture(GL_TEXTURE_2D, texture);
+    if (textureWidth != width || textureHeight != height) {
+      textureWidth = width;
+      textureHeight = height;
+      glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+      glBindFramebuffer(GL_READ_FRAMEBUFFER, readFramebuffer);
+      glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, g_target.stride());
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, g_target.pixels());
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    util::count(util::G3D_COUNTER_TEXTURE_BYTES_UPLOADED, static_cast<uint64_t>(width) * height * 4);
+
+    // El scissor del último viewport también recortaría el blit
+    glDisable(GL_SCISSOR_TEST);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, readFramebuffer);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, framebuffer);
+    glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+  }
+};
+
+}  // namespace opengl
+}  // namespace graph3d
+
+#endif
@@ -0,0 +1,891 @@
+#ifndef GRAPH3D_OPENGL_TEXTURE_CACHE_H_
+#define GRAPH3D_OPENGL_TEXTURE_CACHE_H_
+
+// Caché de texturas de todo el proceso, compartida entre modelos y materiales.
+//
+// Las entradas se identifican por el contenido del archivo, así dos rutas a la misma imagen comparten la
+// textura; la ruta canónica de cada archivo ya leído lleva directo a su entrada, sin volver a leerlo.
+// Cada modelo que usa una textura tiene una referencia (TextureRef). Las entradas sin referencias quedan
+// cargadas para la próxima vez hasta que la memoria de texturas supera el presupuesto; ahí se liberan
+// las que se usaron hace más tiempo.
+//
+// Los mipmaps se generan en CPU al decodificar (util/mipmaps.h), según el uso de la textura: el color se filtra en
+// lineal y las normales se renormalizan. El mismo archivo con dos usos son dos entradas.
+//
+// Las imágenes DDS y KTX2 (BCn, util/texture_codec.h) se suben con sus mipmaps tal cual, sin decodificar. Con la
+// compresión activada (setCompression), las demás se cocinan a DDS en un job aparte y se guardan en la carpeta de
+// recursos cocinados (util/cook_cache.h), con el hash del contenido como nombre: desde la próxima carga llegan
+// comprimidas.
+//
+// Con streaming (setStreaming), upload() sólo sube los mipmaps de hasta residentSize texels: el modelo se puede
+// dibujar enseguida. Cada draw pide el nivel que le corresponde según el tamaño del modelo en pantalla (demand()) y
+// stream(), una vez por frame, los pasa al TextureUploader (opengl/texture_uploader.h), que los sube sin frenar el
+// frame y con un presupuesto de bytes por frame. Si la memoria supera el presupuesto, las texturas que no se
+// pidieron hace un rato pierden sus niveles de más detalle.
+//
+// acquire() y decode() corren en cualquier hilo; upload(), stream(), trim() y clear() tocan GL, así que sólo en el
+// principal.
+
+#include <glad/glad.h>
+
+#include <stb_image.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <exceptions/messages.h>
+#include <exceptions/warning.h>
+#include <opengl/backend.h>
+#include <opengl/texture_uploader.h>
+#include <software/image.h>
+#include <util/cook_cache.h>
+#include <util/hash.h>
+#include <util/jobs.h>
+#include <util/mapped_file.h>
+#include <util/metrics.h>
+#include <util/mipmaps.h>
+#include <util/profiler.h>
+#include <util/texture_codec.h>
+
+// GL_EXT_texture_compression_s3tc no es parte del core
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_SRGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_SRGB_S3TC_DXT1_EXT 0x8C4C
+#endif
+#ifndef GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT 0x8C4F
+#endif
+
+namespace graph3d {
+namespace opengl {
+
+enum TextureUsage {
+  G3D_TEXTURE_DATA,        // Valores lineales (especular, alturas)
+  G3D_TEXTURE_COLOR,       // Color en sRGB en una textura común: sólo los mipmaps se filtran en lineal
+  G3D_TEXTURE_COLOR_SRGB,  // Igual, pero GL_SRGB8(_ALPHA8): GL lo pasa a lineal al muestrear
+  G3D_TEXTURE_NORMAL,      // Normales en [0, 1]
+};
+
+struct CachedTexture {
+  uint64_t hash = 0;  // Del contenido del archivo
+  uint64_t key = 0;   // Del contenido y el uso: identifica la entrada y su versión cocinada
+  TextureUsage usage = G3D_TEXTURE_DATA;
+  std::string path;   // Ruta canónica del primer archivo con este contenido
+
+  // Se decodifica una sola vez, aunque la pidan varios hilos a la vez. Los bytes del archivo
+  // y los píxeles se liberan cuando ya no hacen falta
+  std::once_flag decodeOnce;
+  std::vector<unsigned char> file;
+  int width = 0, height = 0, channels = 0;
+  std::unique_ptr<unsigned char, void (*)(void *)> pixels{nullptr, stbi_image_free};
+  util::MipChain mips;
+
+  // Bloques comprimidos, con sus mipmaps, en lugar de `pixels`
+  std::unique_ptr<util::CompressedImage> compressed;
+
+  /// GL, sólo en el hilo principal
+  bool uploaded = false;
+  unsigned int id = 0;
+  size_t memory = 0;  // De los niveles que están en GL
+  std::shared_ptr<const software::Image> image;
+  GLenum internalFormat = 0, format = 0;  // format = 0: bloques comprimidos
+
+  // Streaming: GL tiene los niveles [baseLevel, levels). Los de más detalle se suben cuando algún draw los pide
+  // (wantedLevel, en el frame demandFrame) y, mientras falten, los niveles quedan también en CPU
+  uint32_t levels = 0, baseLevel = 0;
+  uint32_t queuedLevel = 0;  // El último que se encoló en el TextureUploader; baseLevel si no hay ninguno en camino
+  uint32_t tailLevel = 0;   // Los de aquí para abajo nunca se sacan
+  uint32_t firstLevel = 0;  // El de más detalle que se puede subir (no más que baseLevel si falla la relectura)
+  uint32_t wantedLevel = 0;
+  uint64_t demandFrame = 0;
+  std::vector<size_t> levelBytes;
+  bool reloading = false;
+  std::shared_ptr<CachedTexture> reloaded;  // Protegido por el mutex de la caché
+
+  /// Protegidos por el mutex de la caché
+  uint32_t references = 0;
+  uint64_t lastUse = 0;
+};
+
+struct TextureCacheStats {
+  uint64_t hits = 0;       // acquire() que encontró la entrada
+  uint64_t misses = 0;     // acquire() que tuvo que crearla
+  uint64_t evictions = 0;  // Texturas liberadas por el presupuesto
+  uint64_t streamedLevels = 0;  // Mipmaps subidos por stream()
+  uint64_t droppedLevels = 0;   // Mipmaps sacados por el presupuesto
+};
+
+// Referencia a una entrada de la caché. Al destruirse la suelta
+class TextureRef {
+  std::shared_ptr<CachedTexture> g_entry;
+
+ public:
+  TextureRef() {}
+  explicit TextureRef(std::shared_ptr<CachedTexture> entry) : g_entry(std::move(entry)) {}
+  TextureRef(TextureRef &&other) noexcept : g_entry(std::move(other.g_entry)) {}
+  TextureRef &operator=(TextureRef &&other) noexcept {
+    if (this != &other) {
+      reset();
+      g_entry = std::move(other.g_entry);
+    }
+    return *this;
+  }
+  TextureRef(const TextureRef &) = delete;
+  TextureRef &operator=(const TextureRef &) = delete;
+  ~TextureRef() { reset(); }
+
+  void reset();
+
+  CachedTexture *get() const { return g_entry.get(); }
+  CachedTexture *operator->() const { return g_entry.get(); }
+  CachedTexture &operator*() const { return *g_entry; }
+  explicit operator bool() const { return static_cast<bool>(g_entry); }
+};
+
+class TextureCache {
+ public:
+  /// Singleton
+  static TextureCache &getInstance() {
+    static TextureCache instance;
+    return instance;
+  }
+
+ private:
+  std::mutex mutex;
+  std::unordered_map<std::string, uint64_t> paths;
+  std::unordered_map<uint64_t, std::shared_ptr<CachedTexture>> entries;
+
+  size_t g_budget = size_t(512) << 20;
+  bool g_compression = [] {
+    const char *compression = std::getenv("G3D_TEXTURE_COMPRESSION");
+    return compression && *compression && std::strcmp(compression, "0") != 0;
+  }();
+  util::JobCounter cooking;
+  util::MipFilter g_mipFilter = util::G3D_MIP_BOX;
+  bool g_streaming = [] {
+    const char *streaming = std::getenv("G3D_TEXTURE_STREAMING");
+    return !streaming || std::strcmp(streaming, "0") != 0;
+  }();
+  size_t g_uploadBudget = size_t(8) << 20;
+  size_t g_memory = 0;  // Memoria de las texturas subidas, con o sin referencias
+  uint64_t useClock = 0;
+  TextureCacheStats g_stats;
+
+  /// Streaming, sólo en el hilo principal
+  static constexpr uint32_t residentSize = 128;
+  static constexpr uint64_t idleFrames = 120;
+  uint64_t streamFrame = 1;
+  util::JobCounter reloads;
+
+  TextureCache() {}
+
+ public:
+  TextureCache &operator=(const TextureCache &) = delete;
+  TextureCache(const TextureCache &) = delete;
+
+ public:
+  /// Referencia a la textura del archivo `path`. Lee el archivo si es la primera vez que se ve esa ruta.
+  /// Si no se puede leer, avisa y devuelve una referencia vacía
+  TextureRef acquire(const std::string &path, TextureUsage usage = G3D_TEXTURE_DATA) {
+    std::error_code error;
+    std::string key = std::filesystem::weakly_canonical(path, error).generic_string();
+    if (error) key = path;
+
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      auto known = paths.find(key);
+      if (known != paths.end()) {
+        auto it = entries.find(entryKey(known->second, usage));
+        if (it != entries.end()) {
+          g_stats.hits++;
+          return reference(it->second);
+        }
+      }
+    }
+
+    std::vector<unsigned char> file = readFile(key);
+    if (file.empty()) {
+      exceptions::warning("WAR005", exceptions::format(exceptions::WAR005, key.c_str()));
+      return TextureRef();
+    }
+
+    const uint64_t hash = util::hash64(file.data(), file.size());
+    std::lock_guard<std::mutex> lock(mutex);
+    paths[key] = hash;
+    std::shared_ptr<CachedTexture> &entry = entries[entryKey(hash, usage)];
+    if (entry) {
+      g_stats.hits++;
+    } else {
+      g_stats.misses++;
+      entry = std::make_shared<CachedTexture>();
+      entry->hash = hash;
+      entry->key = entryKey(hash, usage);
+      entry->usage = usage;
+      entry->path = key;
+      entry->file = std::move(file);
+    }
+    return reference(entry);
+  }
+
+  /// Olvida qué contenido tenía `path`: el próximo acquire() vuelve a leer el archivo. Las referencias que ya
+  /// existen siguen con la textura de antes (recarga en caliente)
+  void invalidate(const std::string &path) {
+    std::error_code error;
+    std::string key = std::filesystem::weakly_canonical(path, error).generic_string();
+    if (error) key = path;
+    std::lock_guard<std::mutex> lock(mutex);
+    paths.erase(key);
+  }
+
+  /// Decodifica la imagen si nadie lo hizo todavía. Si otro hilo la está decodificando, espera a que termine
+  void decode(CachedTexture &texture) {
+    std::call_once(texture.decodeOnce, [this, &texture] {
+      G3D_PROFILE_SCOPE("TextureCache::decode");
+      if (readCompressed(texture)) return;
+
+      texture.pixels.reset(stbi_load_from_memory(texture.file.data(), static_cast<int>(texture.file.size()),
+                                                 &texture.width, &texture.height, &texture.channels, 0));
+      std::vector<unsigned char>().swap(texture.file);
+      if (!texture.pixels) {
+        exceptions::warning("WAR005", exceptions::format(exceptions::WAR005, texture.path.c_str()));
+        return;
+      }
+
+      texture.mips = util::generateMips(texture.pixels.get(), texture.width, texture.height, texture.channels,
+                                        mipOptions(texture.usage));
+      if (compression()) cook(texture);
+    });
+  }
+
+  /// Crea la textura de GL si todavía no existe. Una imagen que no se pudo decodificar queda vacía.
+  /// Con streaming, sólo sube los mipmaps de hasta residentSize texels; el resto llega con stream()
+  void upload(CachedTexture &texture) {
+    if (texture.uploaded) return;
+    decode(texture);
+    G3D_PROFILE_SCOPE("TextureCache::upload");
+    glGenTextures(1, &texture.id);
+
+    if (texture.compressed) prepareCompressed(texture);
+    if (texture.pixels) prepareUncompressed(texture);
+
+    texture.levels = levelCount(texture);
+    if (texture.levels) {
+      texture.levelBytes.resize(texture.levels);
+      for (uint32_t level = 0; level < texture.levels; level++)
+        texture.levelBytes[level] = levelData(texture, level).size;
+      texture.baseLevel = streaming() && !isSoftware() ? tailLevel(texture) : 0;
+      texture.tailLevel = texture.queuedLevel = texture.wantedLevel = texture.baseLevel;
+
+      // Los niveles chicos de RGB no tienen filas múltiplos de 4 bytes
+      glBindTexture(GL_TEXTURE_2D, texture.id);
+      glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+      for (uint32_t level = texture.baseLevel; level < texture.levels; level++) {
+        const texture_level data = levelData(texture, level);
+        uploadLevel(texture, level, data, data.data);
+        texture.memory += data.size;
+      }
+      glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, static_cast<GLint>(texture.baseLevel));
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(texture.levels - 1));
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+      util::Metrics &metrics = util::Metrics::getInstance();
+      metrics.add(util::G3D_COUNTER_TEXTURE_BYTES_UPLOADED, texture.memory);
+      metrics.add(util::G3D_GAUGE_TEXTURES, 1);
+      metrics.add(util::G3D_GAUGE_TEXTURE_MEMORY, static_cast<int64_t>(texture.memory));
+    }
+
+    if (texture.baseLevel == 0) freeSource(texture);
+    texture.uploaded = true;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    g_memory += texture.memory;
+    trimLocked();
+  }
+
+  /// Un draw muestra la textura sobre unos `pixels` de pantalla (el lado más largo de lo que se dibuja).
+  /// Pide el mipmap que corresponde para el próximo stream(). Sólo en el hilo principal
+  void demand(CachedTexture &texture, float pixels) {
+    if (!texture.uploaded || texture.levels < 2) return;
+    const float size = static_cast<float>(std::max(texture.width, texture.height));
+    const float level = pixels > 0 ? std::floor(std::log2(size / pixels)) : texture.levels - 1.f;
+    const uint32_t wanted = static_cast<uint32_t>(std::min(std::max(level, 0.f), texture.levels - 1.f));
+    if (texture.demandFrame != streamFrame || wanted < texture.wantedLevel) texture.wantedLevel = wanted;
+    texture.demandFrame = streamFrame;
+  }
+
+  /// Una vez por frame, en el hilo principal. Encola en el TextureUploader los mipmaps que pidieron los draws del
+  /// frame, emite los que ya se copiaron hasta gastar el presupuesto de bytes (siempre al menos uno) y, si la memoria
+  /// de texturas supera el presupuesto, saca los de más detalle de las que no se piden hace idleFrames frames
+  void stream() {
+    G3D_PROFILE_SCOPE("TextureCache::stream");
+    std::vector<std::shared_ptr<CachedTexture>> pending;
+    size_t frameBudget;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      frameBudget = g_uploadBudget;
+      for (auto &entry : entries) {
+        const CachedTexture &texture = *entry.second;
+        if (texture.uploaded && texture.demandFrame == streamFrame && texture.queuedLevel > targetLevel(texture))
+          pending.push_back(entry.second);
+      }
+    }
+
+    // Primero las que están más lejos del nivel que se pidió
+    std::sort(pending.begin(), pending.end(), [](const auto &a, const auto &b) {
+      return a->queuedLevel - targetLevel(*a) > b->queuedLevel - targetLevel(*b);
+    });
+
+    // Lo que los jobs copiaron desde frames anteriores; lo de este frame sale en el próximo
+    TextureUploader::getInstance().flush(frameBudget);
+
+    for (const std::shared_ptr<CachedTexture> &entry : pending) {
+      CachedTexture &texture = *entry;
+      bool full = false;
+      while (!full && texture.queuedLevel > targetLevel(texture)) {
+        if (!hasSource(texture) && !adoptSource(texture)) {
+          if (texture.baseLevel > targetLevel(texture)) reload(entry);
+          break;
+        }
+        full = !queueLevel(entry);
+      }
+      if (full) break;
+    }
+
+    evictLevels();
+    streamFrame++;
+  }
+
+  /// Libera texturas sin referencias hasta entrar en el presupuesto
+  void trim() {
+    std::lock_guard<std::mutex> lock(mutex);
+    trimLocked();
+  }
+
+  /// Libera todas las texturas sin referencias, sin importar el presupuesto. Antes de destruir el contexto de GL.
+  /// También espera las texturas que se están cocinando, para no perderlas
+  void clear() {
+    util::JobSystem::getInstance().wait(cooking);
+    util::JobSystem::getInstance().wait(reloads);
+    TextureUploader::getInstance().clear();
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto &entry : entries) entry.second->queuedLevel = entry.second->baseLevel;
+    for (auto it = entries.begin(); it != entries.end();) {
+      if (it->second->references == 0) {
+        destroy(*it->second);
+        it = entries.erase(it);
+      } else
+        ++it;
+    }
+    paths.clear();
+  }
+
+  /// Bytes de texturas (con mipmaps) que pueden quedar cargados. Primero se liberan las que no tienen referencias y
+  /// después, en stream(), los mipmaps de más detalle de las que no se usan; el total puede superarlo igual
+  size_t budget() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return g_budget;
+  }
+  void setBudget(size_t budget) {
+    std::lock_guard<std::mutex> lock(mutex);
+    g_budget = budget;
+    if (util::JobSystem::getInstance().isMainThread()) trimLocked();
+  }
+
+  /// Filtro de los mipmaps de las texturas que se decodifiquen desde ahora
+  util::MipFilter mipFilter() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return g_mipFilter;
+  }
+  void setMipFilter(util::MipFilter filter) {
+    std::lock_guard<std::mutex> lock(mutex);
+    g_mipFilter = filter;
+  }
+
+  /// Subir sólo los mipmaps chicos y el resto a medida que se pidan. Por defecto sí, salvo G3D_TEXTURE_STREAMING=0.
+  /// No afecta a las texturas ya subidas ni al renderer por software, que necesita la imagen entera
+  bool streaming() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return g_streaming;
+  }
+  void setStreaming(bool streaming) {
+    std::lock_guard<std::mutex> lock(mutex);
+    g_streaming = streaming;
+  }
+
+  /// Bytes de mipmaps que stream() sube por frame
+  size_t uploadBudget() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return g_uploadBudget;
+  }
+  void setUploadBudget(size_t budget) {
+    std::lock_guard<std::mutex> lock(mutex);
+    g_uploadBudget = budget;
+  }
+
+  /// Cocinar a BCn las imágenes sin comprimir. Por defecto, sólo con G3D_TEXTURE_COMPRESSION
+  bool compression() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return g_compression;
+  }
+  void setCompression(bool compression) {
+    std::lock_guard<std::mutex> lock(mutex);
+    g_compression = compression;
+  }
+
+  size_t memory() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return g_memory;
+  }
+  size_t size() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+  }
+  TextureCacheStats stats() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return g_stats;
+  }
+
+ private:
+  friend class TextureRef;
+
+  TextureRef reference(const std::shared_ptr<CachedTexture> &entry) {
+    entry->references++;
+    entry->lastUse = ++useClock;
+    return TextureRef(entry);
+  }
+
+  void release(CachedTexture &entry) {
+    std::lock_guard<std::mutex> lock(mutex);
+    entry.references--;
+    entry.lastUse = ++useClock;
+    if (util::JobSystem::getInstance().isMainThread()) trimLocked();
+  }
+
+  // El archivo puede estar suelto o dentro de un paquete de recursos (util/asset_pack.h)
+  static std::vector<unsigned char> readFile(const std::string &path) {
+    G3D_PROFILE_SCOPE("TextureCache::read");
+    std::shared_ptr<util::MappedFile> file = util::MappedFile::open(path);
+    if (!file) return std::vector<unsigned char>();
+    return std::vector<unsigned char>(file->data(), file->data() + file->size());
+  }
+
+  static uint64_t entryKey(uint64_t hash, TextureUsage usage) {
+    const uint32_t value = usage;
+    return util::hash64(&value, sizeof(value), hash);
+  }
+
+  util::MipOptions mipOptions(TextureUsage usage) {
+    util::MipOptions options;
+    options.srgb = usage == G3D_TEXTURE_COLOR || usage == G3D_TEXTURE_COLOR_SRGB;
+    options.normalMap = usage == G3D_TEXTURE_NORMAL;
+    options.filter = mipFilter();
+    return options;
+  }
+
+  // Copia para el renderer por software, que muestrea sin conversiones: una textura sRGB se pasa a lineal
+  static std::shared_ptr<const software::Image> softwareImage(const CachedTexture &texture,
+                                                              const unsigned char *pixels) {
+    const uint32_t channels = texture.channels;
+    if (texture.usage != G3D_TEXTURE_COLOR_SRGB || channels < 3)
+      return software::Image::create(texture.width, texture.height, channels, pixels);
+
+    std::vector<unsigned char> linear(pixels, pixels + static_cast<size_t>(texture.width) * texture.height * channels);
+    for (size_t i = 0; i < linear.size(); i += channels)
+      for (uint32_t c = 0; c < 3; c++)
+        linear[i + c] = static_cast<unsigned char>(util::srgbToLinear(linear[i + c]) * 255 + .5f);
+    return software::Image::create(texture.width, texture.height, channels, linear.data());
+  }
+
+  // DDS o KTX2, o la versión cocinada de la imagen si ya existe
+  bool readCompressed(CachedTexture &texture) {
+    std::unique_ptr<util::CompressedImage> image(new util::CompressedImage());
+    if (util::isCompressedContainer(texture.file.data(), texture.file.size())) {
+      if (!util::readCompressed(std::move(texture.file), *image)) {
+        exceptions::warning("WAR005", exceptions::format(exceptions::WAR005, texture.path.c_str()));
+        std::vector<unsigned char>().swap(texture.file);
+        return true;
+      }
+    } else {
+      const std::string cooked = compression() ? util::CookCache::getInstance().pathFor(texture.key, ".dds") : "";
+      if (cooked.empty()) return false;
+      std::ifstream in(cooked, std::ios::binary);
+      if (!in.is_open()) return false;
+      std::vector<unsigned char> file((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+      if (!util::readCompressed(std::move(file), *image)) return false;
+    }
+
+    std::vector<unsigned char>().swap(texture.file);
+    texture.width = static_cast<int>(image->width);
+    texture.height = static_cast<int>(image->height);
+    texture.channels = static_cast<int>(util::blockChannels(image->format));
+    texture.compressed = std::move(image);
+    return true;
+  }
+
+  // Comprime una copia de los píxeles en un job, sin demorar esta carga, y la deja para la próxima
+  void cook(const CachedTexture &texture) {
+    const std::string path = util::CookCache::getInstance().pathFor(texture.key, ".dds");
+    if (path.empty()) return;
+    const size_t size = static_cast<size_t>(texture.width) * texture.height * texture.channels;
+    std::shared_ptr<std::vector<unsigned char>> pixels =
+        std::make_shared<std::vector<unsigned char>>(texture.pixels.get(), texture.pixels.get() + size);
+    std::shared_ptr<util::MipChain> mips = std::make_shared<util::MipChain>(texture.mips);
+    const uint32_t width = texture.width, height = texture.height, channels = texture.channels;
+
+    util::JobSystem::getInstance().run(
+        [path, pixels, mips, width, height, channels] {
+          bool written = false;
+          try {
+            written = util::writeDDS(path, util::compressImage(pixels->data(), width, height, channels, *mips));
+          } catch (...) {
+          }
+          if (!written) exceptions::warning("WAR011", exceptions::format(exceptions::WAR011, path.c_str()));
+        },
+        &cooking, "TextureCache::cook");
+  }
+
+  static bool extension(const char *extension) {
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; i++) {
+      const char *name = reinterpret_cast<const char *>(glGetStringi(GL_EXTENSIONS, i));
+      if (name && std::strcmp(name, extension) == 0) return true;
+    }
+    return false;
+  }
+
+  static bool supported(util::BlockFormat format, bool srgb) {
+    // RGTC es core desde 3.0 y BPTC desde 4.2; S3TC sigue siendo una extensión, y en sRGB otra más
+    static const bool s3tc = extension("GL_EXT_texture_compression_s3tc");
+    static const bool s3tcSrgb = s3tc && (extension("GL_EXT_texture_sRGB") ||
+                                          extension("GL_EXT_texture_compression_s3tc_srgb"));
+    switch (format) {
+      case util::G3D_BC1:
+      case util::G3D_BC3:
+        return srgb ? s3tcSrgb : s3tc;
+      case util::G3D_BC4:
+      case util::G3D_BC5:
+        return true;
+      case util::G3D_BC7:
+        return GLAD_GL_VERSION_4_2 != 0;
+    }
+    return false;
+  }
+
+  void prepareUncompressed(CachedTexture &texture) {
+    const int channels = texture.channels;
+    if (channels == 1)
+      texture.format = GL_RED;
+    else if (channels == 2)
+      texture.format = GL_RG;
+    else if (channels == 3)
+      texture.format = GL_RGB;
+    else
+      texture.format = GL_RGBA;
+    texture.internalFormat = texture.format;
+    if (texture.usage == G3D_TEXTURE_COLOR_SRGB && channels >= 3)
+      texture.internalFormat = channels == 3 ? GL_SRGB8 : GL_SRGB8_ALPHA8;
+
+    if (isSoftware()) texture.image = softwareImage(texture, texture.pixels.get());
+  }
+
+  // Los bloques se suben tal cual. Si GL no tiene el formato, se decodifican y siguen el camino de siempre
+  void prepareCompressed(CachedTexture &texture) {
+    const util::CompressedImage &image = *texture.compressed;
+    const bool srgb = texture.usage == G3D_TEXTURE_COLOR_SRGB;
+    if (!supported(image.format, srgb)) {
+      decompress(texture);
+      return;
+    }
+
+    if (isSoftware()) {
+      std::vector<unsigned char> pixels(static_cast<size_t>(image.width) * image.height * texture.channels);
+      if (util::decodeBlocks(image.format, image.data.data() + image.levels[0].offset, image.width, image.height,
+                             pixels.data()))
+        texture.image = softwareImage(texture, pixels.data());
+      else
+        exceptions::warning("WAR005", exceptions::format(exceptions::WAR005, texture.path.c_str()));
+    }
+
+    texture.format = 0;
+    texture.internalFormat = srgb ? GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM : GL_COMPRESSED_RGBA_BPTC_UNORM;
+    if (image.format == util::G3D_BC1)
+      texture.internalFormat = srgb ? GL_COMPRESSED_SRGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+    else if (image.format == util::G3D_BC3)
+      texture.internalFormat = srgb ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+    else if (image.format == util::G3D_BC4)
+      texture.internalFormat = GL_COMPRESSED_RED_RGTC1;
+    else if (image.format == util::G3D_BC5)
+      texture.internalFormat = GL_COMPRESSED_RG_RGTC2;
+  }
+
+  // Nivel base de los bloques a píxeles, con mipmaps nuevos: los del archivo podrían no llegar a 1x1
+  bool decompress(CachedTexture &texture) {
+    const util::CompressedImage &image = *texture.compressed;
+    const size_t size = static_cast<size_t>(image.width) * image.height * texture.channels;
+    std::unique_ptr<unsigned char, void (*)(void *)> pixels{static_cast<unsigned char *>(std::malloc(size)), std::free};
+    const bool decoded =
+        util::decodeBlocks(image.format, image.data.data() + image.levels[0].offset, image.width, image.height,
+                           pixels.get());
+    texture.compressed.reset();
+    if (!decoded) {
+      exceptions::warning("WAR005", exceptions::format(exceptions::WAR005, texture.path.c_str()));
+      return false;
+    }
+    texture.pixels = std::move(pixels);
+    texture.mips = util::generateMips(texture.pixels.get(), texture.width, texture.height, texture.channels,
+                                      mipOptions(texture.usage));
+    return true;
+  }
+
+  /// Niveles en CPU: bloques comprimidos, o píxeles y util::MipChain
+  struct texture_level {
+    const unsigned char *data;
+    size_t size;
+    uint32_t width, height;
+  };
+
+  static bool hasSource(const CachedTexture &texture) { return texture.pixels || texture.compressed; }
+
+  static uint32_t levelCount(const CachedTexture &texture) {
+    if (texture.compressed) return static_cast<uint32_t>(texture.compressed->levels.size());
+    return texture.pixels ? 1 + static_cast<uint32_t>(texture.mips.levels.size()) : 0;
+  }
+
+  static texture_level levelData(const CachedTexture &texture, uint32_t level) {
+    if (texture.compressed) {
+      const util::CompressedLevel &data = texture.compressed->levels[level];
+      return {texture.compressed->data.data() + data.offset, data.size, data.width, data.height};
+    }
+    if (level == 0) {
+      const uint32_t width = texture.width, height = texture.height;
+      return {texture.pixels.get(), static_cast<size_t>(width) * height * texture.channels, width, height};
+    }
+    const util::MipLevel &mip = texture.mips.levels[level - 1];
+    return {texture.mips.data.data() + mip.offset, static_cast<size_t>(mip.width) * mip.height * texture.channels,
+            mip.width, mip.height};
+  }
+
+  // `pixels` es la dirección de los datos o, con un GL_PIXEL_UNPACK_BUFFER, el offset en el buffer
+  static void uploadLevel(const CachedTexture &texture, uint32_t level, const texture_level &data,
+                          const void *pixels) {
+    if (texture.format)
+      glTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), texture.internalFormat, data.width, data.height, 0,
+                   texture.format, GL_UNSIGNED_BYTE, pixels);
+    else
+      glCompressedTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), texture.internalFormat, data.width,
+                             data.height, 0, static_cast<GLsizei>(data.size), pixels);
+  }
+
+  static void freeSource(CachedTexture &texture) {
+    texture.pixels.reset();
+    texture.mips = util::MipChain();
+    texture.compressed.reset();
+  }
+
+  // Primer nivel de hasta residentSize texels por lado: de ahí para abajo siempre están en GL
+  static uint32_t tailLevel(const CachedTexture &texture) {
+    uint32_t level = 0;
+    while (level + 1 < texture.levels) {
+      const texture_level data = levelData(texture, level);
+      if (std::max(data.width, data.height) <= residentSize) break;
+      level++;
+    }
+    return level;
+  }
+
+  static uint32_t targetLevel(const CachedTexture &texture) {
+    return std::max(texture.wantedLevel, texture.firstLevel);
+  }
+
+  // Encola el nivel siguiente al último encolado. Un job lo copia al staging y, cuando el uploader lo emite, pasa a
+  // ser el nivel base. false si el uploader no tiene lugar
+  bool queueLevel(const std::shared_ptr<CachedTexture> &entry) {
+    const uint32_t level = entry->queuedLevel - 1;
+    const bool queued = TextureUploader::getInstance().enqueue(
+        entry->levelBytes[level],
+        [entry, level](void *target) {
+          const texture_level data = levelData(*entry, level);
+          std::memcpy(target, data.data, data.size);
+        },
+        [this, entry, level](const void *pixels) { define(*entry, level, pixels); });
+    if (queued) entry->queuedLevel = level;
+    return queued;
+  }
+
+  void define(CachedTexture &texture, uint32_t level, const void *pixels) {
+    // Se liberó mientras el nivel estaba en camino
+    if (!texture.uploaded) return;
+
+    glBindTexture(GL_TEXTURE_2D, texture.id);
+    const texture_level data = levelData(texture, level);
+    uploadLevel(texture, level, data, pixels);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, static_cast<GLint>(level));
+
+    texture.baseLevel = level;
+    util::Metrics::getInstance().add(util::G3D_COUNTER_TEXTURE_BYTES_UPLOADED, data.size);
+    resize(texture, static_cast<int64_t>(data.size));
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      g_stats.streamedLevels++;
+    }
+    if (level == 0) freeSource(texture);
+  }
+
+  // Saca de GL el nivel de más detalle que tiene la textura. Los píxeles en CPU también se liberan: si se vuelve a
+  // pedir, se lee otra vez el archivo
+  void dropLevel(CachedTexture &texture) {
+    const uint32_t level = texture.baseLevel;
+    glBindTexture(GL_TEXTURE_2D, texture.id);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, static_cast<GLint>(level + 1));
+    // Un nivel de 0x0 no ocupa memoria
+    uploadLevel(texture, level, {nullptr, 0, 0, 0}, nullptr);
+
+    texture.baseLevel = texture.queuedLevel = level + 1;
+    resize(texture, -static_cast<int64_t>(texture.levelBytes[level]));
+    freeSource(texture);
+    std::lock_guard<std::mutex> lock(mutex);
+    g_stats.droppedLevels++;
+  }
+
+  void resize(CachedTexture &texture, int64_t bytes) {
+    texture.memory += bytes;
+    util::Metrics::getInstance().add(util::G3D_GAUGE_TEXTURE_MEMORY, bytes);
+    std::lock_guard<std::mutex> lock(mutex);
+    g_memory += bytes;
+  }
+
+  void evictLevels() {
+    std::vector<CachedTexture *> idle;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (g_memory <= g_budget) return;
+      for (auto &entry : entries) {
+        CachedTexture &texture = *entry.second;
+        if (texture.uploaded && texture.baseLevel < texture.tailLevel && texture.queuedLevel == texture.baseLevel &&
+            texture.demandFrame + idleFrames < streamFrame)
+          idle.push_back(&texture);
+      }
+    }
+
+    std::sort(idle.begin(), idle.end(),
+              [](const CachedTexture *a, const CachedTexture *b) { return a->demandFrame < b->demandFrame; });
+    for (CachedTexture *texture : idle) {
+      while (texture->baseLevel < texture->tailLevel && memory() > budget()) dropLevel(*texture);
+      if (memory() <= budget()) break;
+    }
+  }
+
+  // Vuelve a leer el archivo en un job, para subir niveles que se habían sacado. Con un solo hilo, los jobs sólo
+  // corren dentro de un wait(): se lee acá mismo
+  void reload(const std::shared_ptr<CachedTexture> &entry) {
+    if (entry->reloading) return;
+    entry->reloading = true;
+    auto read = [this, entry] {
+      std::shared_ptr<CachedTexture> fresh = std::make_shared<CachedTexture>();
+      fresh->hash = entry->hash;
+      fresh->key = entry->key;
+      fresh->usage = entry->usage;
+      fresh->path = entry->path;
+      fresh->file = readFile(entry->path);
+      if (!fresh->file.empty()) decode(*fresh);
+      std::lock_guard<std::mutex> lock(mutex);
+      entry->reloaded = std::move(fresh);
+    };
+
+    util::JobSystem &jobs = util::JobSystem::getInstance();
+    if (jobs.threads() == 1)
+      read();
+    else
+      jobs.run(read, &reloads, "TextureCache::reload");
+  }
+
+  // Toma lo que leyó reload(). Si el archivo ya no es el mismo, la textura se queda con los niveles que tiene
+  bool adoptSource(CachedTexture &texture) {
+    std::shared_ptr<CachedTexture> fresh;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      fresh = std::move(texture.reloaded);
+    }
+    if (!fresh) return false;
+    texture.reloading = false;
+
+    if (fresh->compressed && texture.format) decompress(*fresh);
+    if (fresh->width != texture.width || fresh->height != texture.height || fresh->channels != texture.channels ||
+        levelCount(*fresh) != texture.levels || static_cast<bool>(fresh->compressed) != (texture.format == 0)) {
+      texture.firstLevel = texture.baseLevel;
+      return false;
+    }
+
+    texture.pixels = std::move(fresh->pixels);
+    texture.mips = std::move(fresh->mips);
+    texture.compressed = std::move(fresh->compressed);
+    return true;
+  }
+
+  void trimLocked() {
+    // Decodificadas que nadie llegó a subir (cargas canceladas): no sirven sin referencias
+    for (auto it = entries.begin(); it != entries.end();) {
+      if (it->second->references == 0 && !it->second->uploaded)
+        it = entries.erase(it);
+      else
+        ++it;
+    }
+
+    while (g_memory > g_budget) {
+      auto victim = entries.end();
+      for (auto it = entries.begin(); it != entries.end(); ++it) {
+        if (it->second->references == 0 && (victim == entries.end() || it->second->lastUse < victim->second->lastUse))
+          victim = it;
+      }
+      if (victim == entries.end()) break;
+
+      destroy(*victim->second);
+      entries.erase(victim);
+      g_stats.evictions++;
+    }
+  }
+
+  void destroy(CachedTexture &entry) {
+    if (!entry.uploaded) return;
+    glDeleteTextures(1, &entry.id);
+    g_memory -= entry.memory;
+    if (entry.memory) {
+      util::Metrics &metrics = util::Metrics::getInstance();
+      metrics.add(util::G3D_GAUGE_TEXTURES, -1);
+      metrics.add(util::G3D_GAUGE_TEXTURE_MEMORY, -static_cast<int64_t>(entry.memory));
+    }
+    entry.uploaded = false;
+  }
+};
+
+inline void TextureRef::reset() {
+  if (!g_entry) return;
+  TextureCache::getInstance().release(*g_entry);
+  g_entry.reset();
+}
+
+}  // namespace opengl
+}  // namespace graph3d
+
+#endif
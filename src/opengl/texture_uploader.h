@@ -0,0 +1,260 @@
+#ifndef GRAPH3D_OPENGL_TEXTURE_UPLOADER_H_
+#define GRAPH3D_OPENGL_TEXTURE_UPLOADER_H_
+
+// Subidas de texturas que no frenan el frame.
+//
+// El staging es un anillo dentro de un GL_PIXEL_UNPACK_BUFFER mapeado de forma persistente (GL_ARB_buffer_storage).
+// El hilo principal reserva espacio con enqueue() y un job copia los píxeles directo a la memoria mapeada. En algún
+// frame siguiente, flush() emite las subidas con la copia terminada, en orden y hasta gastar el presupuesto de bytes,
+// y pone un fence detrás de cada una. El espacio vuelve al anillo recién cuando GL pasó ese fence, así nunca se
+// escribe algo que el driver todavía no leyó.
+//
+// Sin buffer storage (el contexto pide 4.3), el anillo es memoria común y GL copia desde ahí al emitir.
+// Lo que no entra en el anillo se copia a un buffer propio y se sube desde memoria común.
+
+#include <glad/glad.h>
+
+#include <GLFW/glfw3.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <memory>
+
+#include <opengl/backend.h>
+#include <opengl/headless.h>
+#include <util/jobs.h>
+#include <util/profiler.h>
+
+// GL_ARB_buffer_storage es core desde 4.4, así que glad (4.3) no lo carga
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+
+namespace graph3d {
+namespace opengl {
+
+class TextureUploader {
+ public:
+  /// Singleton
+  static TextureUploader &getInstance() {
+    static TextureUploader instance;
+    return instance;
+  }
+
+  /// Escribe los bytes de la subida en `target`. Corre en un job
+  typedef std::function<void(void *target)> fill_func_t;
+  /// La llamada a GL (glTexImage2D, ...), en el hilo principal. `pixels` es un offset en el GL_PIXEL_UNPACK_BUFFER
+  /// ligado o, sin buffer, la dirección de los datos
+  typedef std::function<void(const void *pixels)> issue_func_t;
+
+  static constexpr size_t stagingSize = size_t(32) << 20;
+
+ private:
+  typedef void(APIENTRYP buffer_storage_func_t)(GLenum target, GLsizeiptr size, const void *data, GLbitfield flags);
+
+  struct staged_upload {
+    size_t offset = 0, size = 0;
+    bool ring = false;                     // Ocupa [offset, offset + size) del anillo hasta que se recicla
+    std::unique_ptr<unsigned char[]> own;  // Si no entra en el anillo. Se suelta al emitir
+    issue_func_t issue;
+    util::JobCounter copied;
+    bool issued = false;
+    GLsync fence = nullptr;
+  };
+
+  bool initialized = false;
+  unsigned int buffer = 0;
+  unsigned char *staging = nullptr;           // Mapeado, o `memory` sin buffer storage
+  std::unique_ptr<unsigned char[]> memory;
+  std::deque<std::unique_ptr<staged_upload>> uploads;  // En orden de reserva, que es el del anillo
+
+  TextureUploader() {}
+
+ public:
+  TextureUploader &operator=(const TextureUploader &) = delete;
+  TextureUploader(const TextureUploader &) = delete;
+
+ public:
+  /// Encola una subida de `size` bytes. Sólo en el hilo principal.
+  /// Devuelve false si el anillo está lleno: hay que volver a intentar en otro frame
+  bool enqueue(size_t size, fill_func_t fill, issue_func_t issue) {
+    if (!initialized) initialize();
+    recycle();
+
+    std::unique_ptr<staged_upload> upload(new staged_upload());
+    upload->size = size;
+    upload->issue = std::move(issue);
+    unsigned char *target;
+    if (size > stagingSize) {
+      upload->own.reset(new unsigned char[size]);
+      target = upload->own.get();
+    } else {
+      if (!allocate(size, upload->offset)) return false;
+      upload->ring = true;
+      target = staging + upload->offset;
+    }
+
+    // Con un solo hilo, los jobs sólo corren dentro de un wait(): se copia acá mismo
+    util::JobSystem &jobs = util::JobSystem::getInstance();
+    if (jobs.threads() == 1)
+      fill(target);
+    else
+      jobs.run([fill, target] { fill(target); }, &upload->copied, "TextureUploader::copy");
+    uploads.push_back(std::move(upload));
+    return true;
+  }
+
+  /// Emite las subidas ya copiadas, en orden, hasta gastar `budget` bytes (siempre al menos una).
+  /// Devuelve los bytes emitidos. Sólo en el hilo principal
+  size_t flush(size_t budget) {
+    G3D_PROFILE_SCOPE("TextureUploader::flush");
+    recycle();
+    size_t spent = 0;
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (const std::unique_ptr<staged_upload> &upload : uploads) {
+      if (upload->issued) continue;
+      if (!upload->copied.done() || (spent && spent + upload->size > budget)) break;
+
+      if (!upload->ring || !buffer) {
+        upload->issue(upload->ring ? staging + upload->offset : upload->own.get());
+      } else {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+        upload->issue(reinterpret_cast<const void *>(upload->offset));
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        upload->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+      }
+      upload->issued = true;
+      upload->own.reset();
+      spent += upload->size;
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    return spent;
+  }
+
+  /// Subidas encoladas que todavía no se emitieron
+  size_t pending() const {
+    size_t count = 0;
+    for (const std::unique_ptr<staged_upload> &upload : uploads) count += !upload->issued;
+    return count;
+  }
+
+  /// Descarta lo pendiente (espera las copias en curso) y libera el buffer. Antes de destruir el contexto de GL
+  void clear() {
+    util::JobSystem &jobs = util::JobSystem::getInstance();
+    for (const std::unique_ptr<staged_upload> &upload : uploads) {
+      jobs.wait(upload->copied);
+      if (upload->fence) glDeleteSync(upload->fence);
+    }
+    uploads.clear();
+    if (buffer) {
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+      glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+      glDeleteBuffers(1, &buffer);
+    }
+    buffer = 0;
+    staging = nullptr;
+    memory.reset();
+    initialized = false;
+  }
+
+  /// true si el staging es un buffer de GL mapeado
+  bool persistent() const { return buffer != 0; }
+
+ private:
+  void initialize() {
+    initialized = true;
+    buffer_storage_func_t bufferStorage = reinterpret_cast<buffer_storage_func_t>(
+        isHeadless() ? HeadlessDevice::getProcAddress("glBufferStorage")
+                     : reinterpret_cast<void *>(glfwGetProcAddress("glBufferStorage")));
+    GLint major = 0, minor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &major);
+    glGetIntegerv(GL_MINOR_VERSION, &minor);
+
+    if (bufferStorage && (major > 4 || (major == 4 && minor >= 4) || hasExtension("GL_ARB_buffer_storage"))) {
+      const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+      glGenBuffers(1, &buffer);
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+      bufferStorage(GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(stagingSize), nullptr, flags);
+      staging = static_cast<unsigned char *>(
+          glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, static_cast<GLsizeiptr>(stagingSize), flags));
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+      if (staging) return;
+      glDeleteBuffers(1, &buffer);
+      buffer = 0;
+    }
+
+    memory.reset(new unsigned char[stagingSize]);
+    staging = memory.get();
+  }
+
+  static bool hasExtension(const char *extension) {
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; i++) {
+      const char *name = reinterpret_cast<const char *>(glGetStringi(GL_EXTENSIONS, i));
+      if (name && std::strcmp(name, extension) == 0) return true;
+    }
+    return false;
+  }
+
+  // Devuelve al anillo el espacio de las subidas que GL ya leyó. Se libera en orden, desde la más vieja
+  void recycle() {
+    while (!uploads.empty()) {
+      staged_upload &upload = *uploads.front();
+      if (!upload.issued) break;
+      if (upload.fence) {
+        const GLenum status = glClientWaitSync(upload.fence, 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) break;
+        glDeleteSync(upload.fence);
+      }
+      uploads.pop_front();
+    }
+  }
+
+  // Espacio contiguo de `size` bytes detrás de la última reserva, o al principio si no entra al final.
+  // Sólo cuentan las subidas del anillo: las que tienen buffer propio no ocupan lugar, emitidas o no
+  bool allocate(size_t size, size_t &offset) {
+    size = (size + 63) & ~size_t(63);
+    const staged_upload *first = nullptr, *last = nullptr;
+    for (const std::unique_ptr<staged_upload> &upload : uploads) {
+      if (!upload->ring) continue;
+      if (!first) first = upload.get();
+      last = upload.get();
+    }
+    if (!first) {
+      offset = 0;
+      return true;
+    }
+
+    const size_t head = (last->offset + last->size + 63) & ~size_t(63);
+    if (head > stagingSize) return false;  // No pasa: ninguna reserva del anillo se sale de él
+    if (first->offset <= last->offset) {
+      if (stagingSize - head >= size) {
+        offset = head;
+        return true;
+      }
+      if (first->offset >= size) {
+        offset = 0;
+        return true;
+      }
+      return false;
+    }
+    if (first->offset >= head + size) {
+      offset = head;
+      return true;
+    }
+    return false;
+  }
+};
+
+}  // namespace opengl
+}  // namespace graph3d
+
+#endif
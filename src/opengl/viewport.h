@@ -14,18 +14,25 @@
 
 #include <entity/camera.h>
 #include <entity/light.h>
+#include <opengl/backend.h>
 #include <opengl/drawer.h>
+#include <software/rasterizer.h>
+#include <util/allocations.h>
 #include <util/bounds.h>
 #include <util/dimension.h>
 #include <util/pipe.h>
+#include <util/profiler.h>
 #include <util/resizer.h>
 
 namespace graph3d {
+class Graph3D;
+
 namespace opengl {
 class Window;
 
 class Viewport {
   friend class graph3d::opengl::Window;
+  friend class graph3d::Graph3D;
 
  private:
   typedef std::pair<drawer*, int32_t> drawer_entry;
@@ -121,7 +128,7 @@ class Viewport {
 
  public:
   void close() const {
-    for (close_func_t func : closeSubscribers) func(*this);
+    for (const close_func_t& func : closeSubscribers) func(*this);
   }
 
   void attachDrawer(drawer* listener, int32_t priority = 0) {
@@ -167,7 +174,21 @@ class Viewport {
   void updateSize() { g_bounds = g_resizer.calcSize(window->width, window->height); }
 
   void draw(const Context& context) const {
-    glViewport(g_bounds.first.width, g_bounds.first.height, g_bounds.second.width, g_bounds.second.height);
+    G3D_PROFILE_SCOPE("Viewport::draw");
+    G3D_ALLOC_TAG("Viewport::draw");
+    if (isSoftware()) {
+      // La pasada queda abierta para los draws; se dibuja al abrir la próxima o al presentar la ventana
+      uint32_t clear = 0;
+      if (g_clearMask & GL_COLOR_BUFFER_BIT) clear |= software::G3D_CLEAR_COLOR;
+      if (g_clearMask & GL_DEPTH_BUFFER_BIT) clear |= software::G3D_CLEAR_DEPTH;
+      software::Rasterizer::getInstance().begin(g_bounds.first.width, g_bounds.first.height, g_bounds.width,
+                                                g_bounds.height, depthTesting, clear, clearColor);
+
+      for (const drawer_entry& drawer : drawers) drawer.first->draw(context);
+      return;
+    }
+
+    glViewport(g_bounds.first.width, g_bounds.first.height, g_bounds.width, g_bounds.height);
 
     glEnable(GL_SCISSOR_TEST);
     glScissor(g_bounds.first.width, g_bounds.first.height, g_bounds.width, g_bounds.height);
@@ -185,7 +206,7 @@ class Viewport {
     glClearColor(clearColor.r, clearColor.g, clearColor.b, clearColor.a);
     glClear(g_clearMask);
 
-    for (std::pair<drawer*, int32_t> drawer : drawers) drawer.first->draw(context);
+    for (const drawer_entry& drawer : drawers) drawer.first->draw(context);
   }
 
   void bindPipes() {
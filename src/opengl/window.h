@@ -11,11 +11,18 @@
 
 #include <exceptions/exception.h>
 #include <exceptions/messages.h>
+#include <opengl/backend.h>
+#include <opengl/capture.h>
+#include <opengl/framebuffer.h>
+#include <opengl/headless.h>
 #include <opengl/monitor.h>
+#include <opengl/software_surface.h>
 #include <opengl/viewport.h>
+#include <util/allocations.h>
 #include <util/dimension.h>
 #include <util/logger.h>
 #include <util/pipe.h>
+#include <util/profiler.h>
 
 namespace graph3d {
 struct Context;
@@ -81,9 +88,16 @@ class Window {
   static bool viewport_comp(const viewport_entry& a, const viewport_entry& b) { return a.second < b.second; }
 
  private:
-  GLFWwindow* g_ref;
+  GLFWwindow* g_ref = nullptr;
   Monitor* g_monitor = nullptr;
 
+  // Sólo en modo headless: la ventana es un framebuffer del contexto EGL
+  Framebuffer* g_framebuffer = nullptr;
+  mutable bool g_closed = false;
+
+  // Sólo con el renderer por software: la imagen que dibuja el rasterizador
+  SoftwareSurface* g_surface = nullptr;
+
   util::dimension g_size;
 
   std::vector<viewport_entry> viewports;
@@ -91,42 +105,58 @@ class Window {
 
   std::vector<viewport_draw_func_t> viewportDrawSubscribers;
 
+  FrameCapture* g_capture = nullptr;
+  const Viewport* captureViewport = nullptr;
+
  public:
   Window& operator=(const Window&) = delete;
   Window(const Window&) = delete;
 
   Window(const int width, const int height, const char* title, bool fullscreen) : g_size(width, height) {
-    util::log("> Crear Ventana", 3);
-    g_ref = glfwCreateWindow(width, height, title, NULL, NULL);
-    if (g_ref == nullptr) throw exceptions::exception("ERR005", exceptions::ERR005);
+    G3D_LOG(3, "> Crear Ventana");
+    if (isHeadless()) {
+      g_framebuffer = new Framebuffer(g_size);
+    } else {
+      g_ref = glfwCreateWindow(width, height, title, NULL, NULL);
+      if (g_ref == nullptr) throw exceptions::exception("ERR005", exceptions::ERR005);
+    }
+    if (isSoftware()) g_surface = new SoftwareSurface(g_size);
     g_mainViewport = viewports.emplace_back(new Viewport(&g_size), 0).first;
     g_mainViewport->onClose(&Window::viewportClose, this);
 
-    setFullscreen(fullscreen);
+    if (!isHeadless()) setFullscreen(fullscreen);
 
     bindPipes();
-    util::log("  < Crear Ventana", 3);
+    G3D_LOG(3, "  < Crear Ventana");
   }
 
   ~Window() {
-    util::log("> Eliminar Ventana", 3);
+    G3D_LOG(3, "> Eliminar Ventana");
+    stopCapture();
     for (const viewport_entry& entry : viewports) delete entry.first;
 
     viewports.clear();
 
-    glfwDestroyWindow(ref);
+    // Antes que el framebuffer o la ventana, mientras el contexto sigue vivo
+    if (g_surface) delete g_surface;
+    if (isHeadless())
+      delete g_framebuffer;
+    else
+      glfwDestroyWindow(ref);
     if (g_monitor) delete g_monitor;
-    util::log("  < Eliminar Ventana", 3);
+    G3D_LOG(3, "  < Eliminar Ventana");
   }
 
  private:
   util::dimension getSize() {
+    if (isHeadless()) return g_size;
     int width, height;
     glfwGetWindowSize(g_ref, &width, &height);
     return util::dimension(width, height);
   }
 
   glm::vec2 getPosition() {
+    if (isHeadless()) return glm::vec2(0, 0);
     int x, y;
     glfwGetWindowPos(g_ref, &x, &y);
     return glm::vec2(x, y);
@@ -138,38 +168,48 @@ class Window {
 
   Viewport* getMainViewport() { return g_mainViewport; }
 
+  GLuint getFramebuffer() { return g_framebuffer ? g_framebuffer->id() : 0; }
+
+  FrameCapture* getCapture() { return g_capture; }
+
  private:
-  bool isDecorated() { return glfwGetWindowAttrib(g_ref, GLFW_DECORATED); }
+  bool isDecorated() { return !isHeadless() && glfwGetWindowAttrib(g_ref, GLFW_DECORATED); }
 
   bool isFullscreen() { return g_monitor; }
 
  private:
   const util::dimension& setSize(const util::dimension& size) {
-    glfwSetWindowSize(g_ref, size.width, size.height);
+    if (g_surface) g_surface->resize(size);
+    if (isHeadless()) {
+      g_size = size;
+      g_framebuffer->resize(size);
+    } else
+      glfwSetWindowSize(g_ref, size.width, size.height);
     return size;
   }
 
   const glm::vec2& setPosition(const glm::vec2& pos) {
-    glfwSetWindowSize(g_ref, (int)pos.x, (int)pos.y);
+    if (!isHeadless()) glfwSetWindowSize(g_ref, (int)pos.x, (int)pos.y);
     return pos;
   }
 
   const bool& setDecorated(const bool& decorated) {
-    glfwSetWindowAttrib(g_ref, GLFW_DECORATED, decorated ? GLFW_TRUE : GLFW_FALSE);
+    if (!isHeadless()) glfwSetWindowAttrib(g_ref, GLFW_DECORATED, decorated ? GLFW_TRUE : GLFW_FALSE);
     return decorated;
   }
 
   const bool& setFullscreen(const bool& fullscreen) {
-    util::log("> Chequear pantalla completa", 5);
+    if (isHeadless()) return fullscreen;
+    G3D_LOG(5, "> Chequear pantalla completa");
     if (fullscreen && !g_monitor) {
-      util::log("> Cambiar a Pantalla completa", 6);
+      G3D_LOG(6, "> Cambiar a Pantalla completa");
       g_monitor = new Monitor(*this);
       util::dimension monSize = g_monitor->size;
       int refreshRate = g_monitor->refreshRate;
       glfwSetWindowMonitor(g_ref, g_monitor->getRef(), 0, 0, monSize.width, monSize.height, refreshRate);
-      util::log("  < Cambiar a Pantalla completa", 6);
+      G3D_LOG(6, "  < Cambiar a Pantalla completa");
     } else if (!fullscreen && g_monitor) {
-      util::log("> Pasar a modo Ventana", 6);
+      G3D_LOG(6, "> Pasar a modo Ventana");
       glm::vec2 monPos = g_monitor->position, monSize = (util::dimension)g_monitor->size;
       delete g_monitor;
       g_monitor = nullptr;
@@ -177,10 +217,10 @@ class Window {
       pos.width = (int)(monPos.x + (monSize.x - size.width) / 2);
       pos.height = (int)(monPos.y + (monSize.y - size.width) / 2);
       glfwSetWindowMonitor(g_ref, NULL, pos.width, pos.height, (int)monSize.x, (int)monSize.y, GLFW_DONT_CARE);
-      util::log("> Pasar a modo ventana", 6);
+      G3D_LOG(6, "> Pasar a modo ventana");
     }
 
-    util::log("  < Chequear pantalla completa", 5);
+    G3D_LOG(5, "  < Chequear pantalla completa");
     return fullscreen;
   }
 
@@ -195,15 +235,56 @@ class Window {
   util::copy_pipe_get<Monitor*, Window, &getMonitor> monitor;
   util::copy_pipe_get<Viewport*, Window, &getMainViewport> mainViewport;
 
+  // 0 (el framebuffer por defecto) salvo en modo headless
+  util::copy_pipe_get<GLuint, Window, &getFramebuffer> framebuffer;
+
+  // nullptr si no se está capturando
+  util::copy_pipe_get<FrameCapture*, Window, &getCapture> capture;
+
  public:
-  void close() const { glfwSetWindowShouldClose(g_ref, GLFW_TRUE); }
-  bool shouldClose() const { return glfwWindowShouldClose(g_ref); }
-  void minimize() const { glfwIconifyWindow(g_ref); }
-  void restore() const { glfwRestoreWindow(g_ref); }
-  void maximize() const { glfwMaximizeWindow(g_ref); }
-  void focus() const { glfwFocusWindow(g_ref); }
-  void hide() const { glfwHideWindow(g_ref); }
-  void show() const { glfwShowWindow(g_ref); }
+  void close() const {
+    if (isHeadless())
+      g_closed = true;
+    else
+      glfwSetWindowShouldClose(g_ref, GLFW_TRUE);
+  }
+  bool shouldClose() const { return isHeadless() ? g_closed : glfwWindowShouldClose(g_ref); }
+  void minimize() const {
+    if (!isHeadless()) glfwIconifyWindow(g_ref);
+  }
+  void restore() const {
+    if (!isHeadless()) glfwRestoreWindow(g_ref);
+  }
+  void maximize() const {
+    if (!isHeadless()) glfwMaximizeWindow(g_ref);
+  }
+  void focus() const {
+    if (!isHeadless()) glfwFocusWindow(g_ref);
+  }
+  void hide() const {
+    if (!isHeadless()) glfwHideWindow(g_ref);
+  }
+  void show() const {
+    if (!isHeadless()) glfwShowWindow(g_ref);
+  }
+
+  /// Hace actual el contexto de la ventana y su framebuffer (y su imagen, con el renderer por software)
+  void makeCurrent() const {
+    if (isHeadless()) {
+      HeadlessDevice::getInstance().makeCurrent();
+      g_framebuffer->bind();
+    } else
+      glfwMakeContextCurrent(g_ref);
+    if (g_surface) g_surface->bind();
+  }
+
+  /// Con el renderer por software, copia lo rasterizado al framebuffer de la ventana. draw() ya lo hace solo;
+  /// hace falta sólo si se dibujan viewports a mano
+  void present() const {
+    if (!g_surface) return;
+    makeCurrent();
+    g_surface->present(g_framebuffer ? g_framebuffer->id() : 0);
+  }
 
  public:
   Viewport* createViewport(int32_t priority = 0) {
@@ -214,7 +295,26 @@ class Window {
   }
 
  public:
-  bool operator==(const Window& other) const { return g_ref == other.ref; }
+  /// Captura cada frame de la ventana, o sólo de `viewport`, hasta llamar a stopCapture
+  FrameCapture* startCapture(const CaptureSettings& settings, const Viewport* viewport = nullptr) {
+    stopCapture();
+    makeCurrent();
+    g_capture = new FrameCapture(settings);
+    captureViewport = viewport;
+    return g_capture;
+  }
+
+  /// Espera los frames pendientes y cierra la captura
+  void stopCapture() {
+    if (!g_capture) return;
+    makeCurrent();
+    delete g_capture;
+    g_capture = nullptr;
+    captureViewport = nullptr;
+  }
+
+ public:
+  bool operator==(const Window& other) const { return this == &other; }
 
  private:
   void viewportClose(const Viewport& viewport) {
@@ -222,6 +322,7 @@ class Window {
 
     while (it != end) {
       if (*(it->first) == viewport) {
+        if (captureViewport == it->first) stopCapture();
         delete it->first;
         it = viewports.erase(it);
         end = viewports.end();
@@ -231,15 +332,30 @@ class Window {
   }
 
   void draw(const Context& context) const {
-    glfwMakeContextCurrent(g_ref);
+    G3D_PROFILE_SCOPE("Window::draw");
+    G3D_ALLOC_TAG("Window::draw");
+    makeCurrent();
 
     for (const viewport_entry& entry : viewports) viewportDraw(entry.first, context);
+    if (g_surface) g_surface->present(g_framebuffer ? g_framebuffer->id() : 0);
 
-    glfwSwapBuffers(g_ref);
+    if (g_capture) {
+      const GLuint target = g_framebuffer ? g_framebuffer->id() : 0;
+      if (captureViewport) {
+        const util::bounds& bounds = captureViewport->g_bounds;
+        g_capture->capture(target, bounds.first.width, bounds.first.height, bounds.width, bounds.height);
+      } else
+        g_capture->capture(target, 0, 0, g_size.width, g_size.height);
+    }
+
+    if (!isHeadless()) {
+      G3D_PROFILE_SCOPE("Window::swapBuffers");
+      glfwSwapBuffers(g_ref);
+    }
   }
 
   void viewportDraw(Viewport* viewport, const Context& context) const {
-    for (viewport_draw_func_t func : viewportDrawSubscribers) func(context, *this, *viewport);
+    for (const viewport_draw_func_t& func : viewportDrawSubscribers) func(context, *this, *viewport);
     viewport->draw(context);
   }
 
@@ -253,6 +369,8 @@ class Window {
     ref.setParent(this);
     monitor.setParent(this);
     mainViewport.setParent(this);
+    framebuffer.setParent(this);
+    capture.setParent(this);
   }
 
  public:
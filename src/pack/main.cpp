@@ -0,0 +1,130 @@
+// graph3d_pack: arma un paquete de recursos (util/asset_pack.h) con el contenido de una carpeta.
+//
+//   graph3d_pack resources resources.g3dpack
+//   graph3d_pack resources resources.g3dpack --store .g3dmesh,.dds --align 64
+//
+// Los nombres quedan relativos a la carpeta, así que la aplicación registra "resources.g3dpack/shaders" donde antes
+// registraba "resources/shaders". Sale con 1 si no se puede leer la carpeta o escribir el paquete.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <util/asset_pack.h>
+
+namespace {
+
+struct Options {
+  std::string folder, output;
+  bool compress = true;
+  // Se leen directo del paquete, sin descomprimir ni copiar: las mallas cocinadas se mapean tal cual
+  std::vector<std::string> store = {".g3dmesh"};
+  uint32_t alignment = 16;
+};
+
+void usage() {
+  std::cerr << "Uso: graph3d_pack CARPETA PAQUETE [opciones]\n"
+               "  --store EXT,...   extensiones que se guardan sin comprimir (.g3dmesh)\n"
+               "  --no-compress     no comprimir nada\n"
+               "  --align N         alineacion de cada entrada en bytes (16)\n";
+}
+
+std::vector<std::string> split(const std::string& value) {
+  std::vector<std::string> items;
+  for (size_t start = 0; start <= value.size();) {
+    const size_t end = std::min(value.find(',', start), value.size());
+    if (end > start) items.push_back(value.substr(start, end - start));
+    start = end + 1;
+  }
+  return items;
+}
+
+bool parse(int argc, char** argv, Options& options) {
+  std::vector<std::string> positional;
+  for (int i = 1; i < argc; i++) {
+    const std::string arg = argv[i];
+    if (arg == "--help" || arg == "-h") return false;
+    if (arg == "--no-compress") {
+      options.compress = false;
+      continue;
+    }
+    if (arg.compare(0, 2, "--")) {
+      positional.push_back(arg);
+      continue;
+    }
+    if (i + 1 >= argc) {
+      std::cerr << "Falta el valor de " << arg << '\n';
+      return false;
+    }
+
+    const std::string value = argv[++i];
+    if (arg == "--store")
+      options.store = split(value);
+    else if (arg == "--align")
+      options.alignment = static_cast<uint32_t>(std::strtoul(value.c_str(), nullptr, 10));
+    else {
+      std::cerr << "Opcion desconocida: " << arg << '\n';
+      return false;
+    }
+  }
+  if (positional.size() != 2 || options.alignment == 0) return false;
+  options.folder = positional[0];
+  options.output = positional[1];
+  return true;
+}
+
+bool stored(const Options& options, const std::filesystem::path& path) {
+  const std::string extension = path.extension().generic_string();
+  for (const std::string& item : options.store)
+    if (extension == item || extension == '.' + item) return true;
+  return false;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options options;
+  if (!parse(argc, argv, options)) {
+    usage();
+    return 1;
+  }
+
+  std::error_code error;
+  const std::filesystem::path root(options.folder);
+  const std::filesystem::path output = std::filesystem::weakly_canonical(options.output, error);
+  graph3d::util::AssetPackWriter writer(options.alignment);
+
+  for (std::filesystem::recursive_directory_iterator it(root, error), end; !error && it != end; it.increment(error)) {
+    if (!it->is_regular_file(error)) continue;
+    // El paquete puede quedar dentro de la carpeta que se empaqueta: no se incluye a sí mismo
+    if (std::filesystem::weakly_canonical(it->path(), error) == output) continue;
+
+    std::ifstream in(it->path(), std::ios::binary);
+    if (!in.is_open()) {
+      std::cerr << "No se pudo leer " << it->path().generic_string() << '\n';
+      return 1;
+    }
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    const std::string name = it->path().lexically_relative(root).generic_string();
+    writer.add(name, std::move(data), options.compress && !stored(options, it->path()));
+  }
+  if (error) {
+    std::cerr << "No se pudo recorrer " << options.folder << ": " << error.message() << '\n';
+    return 1;
+  }
+
+  if (!writer.write(options.output)) {
+    std::cerr << "No se pudo escribir " << options.output << '\n';
+    return 1;
+  }
+
+  std::printf("%zu archivos, %.1f KiB -> %.1f KiB en %s\n", writer.size(), writer.rawSize() / 1024.,
+              writer.storedSize() / 1024., options.output.c_str());
+  return 0;
+}
@@ -0,0 +1,206 @@
+// graph3d_replay: reproduce en modo headless una sesión grabada con G3D_RECORD o Graph3D::startRecording.
+//
+//   G3D_RECORD=session.g3dr ./3DGraph
+//   graph3d_replay session.g3dr --passes 3 --output frames.jsonl
+//   graph3d_replay session.g3dr --baseline frames_v1.jsonl --threshold 0.1
+//
+// Se corre desde el mismo directorio que la aplicación grabada, así las carpetas de recursos se resuelven igual.
+// Sale con 1 si falla la reproducción y con 2 si el p50 o el p95 empeoran más que `threshold` contra el baseline.
+
+#include <graph3d.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <bench/results.h>
+
+namespace {
+
+struct Options {
+  std::string capture;
+  graph3d::ReplaySettings settings;
+  int width = 800, height = 600;
+
+  std::string output = "graph3d_replay.jsonl";
+  std::string baseline;
+  double threshold = .1;
+};
+
+class ReplayApp : public ::Graph3D {
+ private:
+  const Options& options;
+  graph3d::ReplayStats g_stats;
+  std::string g_renderer;
+
+ public:
+  explicit ReplayApp(const Options& options)
+      : ::Graph3D(options.width, options.height, "graph3d_replay"), options(options) {}
+
+  const graph3d::ReplayStats& stats() const { return g_stats; }
+  const std::string& renderer() const { return g_renderer; }
+
+ protected:
+  void setup() override { headless = true; }
+
+  void initialize() override {
+    g_renderer = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+    g_stats = replay(options.capture, options.settings);
+    close();
+  }
+};
+
+void usage() {
+  std::cerr << "Uso: graph3d_replay GRABACION [opciones]\n"
+               "  --passes N          veces que se reproduce la grabacion (1)\n"
+               "  --no-finish         no esperar a la GPU al final de cada frame\n"
+               "  --size WxH          tamaño inicial de la ventana (800x600)\n"
+               "  --output PATH       tiempos por frame en JSON lines (graph3d_replay.jsonl)\n"
+               "  --baseline PATH     salida de otra reproduccion contra la que comparar\n"
+               "  --threshold X       empeoramiento tolerado, 0.1 = 10% (0.1)\n";
+}
+
+bool parse(int argc, char** argv, Options& options) {
+  for (int i = 1; i < argc; i++) {
+    const std::string arg = argv[i];
+    if (arg == "--help" || arg == "-h") return false;
+    if (arg == "--no-finish") {
+      options.settings.finish = false;
+      continue;
+    }
+    if (arg.compare(0, 2, "--")) {
+      options.capture = arg;
+      continue;
+    }
+    if (i + 1 >= argc) {
+      std::cerr << "Falta el valor de " << arg << '\n';
+      return false;
+    }
+
+    const std::string value = argv[++i];
+    if (arg == "--passes")
+      options.settings.passes = static_cast<uint32_t>(std::strtoul(value.c_str(), nullptr, 10));
+    else if (arg == "--size") {
+      if (std::sscanf(value.c_str(), "%dx%d", &options.width, &options.height) != 2) {
+        std::cerr << "Tamaño invalido: " << value << '\n';
+        return false;
+      }
+    } else if (arg == "--output")
+      options.output = value;
+    else if (arg == "--baseline")
+      options.baseline = value;
+    else if (arg == "--threshold")
+      options.threshold = std::strtod(value.c_str(), nullptr);
+    else {
+      std::cerr << "Opcion desconocida: " << arg << '\n';
+      return false;
+    }
+  }
+  return !options.capture.empty() && options.settings.passes > 0;
+}
+
+void writeString(std::ostream& out, const std::string& value) {
+  out << '"';
+  for (char c : value) {
+    if (c == '"' || c == '\\') out << '\\';
+    out << c;
+  }
+  out << '"';
+}
+
+// Busca "clave":número en la línea de resumen de una reproducción anterior. -1 si no está
+double readSummary(const std::string& path, const std::string& name) {
+  std::ifstream file(path);
+  const std::string key = '"' + name + "\":";
+  for (std::string line; std::getline(file, line);) {
+    if (line.find("\"summary\":") == std::string::npos) continue;
+    const size_t pos = line.find(key);
+    if (pos != std::string::npos) return std::strtod(line.c_str() + pos + key.size(), nullptr);
+  }
+  return -1;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  using graph3d::bench::Distribution;
+  using graph3d::bench::summarize;
+
+  Options options;
+  if (!parse(argc, argv, options)) {
+    usage();
+    return 1;
+  }
+
+  ReplayApp app(options);
+  if (!app.start()) return 1;
+
+  const graph3d::ReplayStats& stats = app.stats();
+  if (stats.frames.empty()) {
+    std::cerr << "La grabacion no tiene frames completos\n";
+    return 1;
+  }
+
+  std::ofstream output(options.output, std::ios::out | std::ios::trunc);
+  if (!output.is_open()) {
+    std::cerr << "No se pudo abrir " << options.output << '\n';
+    return 1;
+  }
+
+  output << "{\"replay\":";
+  writeString(output, options.capture);
+  output << ",\"version\":1,\"renderer\":";
+  writeString(output, app.renderer());
+  output << "}\n" << std::setprecision(6);
+
+  // Sólo la última pasada entra en el resumen: las anteriores calientan caches y drivers
+  const uint32_t lastPass = stats.frames.back().pass;
+  std::vector<double> replayed, recorded;
+  for (const graph3d::ReplayFrame& frame : stats.frames) {
+    output << "{\"pass\":" << frame.pass << ",\"frame\":" << frame.frame << ",\"recordedMs\":"
+           << frame.recordedTime * 1000 << ",\"replayMs\":" << frame.time * 1000 << ",\"drawCalls\":" << frame.drawCalls
+           << ",\"triangles\":" << frame.triangles << "}\n";
+    if (frame.pass != lastPass) continue;
+    replayed.push_back(frame.time * 1000);
+    recorded.push_back(frame.recordedTime * 1000);
+  }
+
+  const Distribution replay = summarize(replayed), original = summarize(recorded);
+  output << "{\"summary\":true,\"frames\":" << replayed.size() << ",\"loadSeconds\":" << stats.loadSeconds
+         << ",\"replayMeanMs\":" << replay.mean << ",\"replayP50Ms\":" << replay.p50
+         << ",\"replayP95Ms\":" << replay.p95 << ",\"replayMaxMs\":" << replay.max
+         << ",\"recordedMeanMs\":" << original.mean << ",\"recordedP50Ms\":" << original.p50 << "}\n";
+  output.close();
+
+  std::printf("%zu frames, cargas %.3f s\n", replayed.size(), stats.loadSeconds);
+  std::printf("reproduccion  media %8.3f ms  p50 %8.3f ms  p95 %8.3f ms  max %8.3f ms\n", replay.mean, replay.p50,
+              replay.p95, replay.max);
+  std::printf("grabacion     media %8.3f ms  p50 %8.3f ms\n", original.mean, original.p50);
+
+  if (options.baseline.empty()) return 0;
+
+  bool regression = false, found = false;
+  for (const char* metric : {"replayP50Ms", "replayP95Ms"}) {
+    const double before = readSummary(options.baseline, metric);
+    if (before <= 0) continue;
+    found = true;
+
+    const double after = std::strcmp(metric, "replayP50Ms") ? replay.p95 : replay.p50;
+    if (after > before * (1 + options.threshold)) {
+      std::printf("REGRESION %s: %.4f -> %.4f (%+.1f%%)\n", metric, before, after, (after / before - 1) * 100);
+      regression = true;
+    }
+  }
+
+  if (!found) {
+    std::cerr << "No se pudo leer el baseline " << options.baseline << '\n';
+    return 1;
+  }
+  if (!regression) std::printf("Sin regresiones contra %s\n", options.baseline.c_str());
+  return regression ? 2 : 0;
+}
@@ -0,0 +1,52 @@
+#include <software/image.h>
+
+#include <cmath>
+
+namespace graph3d {
+namespace software {
+
+std::shared_ptr<const Image> Image::create(uint32_t width, uint32_t height, uint32_t channels, const uint8_t* data) {
+  std::shared_ptr<Image> image = std::make_shared<Image>();
+  image->g_width = width;
+  image->g_height = height;
+  image->g_pixels.resize(static_cast<size_t>(width) * height * 4);
+
+  uint8_t* out = image->g_pixels.data();
+  const size_t count = static_cast<size_t>(width) * height;
+  for (size_t i = 0; i < count; i++, out += 4, data += channels) {
+    out[0] = data[0];
+    out[1] = channels > 1 ? data[1] : 0;
+    out[2] = channels > 2 ? data[2] : 0;
+    out[3] = channels > 3 ? data[3] : 255;
+  }
+  return image;
+}
+
+glm::vec4 Image::sample(const glm::vec2& uv) const {
+  if (g_pixels.empty()) return glm::vec4(0, 0, 0, 1);
+
+  // Centros de texel en .5, como GL
+  const float x = uv.x * g_width - .5f, y = uv.y * g_height - .5f;
+  const float fx = std::floor(x), fy = std::floor(y);
+  const float tx = x - fx, ty = y - fy;
+
+  const int width = static_cast<int>(g_width), height = static_cast<int>(g_height);
+  int x0 = static_cast<int>(fx) % width, y0 = static_cast<int>(fy) % height;
+  if (x0 < 0) x0 += width;
+  if (y0 < 0) y0 += height;
+  const int x1 = x0 + 1 == width ? 0 : x0 + 1, y1 = y0 + 1 == height ? 0 : y0 + 1;
+
+  const uint8_t* row0 = g_pixels.data() + static_cast<size_t>(y0) * g_width * 4;
+  const uint8_t* row1 = g_pixels.data() + static_cast<size_t>(y1) * g_width * 4;
+  const uint8_t *a = row0 + x0 * 4, *b = row0 + x1 * 4, *c = row1 + x0 * 4, *d = row1 + x1 * 4;
+
+  glm::vec4 color;
+  for (int i = 0; i < 4; i++) {
+    const float top = a[i] + (b[i] - a[i]) * tx, bottom = c[i] + (d[i] - c[i]) * tx;
+    color[i] = (top + (bottom - top) * ty) * (1.f / 255.f);
+  }
+  return color;
+}
+
+}  // namespace software
+}  // namespace graph3d
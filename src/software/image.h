@@ -0,0 +1,37 @@
+#ifndef GRAPH3D_SOFTWARE_IMAGE_H_
+#define GRAPH3D_SOFTWARE_IMAGE_H_
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <glm/vec2.hpp>
+#include <glm/vec4.hpp>
+
+namespace graph3d {
+namespace software {
+
+// Copia en CPU de una textura, para que los kernels la puedan muestrear. Siempre RGBA8, fila 0 = v 0
+class Image {
+ private:
+  uint32_t g_width = 0, g_height = 0;
+  std::vector<uint8_t> g_pixels;
+
+ public:
+  /// Convierte 1, 2, 3 o 4 canales igual que glTexImage2D con GL_RED, GL_RG, GL_RGB y GL_RGBA
+  static std::shared_ptr<const Image> create(uint32_t width, uint32_t height, uint32_t channels,
+                                             const uint8_t* data);
+
+  uint32_t width() const { return g_width; }
+  uint32_t height() const { return g_height; }
+  const uint8_t* pixels() const { return g_pixels.data(); }
+  size_t getMemory() const { return g_pixels.size(); }
+
+  /// Filtro bilineal y GL_REPEAT en ambos ejes. Sin mipmaps: se muestrea siempre el nivel base
+  glm::vec4 sample(const glm::vec2& uv) const;
+};
+
+}  // namespace software
+}  // namespace graph3d
+
+#endif
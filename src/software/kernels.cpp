@@ -0,0 +1,103 @@
+#include <software/kernels.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include <glm/geometric.hpp>
+
+namespace graph3d {
+namespace software {
+
+Kernel findKernel(const std::string& shader) {
+  if (shader == "simple_model") return G3D_KERNEL_SIMPLE_MODEL;
+  if (shader == "simple_phong") return G3D_KERNEL_SIMPLE_PHONG;
+  if (shader == "bench") return G3D_KERNEL_POINT_LIGHTS;
+  return G3D_KERNEL_NONE;
+}
+
+bool usesVaryings(Kernel kernel) { return kernel == G3D_KERNEL_SIMPLE_PHONG || kernel == G3D_KERNEL_POINT_LIGHTS; }
+
+bool usesNormalMatrix(Kernel kernel) { return kernel == G3D_KERNEL_SIMPLE_PHONG; }
+
+// Nombres de los uniforms de las luces del bench, armados una sola vez
+static const std::string& lightUniform(uint32_t light, bool color) {
+  static std::string names[maxLights * 2];
+  std::string& name = names[light * 2 + color];
+  if (name.empty()) name = "lights[" + std::to_string(light) + (color ? "].color" : "].position");
+  return name;
+}
+
+static const Image* unit(const Image* const* units, uint32_t unitCount, int index) {
+  return index >= 0 && static_cast<uint32_t>(index) < unitCount ? units[index] : nullptr;
+}
+
+void resolve(Kernel kernel, const Uniforms& uniforms, const Image* const* units, uint32_t unitCount,
+             ShadeState& state) {
+  state.kernel = kernel;
+  switch (kernel) {
+    case G3D_KERNEL_SIMPLE_PHONG:
+      state.viewPos = uniforms.getVec3("viewPos");
+      state.shininess = uniforms.getFloat("material.shininess", state.shininess);
+      state.lightDirection = uniforms.getVec3("light.direction", state.lightDirection);
+      state.lightAmbient = uniforms.getVec3("light.ambient");
+      state.lightDiffuse = uniforms.getVec3("light.diffuse");
+      state.lightSpecular = uniforms.getVec3("light.specular");
+      // Los samplers que nadie asignó leen la unidad 0, como en GL
+      state.diffuseMap = unit(units, unitCount, uniforms.getInt("material.diffuse"));
+      state.specularMap = unit(units, unitCount, uniforms.getInt("material.specular"));
+      break;
+    case G3D_KERNEL_POINT_LIGHTS:
+      state.albedo = uniforms.getVec3("albedo");
+      state.lightCount = static_cast<uint32_t>(std::clamp(uniforms.getInt("lightCount"), 0, int(maxLights)));
+      for (uint32_t i = 0; i < state.lightCount; i++) {
+        state.lightPositions[i] = uniforms.getVec3(lightUniform(i, false).c_str());
+        state.lightColors[i] = uniforms.getVec3(lightUniform(i, true).c_str());
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+// Un sampler sin textura lee negro opaco, igual que una textura incompleta en GL
+static glm::vec3 sample(const Image* image, const glm::vec2& uv) {
+  return image ? glm::vec3(image->sample(uv)) : glm::vec3(0.f);
+}
+
+glm::vec4 shade(const ShadeState& state, const glm::vec3& position, const glm::vec3& normal, const glm::vec2& uv) {
+  switch (state.kernel) {
+    case G3D_KERNEL_SIMPLE_PHONG: {
+      const glm::vec3 albedo = sample(state.diffuseMap, uv);
+      const glm::vec3 ambient = state.lightAmbient * albedo;
+
+      const glm::vec3 norm = glm::normalize(normal);
+      const glm::vec3 lightDir = glm::normalize(-state.lightDirection);
+      const float diff = std::max(glm::dot(norm, lightDir), 0.f);
+      const glm::vec3 diffuse = state.lightDiffuse * diff * albedo;
+
+      const glm::vec3 viewDir = glm::normalize(state.viewPos - position);
+      const glm::vec3 reflectDir = glm::reflect(-lightDir, norm);
+      const float spec = std::pow(std::max(glm::dot(viewDir, reflectDir), 0.f), state.shininess);
+      const glm::vec3 specular = state.lightSpecular * spec * sample(state.specularMap, uv);
+
+      return glm::vec4(ambient + diffuse + specular, 1.f);
+    }
+    case G3D_KERNEL_POINT_LIGHTS: {
+      const glm::vec3 norm = glm::normalize(normal);
+      glm::vec3 result = .05f * state.albedo;
+      for (uint32_t i = 0; i < state.lightCount; i++) {
+        const glm::vec3 toLight = state.lightPositions[i] - position;
+        const float distance2 = glm::dot(toLight, toLight);
+        const float attenuation = 1.f / (1.f + distance2);
+        const float diff = std::max(glm::dot(norm, toLight * (1.f / std::sqrt(distance2))), 0.f);
+        result += state.albedo * state.lightColors[i] * diff * attenuation;
+      }
+      return glm::vec4(result, 1.f);
+    }
+    default:
+      return glm::vec4(1.f);
+  }
+}
+
+}  // namespace software
+}  // namespace graph3d
@@ -0,0 +1,66 @@
+#ifndef GRAPH3D_SOFTWARE_KERNELS_H_
+#define GRAPH3D_SOFTWARE_KERNELS_H_
+
+// Kernels de shading del rasterizador por software: el equivalente en C++ de los programas de resources/shaders.
+// Cada programa se asocia a un kernel por el nombre de su carpeta
+
+#include <cstdint>
+#include <string>
+
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+#include <software/image.h>
+#include <software/uniforms.h>
+
+namespace graph3d {
+namespace software {
+
+enum Kernel {
+  G3D_KERNEL_NONE,          // Programa sin kernel: se dibuja en blanco
+  G3D_KERNEL_SIMPLE_MODEL,  // simple_model: blanco
+  G3D_KERNEL_SIMPLE_PHONG,  // simple_phong: luz direccional, mapas difuso y especular
+  G3D_KERNEL_POINT_LIGHTS   // bench: albedo y hasta maxLights luces puntuales
+};
+
+static constexpr uint32_t maxLights = 32;
+
+/// G3D_KERNEL_NONE si el programa no tiene equivalente
+Kernel findKernel(const std::string& shader);
+
+// Todo lo que un kernel lee por fragmento, resuelto una vez por draw
+struct ShadeState {
+  Kernel kernel = G3D_KERNEL_NONE;
+
+  // simple_phong
+  glm::vec3 viewPos{0.f};
+  float shininess = 32.f;
+  glm::vec3 lightDirection{0.f, -1.f, 0.f};
+  glm::vec3 lightAmbient{0.f}, lightDiffuse{0.f}, lightSpecular{0.f};
+  const Image *diffuseMap = nullptr, *specularMap = nullptr;
+
+  // bench
+  glm::vec3 albedo{1.f};
+  uint32_t lightCount = 0;
+  glm::vec3 lightPositions[maxLights];
+  glm::vec3 lightColors[maxLights];
+};
+
+/// Si el kernel usa posición, normal y coordenadas de textura. Si no, el rasterizador no las interpola
+bool usesVaryings(Kernel kernel);
+
+/// Si la normal se transforma con la inversa transpuesta del modelo (true) o con el modelo (false)
+bool usesNormalMatrix(Kernel kernel);
+
+/// Lee los uniforms del kernel. `units` son las texturas de cada unidad, como las enlaza Mesh::Draw
+void resolve(Kernel kernel, const Uniforms& uniforms, const Image* const* units, uint32_t unitCount,
+             ShadeState& state);
+
+/// Color de un fragmento. `position` y `normal` en espacio de mundo; `normal` sin normalizar
+glm::vec4 shade(const ShadeState& state, const glm::vec3& position, const glm::vec3& normal, const glm::vec2& uv);
+
+}  // namespace software
+}  // namespace graph3d
+
+#endif
@@ -0,0 +1,413 @@
+#include <software/rasterizer.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <utility>
+
+#include <glm/geometric.hpp>
+#include <glm/matrix.hpp>
+
+#include <software/simd.h>
+#include <util/profiler.h>
+
+namespace graph3d {
+namespace software {
+
+// RGBA8 en el orden de Target::pixels. NaN termina en 0
+static uint32_t pack(const glm::vec4& color) {
+  uint32_t result = 0;
+  for (int i = 0; i < 4; i++) {
+    const float value = color[i] > 0.f ? (color[i] < 1.f ? color[i] : 1.f) : 0.f;
+    result |= static_cast<uint32_t>(value * 255.f + .5f) << (i * 8);
+  }
+  return result;
+}
+
+Rasterizer& Rasterizer::getInstance() {
+  static Rasterizer instance;
+  return instance;
+}
+
+void Rasterizer::setTarget(Target* target) {
+  flush();
+  g_target = target;
+}
+
+void Rasterizer::release(Target* target) {
+  if (g_target != target) return;
+  flush();
+  g_target = nullptr;
+}
+
+void Rasterizer::begin(int x, int y, int width, int height, bool depthTest, uint32_t clearMask,
+                       const glm::vec4& clearColor) {
+  flush();
+  if (!g_target) return;
+
+  // Recortado al target, igual que el scissor de GL
+  const int x1 = std::min<int>(x + width, g_target->width()), y1 = std::min<int>(y + height, g_target->height());
+  passX = std::max(x, 0);
+  passY = std::max(y, 0);
+  passWidth = x1 - passX;
+  passHeight = y1 - passY;
+  if (passWidth <= 0 || passHeight <= 0) return;
+
+  this->depthTest = depthTest;
+  this->clearMask = clearMask;
+  this->clearColor = pack(clearColor);
+
+  tileX0 = passX / tileSize;
+  tileY0 = passY / tileSize;
+  tilesX = (x1 - 1) / tileSize - tileX0 + 1;
+  tilesY = (y1 - 1) / tileSize - tileY0 + 1;
+  open = true;
+}
+
+void Rasterizer::draw(const VertexStream& vertices, const uint32_t* indices, uint32_t indexCount,
+                      const glm::mat4& model, const glm::mat4& viewProjection, const ShadeState& state) {
+  if (!open || indexCount < 3 || !vertices.count) return;
+
+  draw_command& command = draws.emplace_back();
+  command.vertices = vertices;
+  command.indices = indices;
+  command.indexCount = indexCount - indexCount % 3;
+  command.model = model;
+  command.viewProjection = viewProjection;
+  command.state = state;
+  command.varyings = usesVaryings(state.kernel);
+  command.color = command.varyings ? 0 : pack(shade(state, glm::vec3(0.f), glm::vec3(0.f), glm::vec2(0.f)));
+  if (command.varyings)
+    command.normalMatrix =
+        usesNormalMatrix(state.kernel) ? glm::transpose(glm::inverse(glm::mat3(model))) : glm::mat3(model);
+  command.firstVertex = 0;
+}
+
+void Rasterizer::flush() {
+  if (!open) return;
+  open = false;
+  G3D_PROFILE_SCOPE("Rasterizer::flush");
+
+  // 1. Vértices
+  size_t vertexCount = 0;
+  vertexJobs.clear();
+  for (uint32_t i = 0; i < draws.size(); i++) {
+    draw_command& command = draws[i];
+    command.firstVertex = vertexCount;
+    vertexCount += command.vertices.count;
+    for (uint32_t begin = 0; begin < command.vertices.count; begin += verticesPerJob)
+      vertexJobs.push_back({i, begin, std::min(begin + verticesPerJob, command.vertices.count)});
+  }
+  if (vertices.size() < vertexCount) vertices.resize(vertexCount);
+  {
+    G3D_PROFILE_SCOPE("Rasterizer::vertices");
+    jobs.parallelFor(static_cast<uint32_t>(vertexJobs.size()),
+                     [this](uint32_t i) { transformVertices(vertexJobs[i]); });
+  }
+
+  // 2. Setup y binning. Los bloques viejos se reusan, así sus vectores no vuelven a reservar memoria
+  const uint32_t tileCount = static_cast<uint32_t>(tilesX * tilesY);
+  size_t jobCount = 0;
+  for (uint32_t i = 0; i < draws.size(); i++) {
+    const uint32_t triangles = draws[i].indexCount / 3;
+    for (uint32_t begin = 0; begin < triangles; begin += trianglesPerJob) {
+      if (jobCount == triangleJobs.size()) triangleJobs.emplace_back();
+      triangleJobs[jobCount++].triangles = {i, begin, std::min(begin + trianglesPerJob, triangles)};
+      g_stats.triangles += std::min(begin + trianglesPerJob, triangles) - begin;
+    }
+  }
+  triangleJobs.resize(jobCount);
+  {
+    G3D_PROFILE_SCOPE("Rasterizer::setup");
+    jobs.parallelFor(static_cast<uint32_t>(jobCount), [this, tileCount](uint32_t i) {
+      job& work = triangleJobs[i];
+      work.output.clear();
+      work.bins.resize(tileCount);
+      for (std::vector<uint32_t>& bin : work.bins) bin.clear();
+      work.binned = 0;
+      setupTriangles(work);
+    });
+  }
+
+  // 3. Tiles
+  {
+    G3D_PROFILE_SCOPE("Rasterizer::tiles");
+    jobs.parallelFor(tileCount, [this](uint32_t tile) { drawTile(tile); });
+  }
+
+  g_stats.passes++;
+  g_stats.draws += draws.size();
+  g_stats.tiles += tileCount;
+  for (const job& work : triangleJobs) {
+    g_stats.rasterized += work.output.size();
+    g_stats.binned += work.binned;
+  }
+  draws.clear();
+}
+
+void Rasterizer::transformVertices(const range& work) {
+  const draw_command& command = draws[work.draw];
+  const VertexStream& stream = command.vertices;
+  const uint8_t* data = static_cast<const uint8_t*>(stream.data);
+  clip_vertex* out = vertices.data() + command.firstVertex;
+
+  for (uint32_t i = work.begin; i < work.end; i++) {
+    const uint8_t* vertex = data + static_cast<size_t>(i) * stream.stride;
+    glm::vec3 position;
+    std::memcpy(&position, vertex + stream.position, sizeof(position));
+
+    const glm::vec4 world = command.model * glm::vec4(position, 1.f);
+    clip_vertex& result = out[i];
+    result.position = command.viewProjection * world;
+    if (!command.varyings) continue;
+
+    glm::vec3 normal;
+    glm::vec2 uv;
+    std::memcpy(&normal, vertex + stream.normal, sizeof(normal));
+    std::memcpy(&uv, vertex + stream.texCoords, sizeof(uv));
+    normal = command.normalMatrix * normal;
+
+    const float varyings[8] = {world.x, world.y, world.z, normal.x, normal.y, normal.z, uv.x, uv.y};
+    std::memcpy(result.varyings, varyings, sizeof(varyings));
+  }
+}
+
+// Bits de los planos del frustum que deja afuera cada vértice
+enum : uint32_t {
+  CLIP_LEFT = 1,
+  CLIP_RIGHT = 2,
+  CLIP_BOTTOM = 4,
+  CLIP_TOP = 8,
+  CLIP_NEAR = 16,
+  CLIP_FAR = 32
+};
+
+static uint32_t outcode(const glm::vec4& position) {
+  uint32_t code = 0;
+  if (position.x < -position.w) code |= CLIP_LEFT;
+  if (position.x > position.w) code |= CLIP_RIGHT;
+  if (position.y < -position.w) code |= CLIP_BOTTOM;
+  if (position.y > position.w) code |= CLIP_TOP;
+  if (position.z < -position.w) code |= CLIP_NEAR;
+  if (position.z > position.w) code |= CLIP_FAR;
+  return code;
+}
+
+void Rasterizer::setupTriangles(job& work) {
+  const draw_command& command = draws[work.triangles.draw];
+  const clip_vertex* input = vertices.data() + command.firstVertex;
+  const uint32_t count = command.vertices.count;
+
+  for (uint32_t i = work.triangles.begin; i < work.triangles.end; i++) {
+    const uint32_t* index = command.indices + i * 3;
+    if (index[0] >= count || index[1] >= count || index[2] >= count) continue;
+
+    const clip_vertex* triangle[3] = {input + index[0], input + index[1], input + index[2]};
+    const uint32_t code0 = outcode(triangle[0]->position), code1 = outcode(triangle[1]->position),
+                   code2 = outcode(triangle[2]->position);
+    if (code0 & code1 & code2) continue;
+
+    // Sólo near y far se recortan: los otros planos los resuelve el bounding box contra la pasada
+    if ((code0 | code1 | code2) & (CLIP_NEAR | CLIP_FAR))
+      clipTriangle(work, triangle, work.triangles.draw, command.varyings);
+    else
+      setupTriangle(work, *triangle[0], *triangle[1], *triangle[2], work.triangles.draw, command.varyings);
+  }
+}
+
+// Distancia con signo al plano near (z = -w) o far (z = w); adentro es positiva
+static float planeDistance(const glm::vec4& position, bool nearPlane) {
+  return nearPlane ? position.z + position.w : position.w - position.z;
+}
+
+void Rasterizer::clipTriangle(job& work, const clip_vertex* input[3], uint32_t drawIndex, bool varyings) {
+  // Sutherland-Hodgman: un triángulo recortado por dos planos tiene a lo sumo 5 vértices
+  clip_vertex buffers[2][5];
+  uint32_t count = 3;
+  for (uint32_t i = 0; i < 3; i++) buffers[0][i] = *input[i];
+
+  clip_vertex* polygon = buffers[0];
+  clip_vertex* output = buffers[1];
+  for (bool nearPlane : {true, false}) {
+    uint32_t outputCount = 0;
+    for (uint32_t i = 0; i < count; i++) {
+      const clip_vertex &current = polygon[i], &next = polygon[(i + 1) % count];
+      const float d0 = planeDistance(current.position, nearPlane), d1 = planeDistance(next.position, nearPlane);
+      if (d0 >= 0) output[outputCount++] = current;
+      if ((d0 >= 0) != (d1 >= 0)) {
+        const float t = d0 / (d0 - d1);
+        clip_vertex& vertex = output[outputCount++];
+        vertex.position = current.position + (next.position - current.position) * t;
+        for (int k = 0; k < 8; k++)
+          vertex.varyings[k] = current.varyings[k] + (next.varyings[k] - current.varyings[k]) * t;
+      }
+    }
+    count = outputCount;
+    if (count < 3) return;
+    std::swap(polygon, output);
+  }
+
+  for (uint32_t i = 1; i + 1 < count; i++)
+    setupTriangle(work, polygon[0], polygon[i], polygon[i + 1], drawIndex, varyings);
+}
+
+void Rasterizer::setupTriangle(job& work, const clip_vertex& v0, const clip_vertex& v1, const clip_vertex& v2,
+                               uint32_t drawIndex, bool varyings) {
+  const clip_vertex* input[3] = {&v0, &v1, &v2};
+  float x[3], y[3], z[3], invW[3];
+  for (int i = 0; i < 3; i++) {
+    const glm::vec4& position = input[i]->position;
+    invW[i] = 1.f / position.w;
+    x[i] = (position.x * invW[i] * .5f + .5f) * passWidth + passX;
+    y[i] = (position.y * invW[i] * .5f + .5f) * passHeight + passY;
+    z[i] = position.z * invW[i] * .5f + .5f;
+  }
+
+  float area = (x[1] - x[0]) * (y[2] - y[0]) - (y[1] - y[0]) * (x[2] - x[0]);
+  if (!(std::abs(area) > 0.f)) return;
+
+  // Sin culling de caras, como el estado por defecto de GL: los triángulos horarios se dan vuelta
+  if (area < 0) {
+    std::swap(input[1], input[2]);
+    std::swap(x[1], x[2]);
+    std::swap(y[1], y[2]);
+    std::swap(z[1], z[2]);
+    std::swap(invW[1], invW[2]);
+    area = -area;
+  }
+
+  // Píxeles cuyo centro puede caer adentro, recortados a la pasada
+  const int minX = std::max(passX, static_cast<int>(std::ceil(std::min({x[0], x[1], x[2]}) - .5f)));
+  const int maxX = std::min(passX + passWidth - 1, static_cast<int>(std::floor(std::max({x[0], x[1], x[2]}) - .5f)));
+  const int minY = std::max(passY, static_cast<int>(std::ceil(std::min({y[0], y[1], y[2]}) - .5f)));
+  const int maxY = std::min(passY + passHeight - 1, static_cast<int>(std::floor(std::max({y[0], y[1], y[2]}) - .5f)));
+  if (minX > maxX || minY > maxY) return;
+
+  triangle& tri = work.output.emplace_back();
+  tri.originX = x[0];
+  tri.originY = y[0];
+
+  // Borde i: el opuesto al vértice i, de (i + 1) a (i + 2)
+  for (int i = 0; i < 3; i++) {
+    const int from = (i + 1) % 3, to = (i + 2) % 3;
+    tri.a[i] = y[from] - y[to];
+    tri.b[i] = x[to] - x[from];
+    tri.c[i] = -(tri.a[i] * (x[from] - x[0]) + tri.b[i] * (y[from] - y[0]));
+    const bool owner = tri.a[i] > 0 || (tri.a[i] == 0 && tri.b[i] > 0);
+    tri.threshold[i] = owner ? 0.f : std::numeric_limits<float>::denorm_min();
+  }
+
+  tri.invArea = 1.f / area;
+  tri.z0 = z[0];
+  tri.dz1 = (z[1] - z[0]) * tri.invArea;
+  tri.dz2 = (z[2] - z[0]) * tri.invArea;
+  tri.minX = minX;
+  tri.minY = minY;
+  tri.maxX = maxX;
+  tri.maxY = maxY;
+  tri.draw = drawIndex;
+
+  for (int i = 0; i < 3; i++) {
+    tri.invW[i] = invW[i];
+    if (varyings)
+      for (int k = 0; k < 8; k++) tri.varyings[i][k] = input[i]->varyings[k] * invW[i];
+  }
+
+  const uint32_t index = static_cast<uint32_t>(work.output.size() - 1);
+  const int firstX = minX / tileSize - tileX0, lastX = maxX / tileSize - tileX0;
+  const int firstY = minY / tileSize - tileY0, lastY = maxY / tileSize - tileY0;
+  for (int ty = firstY; ty <= lastY; ty++)
+    for (int tx = firstX; tx <= lastX; tx++) work.bins[ty * tilesX + tx].push_back(index);
+  work.binned += static_cast<uint64_t>(lastX - firstX + 1) * (lastY - firstY + 1);
+}
+
+void Rasterizer::drawTile(uint32_t tile) {
+  const int tx = static_cast<int>(tile) % tilesX + tileX0, ty = static_cast<int>(tile) / tilesX + tileY0;
+  const int x0 = std::max(passX, tx * tileSize), x1 = std::min(passX + passWidth, (tx + 1) * tileSize) - 1;
+  const int y0 = std::max(passY, ty * tileSize), y1 = std::min(passY + passHeight, (ty + 1) * tileSize) - 1;
+
+  const uint32_t stride = g_target->stride();
+  if (clearMask) {
+    for (int y = y0; y <= y1; y++) {
+      const size_t row = static_cast<size_t>(y) * stride;
+      if (clearMask & G3D_CLEAR_COLOR) std::fill_n(g_target->color() + row + x0, x1 - x0 + 1, clearColor);
+      if (clearMask & G3D_CLEAR_DEPTH) std::fill_n(g_target->depth() + row + x0, x1 - x0 + 1, 1.f);
+    }
+  }
+
+  for (const job& work : triangleJobs) {
+    for (uint32_t index : work.bins[tile]) {
+      const triangle& tri = work.output[index];
+      rasterize(tri, draws[tri.draw], std::max(x0, tri.minX), std::max(y0, tri.minY), std::min(x1, tri.maxX),
+                std::min(y1, tri.maxY));
+    }
+  }
+}
+
+void Rasterizer::rasterize(const triangle& tri, const draw_command& command, int x0, int y0, int x1, int y1) {
+  if (x0 > x1 || y0 > y1) return;
+
+  const uint32_t stride = g_target->stride();
+  const float4 lanes = float4::set(0.f, 1.f, 2.f, 3.f);
+  const float4 a0 = float4::set(tri.a[0]), a1 = float4::set(tri.a[1]), a2 = float4::set(tri.a[2]);
+  const float4 step0 = float4::set(tri.a[0] * 4), step1 = float4::set(tri.a[1] * 4), step2 = float4::set(tri.a[2] * 4);
+  const float4 t0 = float4::set(tri.threshold[0]), t1 = float4::set(tri.threshold[1]),
+               t2 = float4::set(tri.threshold[2]);
+  const float4 z0 = float4::set(tri.z0), dz1 = float4::set(tri.dz1), dz2 = float4::set(tri.dz2);
+
+  // Los bloques de 4 empiezan en múltiplos de 4, igual que los tiles (salvo en los bordes de la pasada, donde no
+  // hay otro tile), y las filas del target tienen un múltiplo de 4 píxeles: un bloque nunca lee píxeles de otro tile
+  const int start = x0 & ~3;
+  float e1Lanes[4], e2Lanes[4], zLanes[4];
+
+  for (int y = y0; y <= y1; y++) {
+    uint32_t* color = g_target->color() + static_cast<size_t>(y) * stride;
+    float* depth = g_target->depth() + static_cast<size_t>(y) * stride;
+
+    const float px = start + .5f - tri.originX, py = y + .5f - tri.originY;
+    float4 e0 = float4::set(tri.a[0] * px + tri.b[0] * py + tri.c[0]) + a0 * lanes;
+    float4 e1 = float4::set(tri.a[1] * px + tri.b[1] * py + tri.c[1]) + a1 * lanes;
+    float4 e2 = float4::set(tri.a[2] * px + tri.b[2] * py + tri.c[2]) + a2 * lanes;
+
+    for (int x = start; x <= x1; x += 4, e0 = e0 + step0, e1 = e1 + step1, e2 = e2 + step2) {
+      int mask = e0.greaterEqual(t0) & e1.greaterEqual(t1) & e2.greaterEqual(t2);
+      if (x < x0) mask &= (0xF << (x0 - x)) & 0xF;
+      if (x + 3 > x1) mask &= 0xF >> (x + 3 - x1);
+      if (!mask) continue;
+
+      const float4 z = z0 + e1 * dz1 + e2 * dz2;
+      if (depthTest) {
+        mask &= z.less(float4::load(depth + x));
+        if (!mask) continue;
+      }
+
+      z.store(zLanes);
+      if (command.varyings) {
+        e1.store(e1Lanes);
+        e2.store(e2Lanes);
+      }
+
+      for (int lane = 0; lane < 4; lane++) {
+        if (!(mask & (1 << lane))) continue;
+        if (depthTest) depth[x + lane] = zLanes[lane];
+        if (!command.varyings) {
+          color[x + lane] = command.color;
+          continue;
+        }
+
+        const float l1 = e1Lanes[lane] * tri.invArea, l2 = e2Lanes[lane] * tri.invArea, l0 = 1.f - l1 - l2;
+        const float w = 1.f / (l0 * tri.invW[0] + l1 * tri.invW[1] + l2 * tri.invW[2]);
+        float v[8];
+        for (int k = 0; k < 8; k++)
+          v[k] = (l0 * tri.varyings[0][k] + l1 * tri.varyings[1][k] + l2 * tri.varyings[2][k]) * w;
+
+        color[x + lane] = pack(shade(command.state, glm::vec3(v[0], v[1], v[2]), glm::vec3(v[3], v[4], v[5]),
+                                     glm::vec2(v[6], v[7])));
+      }
+    }
+  }
+}
+
+}  // namespace software
+}  // namespace graph3d
@@ -0,0 +1,181 @@
+#ifndef GRAPH3D_SOFTWARE_RASTERIZER_H_
+#define GRAPH3D_SOFTWARE_RASTERIZER_H_
+
+// Rasterizador por software, para máquinas sin GPU donde el camino genérico de Mesa es el cuello de botella.
+//
+// Los draws de una pasada (un viewport) se acumulan y se dibujan juntos en flush():
+//   1. vértices a clip space, en bloques repartidos entre los hilos
+//   2. clipping contra near/far, setup de las funciones de borde y binning en tiles de tileSize x tileSize,
+//      también en bloques; cada bloque guarda sus propios bins, así no hay locks y se conserva el orden
+//   3. cada hilo toma tiles enteros y los dibuja: depth test y funciones de borde de a 4 píxeles
+//      (software/simd.h), y el kernel de shading por fragmento. Un tile tiene un solo dueño, así que escribir
+//      el target no necesita locks
+//
+// Los triángulos de cada tile se dibujan en el orden en que se enviaron, así la imagen es determinista
+// y no depende de la cantidad de hilos.
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/mat3x3.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/vec4.hpp>
+
+#include <software/kernels.h>
+#include <software/target.h>
+#include <util/jobs.h>
+
+namespace graph3d {
+namespace software {
+
+// Vértices con cualquier layout: offsets en bytes de cada atributo dentro de un vértice de `stride` bytes
+// (opengl::Vertex, por ejemplo). La posición es un vec3, la normal un vec3 y las coordenadas de textura un vec2
+struct VertexStream {
+  const void* data = nullptr;
+  uint32_t count = 0, stride = 0;
+  uint32_t position = 0, normal = 0, texCoords = 0;
+};
+
+enum ClearFlags : uint32_t { G3D_CLEAR_COLOR = 1, G3D_CLEAR_DEPTH = 2 };
+
+// Acumulados desde el último resetStats()
+struct RasterStats {
+  uint64_t passes = 0;
+  uint64_t draws = 0;
+  uint64_t triangles = 0;   // Enviados
+  uint64_t rasterized = 0;  // Después de descartar y recortar
+  uint64_t binned = 0;      // Referencias triángulo-tile
+  uint64_t tiles = 0;
+};
+
+class Rasterizer {
+ public:
+  static constexpr int tileSize = 64;
+
+  /// Singleton. Reparte el trabajo en el sistema de jobs del motor (util/jobs.h)
+  static Rasterizer& getInstance();
+
+ private:
+  static constexpr uint32_t verticesPerJob = 4096;
+  static constexpr uint32_t trianglesPerJob = 2048;
+
+  // Vértice en clip space con sus varyings: posición de mundo, normal y coordenadas de textura
+  struct clip_vertex {
+    glm::vec4 position;
+    float varyings[8];
+  };
+
+  struct triangle {
+    // e_i = a * (x - originX) + b * (y - originY) + c, positiva adentro. Relativa al primer vértice para no
+    // perder precisión lejos del origen. Un píxel justo sobre un borde lo dibuja sólo uno de los dos
+    // triángulos que lo comparten (threshold 0 o el menor float positivo)
+    float originX, originY;
+    float a[3], b[3], c[3];
+    float threshold[3];
+
+    // Depth = z0 + e1 * dz1 + e2 * dz2
+    float z0, dz1, dz2;
+    float invArea;
+    float invW[3];
+
+    int minX, minY, maxX, maxY;
+    uint32_t draw;
+
+    // Divididos por w, para interpolar con corrección de perspectiva
+    float varyings[3][8];
+  };
+
+  struct draw_command {
+    VertexStream vertices;
+    const uint32_t* indices;
+    uint32_t indexCount;
+
+    glm::mat4 model, viewProjection;
+    glm::mat3 normalMatrix;
+    ShadeState state;
+    bool varyings;
+
+    // Kernels sin varyings: el color de todos los fragmentos, ya empaquetado
+    uint32_t color;
+
+    // Primer vértice en `vertices` del rasterizador
+    size_t firstVertex;
+  };
+
+  // Bloque de vértices o de triángulos de un draw
+  struct range {
+    uint32_t draw;
+    uint32_t begin, end;
+  };
+
+  struct job {
+    range triangles;
+    std::vector<triangle> output;
+    std::vector<std::vector<uint32_t>> bins;
+    uint64_t binned = 0;
+  };
+
+ private:
+  /// Pasada actual
+  Target* g_target = nullptr;
+  bool open = false;
+  int passX = 0, passY = 0, passWidth = 0, passHeight = 0;
+  bool depthTest = false;
+  uint32_t clearMask = 0;
+  uint32_t clearColor = 0;
+
+  std::vector<draw_command> draws;
+  std::vector<clip_vertex> vertices;
+  std::vector<range> vertexJobs;
+  std::vector<job> triangleJobs;
+  int tileX0 = 0, tileY0 = 0, tilesX = 0, tilesY = 0;
+
+  RasterStats g_stats;
+  util::JobSystem& jobs;
+
+ public:
+  Rasterizer& operator=(const Rasterizer&) = delete;
+  Rasterizer(const Rasterizer&) = delete;
+
+  /// El hilo que llama a flush() también trabaja
+  explicit Rasterizer(util::JobSystem& jobs = util::JobSystem::getInstance()) : jobs(jobs) {}
+
+  uint32_t threads() const { return jobs.threads(); }
+
+  /// Target de las próximas pasadas. Termina la pasada abierta en el target anterior
+  void setTarget(Target* target);
+  Target* target() const { return g_target; }
+
+  /// Olvida el target si es el actual (antes de destruirlo), terminando lo pendiente
+  void release(Target* target);
+
+  /// Abre una pasada sobre un rectángulo del target (x e y desde abajo a la izquierda), que también recorta.
+  /// El borrado se hace tile por tile en flush(), junto con los draws
+  void begin(int x, int y, int width, int height, bool depthTest, uint32_t clearMask = 0,
+             const glm::vec4& clearColor = glm::vec4(0.f));
+
+  /// Agrega un draw de triángulos indexados a la pasada abierta. Los vértices y los índices se leen recién
+  /// en flush(), así que tienen que seguir vivos hasta entonces
+  void draw(const VertexStream& vertices, const uint32_t* indices, uint32_t indexCount, const glm::mat4& model,
+            const glm::mat4& viewProjection, const ShadeState& state);
+
+  /// Dibuja la pasada abierta y la cierra. Vuelve cuando el target está escrito
+  void flush();
+
+  const RasterStats& stats() const { return g_stats; }
+  void resetStats() { g_stats = RasterStats(); }
+
+ private:
+  void transformVertices(const range& work);
+  void setupTriangles(job& work);
+  void clipTriangle(job& work, const clip_vertex* input[3], uint32_t drawIndex, bool varyings);
+  void setupTriangle(job& work, const clip_vertex& v0, const clip_vertex& v1, const clip_vertex& v2,
+                     uint32_t drawIndex, bool varyings);
+  void drawTile(uint32_t tile);
+  void rasterize(const triangle& tri, const draw_command& command, int x0, int y0, int x1, int y1);
+};
+
+}  // namespace software
+}  // namespace graph3d
+
+#endif
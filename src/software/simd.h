@@ -0,0 +1,94 @@
+#ifndef GRAPH3D_SOFTWARE_SIMD_H_
+#define GRAPH3D_SOFTWARE_SIMD_H_
+
+// Cuatro floats por operación: SSE2 en x86-64, NEON en ARM64 y un fallback escalar para el resto.
+// Alcanza para las funciones de borde y el depth test del rasterizador, que evalúan 4 píxeles de una fila juntos
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define G3D_SIMD_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define G3D_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+namespace graph3d {
+namespace software {
+
+struct float4 {
+#if defined(G3D_SIMD_SSE2)
+  __m128 v;
+
+  static float4 set(float value) { return {_mm_set1_ps(value)}; }
+  static float4 set(float a, float b, float c, float d) { return {_mm_setr_ps(a, b, c, d)}; }
+  static float4 load(const float* values) { return {_mm_loadu_ps(values)}; }
+  void store(float* values) const { _mm_storeu_ps(values, v); }
+
+  float4 operator+(const float4& other) const { return {_mm_add_ps(v, other.v)}; }
+  float4 operator-(const float4& other) const { return {_mm_sub_ps(v, other.v)}; }
+  float4 operator*(const float4& other) const { return {_mm_mul_ps(v, other.v)}; }
+
+  /// Bit i prendido si el carril i cumple la comparación
+  int greaterEqual(const float4& other) const { return _mm_movemask_ps(_mm_cmpge_ps(v, other.v)); }
+  int less(const float4& other) const { return _mm_movemask_ps(_mm_cmplt_ps(v, other.v)); }
+#elif defined(G3D_SIMD_NEON)
+  float32x4_t v;
+
+  static float4 set(float value) { return {vdupq_n_f32(value)}; }
+  static float4 set(float a, float b, float c, float d) {
+    const float values[4] = {a, b, c, d};
+    return {vld1q_f32(values)};
+  }
+  static float4 load(const float* values) { return {vld1q_f32(values)}; }
+  void store(float* values) const { vst1q_f32(values, v); }
+
+  float4 operator+(const float4& other) const { return {vaddq_f32(v, other.v)}; }
+  float4 operator-(const float4& other) const { return {vsubq_f32(v, other.v)}; }
+  float4 operator*(const float4& other) const { return {vmulq_f32(v, other.v)}; }
+
+  int greaterEqual(const float4& other) const { return movemask(vcgeq_f32(v, other.v)); }
+  int less(const float4& other) const { return movemask(vcltq_f32(v, other.v)); }
+
+ private:
+  static int movemask(uint32x4_t mask) {
+    static const int32_t shifts[4] = {0, 1, 2, 3};
+    const uint32x4_t bits = vshlq_u32(vshrq_n_u32(mask, 31), vld1q_s32(shifts));
+    return static_cast<int>(vaddvq_u32(bits));
+  }
+#else
+  float v[4];
+
+  static float4 set(float value) { return {{value, value, value, value}}; }
+  static float4 set(float a, float b, float c, float d) { return {{a, b, c, d}}; }
+  static float4 load(const float* values) { return {{values[0], values[1], values[2], values[3]}}; }
+  void store(float* values) const {
+    for (int i = 0; i < 4; i++) values[i] = v[i];
+  }
+
+  float4 operator+(const float4& other) const {
+    return {{v[0] + other.v[0], v[1] + other.v[1], v[2] + other.v[2], v[3] + other.v[3]}};
+  }
+  float4 operator-(const float4& other) const {
+    return {{v[0] - other.v[0], v[1] - other.v[1], v[2] - other.v[2], v[3] - other.v[3]}};
+  }
+  float4 operator*(const float4& other) const {
+    return {{v[0] * other.v[0], v[1] * other.v[1], v[2] * other.v[2], v[3] * other.v[3]}};
+  }
+
+  int greaterEqual(const float4& other) const {
+    int mask = 0;
+    for (int i = 0; i < 4; i++) mask |= (v[i] >= other.v[i]) << i;
+    return mask;
+  }
+  int less(const float4& other) const {
+    int mask = 0;
+    for (int i = 0; i < 4; i++) mask |= (v[i] < other.v[i]) << i;
+    return mask;
+  }
+#endif
+};
+
+}  // namespace software
+}  // namespace graph3d
+
+#endif
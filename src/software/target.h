@@ -0,0 +1,49 @@
+#ifndef GRAPH3D_SOFTWARE_TARGET_H_
+#define GRAPH3D_SOFTWARE_TARGET_H_
+
+#include <cstdint>
+#include <vector>
+
+namespace graph3d {
+namespace software {
+
+// Color RGBA8 y depth float de una ventana (o de cualquier imagen) dibujada por el rasterizador.
+// Filas de abajo hacia arriba, como el framebuffer de GL, así la imagen se sube sin darla vuelta.
+// Las filas tienen un múltiplo de 4 píxeles para que el rasterizador lea de a 4 sin salirse
+class Target {
+ private:
+  uint32_t g_width = 0, g_height = 0, g_stride = 0;
+  std::vector<uint32_t> g_color;
+  std::vector<float> g_depth;
+
+ public:
+  Target& operator=(const Target&) = delete;
+  Target(const Target&) = delete;
+
+  Target(uint32_t width, uint32_t height) { resize(width, height); }
+
+  void resize(uint32_t width, uint32_t height) {
+    g_width = width;
+    g_height = height;
+    g_stride = (width + 3) & ~3u;
+    g_color.assign(static_cast<size_t>(g_stride) * height, 0);
+    g_depth.assign(static_cast<size_t>(g_stride) * height, 1.f);
+  }
+
+  uint32_t width() const { return g_width; }
+  uint32_t height() const { return g_height; }
+
+  /// Píxeles por fila
+  uint32_t stride() const { return g_stride; }
+
+  uint32_t* color() { return g_color.data(); }
+  float* depth() { return g_depth.data(); }
+
+  /// R, G, B y A de cada píxel, en ese orden
+  const uint8_t* pixels() const { return reinterpret_cast<const uint8_t*>(g_color.data()); }
+};
+
+}  // namespace software
+}  // namespace graph3d
+
+#endif
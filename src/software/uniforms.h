@@ -0,0 +1,82 @@
+#ifndef GRAPH3D_SOFTWARE_UNIFORMS_H_
+#define GRAPH3D_SOFTWARE_UNIFORMS_H_
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <string>
+
+#include <glm/vec3.hpp>
+
+#include <util/recording.h>
+
+namespace graph3d {
+namespace software {
+
+// Últimos valores de los uniforms de un programa, para que los kernels los lean al rasterizar.
+// Se guardan crudos, con su tipo, igual que en una grabación (util/recording.h)
+class Uniforms {
+ private:
+  struct value {
+    util::UniformType type;
+    uint32_t data[16];
+  };
+
+  // std::less<> permite buscar con un const char* sin armar un std::string
+  std::map<std::string, value, std::less<>> values;
+
+ public:
+  void set(const char* name, util::UniformType type, const void* data) {
+    auto it = values.find(name);
+    if (it == values.end()) it = values.emplace(name, value()).first;
+    it->second.type = type;
+    std::memcpy(it->second.data, data, util::getUniformComponents(type) * sizeof(uint32_t));
+  }
+
+  float getFloat(const char* name, float fallback = 0) const {
+    auto it = values.find(name);
+    if (it == values.end()) return fallback;
+    return component(it->second, 0);
+  }
+
+  int getInt(const char* name, int fallback = 0) const {
+    auto it = values.find(name);
+    if (it == values.end()) return fallback;
+    if (it->second.type == util::G3D_UNIFORM_INT) return static_cast<int32_t>(it->second.data[0]);
+    if (it->second.type == util::G3D_UNIFORM_UINT) return static_cast<int>(it->second.data[0]);
+    return static_cast<int>(component(it->second, 0));
+  }
+
+  glm::vec3 getVec3(const char* name, const glm::vec3& fallback = glm::vec3(0)) const {
+    auto it = values.find(name);
+    if (it == values.end() || util::getUniformComponents(it->second.type) < 3) return fallback;
+    return glm::vec3(component(it->second, 0), component(it->second, 1), component(it->second, 2));
+  }
+
+ private:
+  static float component(const value& entry, uint32_t index) {
+    switch (entry.type) {
+      case util::G3D_UNIFORM_INT:
+      case util::G3D_UNIFORM_IVEC2:
+      case util::G3D_UNIFORM_IVEC3:
+      case util::G3D_UNIFORM_IVEC4:
+        return static_cast<float>(static_cast<int32_t>(entry.data[index]));
+      case util::G3D_UNIFORM_UINT:
+      case util::G3D_UNIFORM_UVEC2:
+      case util::G3D_UNIFORM_UVEC3:
+      case util::G3D_UNIFORM_UVEC4:
+        return static_cast<float>(entry.data[index]);
+      default: {
+        float result;
+        std::memcpy(&result, entry.data + index, sizeof(float));
+        return result;
+      }
+    }
+  }
+};
+
+}  // namespace software
+}  // namespace graph3d
+
+#endif
@@ -0,0 +1,97 @@
+// Presupuesto de reservas de memoria por frame (util/allocations.h). Este es el único archivo de los tests que
+// incluye graph3d.h (util/resources.h define funciones no inline)
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <graph3d.h>
+#include <opengl/headless.h>
+#include <opengl/primitives.h>
+#include <tests/harness.h>
+#include <util/allocations.h>
+
+using namespace graph3d;
+
+namespace {
+
+// Una grilla de esferas y cubos con una luz, en una ventana headless. Nada del dibujo reserva memoria: lo que
+// se cuente por frame es del motor
+class SteadyScene : public ::Graph3D, public opengl::drawer {
+  uint32_t frames;
+  std::vector<entity::Object*> objects;
+
+ public:
+  explicit SteadyScene(uint32_t frames) : ::Graph3D(128, 128, "graph3d_tests"), frames(frames) {}
+
+ protected:
+  void setup() override {
+    headless = true;
+    frameLimit = frames;
+  }
+
+  void configure() override {
+    addShaderFolder("resources/shaders");
+    getContext().viewport.operator->().attachDrawer(this);
+  }
+
+  void preinitialize() override {
+    loadShader("bench");
+    addModel("sphere", new opengl::Model({opengl::createSphere(.5f, 12, 24)}));
+    addModel("cube", new opengl::Model({opengl::createCube(.8f)}));
+  }
+
+  void initialize() override {
+    for (uint32_t i = 0; i < 64; i++) {
+      entity::Object* object = createObject("object_" + std::to_string(i));
+      object->setModel(i % 2 ? "cube" : "sphere");
+      object->position = glm::vec3(static_cast<float>(i % 8) - 4.f, 0.f, -3.f - static_cast<float>(i / 8));
+      objects.push_back(object);
+    }
+  }
+
+ public:
+  void draw(const Context& context) override {
+    useShader("bench");
+    opengl::Shader* shader = context.shader;
+    shader->set("lightCount", 1);
+    shader->set("lights[0].position", glm::vec3(0.f, 4.f, -4.f));
+    shader->set("lights[0].color", glm::vec3(1.f));
+    shader->set("albedo", glm::vec3(.8f));
+    for (entity::Object* object : objects) drawObject(object);
+  }
+};
+
+void requireHeadless() {
+  try {
+    opengl::HeadlessDevice::getInstance().create();
+    opengl::HeadlessDevice::getInstance().destroy();
+  } catch (const exceptions::exception& error) {
+    G3D_SKIP("sin contexto headless: " + error.getDescription());
+  }
+}
+
+}  // namespace
+
+// Los frames estables (después del warmup: cargas, compilación de shaders, primeras reservas de los vectores del
+// frame) no reservan memoria más allá del presupuesto
+G3D_TEST(allocationsSteadyFrames, "allocations/steady_frames") {
+#ifndef G3D_ALLOC_TRACKING
+  G3D_SKIP("el motor se compiló sin GRAPH3D_ALLOC_TRACKING");
+#else
+  requireHeadless();
+  static constexpr uint64_t maxAllocations = 0;
+  static constexpr uint32_t warmup = 10, frames = 60;
+
+  util::allocations::setFrameBudget(maxAllocations, 0, warmup);
+  const bool started = SteadyScene(warmup + frames).start();
+  util::allocations::clearFrameBudget();
+  G3D_CHECK(started);
+
+  const util::allocations::counters worst = util::allocations::worstOverrun();
+  if (util::allocations::budgetOverruns())
+    G3D_FAIL(std::to_string(util::allocations::budgetOverruns()) + " frames fuera de presupuesto. " +
+             exceptions::format(exceptions::ERR011, (unsigned long long)worst.count, (unsigned long long)worst.bytes) +
+             ". " + exceptions::format(exceptions::ERR011_2, (unsigned long long)maxAllocations, 0ull));
+#endif
+}
@@ -0,0 +1,138 @@
+// Paquetes de recursos (util/asset_pack.h): lo que se escribe se vuelve a leer igual, y un paquete truncado o
+// dañado no se abre o no devuelve la entrada
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <tests/harness.h>
+#include <util/asset_pack.h>
+#include <util/mapped_file.h>
+
+using namespace graph3d;
+
+namespace {
+
+const std::string packPath = (std::filesystem::temp_directory_path() / "graph3d_tests.g3dpack").string();
+
+std::vector<uint8_t> bytes(const std::string& text) { return std::vector<uint8_t>(text.begin(), text.end()); }
+
+std::string repeated() {
+  std::string text;
+  for (int i = 0; i < 500; i++) text += "#define LIGHTS 4\nuniform vec3 color;\n";
+  return text;
+}
+
+// Un archivo guardado tal cual, uno comprimido y uno vacío
+void writePack() {
+  util::AssetPackWriter writer;
+  writer.add("shaders/plain/plain.vshader", bytes("void main() {}\n"), true);
+  writer.add("shaders/lib/common.glsl", bytes(repeated()), true);
+  writer.add("models/empty.obj", {}, true);
+  G3D_CHECK(writer.write(packPath));
+}
+
+std::vector<uint8_t> readFile(const std::string& path) {
+  std::ifstream in(path, std::ios::binary);
+  return std::vector<uint8_t>((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+}
+
+void writeFile(const std::string& path, const std::vector<uint8_t>& data) {
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  out.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+}
+
+std::string contents(const std::shared_ptr<util::MappedFile>& file) {
+  return file ? std::string(reinterpret_cast<const char*>(file->data()), file->size()) : std::string();
+}
+
+// Posición en el archivo de la entrada `name`
+size_t entryOffset(const std::vector<uint8_t>& file, const std::string& name) {
+  util::PackHeader header;
+  std::memcpy(&header, file.data(), sizeof(header));
+  for (uint32_t i = 0; i < header.entryCount; i++) {
+    util::PackEntry entry;
+    const size_t at = header.indexOffset + i * sizeof(util::PackEntry);
+    std::memcpy(&entry, file.data() + at, sizeof(entry));
+    const char* names = reinterpret_cast<const char*>(file.data() + header.namesOffset);
+    if (std::string(names + entry.nameOffset, entry.nameSize) == name) return at;
+  }
+  G3D_FAIL("no esta la entrada " + name);
+}
+
+}  // namespace
+
+G3D_TEST(assetPackRoundTrip, "asset_pack/round_trip") {
+  writePack();
+  std::shared_ptr<util::AssetPack> pack = util::AssetPack::open(packPath);
+  G3D_CHECK(pack && pack->size() == 3);
+  G3D_CHECK(pack->entry("shaders/lib/common.glsl")->codec == util::G3D_PACK_LZ4);
+  G3D_CHECK(pack->entry("shaders/plain/plain.vshader")->codec == util::G3D_PACK_STORED);
+
+  G3D_CHECK(contents(pack->read("shaders/plain/plain.vshader")) == "void main() {}\n");
+  G3D_CHECK(contents(pack->read("shaders/lib/common.glsl")) == repeated());
+  G3D_CHECK(pack->contains("models/empty.obj") && !pack->read("models/empty.obj"));
+  G3D_CHECK(!pack->contains("shaders/missing.glsl") && !pack->read("shaders/missing.glsl"));
+
+  G3D_CHECK(pack->hasFolder("shaders/plain") && !pack->hasFolder("textures"));
+  const std::vector<std::string> shaders = pack->list("shaders/lib");
+  G3D_CHECK(shaders.size() == 1 && shaders[0] == "shaders/lib/common.glsl");
+
+  std::error_code error;
+  std::filesystem::remove(packPath, error);
+}
+
+G3D_TEST(assetPackCorrupt, "asset_pack/corrupt") {
+  writePack();
+  const std::vector<uint8_t> file = readFile(packPath);
+  const std::string damagedPath = packPath + ".damaged";
+
+  // Truncado en cualquier punto: el índice y los nombres van al final
+  for (size_t size = 0; size < file.size(); size += 1 + size / 4) {
+    writeFile(damagedPath, std::vector<uint8_t>(file.begin(), file.begin() + size));
+    G3D_CHECK(!util::AssetPack::open(damagedPath));
+  }
+
+  std::vector<uint8_t> damaged = file;
+  damaged[0] = 'X';
+  writeFile(damagedPath, damaged);
+  G3D_CHECK(!util::AssetPack::open(damagedPath));
+
+  // Una entrada comprimida que dice medir más de lo que pueden dar sus bytes no llega a reservar memoria
+  const size_t lz4 = entryOffset(file, "shaders/lib/common.glsl");
+  damaged = file;
+  const uint64_t huge = uint64_t(1) << 60;
+  std::memcpy(&damaged[lz4 + offsetof(util::PackEntry, size)], &huge, sizeof(huge));
+  writeFile(damagedPath, damaged);
+  G3D_CHECK(!util::AssetPack::open(damagedPath));
+
+  // Una entrada guardada tal cual que se sale del archivo
+  const size_t stored = entryOffset(file, "shaders/plain/plain.vshader");
+  damaged = file;
+  const uint64_t offset = file.size();
+  std::memcpy(&damaged[stored + offsetof(util::PackEntry, offset)], &offset, sizeof(offset));
+  writeFile(damagedPath, damaged);
+  G3D_CHECK(!util::AssetPack::open(damagedPath));
+
+  // Con los datos comprimidos dañados, read() falla o devuelve el tamaño de la entrada
+  util::PackEntry entry;
+  std::memcpy(&entry, &file[lz4], sizeof(entry));
+  damaged = file;
+  for (uint64_t i = 0; i < entry.storedSize; i += 3) damaged[entry.offset + i] ^= 0x5A;
+  writeFile(damagedPath, damaged);
+  std::shared_ptr<util::AssetPack> pack = util::AssetPack::open(damagedPath);
+  G3D_CHECK(pack);
+  std::shared_ptr<util::MappedFile> read = pack->read("shaders/lib/common.glsl");
+  G3D_CHECK(!read || read->size() == entry.size);
+  pack.reset();
+
+  std::error_code error;
+  std::filesystem::remove(packPath, error);
+  std::filesystem::remove(damagedPath, error);
+}
@@ -0,0 +1,71 @@
+#ifndef GRAPH3D_TESTS_HARNESS_H_
+#define GRAPH3D_TESTS_HARNESS_H_
+
+#include <string>
+#include <vector>
+
+namespace graph3d {
+namespace tests {
+
+typedef void (*test_func_t)();
+
+struct Test {
+  const char* name;
+  test_func_t func;
+};
+
+std::vector<Test>& getTests();
+
+struct Registration {
+  Registration(const char* name, test_func_t func) { getTests().push_back({name, func}); }
+};
+
+// G3D_CHECK la lanza al fallar y el runner la atrapa: el resto del test no corre
+struct Failure {
+  std::string message;
+};
+
+// El test no se puede correr en esta configuración (sin EGL, sin G3D_ALLOC_TRACKING...): no cuenta como falla
+struct Skip {
+  std::string reason;
+};
+
+std::string describe(const char* file, int line, const std::string& message);
+
+}  // namespace tests
+}  // namespace graph3d
+
+#define G3D_TEST_CONCAT_IMPL(a, b) a##b
+#define G3D_TEST_CONCAT(a, b) G3D_TEST_CONCAT_IMPL(a, b)
+
+// G3D_TEST(lz4RoundTrip, "lz4/round_trip") { G3D_CHECK(decompress(compress(data)) == data); }
+#define G3D_TEST(func, name)                                                                  \
+  static void func();                                                                        \
+  static ::graph3d::tests::Registration G3D_TEST_CONCAT(g3d_test_, func)(name, &func);        \
+  static void func()
+
+#define G3D_CHECK(condition)                                                                              \
+  do {                                                                                                    \
+    if (!(condition))                                                                                     \
+      throw ::graph3d::tests::Failure{::graph3d::tests::describe(__FILE__, __LINE__, #condition)};        \
+  } while (0)
+
+#define G3D_FAIL(message) throw ::graph3d::tests::Failure{::graph3d::tests::describe(__FILE__, __LINE__, message)}
+
+#define G3D_SKIP(reason) throw ::graph3d::tests::Skip{reason}
+
+// `statement` tiene que lanzar exceptions::exception con ese código
+#define G3D_CHECK_THROWS(statement, expected)                                                             \
+  do {                                                                                                    \
+    bool g3dThrown = false;                                                                               \
+    try {                                                                                                 \
+      statement;                                                                                          \
+    } catch (const ::graph3d::exceptions::exception& error) {                                             \
+      g3dThrown = std::string(error.code()) == (expected);                                                \
+    }                                                                                                     \
+    if (!g3dThrown)                                                                                       \
+      throw ::graph3d::tests::Failure{                                                                    \
+          ::graph3d::tests::describe(__FILE__, __LINE__, #statement " sin " expected)};                    \
+  } while (0)
+
+#endif
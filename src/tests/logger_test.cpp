@@ -0,0 +1,80 @@
+// Logger asíncrono (util/logger.h): las líneas de varios hilos llegan enteras a std::clog, aunque ocupen varios
+// slots de la cola
+
+#include <cstddef>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <tests/harness.h>
+#include <util/logger.h>
+
+using namespace graph3d;
+
+namespace {
+
+const int threadCount = 8;
+const int linesPerThread = 400;
+
+// "<hilo> <línea> " y después un relleno de una sola letra, de largo distinto en cada línea: de 1 a 4 slots
+std::string makeLine(int thread, int line) {
+  std::string text = std::to_string(thread) + " " + std::to_string(line) + " ";
+  return text + std::string(100 + (thread * 131 + line * 37) % 800, static_cast<char>('a' + thread));
+}
+
+// Redirige std::clog mientras vive; el hilo escritor es el único que escribe en él
+class CaptureLog {
+  std::ostringstream captured;
+  std::streambuf* previous;
+
+ public:
+  CaptureLog() {
+    util::logger::flush();
+    previous = std::clog.rdbuf(captured.rdbuf());
+  }
+  ~CaptureLog() {
+    util::logger::flush();
+    std::clog.rdbuf(previous);
+  }
+
+  std::string text() {
+    util::logger::flush();
+    return captured.str();
+  }
+};
+
+}  // namespace
+
+G3D_TEST(loggerLongLines, "logger/long_lines") {
+  std::string output;
+  {
+    CaptureLog capture;
+    std::vector<std::thread> threads;
+    for (int thread = 0; thread < threadCount; thread++)
+      threads.emplace_back([thread]() {
+        for (int line = 0; line < linesPerThread; line++) {
+          const std::string text = makeLine(thread, line);
+          util::logger::write(text.data(), text.size());
+        }
+      });
+    for (std::thread& thread : threads) thread.join();
+    output = capture.text();
+  }
+
+  // Cada hilo tiene que aparecer con todas sus líneas, en orden y sin pedazos de otras
+  std::vector<int> next(threadCount, 0);
+  std::istringstream lines(output);
+  std::string line;
+  while (std::getline(lines, line)) {
+    std::istringstream fields(line);
+    int thread = -1, index = -1;
+    fields >> thread >> index;
+    if (thread < 0 || thread >= threadCount) G3D_FAIL("linea sin hilo: " + line.substr(0, 40));
+    if (index != next[thread]) G3D_FAIL("linea fuera de orden: " + line.substr(0, 40));
+    if (line != makeLine(thread, index)) G3D_FAIL("linea mezclada: " + line.substr(0, 40));
+    next[thread]++;
+  }
+  for (int thread = 0; thread < threadCount; thread++) G3D_CHECK(next[thread] == linesPerThread);
+}
@@ -0,0 +1,97 @@
+// Compresión LZ4 (util/lz4.h): lo comprimido vuelve igual, y un bloque dañado o truncado se rechaza sin escribir
+// fuera del buffer de salida
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <tests/harness.h>
+#include <util/lz4.h>
+
+using namespace graph3d;
+
+namespace {
+
+std::vector<uint8_t> compress(const std::vector<uint8_t>& data) {
+  std::vector<uint8_t> out(util::lz4Bound(data.size()));
+  const size_t size = util::lz4Compress(data.data(), data.size(), out.data(), out.size());
+  G3D_CHECK(size > 0 && size <= out.size());
+  out.resize(size);
+  return out;
+}
+
+bool decompress(const std::vector<uint8_t>& block, size_t size, std::vector<uint8_t>& out) {
+  out.assign(size, 0);
+  return util::lz4Decompress(block.data(), block.size(), out.data(), out.size());
+}
+
+// Texto con repeticiones cortas y largas, y bytes que no comprimen
+std::vector<std::vector<uint8_t>> samples() {
+  std::vector<std::vector<uint8_t>> result;
+  result.emplace_back();
+  result.push_back({'a', 'b', 'c'});
+  result.emplace_back(100000, 0);
+
+  std::string text;
+  for (int i = 0; i < 2000; i++) text += "vertex " + std::to_string(i % 37) + " 0.5 1.0\n";
+  result.emplace_back(text.begin(), text.end());
+
+  std::vector<uint8_t> noise(70000);
+  uint32_t state = 12345;
+  for (uint8_t& byte : noise) {
+    state = state * 1664525u + 1013904223u;
+    byte = static_cast<uint8_t>(state >> 24);
+  }
+  result.push_back(noise);
+  return result;
+}
+
+}  // namespace
+
+G3D_TEST(lz4RoundTrip, "lz4/round_trip") {
+  for (const std::vector<uint8_t>& data : samples()) {
+    const std::vector<uint8_t> block = compress(data);
+    std::vector<uint8_t> out;
+    G3D_CHECK(decompress(block, data.size(), out));
+    G3D_CHECK(out == data);
+    G3D_CHECK(data.size() <= util::lz4MaxDecompressed(block.size()));
+  }
+
+  // Sin lugar para el peor caso, no escribe nada
+  const std::vector<uint8_t> noise = samples().back();
+  std::vector<uint8_t> small(noise.size() / 2);
+  G3D_CHECK(util::lz4Compress(noise.data(), noise.size(), small.data(), small.size()) == 0);
+}
+
+G3D_TEST(lz4Corrupt, "lz4/corrupt") {
+  const std::vector<uint8_t> data = samples()[3];
+  const std::vector<uint8_t> block = compress(data);
+  std::vector<uint8_t> out;
+
+  // Tamaño esperado distinto
+  G3D_CHECK(!decompress(block, data.size() - 1, out));
+  G3D_CHECK(!decompress(block, data.size() + 1, out));
+
+  // Truncado en cualquier punto
+  for (size_t size = 0; size < block.size(); size += 1 + size / 8) {
+    const std::vector<uint8_t> truncated(block.begin(), block.begin() + size);
+    G3D_CHECK(!decompress(truncated, data.size(), out));
+  }
+
+  // Una repetición que apunta antes del principio
+  const std::vector<uint8_t> before = {0x10, 'a', 0x05, 0x00, 0x00};
+  G3D_CHECK(!decompress(before, 5, out));
+  const std::vector<uint8_t> zero = {0x10, 'a', 0x00, 0x00, 0x00};
+  G3D_CHECK(!decompress(zero, 5, out));
+
+  // Un largo extendido que no termina
+  const std::vector<uint8_t> length = {0xF0, 0xFF, 0xFF};
+  G3D_CHECK(!decompress(length, 600, out));
+
+  // Bytes cambiados: si se acepta, tiene que ser con el tamaño exacto
+  for (size_t i = 0; i < block.size(); i += 7) {
+    std::vector<uint8_t> damaged = block;
+    damaged[i] ^= 0xA5;
+    if (decompress(damaged, data.size(), out)) G3D_CHECK(out.size() == data.size());
+  }
+}
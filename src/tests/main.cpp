@@ -0,0 +1,86 @@
+// graph3d_tests: tests del motor. Los que necesitan GL usan el backend headless y se saltean si no hay EGL.
+//
+//   graph3d_tests                 (todos)
+//   graph3d_tests --filter lz4/   (los que contienen el texto)
+//   graph3d_tests --list
+//
+// Sale con 1 si falla alguno. Se corre desde la raíz del repositorio (ctest ya lo hace): usa resources/.
+
+#include <cstdio>
+#include <exception>
+#include <iostream>
+#include <string>
+
+#include <exceptions/exception.h>
+#include <tests/harness.h>
+#include <util/logger.h>
+
+namespace graph3d {
+namespace tests {
+
+std::vector<Test>& getTests() {
+  static std::vector<Test> tests;
+  return tests;
+}
+
+std::string describe(const char* file, int line, const std::string& message) {
+  return std::string(file) + ':' + std::to_string(line) + ": " + message;
+}
+
+}  // namespace tests
+}  // namespace graph3d
+
+using namespace graph3d::tests;
+
+int main(int argc, char** argv) {
+  std::string filter;
+  bool list = false;
+  for (int i = 1; i < argc; i++) {
+    const std::string arg = argv[i];
+    if (arg == "--list")
+      list = true;
+    else if (arg == "--filter" && i + 1 < argc)
+      filter = argv[++i];
+    else {
+      std::cerr << "Uso: graph3d_tests [--list] [--filter TEXTO]\n";
+      return 1;
+    }
+  }
+
+  if (list) {
+    for (const Test& test : getTests()) std::printf("%s\n", test.name);
+    return 0;
+  }
+
+  int passed = 0, failed = 0, skipped = 0;
+  for (const Test& test : getTests()) {
+    if (!filter.empty() && std::string(test.name).find(filter) == std::string::npos) continue;
+
+    std::string error;
+    try {
+      test.func();
+    } catch (const Failure& failure) {
+      error = failure.message;
+    } catch (const Skip& skip) {
+      std::printf("SALTEADO %s: %s\n", test.name, skip.reason.c_str());
+      skipped++;
+      continue;
+    } catch (const graph3d::exceptions::exception& exception) {
+      error = std::string("excepcion ") + exception.code() + ": " + exception.getDescription();
+    } catch (const std::exception& exception) {
+      error = std::string("excepcion: ") + exception.what();
+    }
+    graph3d::util::logger::flush();
+
+    if (error.empty()) {
+      std::printf("OK       %s\n", test.name);
+      passed++;
+    } else {
+      std::printf("FALLA    %s\n         %s\n", test.name, error.c_str());
+      failed++;
+    }
+  }
+
+  std::printf("%d bien, %d fallas, %d salteados\n", passed, failed, skipped);
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,98 @@
+// Grabaciones de comandos (util/recording.h): lo grabado se vuelve a leer igual, y una cantidad dañada se
+// rechaza con ERR014 antes de reservar memoria por ella
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <exceptions/exception.h>
+#include <tests/harness.h>
+#include <util/recording.h>
+
+using namespace graph3d;
+
+namespace {
+
+const std::string recordingPath = (std::filesystem::temp_directory_path() / "graph3d_tests.g3dr").string();
+
+const float vertices[6] = {0, 1, 2, 3, 4, 5};
+const uint32_t indices[3] = {0, 1, 0};
+
+// Posiciones de las cantidades en el archivo: "G3DR", versión, y el comando de MODEL_DATA con alias "quad"
+const size_t modelNameSize = 9, meshCount = 17, vertexCount = 25, indexCount = 25 + 4 + sizeof(vertices);
+const size_t useShader = indexCount + 4 + sizeof(indices), shaderNameSize = useShader + 1;
+const size_t keywordCount = shaderNameSize + 4 + 5, keywordSize = keywordCount + 4;
+
+void writeRecording() {
+  G3D_CHECK(util::Recorder::start(recordingPath));
+  util::Recorder& recorder = *util::Recorder::active();
+  recorder.modelData("quad", {{vertices, 3, sizeof(float) * 2, indices, 3}});
+  recorder.useShader("plain", {"RED", "BLUE"});
+  util::Recorder::stop();
+}
+
+std::vector<uint8_t> readFile(const std::string& path) {
+  std::ifstream in(path, std::ios::binary);
+  return std::vector<uint8_t>((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+}
+
+void writeFile(const std::string& path, const std::vector<uint8_t>& data) {
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  out.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+}
+
+void readAll(const std::string& path) {
+  util::CommandReader reader(path);
+  util::Command command;
+  while (reader.next(command)) {
+  }
+}
+
+}  // namespace
+
+G3D_TEST(recordingRoundTrip, "recording/round_trip") {
+  writeRecording();
+  util::CommandReader reader(recordingPath);
+  util::Command command;
+
+  G3D_CHECK(reader.next(command) && command.type == util::G3D_CMD_MODEL_DATA && command.name == "quad");
+  G3D_CHECK(command.meshes.size() == 1 && command.meshes[0].vertexSize == sizeof(float) * 2);
+  G3D_CHECK(command.meshes[0].vertices.size() == sizeof(vertices) && command.meshes[0].indices.size() == 3);
+
+  G3D_CHECK(reader.next(command) && command.type == util::G3D_CMD_USE_SHADER && command.name == "plain");
+  G3D_CHECK(command.keywords == std::vector<std::string>({"RED", "BLUE"}));
+  G3D_CHECK(!reader.next(command));
+
+  std::error_code error;
+  std::filesystem::remove(recordingPath, error);
+}
+
+G3D_TEST(recordingCorrupt, "recording/corrupt") {
+  writeRecording();
+  const std::vector<uint8_t> file = readFile(recordingPath);
+  G3D_CHECK(file[useShader] == util::G3D_CMD_USE_SHADER);
+  const std::string damagedPath = recordingPath + ".damaged";
+
+  // Cada cantidad, cambiada por una que no entra en el archivo
+  for (size_t offset : {modelNameSize, meshCount, vertexCount, indexCount, shaderNameSize, keywordCount, keywordSize})
+    for (uint32_t count : {0xFFFFFFFFu, 0x40000000u, static_cast<uint32_t>(file.size())}) {
+      std::vector<uint8_t> damaged = file;
+      for (int i = 0; i < 4; i++) damaged[offset + i] = static_cast<uint8_t>(count >> (i * 8));
+      writeFile(damagedPath, damaged);
+      G3D_CHECK_THROWS(readAll(damagedPath), "ERR014");
+    }
+
+  // Truncado dentro de un comando
+  for (size_t size = 9; size < file.size(); size++) {
+    if (size == useShader) continue;
+    writeFile(damagedPath, std::vector<uint8_t>(file.begin(), file.begin() + size));
+    G3D_CHECK_THROWS(readAll(damagedPath), "ERR014");
+  }
+
+  std::error_code error;
+  std::filesystem::remove(recordingPath, error);
+  std::filesystem::remove(damagedPath, error);
+}
@@ -0,0 +1,140 @@
+// Compresión por bloques y contenedores DDS/KTX2 (util/texture_codec.h). Los archivos rotos o armados a mano
+// tienen que rechazarse sin leer fuera de los datos
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <tests/harness.h>
+#include <util/mipmaps.h>
+#include <util/texture_codec.h>
+
+using namespace graph3d;
+
+namespace {
+
+// Degradé suave, que los bloques representan bien
+std::vector<uint8_t> gradient(uint32_t width, uint32_t height, uint32_t channels) {
+  std::vector<uint8_t> pixels(static_cast<size_t>(width) * height * channels);
+  for (uint32_t y = 0; y < height; y++)
+    for (uint32_t x = 0; x < width; x++)
+      for (uint32_t c = 0; c < channels; c++)
+        pixels[(static_cast<size_t>(y) * width + x) * channels + c] = static_cast<uint8_t>(x * 8 + y * 4 + c * 16);
+  return pixels;
+}
+
+int maxError(util::BlockFormat format, uint32_t channels) {
+  const uint32_t width = 16, height = 16;
+  const std::vector<uint8_t> pixels = gradient(width, height, channels);
+  std::vector<uint8_t> blocks(util::compressedSize(format, width, height));
+  util::encodeBlocks(format, pixels.data(), width, height, channels, blocks.data());
+
+  std::vector<uint8_t> decoded(static_cast<size_t>(width) * height * util::blockChannels(format));
+  G3D_CHECK(util::decodeBlocks(format, blocks.data(), width, height, decoded.data()));
+  int error = 0;
+  for (size_t i = 0; i < static_cast<size_t>(width) * height; i++)
+    for (uint32_t c = 0; c < channels; c++)
+      error = std::max(error, std::abs(pixels[i * channels + c] - decoded[i * util::blockChannels(format) + c]));
+  return error;
+}
+
+void writeLE(std::vector<uint8_t>& file, size_t offset, uint64_t value, int bytes) {
+  for (int i = 0; i < bytes; i++) file[offset + i] = static_cast<uint8_t>(value >> (i * 8));
+}
+
+// KTX2 de 4x4 en BC1 con un nivel: cabecera de 80 bytes, el índice de niveles y un bloque
+std::vector<uint8_t> ktx2() {
+  const uint8_t identifier[12] = {0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+  std::vector<uint8_t> file(80 + 24 + 8, 0);
+  std::copy(identifier, identifier + 12, file.begin());
+  writeLE(file, 12, 131, 4);  // VK_FORMAT_BC1_RGB_UNORM_BLOCK
+  writeLE(file, 20, 4, 4);
+  writeLE(file, 24, 4, 4);
+  writeLE(file, 36, 1, 4);
+  writeLE(file, 40, 1, 4);
+  writeLE(file, 80, 104, 8);
+  writeLE(file, 88, 8, 8);
+  return file;
+}
+
+std::vector<uint8_t> dds() {
+  const uint32_t width = 8, height = 8;
+  const std::vector<uint8_t> pixels = gradient(width, height, 3);
+  util::MipChain mips = util::generateMips(pixels.data(), width, height, 3, util::MipOptions());
+  util::CompressedImage image = util::compressImage(pixels.data(), width, height, 3, mips);
+
+  const std::string path = (std::filesystem::temp_directory_path() / "graph3d_tests_codec.dds").string();
+  G3D_CHECK(util::writeDDS(path, image));
+  std::ifstream in(path, std::ios::binary);
+  std::vector<uint8_t> file((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  std::error_code error;
+  std::filesystem::remove(path, error);
+  return file;
+}
+
+}  // namespace
+
+G3D_TEST(codecRoundTrip, "texture_codec/round_trip") {
+  G3D_CHECK(maxError(util::G3D_BC1, 3) <= 12);
+  G3D_CHECK(maxError(util::G3D_BC3, 4) <= 12);
+  G3D_CHECK(maxError(util::G3D_BC4, 1) <= 4);
+  G3D_CHECK(maxError(util::G3D_BC5, 2) <= 4);
+}
+
+G3D_TEST(codecDDS, "texture_codec/dds") {
+  std::vector<uint8_t> file = dds();
+  util::CompressedImage image;
+  G3D_CHECK(util::isCompressedContainer(file.data(), file.size()));
+  G3D_CHECK(util::readCompressed(std::vector<uint8_t>(file), image));
+  G3D_CHECK(image.format == util::G3D_BC1 && image.width == 8 && image.height == 8);
+  G3D_CHECK(image.levels.size() == 4 && image.levels.back().width == 1);
+
+  // Truncado: falta el último nivel
+  std::vector<uint8_t> truncated(file.begin(), file.end() - 1);
+  G3D_CHECK(!util::readCompressed(std::move(truncated), image));
+
+  // Más niveles de los que puede tener una imagen de 8x8
+  std::vector<uint8_t> levels = file;
+  writeLE(levels, 4 + 24, 5, 4);
+  G3D_CHECK(!util::readCompressed(std::move(levels), image));
+  levels = file;
+  writeLE(levels, 4 + 24, 0xFFFFFFFF, 4);
+  G3D_CHECK(!util::readCompressed(std::move(levels), image));
+
+  std::vector<uint8_t> huge = file;
+  writeLE(huge, 4 + 8, 0xFFFFFFFF, 4);
+  writeLE(huge, 4 + 12, 0xFFFFFFFF, 4);
+  G3D_CHECK(!util::readCompressed(std::move(huge), image));
+}
+
+G3D_TEST(codecKTX2, "texture_codec/ktx2") {
+  util::CompressedImage image;
+  G3D_CHECK(util::readCompressed(ktx2(), image));
+  G3D_CHECK(image.format == util::G3D_BC1 && image.levels.size() == 1 && image.levels[0].offset == 104);
+
+  // Con levelCount * 24 en 32 bits, 0x0AAAAAAB daba 8 y el índice parecía entrar en el archivo
+  std::vector<uint8_t> file = ktx2();
+  writeLE(file, 40, 0x0AAAAAAB, 4);
+  G3D_CHECK(!util::readCompressed(std::move(file), image));
+
+  file = ktx2();
+  writeLE(file, 40, 4, 4);
+  G3D_CHECK(!util::readCompressed(std::move(file), image));
+
+  file = ktx2();
+  writeLE(file, 80, 105, 8);  // El nivel se sale del archivo
+  G3D_CHECK(!util::readCompressed(std::move(file), image));
+
+  file = ktx2();
+  writeLE(file, 88, 16, 8);  // No es el tamaño de un nivel de 4x4
+  G3D_CHECK(!util::readCompressed(std::move(file), image));
+
+  file = ktx2();
+  file.resize(90);
+  G3D_CHECK(!util::readCompressed(std::move(file), image));
+}
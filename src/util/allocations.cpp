@@ -0,0 +1,217 @@
+#include <util/allocations.h>
+
+#ifdef G3D_ALLOC_TRACKING
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace graph3d {
+namespace util {
+namespace allocations {
+
+namespace {
+
+// Todo lo que sigue tiene inicialización constante: operator new puede llamarse
+// antes de que corra cualquier constructor estático
+struct thread_state {
+  uint64_t count;
+  uint64_t bytes;
+  const char* tag;
+};
+
+thread_local thread_state state = {0, 0, nullptr};
+
+std::atomic<uint64_t> totalCount{0}, totalBytes{0};
+std::atomic<uint64_t> frameCount{0}, frameBytes{0};
+std::atomic<uint64_t> lastCount{0}, lastBytes{0};
+
+std::atomic<bool> budgetEnabled{false};
+std::atomic<uint64_t> budgetCount{0}, budgetBytes{0};
+std::atomic<uint32_t> budgetWarmup{0};
+std::atomic<uint64_t> overruns{0};
+std::atomic<uint64_t> worstCount{0}, worstBytes{0};
+
+struct tag_entry {
+  std::atomic<const char*> name;
+  std::atomic<uint64_t> count;
+  std::atomic<uint64_t> bytes;
+};
+
+constexpr size_t tagCapacity = 256;
+tag_entry tags[tagCapacity];
+
+void recordTag(const char* name, size_t size) {
+  size_t index = (reinterpret_cast<uintptr_t>(name) >> 3) % tagCapacity;
+
+  for (size_t probe = 0; probe < tagCapacity; probe++, index = (index + 1) % tagCapacity) {
+    const char* current = tags[index].name.load(std::memory_order_acquire);
+    if (!current && tags[index].name.compare_exchange_strong(current, name, std::memory_order_acq_rel))
+      current = name;
+
+    if (current == name) {
+      tags[index].count.fetch_add(1, std::memory_order_relaxed);
+      tags[index].bytes.fetch_add(size, std::memory_order_relaxed);
+      return;
+    }
+  }
+}
+
+inline void record(size_t size) {
+  state.count++;
+  state.bytes += size;
+
+  totalCount.fetch_add(1, std::memory_order_relaxed);
+  totalBytes.fetch_add(size, std::memory_order_relaxed);
+  frameCount.fetch_add(1, std::memory_order_relaxed);
+  frameBytes.fetch_add(size, std::memory_order_relaxed);
+
+  if (state.tag) recordTag(state.tag, size);
+}
+
+void* allocate(size_t size) {
+  record(size);
+  return std::malloc(size ? size : 1);
+}
+
+void* allocate(size_t size, size_t alignment) {
+  record(size);
+#ifdef _WIN32
+  return _aligned_malloc(size ? size : 1, alignment);
+#else
+  void* ptr = nullptr;
+  if (posix_memalign(&ptr, alignment < sizeof(void*) ? sizeof(void*) : alignment, size ? size : 1)) return nullptr;
+  return ptr;
+#endif
+}
+
+void release(void* ptr) { std::free(ptr); }
+
+void releaseAligned(void* ptr) {
+#ifdef _WIN32
+  _aligned_free(ptr);
+#else
+  std::free(ptr);
+#endif
+}
+
+}  // namespace
+
+counters thread() { return {state.count, state.bytes}; }
+
+counters total() {
+  return {totalCount.load(std::memory_order_relaxed), totalBytes.load(std::memory_order_relaxed)};
+}
+
+counters frame() {
+  return {frameCount.load(std::memory_order_relaxed), frameBytes.load(std::memory_order_relaxed)};
+}
+
+counters lastFrame() {
+  return {lastCount.load(std::memory_order_relaxed), lastBytes.load(std::memory_order_relaxed)};
+}
+
+void endFrame() {
+  const uint64_t count = frameCount.exchange(0, std::memory_order_relaxed);
+  const uint64_t bytes = frameBytes.exchange(0, std::memory_order_relaxed);
+  lastCount.store(count, std::memory_order_relaxed);
+  lastBytes.store(bytes, std::memory_order_relaxed);
+
+  if (!budgetEnabled.load(std::memory_order_relaxed)) return;
+
+  uint32_t warmup = budgetWarmup.load(std::memory_order_relaxed);
+  if (warmup) {
+    budgetWarmup.store(warmup - 1, std::memory_order_relaxed);
+    return;
+  }
+
+  const uint64_t maxCount = budgetCount.load(std::memory_order_relaxed);
+  const uint64_t maxBytes = budgetBytes.load(std::memory_order_relaxed);
+
+  if (count <= maxCount && (!maxBytes || bytes <= maxBytes)) return;
+  overruns.fetch_add(1, std::memory_order_relaxed);
+  if (count > worstCount.load(std::memory_order_relaxed)) {
+    worstCount.store(count, std::memory_order_relaxed);
+    worstBytes.store(bytes, std::memory_order_relaxed);
+  }
+}
+
+void setFrameBudget(uint64_t maxAllocations, uint64_t maxBytes, uint32_t warmupFrames) {
+  budgetCount.store(maxAllocations, std::memory_order_relaxed);
+  budgetBytes.store(maxBytes, std::memory_order_relaxed);
+  budgetWarmup.store(warmupFrames, std::memory_order_relaxed);
+  overruns.store(0, std::memory_order_relaxed);
+  worstCount.store(0, std::memory_order_relaxed);
+  worstBytes.store(0, std::memory_order_relaxed);
+  budgetEnabled.store(true, std::memory_order_relaxed);
+}
+
+void clearFrameBudget() { budgetEnabled.store(false, std::memory_order_relaxed); }
+
+uint64_t budgetOverruns() { return overruns.load(std::memory_order_relaxed); }
+
+counters worstOverrun() {
+  return {worstCount.load(std::memory_order_relaxed), worstBytes.load(std::memory_order_relaxed)};
+}
+
+std::vector<std::pair<const char*, counters>> byTag() {
+  std::vector<std::pair<const char*, counters>> result;
+  for (const tag_entry& entry : tags) {
+    const char* name = entry.name.load(std::memory_order_acquire);
+    if (name)
+      result.emplace_back(name, counters{entry.count.load(std::memory_order_relaxed),
+                                         entry.bytes.load(std::memory_order_relaxed)});
+  }
+  return result;
+}
+
+tag_scope::tag_scope(const char* name) : previous(state.tag) { state.tag = name; }
+
+tag_scope::~tag_scope() { state.tag = previous; }
+
+}  // namespace allocations
+}  // namespace util
+}  // namespace graph3d
+
+namespace alloc = graph3d::util::allocations;
+
+void* operator new(size_t size) {
+  void* ptr = alloc::allocate(size);
+  if (!ptr) throw std::bad_alloc();
+  return ptr;
+}
+
+void* operator new[](size_t size) {
+  void* ptr = alloc::allocate(size);
+  if (!ptr) throw std::bad_alloc();
+  return ptr;
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return alloc::allocate(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return alloc::allocate(size); }
+
+void* operator new(size_t size, std::align_val_t alignment) {
+  void* ptr = alloc::allocate(size, static_cast<size_t>(alignment));
+  if (!ptr) throw std::bad_alloc();
+  return ptr;
+}
+
+void* operator new[](size_t size, std::align_val_t alignment) {
+  void* ptr = alloc::allocate(size, static_cast<size_t>(alignment));
+  if (!ptr) throw std::bad_alloc();
+  return ptr;
+}
+
+void operator delete(void* ptr) noexcept { alloc::release(ptr); }
+void operator delete[](void* ptr) noexcept { alloc::release(ptr); }
+void operator delete(void* ptr, size_t) noexcept { alloc::release(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { alloc::release(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { alloc::release(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { alloc::release(ptr); }
+
+void operator delete(void* ptr, std::align_val_t) noexcept { alloc::releaseAligned(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { alloc::releaseAligned(ptr); }
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept { alloc::releaseAligned(ptr); }
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept { alloc::releaseAligned(ptr); }
+
+#endif
@@ -0,0 +1,81 @@
+#ifndef GRAPH3D_UTIL_ALLOCATIONS_H_
+#define GRAPH3D_UTIL_ALLOCATIONS_H_
+
+// Seguimiento de reservas de memoria en el heap.
+// Con G3D_ALLOC_TRACKING definido se reemplazan los operator new/delete globales y se cuentan
+// las reservas por frame, por zona del profiler y por etiqueta (G3D_ALLOC_TAG).
+// Sin la definición, las macros no generan código y los operadores quedan intactos.
+
+#ifdef G3D_ALLOC_TRACKING
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace graph3d {
+namespace util {
+namespace allocations {
+
+struct counters {
+  uint64_t count = 0;
+  uint64_t bytes = 0;
+};
+
+/// Reservas del hilo actual desde que arrancó. Sirve para medir zonas por diferencia
+counters thread();
+
+/// Reservas de todos los hilos desde que arrancó el proceso
+counters total();
+
+/// Reservas del frame en curso, y del último frame cerrado
+counters frame();
+counters lastFrame();
+
+/// Cierra el frame. Si se configuró un presupuesto y el frame lo supera, lo cuenta en budgetOverruns(): el main
+/// loop nunca se corta por esto, lo revisa quien puso el presupuesto (el test de src/tests/allocations_test.cpp)
+void endFrame();
+
+/// Presupuesto por frame estable: se ignoran los primeros `warmupFrames` frames.
+/// `maxBytes` en 0 no limita bytes. Reinicia la cuenta de frames que se pasaron
+void setFrameBudget(uint64_t maxAllocations, uint64_t maxBytes = 0, uint32_t warmupFrames = 1);
+void clearFrameBudget();
+
+/// Frames estables que superaron el presupuesto desde setFrameBudget(), y el que más reservó de ellos
+uint64_t budgetOverruns();
+counters worstOverrun();
+
+/// Reservas acumuladas por etiqueta
+std::vector<std::pair<const char*, counters>> byTag();
+
+// Atribuye las reservas del hilo a `name` mientras dure el bloque.
+// `name` debe ser un literal: las etiquetas se comparan por dirección
+class tag_scope {
+  const char* previous;
+
+ public:
+  tag_scope& operator=(const tag_scope&) = delete;
+  tag_scope(const tag_scope&) = delete;
+
+  explicit tag_scope(const char* name);
+  ~tag_scope();
+};
+
+}  // namespace allocations
+}  // namespace util
+}  // namespace graph3d
+
+#define G3D_ALLOC_CONCAT_IMPL(a, b) a##b
+#define G3D_ALLOC_CONCAT(a, b) G3D_ALLOC_CONCAT_IMPL(a, b)
+
+#define G3D_ALLOC_TAG(name) ::graph3d::util::allocations::tag_scope G3D_ALLOC_CONCAT(g3d_alloc_tag_, __LINE__)(name)
+#define G3D_ALLOC_END_FRAME() ::graph3d::util::allocations::endFrame()
+
+#else
+
+#define G3D_ALLOC_TAG(name) ((void)0)
+#define G3D_ALLOC_END_FRAME() ((void)0)
+
+#endif
+
+#endif
@@ -0,0 +1,294 @@
+#include <util/asset_pack.h>
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include <util/hash.h>
+#include <util/lz4.h>
+#include <util/profiler.h>
+
+namespace graph3d {
+namespace util {
+
+namespace {
+
+// Paquetes montados, por prefijo ("recursos.g3dpack/"). Cada uno aparece con la ruta como se montó y canónica
+struct mount_table {
+  std::mutex mutex;
+  std::vector<std::pair<std::string, std::shared_ptr<AssetPack>>> packs;
+};
+
+mount_table& mounts() {
+  static mount_table table;
+  return table;
+}
+
+std::string trimSlash(const std::string& path) {
+  size_t size = path.size();
+  while (size > 1 && (path[size - 1] == '/' || path[size - 1] == '\\')) size--;
+  return path.substr(0, size);
+}
+
+// "./a/../b\\c" -> "b/c", como quedan los nombres en el paquete
+std::string normalize(const std::string& name) {
+  if (name.find("./") == std::string::npos && name.find('\\') == std::string::npos &&
+      name.find("//") == std::string::npos)
+    return name;
+  return std::filesystem::path(name).lexically_normal().generic_string();
+}
+
+bool entryLess(const PackEntry& entry, uint64_t hash) { return entry.hash < hash; }
+
+}  // namespace
+
+std::string AssetPack::packOf(const std::string& path) {
+  const size_t size = std::strlen(assetPackExtension);
+  for (size_t at = path.find(assetPackExtension); at != std::string::npos; at = path.find(assetPackExtension, at + 1)) {
+    const size_t end = at + size;
+    if (at > 0 && (end == path.size() || path[end] == '/' || path[end] == '\\')) return path.substr(0, end);
+  }
+  return std::string();
+}
+
+std::shared_ptr<AssetPack> AssetPack::open(const std::string& path) {
+  G3D_PROFILE_SCOPE("AssetPack::open");
+  std::shared_ptr<AssetPack> pack(new AssetPack());
+  pack->g_path = trimSlash(path);
+  // Sin leer por adelantado: del paquete sólo se tocan el índice y lo que se pide
+  pack->g_file = MappedFile::map(pack->g_path, false);
+  if (!pack->g_file) return nullptr;
+
+  const unsigned char* bytes = pack->g_file->data();
+  const uint64_t size = pack->g_file->size();
+  PackHeader header;
+  if (size < sizeof(header)) return nullptr;
+  std::memcpy(&header, bytes, sizeof(header));
+  if (std::memcmp(header.magic, "G3DP", 4) != 0 || header.version != assetPackVersion) return nullptr;
+
+  const uint64_t indexSize = static_cast<uint64_t>(header.entryCount) * sizeof(PackEntry);
+  if (header.indexOffset % alignof(PackEntry) || header.indexOffset > size || indexSize > size - header.indexOffset ||
+      header.namesOffset > size || header.namesSize > size - header.namesOffset)
+    return nullptr;
+
+  pack->entries = reinterpret_cast<const PackEntry*>(bytes + header.indexOffset);
+  pack->count = header.entryCount;
+  pack->names = reinterpret_cast<const char*>(bytes + header.namesOffset);
+
+  // Todo lo que después se lee sin chequear tiene que caer dentro del archivo, y el tamaño de una entrada
+  // comprimida tiene que poder salir de sus bytes: read() reserva entry.size antes de descomprimir
+  for (uint32_t i = 0; i < pack->count; i++) {
+    const PackEntry& entry = pack->entries[i];
+    if (entry.offset > size || entry.storedSize > size - entry.offset || entry.nameOffset > header.namesSize ||
+        entry.nameSize > header.namesSize - entry.nameOffset || entry.codec > G3D_PACK_LZ4 ||
+        (entry.codec == G3D_PACK_STORED && entry.storedSize != entry.size) ||
+        (entry.codec == G3D_PACK_LZ4 && entry.size > lz4MaxDecompressed(entry.storedSize)) ||
+        (i && entry.hash < pack->entries[i - 1].hash))
+      return nullptr;
+
+    const std::string name = pack->name(entry);
+    for (size_t slash = name.find('/'); slash != std::string::npos; slash = name.find('/', slash + 1))
+      pack->folders.insert(name.substr(0, slash));
+  }
+  return pack;
+}
+
+std::shared_ptr<AssetPack> AssetPack::mount(const std::string& path) {
+  const std::string given = trimSlash(path);
+  std::error_code error;
+  std::string canonical = std::filesystem::weakly_canonical(given, error).generic_string();
+  if (error) canonical = given;
+
+  mount_table& table = mounts();
+  {
+    std::lock_guard<std::mutex> lock(table.mutex);
+    for (const auto& mounted : table.packs)
+      if (mounted.first == given + '/' || mounted.first == canonical + '/') return mounted.second;
+  }
+
+  std::shared_ptr<AssetPack> pack = open(given);
+  if (!pack) return nullptr;
+  std::lock_guard<std::mutex> lock(table.mutex);
+  table.packs.emplace_back(given + '/', pack);
+  if (canonical != given) table.packs.emplace_back(canonical + '/', pack);
+  return pack;
+}
+
+std::shared_ptr<AssetPack> AssetPack::find(const std::string& path, std::string& name) {
+  mount_table& table = mounts();
+  std::lock_guard<std::mutex> lock(table.mutex);
+  for (const auto& mounted : table.packs) {
+    const std::string& prefix = mounted.first;
+    if (path.size() > prefix.size() && path.compare(0, prefix.size(), prefix) == 0) {
+      name = normalize(path.substr(prefix.size()));
+      return mounted.second;
+    }
+  }
+  return nullptr;
+}
+
+void AssetPack::unmountAll() {
+  mount_table& table = mounts();
+  std::lock_guard<std::mutex> lock(table.mutex);
+  table.packs.clear();
+}
+
+const PackEntry* AssetPack::entry(const std::string& name) const {
+  const uint64_t hash = hash64(name.data(), name.size());
+  for (const PackEntry* it = std::lower_bound(entries, entries + count, hash, entryLess);
+       it != entries + count && it->hash == hash; it++)
+    if (it->nameSize == name.size() && std::memcmp(names + it->nameOffset, name.data(), name.size()) == 0) return it;
+  return nullptr;
+}
+
+bool AssetPack::hasFolder(const std::string& name) const { return folders.count(trimSlash(name)) != 0; }
+
+std::vector<std::string> AssetPack::list(const std::string& folder) const {
+  const std::string prefix = folder.empty() ? std::string() : trimSlash(folder) + '/';
+  std::vector<std::string> result;
+  for (uint32_t i = 0; i < count; i++) {
+    const PackEntry& entry = entries[i];
+    const char* name = names + entry.nameOffset;
+    if (entry.nameSize <= prefix.size() || std::memcmp(name, prefix.data(), prefix.size()) != 0) continue;
+    if (std::memchr(name + prefix.size(), '/', entry.nameSize - prefix.size())) continue;
+    result.emplace_back(name, entry.nameSize);
+  }
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+std::shared_ptr<MappedFile> AssetPack::read(const std::string& name) const {
+  const PackEntry* found = entry(name);
+  return found ? read(*found) : nullptr;
+}
+
+std::shared_ptr<MappedFile> AssetPack::read(const PackEntry& entry) const {
+  G3D_PROFILE_SCOPE("AssetPack::read");
+  if (entry.size == 0) return nullptr;  // Como un archivo vacío
+  const unsigned char* data = g_file->data() + entry.offset;
+
+  if (entry.codec == G3D_PACK_STORED) {
+    g_file->prefetch(entry.offset, entry.storedSize);
+    return MappedFile::view(data, entry.size, g_file);
+  }
+
+  std::shared_ptr<std::vector<uint8_t>> buffer = std::make_shared<std::vector<uint8_t>>(entry.size);
+  if (!lz4Decompress(data, entry.storedSize, buffer->data(), buffer->size())) return nullptr;
+  return MappedFile::view(buffer->data(), buffer->size(), buffer);
+}
+
+void AssetPackWriter::add(const std::string& name, std::vector<uint8_t>&& data, bool compress) {
+  pending_entry entry;
+  entry.name = normalize(name);
+  entry.size = data.size();
+  entry.codec = G3D_PACK_STORED;
+  g_rawSize += data.size();
+
+  if (compress && !data.empty()) {
+    std::vector<uint8_t> compressed(lz4Bound(data.size()));
+    const size_t size = lz4Compress(data.data(), data.size(), compressed.data(), compressed.size());
+    if (size && size <= data.size() - data.size() / 8) {
+      compressed.resize(size);
+      data = std::move(compressed);
+      entry.codec = G3D_PACK_LZ4;
+    }
+  }
+
+  g_storedSize += data.size();
+  entry.data = std::move(data);
+  pending.push_back(std::move(entry));
+}
+
+bool AssetPackWriter::write(const std::string& path) const {
+  G3D_PROFILE_SCOPE("AssetPackWriter::write");
+  // Los datos, en orden alfabético: los archivos de una misma carpeta quedan juntos y se leen con menos page faults
+  std::vector<const pending_entry*> order;
+  for (const pending_entry& entry : pending) order.push_back(&entry);
+  std::sort(order.begin(), order.end(),
+            [](const pending_entry* a, const pending_entry* b) { return a->name < b->name; });
+
+  auto align = [](uint64_t offset, uint64_t alignment) { return (offset + alignment - 1) / alignment * alignment; };
+
+  std::vector<PackEntry> index;
+  std::string names;
+  uint64_t offset = sizeof(PackHeader);
+  for (const pending_entry* entry : order) {
+    offset = align(offset, alignment);
+    PackEntry packed{};
+    packed.hash = hash64(entry->name.data(), entry->name.size());
+    packed.offset = offset;
+    packed.storedSize = entry->data.size();
+    packed.size = entry->size;
+    packed.nameOffset = static_cast<uint32_t>(names.size());
+    packed.nameSize = static_cast<uint32_t>(entry->name.size());
+    packed.codec = entry->codec;
+    index.push_back(packed);
+    names += entry->name;
+    offset += entry->data.size();
+  }
+
+  PackHeader header{};
+  std::memcpy(header.magic, "G3DP", 4);
+  header.version = assetPackVersion;
+  header.entryCount = static_cast<uint32_t>(index.size());
+  header.alignment = alignment;
+  header.indexOffset = align(offset, alignof(PackEntry));
+  header.namesOffset = header.indexOffset + index.size() * sizeof(PackEntry);
+  header.namesSize = names.size();
+
+  // `index` está en el orden de los datos; el paquete lo guarda ordenado para buscar por hash
+  std::vector<PackEntry> sorted = index;
+  std::sort(sorted.begin(), sorted.end(), [&names](const PackEntry& a, const PackEntry& b) {
+    if (a.hash != b.hash) return a.hash < b.hash;
+    return names.compare(a.nameOffset, a.nameSize, names, b.nameOffset, b.nameSize) < 0;
+  });
+
+  std::error_code error;
+  const std::filesystem::path target(path);
+  if (target.has_parent_path()) std::filesystem::create_directories(target.parent_path(), error);
+  const std::string temp = path + ".tmp" + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+
+  {
+    std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) return false;
+    const char zeros[64] = {};
+    auto pad = [&out, &zeros](uint64_t to) {
+      for (uint64_t at = static_cast<uint64_t>(out.tellp()); at < to;) {
+        const uint64_t step = std::min<uint64_t>(to - at, sizeof(zeros));
+        out.write(zeros, static_cast<std::streamsize>(step));
+        at += step;
+      }
+    };
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (size_t i = 0; i < order.size(); i++) {
+      pad(index[i].offset);
+      const std::vector<uint8_t>& data = order[i]->data;
+      out.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+    }
+    pad(header.indexOffset);
+    out.write(reinterpret_cast<const char*>(sorted.data()),
+              static_cast<std::streamsize>(sorted.size() * sizeof(PackEntry)));
+    out.write(names.data(), static_cast<std::streamsize>(names.size()));
+    if (!out.good()) {
+      out.close();
+      std::filesystem::remove(temp, error);
+      return false;
+    }
+  }
+
+  std::filesystem::rename(temp, path, error);
+  if (error) {
+    std::filesystem::remove(temp, error);
+    return false;
+  }
+  return true;
+}
+
+}  // namespace util
+}  // namespace graph3d
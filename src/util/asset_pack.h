@@ -0,0 +1,134 @@
+#ifndef GRAPH3D_UTIL_ASSET_PACK_H_
+#define GRAPH3D_UTIL_ASSET_PACK_H_
+
+// Paquete de recursos (.g3dpack): muchos archivos chicos en uno solo, que se mapea una vez y se lee por índice.
+//
+//   PackHeader
+//   datos de cada entrada, alineados a `alignment`, guardados tal cual o comprimidos con LZ4 (util/lz4.h)
+//   PackEntry[entryCount], ordenadas por hash del nombre y nombre
+//   nombres, relativos a la raíz del paquete, con '/' y sin terminador
+//
+// Un paquete montado (addResourceFolder con el paquete o una carpeta dentro, "recursos.g3dpack/models") se usa como
+// una carpeta: la ruta "recursos.g3dpack/models/casa.obj" es la entrada "models/casa.obj", y util::MappedFile::open
+// la abre como una vista del paquete. Buscar un archivo no toca el disco: el costo de arranque es abrir el paquete
+// y los page faults de lo que se lee. Se arma con graph3d_pack (src/pack/main.cpp).
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include <util/mapped_file.h>
+
+namespace graph3d {
+namespace util {
+
+static const char* const assetPackExtension = ".g3dpack";
+static const uint32_t assetPackVersion = 1;
+
+enum PackCodec : uint32_t { G3D_PACK_STORED, G3D_PACK_LZ4 };
+
+struct PackHeader {
+  char magic[4];  // "G3DP"
+  uint32_t version;
+  uint32_t entryCount;
+  uint32_t alignment;
+  uint64_t indexOffset;
+  uint64_t namesOffset;
+  uint64_t namesSize;
+};
+
+struct PackEntry {
+  uint64_t hash;  // hash64 del nombre
+  uint64_t offset;
+  uint64_t storedSize;  // Bytes en el paquete
+  uint64_t size;        // Bytes del archivo
+  uint32_t nameOffset, nameSize;
+  uint32_t codec;
+  uint32_t reserved;
+};
+
+static_assert(sizeof(PackHeader) == 40 && sizeof(PackEntry) == 48, "PackHeader y PackEntry son parte del formato");
+
+class AssetPack {
+  std::string g_path;
+  std::shared_ptr<MappedFile> g_file;
+  const PackEntry* entries = nullptr;
+  uint32_t count = 0;
+  const char* names = nullptr;
+  std::unordered_set<std::string> folders;
+
+  AssetPack() {}
+
+ public:
+  AssetPack& operator=(const AssetPack&) = delete;
+  AssetPack(const AssetPack&) = delete;
+
+  /// Ruta del paquete si `path` es un paquete o una carpeta dentro de uno ("recursos.g3dpack/shaders"); si no, ""
+  static std::string packOf(const std::string& path);
+
+  /// nullptr si el archivo no existe o no es un paquete válido
+  static std::shared_ptr<AssetPack> open(const std::string& path);
+
+  /// Abre el paquete y lo registra para que sus rutas se resuelvan. Montar dos veces el mismo no lo vuelve a abrir
+  static std::shared_ptr<AssetPack> mount(const std::string& path);
+
+  /// Paquete montado que contiene la ruta `path`, con el nombre de la entrada en `name`. nullptr si no hay
+  static std::shared_ptr<AssetPack> find(const std::string& path, std::string& name);
+
+  /// Desmonta todos los paquetes. Las vistas ya abiertas siguen siendo válidas
+  static void unmountAll();
+
+  const std::string& path() const { return g_path; }
+  uint32_t size() const { return count; }
+
+  /// nullptr si no hay una entrada con ese nombre
+  const PackEntry* entry(const std::string& name) const;
+  bool contains(const std::string& name) const { return entry(name) != nullptr; }
+  bool hasFolder(const std::string& name) const;
+
+  /// Nombres de las entradas que están directamente en `folder`, en orden alfabético
+  std::vector<std::string> list(const std::string& folder) const;
+
+  /// Contenido de la entrada: una vista del paquete si está guardada tal cual, o un buffer nuevo si está
+  /// comprimida. nullptr si no existe o está dañada
+  std::shared_ptr<MappedFile> read(const std::string& name) const;
+  std::shared_ptr<MappedFile> read(const PackEntry& entry) const;
+
+  std::string name(const PackEntry& entry) const { return std::string(names + entry.nameOffset, entry.nameSize); }
+};
+
+// Arma un paquete en memoria y lo escribe de una vez
+class AssetPackWriter {
+  struct pending_entry {
+    std::string name;
+    std::vector<uint8_t> data;
+    uint64_t size;
+    PackCodec codec;
+  };
+
+  uint32_t alignment;
+  std::vector<pending_entry> pending;
+  uint64_t g_rawSize = 0, g_storedSize = 0;
+
+ public:
+  explicit AssetPackWriter(uint32_t alignment = 16) : alignment(alignment ? alignment : 1) {}
+
+  /// Agrega `data` como `name` (relativo, con '/'). Con `compress` se guarda con LZ4, salvo que ahorre menos
+  /// de un octavo: así lo que ya viene comprimido (PNG, JPEG) se sigue leyendo sin copias
+  void add(const std::string& name, std::vector<uint8_t>&& data, bool compress);
+
+  /// Escribe el paquete en `path`. Primero a un temporal, así nadie monta un paquete a medias
+  bool write(const std::string& path) const;
+
+  uint64_t rawSize() const { return g_rawSize; }
+  uint64_t storedSize() const { return g_storedSize; }
+  size_t size() const { return pending.size(); }
+};
+
+}  // namespace util
+}  // namespace graph3d
+
+#endif
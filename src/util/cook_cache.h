@@ -0,0 +1,65 @@
+#ifndef GRAPH3D_UTIL_COOK_CACHE_H_
+#define GRAPH3D_UTIL_COOK_CACHE_H_
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <mutex>
+#include <string>
+
+namespace graph3d {
+namespace util {
+
+// Carpeta donde se guardan los recursos cocinados (mallas .g3dmesh, texturas comprimidas .dds), con el hash del
+// original como nombre. Por defecto G3D_COOK_CACHE o, si no está, una carpeta en la temporal del sistema.
+// Vacía, no se cocina nada
+class CookCache {
+ public:
+  /// Singleton
+  static CookCache& getInstance() {
+    static CookCache instance;
+    return instance;
+  }
+
+ private:
+  std::mutex mutex;
+  std::string g_directory;
+
+  CookCache() {
+    if (const char* directory = std::getenv("G3D_COOK_CACHE")) {
+      g_directory = directory;
+      return;
+    }
+    std::error_code error;
+    std::filesystem::path temp = std::filesystem::temp_directory_path(error);
+    if (!error) g_directory = (temp / "graph3d" / "cooked").generic_string();
+  }
+
+ public:
+  CookCache& operator=(const CookCache&) = delete;
+  CookCache(const CookCache&) = delete;
+
+  std::string directory() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return g_directory;
+  }
+  void setDirectory(const std::string& directory) {
+    std::lock_guard<std::mutex> lock(mutex);
+    g_directory = directory;
+  }
+
+  /// Ruta del recurso cocinado de un original con ese hash. Vacía si no se cocina
+  std::string pathFor(uint64_t sourceHash, const char* extension) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (g_directory.empty()) return std::string();
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(sourceHash));
+    return (std::filesystem::path(g_directory) / (name + std::string(extension))).generic_string();
+  }
+};
+
+}  // namespace util
+}  // namespace graph3d
+
+#endif
@@ -0,0 +1,150 @@
+#include <util/file_watcher.h>
+
+#include <cstring>
+#include <iterator>
+#include <vector>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace graph3d {
+namespace util {
+
+#ifdef __linux__
+
+namespace {
+
+constexpr uint32_t watchMask = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_CLOSE_WRITE | IN_MODIFY |
+                               IN_ATTRIB | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR;
+
+}  // namespace
+
+FileWatcher::FileWatcher() {
+  descriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (descriptor < 0) return;
+  wakeup = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (wakeup < 0) {
+    close(descriptor);
+    descriptor = -1;
+  }
+}
+
+FileWatcher::~FileWatcher() {
+  if (descriptor < 0) return;
+  if (thread.joinable()) {
+    const uint64_t one = 1;
+    if (write(wakeup, &one, sizeof(one)) == sizeof(one)) thread.join();
+    else thread.detach();
+  }
+  close(descriptor);
+  close(wakeup);
+}
+
+int FileWatcher::watch(const std::string& path, listener_t listener) {
+  if (descriptor < 0) return -1;
+  std::lock_guard<std::recursive_mutex> lock(mutex);
+  const int handle = inotify_add_watch(descriptor, path.c_str(), watchMask);
+  if (handle < 0) return -1;
+
+  // El hilo arranca con la primera carpeta: una aplicación sin carpetas de recursos no lo paga
+  if (!thread.joinable()) thread = std::thread(&FileWatcher::run, this);
+  const int id = nextId++;
+  watches[id] = {handle, std::move(listener)};
+  return id;
+}
+
+void FileWatcher::unwatch(int id) {
+  std::lock_guard<std::recursive_mutex> lock(mutex);
+  auto it = watches.find(id);
+  if (it == watches.end()) return;
+  const int handle = it->second.handle;
+  watches.erase(it);
+  for (const auto& other : watches)
+    if (other.second.handle == handle) return;
+  inotify_rm_watch(descriptor, handle);
+}
+
+void FileWatcher::run() {
+  alignas(inotify_event) char buffer[16384];
+  pollfd descriptors[2] = {{descriptor, POLLIN, 0}, {wakeup, POLLIN, 0}};
+
+  while (true) {
+    if (poll(descriptors, 2, -1) < 0) continue;
+    if (descriptors[1].revents) return;
+
+    const ssize_t size = read(descriptor, buffer, sizeof(buffer));
+    if (size <= 0) continue;
+
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+    for (ssize_t offset = 0; offset < size;) {
+      const inotify_event* raw = reinterpret_cast<const inotify_event*>(buffer + offset);
+      offset += sizeof(inotify_event) + raw->len;
+
+      FileEvent event;
+      event.name = raw->len ? raw->name : "";
+      event.directory = (raw->mask & IN_ISDIR) != 0;
+      if (raw->mask & IN_Q_OVERFLOW) {
+        event.kind = G3D_FILE_OVERFLOW;
+        notify(-1, event);
+        continue;
+      }
+
+      // inotify dejó de vigilar la carpeta (se borró, o alguien llamó a unwatch): sus ids ya no valen
+      if (raw->mask & IN_IGNORED) {
+        for (auto it = watches.begin(); it != watches.end();)
+          it = it->second.handle == raw->wd ? watches.erase(it) : std::next(it);
+        continue;
+      }
+
+      if (raw->mask & (IN_DELETE_SELF | IN_MOVE_SELF)) {
+        // La carpeta vigilada misma se borró o se movió
+        event.kind = G3D_FILE_REMOVED;
+        event.directory = true;
+      } else if (raw->mask & (IN_CREATE | IN_MOVED_TO)) {
+        event.kind = G3D_FILE_CREATED;
+      } else if (raw->mask & (IN_DELETE | IN_MOVED_FROM)) {
+        event.kind = G3D_FILE_REMOVED;
+      } else {
+        event.kind = G3D_FILE_CHANGED;
+      }
+
+      notify(raw->wd, event);
+    }
+  }
+}
+
+void FileWatcher::notify(int handle, const FileEvent& event) {
+  // Copias de los ids y del listener: mientras se le avisa, un listener puede vigilar o dejar de vigilar carpetas
+  std::vector<int> ids;
+  for (const auto& entry : watches)
+    if (handle < 0 || entry.second.handle == handle) ids.push_back(entry.first);
+  for (int id : ids) {
+    auto it = watches.find(id);
+    if (it == watches.end()) continue;
+    const listener_t listener = it->second.listener;
+    listener(event);
+  }
+}
+
+#else
+
+FileWatcher::FileWatcher() {}
+
+FileWatcher::~FileWatcher() {}
+
+int FileWatcher::watch(const std::string&, listener_t) { return -1; }
+
+void FileWatcher::unwatch(int) {}
+
+void FileWatcher::run() {}
+
+void FileWatcher::notify(int, const FileEvent&) {}
+
+#endif
+
+}  // namespace util
+}  // namespace graph3d
@@ -0,0 +1,82 @@
+#ifndef GRAPH3D_UTIL_FILE_WATCHER_H_
+#define GRAPH3D_UTIL_FILE_WATCHER_H_
+
+// Avisos de cambios en carpetas. En Linux, un único descriptor de inotify y un hilo que lo espera; los avisos se
+// entregan en ese hilo. En otras plataformas no hay avisos (available() es false) y quien vigile tiene que
+// revisar el disco por su cuenta.
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace graph3d {
+namespace util {
+
+enum FileEventKind {
+  G3D_FILE_CREATED,   // También lo que llega movido desde otra carpeta
+  G3D_FILE_CHANGED,   // Contenido o atributos
+  G3D_FILE_REMOVED,   // También lo que se mueve a otra carpeta
+  G3D_FILE_OVERFLOW,  // Se perdieron avisos: hay que volver a leer todo lo vigilado
+};
+
+struct FileEvent {
+  FileEventKind kind;
+  std::string name;  // Relativo a la carpeta vigilada. Vacío con G3D_FILE_OVERFLOW o si es la carpeta misma
+  bool directory;
+};
+
+class FileWatcher {
+ public:
+  /// Singleton
+  static FileWatcher& getInstance() {
+    static FileWatcher instance;
+    return instance;
+  }
+
+  typedef std::function<void(const FileEvent& event)> listener_t;
+
+ private:
+  // Se avisa mientras se tiene el lock, así después de unwatch() no llega ningún aviso más. Es recursivo porque
+  // un listener puede vigilar una carpeta nueva desde el aviso de que se creó
+  std::recursive_mutex mutex;
+  struct watch_entry {
+    int handle;  // Descriptor de inotify de la carpeta: dos ids que vigilan la misma carpeta comparten el mismo
+    listener_t listener;
+  };
+  std::map<int, watch_entry> watches;
+  int nextId = 0;
+  std::thread thread;
+  int descriptor = -1;
+  int wakeup = -1;
+
+  FileWatcher();
+
+ public:
+  FileWatcher& operator=(const FileWatcher&) = delete;
+  FileWatcher(const FileWatcher&) = delete;
+  ~FileWatcher();
+
+  /// true si la plataforma avisa de los cambios
+  bool available() const { return descriptor >= 0; }
+
+  /// Avisa a `listener` de los cambios directos en la carpeta `path` (no en sus subcarpetas). Devuelve un id para
+  /// unwatch(), o -1 si no se puede vigilar (la carpeta no existe, se llegó al límite de inotify, ...)
+  int watch(const std::string& path, listener_t listener);
+
+  /// Después de que vuelve, `id` no recibe más avisos. Con un id que no existe (-1) sólo espera al aviso en curso
+  void unwatch(int id);
+
+ private:
+  void run();
+
+  // Avisa a los ids que vigilan `handle`, o a todos con -1. Con el lock tomado
+  void notify(int handle, const FileEvent& event);
+};
+
+}  // namespace util
+}  // namespace graph3d
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef GRAPH3D_UTIL_FRUSTUM_H_
+#define GRAPH3D_UTIL_FRUSTUM_H_
+
+#include <glm/glm.hpp>
+#include <glm/mat4x4.hpp>
+
+#include <algorithm>
+#include <limits>
+
+namespace graph3d {
+namespace util {
+
+// Prueba una caja alineada a los ejes contra el frustum de `mvp`.
+// Los planos se extraen directamente de la matriz (Gribb/Hartmann), así quedan en el espacio de la caja
+inline bool intersectsFrustum(const glm::mat4& mvp, const glm::vec3& min, const glm::vec3& max) {
+  const glm::mat4 rows = glm::transpose(mvp);
+  const glm::vec4 planes[6] = {rows[3] + rows[0], rows[3] - rows[0], rows[3] + rows[1],
+                               rows[3] - rows[1], rows[3] + rows[2], rows[3] - rows[2]};
+
+  for (const glm::vec4& plane : planes) {
+    // Vértice de la caja más adentro del plano
+    const glm::vec3 inner(plane.x > 0 ? max.x : min.x, plane.y > 0 ? max.y : min.y, plane.z > 0 ? max.z : min.z);
+    if (glm::dot(glm::vec3(plane), inner) + plane.w < 0) return false;
+  }
+  return true;
+}
+
+// Lado más largo, en NDC ([0, 2] para el viewport entero), de la caja proyectada con `mvp`. Sin recortar contra el
+// viewport: una caja que se sale de la pantalla igual se ve con ese tamaño. Si cruza el plano de la cámara, infinito
+inline float projectedExtent(const glm::mat4& mvp, const glm::vec3& min, const glm::vec3& max) {
+  glm::vec2 low(std::numeric_limits<float>::max()), high(std::numeric_limits<float>::lowest());
+  for (int i = 0; i < 8; i++) {
+    const glm::vec4 corner = mvp * glm::vec4(i & 1 ? max.x : min.x, i & 2 ? max.y : min.y, i & 4 ? max.z : min.z, 1);
+    if (corner.w <= 0) return std::numeric_limits<float>::infinity();
+    const glm::vec2 ndc = glm::vec2(corner) / corner.w;
+    low = glm::min(low, ndc);
+    high = glm::max(high, ndc);
+  }
+  return std::max(high.x - low.x, high.y - low.y);
+}
+
+}  // namespace util
+}  // namespace graph3d
+
+#endif
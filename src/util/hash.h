@@ -0,0 +1,24 @@
+#ifndef GRAPH3D_UTIL_HASH_H_
+#define GRAPH3D_UTIL_HASH_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace graph3d {
+namespace util {
+
+// FNV-1a de 64 bits. Sirve para reconocer contenido repetido, no como hash criptográfico
+inline uint64_t hash64(const void* data, size_t size, uint64_t seed = 14695981039346656037ull) {
+  const unsigned char* bytes = static_cast<const unsigned char*>(data);
+  uint64_t hash = seed;
+  for (size_t i = 0; i < size; i++) {
+    hash ^= bytes[i];
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+}  // namespace util
+}  // namespace graph3d
+
+#endif
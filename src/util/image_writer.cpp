@@ -0,0 +1,141 @@
+#include <util/image_writer.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace graph3d {
+namespace util {
+
+namespace {
+
+struct crc_table {
+  uint32_t values[256];
+
+  crc_table() {
+    for (uint32_t n = 0; n < 256; n++) {
+      uint32_t c = n;
+      for (int k = 0; k < 8; k++) c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+      values[n] = c;
+    }
+  }
+};
+
+uint32_t crc32(uint32_t crc, const uint8_t* data, size_t size) {
+  static const crc_table table;
+  crc = ~crc;
+  for (size_t i = 0; i < size; i++) crc = table.values[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+  return ~crc;
+}
+
+void putU32(std::vector<uint8_t>& out, uint32_t value) {
+  out.push_back(static_cast<uint8_t>(value >> 24));
+  out.push_back(static_cast<uint8_t>(value >> 16));
+  out.push_back(static_cast<uint8_t>(value >> 8));
+  out.push_back(static_cast<uint8_t>(value));
+}
+
+void writeChunk(std::FILE* file, const char* type, const std::vector<uint8_t>& data) {
+  std::vector<uint8_t> header;
+  putU32(header, static_cast<uint32_t>(data.size()));
+  header.insert(header.end(), type, type + 4);
+
+  uint32_t crc = crc32(0, header.data() + 4, 4);
+  crc = crc32(crc, data.data(), data.size());
+
+  std::vector<uint8_t> footer;
+  putU32(footer, crc);
+
+  std::fwrite(header.data(), 1, header.size(), file);
+  if (!data.empty()) std::fwrite(data.data(), 1, data.size(), file);
+  std::fwrite(footer.data(), 1, footer.size(), file);
+}
+
+}  // namespace
+
+bool writePNG(const std::string& path, uint32_t width, uint32_t height, uint32_t channels, const uint8_t* data,
+              size_t stride) {
+  static const uint8_t colorTypes[] = {0, 0, 4, 2, 6};
+  if (channels < 1 || channels > 4) return false;
+
+  std::FILE* file = std::fopen(path.c_str(), "wb");
+  if (!file) return false;
+
+  static const uint8_t signature[] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+  std::fwrite(signature, 1, sizeof(signature), file);
+
+  std::vector<uint8_t> ihdr;
+  putU32(ihdr, width);
+  putU32(ihdr, height);
+  ihdr.insert(ihdr.end(), {8, colorTypes[channels], 0, 0, 0});
+  writeChunk(file, "IHDR", ihdr);
+
+  // Cada fila lleva un byte de filtro (0 = ninguno)
+  const size_t rowSize = static_cast<size_t>(width) * channels;
+  std::vector<uint8_t> raw;
+  raw.reserve((rowSize + 1) * height);
+  for (uint32_t y = 0; y < height; y++) {
+    const uint8_t* row = data + (height - 1 - y) * stride;
+    raw.push_back(0);
+    raw.insert(raw.end(), row, row + rowSize);
+  }
+
+  // zlib con bloques deflate "stored" de hasta 65535 bytes
+  std::vector<uint8_t> idat;
+  idat.reserve(raw.size() + raw.size() / 65535 * 5 + 16);
+  idat.push_back(0x78);
+  idat.push_back(0x01);
+
+  uint32_t a = 1, b = 0;
+  size_t offset = 0;
+  do {
+    const size_t block = std::min<size_t>(65535, raw.size() - offset);
+    const bool last = offset + block == raw.size();
+    idat.push_back(last ? 1 : 0);
+    idat.push_back(static_cast<uint8_t>(block));
+    idat.push_back(static_cast<uint8_t>(block >> 8));
+    idat.push_back(static_cast<uint8_t>(~block));
+    idat.push_back(static_cast<uint8_t>(~block >> 8));
+    idat.insert(idat.end(), raw.begin() + offset, raw.begin() + offset + block);
+
+    // 5552 es el máximo de bytes que se pueden sumar antes de que `b` desborde 32 bits
+    for (size_t i = offset; i < offset + block;) {
+      const size_t end = std::min(offset + block, i + 5552);
+      for (; i < end; i++) {
+        a += raw[i];
+        b += a;
+      }
+      a %= 65521;
+      b %= 65521;
+    }
+    offset += block;
+  } while (offset < raw.size());
+
+  putU32(idat, (b << 16) | a);
+  writeChunk(file, "IDAT", idat);
+  writeChunk(file, "IEND", {});
+
+  const bool ok = !std::ferror(file);
+  std::fclose(file);
+  return ok;
+}
+
+bool writeRaw(std::FILE* file, uint32_t width, uint32_t height, uint32_t channels, const uint8_t* data,
+              size_t stride) {
+  const size_t rowSize = static_cast<size_t>(width) * channels;
+  for (uint32_t y = 0; y < height; y++)
+    if (std::fwrite(data + (height - 1 - y) * stride, 1, rowSize, file) != rowSize) return false;
+  return true;
+}
+
+bool writeRaw(const std::string& path, uint32_t width, uint32_t height, uint32_t channels, const uint8_t* data,
+              size_t stride) {
+  std::FILE* file = std::fopen(path.c_str(), "wb");
+  if (!file) return false;
+
+  const bool ok = writeRaw(file, width, height, channels, data, stride);
+  std::fclose(file);
+  return ok;
+}
+
+}  // namespace util
+}  // namespace graph3d
@@ -0,0 +1,28 @@
+#ifndef GRAPH3D_UTIL_IMAGE_WRITER_H_
+#define GRAPH3D_UTIL_IMAGE_WRITER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+namespace graph3d {
+namespace util {
+
+// Las imágenes se reciben como las entrega glReadPixels: filas de abajo hacia arriba,
+// separadas por `stride` bytes. Se escriben de arriba hacia abajo
+
+/// PNG de 8 bits por canal (1 a 4 canales). Usa deflate sin compresión, así no depende de zlib
+bool writePNG(const std::string& path, uint32_t width, uint32_t height, uint32_t channels, const uint8_t* data,
+              size_t stride);
+
+/// Píxeles crudos, sin encabezado
+bool writeRaw(const std::string& path, uint32_t width, uint32_t height, uint32_t channels, const uint8_t* data,
+              size_t stride);
+bool writeRaw(std::FILE* file, uint32_t width, uint32_t height, uint32_t channels, const uint8_t* data,
+              size_t stride);
+
+}  // namespace util
+}  // namespace graph3d
+
+#endif
@@ -0,0 +1,308 @@
+#include <util/jobs.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+
+#include <util/metrics.h>
+#include <util/profiler.h>
+
+namespace graph3d {
+namespace util {
+
+static uint64_t now() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// Hilo del sistema que está corriendo: los demás hilos usan la cola 0
+static thread_local const JobSystem* currentSystem = nullptr;
+static thread_local uint32_t currentIndex = 0;
+
+JobSystem& JobSystem::getInstance() {
+  static JobSystem instance([] {
+    const char* threads = std::getenv("G3D_JOB_THREADS");
+    return threads ? static_cast<uint32_t>(std::strtoul(threads, nullptr, 10)) : 0u;
+  }());
+  return instance;
+}
+
+JobSystem::JobSystem(uint32_t threads) : mainThread(std::this_thread::get_id()), frameStart(now()) {
+  if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+  for (uint32_t i = 0; i < threads; i++) workers.emplace_back(new worker());
+  lastFrame.resize(threads);
+  for (uint32_t i = 1; i < threads; i++) threadsPool.emplace_back(&JobSystem::workerLoop, this, i);
+}
+
+JobSystem::~JobSystem() {
+  {
+    std::lock_guard<std::mutex> lock(sleepMutex);
+    stopping = true;
+  }
+  wake.notify_all();
+  for (std::thread& thread : threadsPool) thread.join();
+}
+
+void JobSystem::run(std::function<void()> func, JobCounter* counter, const char* name) {
+  if (counter) counter->g_pending.fetch_add(1, std::memory_order_relaxed);
+  push(currentWorker(), {std::move(func), counter, name});
+}
+
+void JobSystem::after(JobCounter& dependency, std::function<void()> func, JobCounter* counter, const char* name) {
+  if (counter) counter->g_pending.fetch_add(1, std::memory_order_relaxed);
+  {
+    std::lock_guard<std::mutex> lock(dependency.mutex);
+    if (dependency.g_pending.load(std::memory_order_acquire) != 0) {
+      dependency.continuations.push_back({std::move(func), counter, name});
+      return;
+    }
+  }
+  push(currentWorker(), {std::move(func), counter, name});
+}
+
+void JobSystem::runOnMainThread(std::function<void()> func, JobCounter* counter, const char* name) {
+  if (counter) counter->g_pending.fetch_add(1, std::memory_order_relaxed);
+  {
+    std::lock_guard<std::mutex> lock(mainMutex);
+    mainJobs.push_back({std::move(func), counter, name});
+  }
+
+  // Por si el hilo principal está dormido en wait()
+  { std::lock_guard<std::mutex> lock(sleepMutex); }
+  wake.notify_all();
+}
+
+void JobSystem::wait(JobCounter& counter) {
+  const uint32_t index = currentWorker();
+  const bool main = isMainThread();
+
+  while (!counter.done()) {
+    job work;
+    bool stolen = false;
+    if (main && popMainThread(work)) {
+      execute(work, 0, false);
+      continue;
+    }
+    if (pop(index, work, stolen)) {
+      execute(work, index, stolen);
+      continue;
+    }
+
+    // Los jobs del hilo principal no despiertan por `queued`: el timeout los cubre
+    std::unique_lock<std::mutex> lock(sleepMutex);
+    wake.wait_for(lock, std::chrono::milliseconds(1),
+                  [&] { return counter.done() || queued.load(std::memory_order_acquire) > 0; });
+  }
+
+  // El último finish() todavía puede tener tomado el mutex del contador
+  std::exception_ptr error;
+  {
+    std::lock_guard<std::mutex> lock(counter.mutex);
+    std::swap(error, counter.error);
+  }
+  if (error) std::rethrow_exception(error);
+}
+
+void JobSystem::parallelFor(uint32_t count, const std::function<void(uint32_t)>& func, uint32_t grain) {
+  if (count == 0) return;
+  grain = std::max(grain, 1u);
+  const uint32_t chunks = (count - 1) / grain + 1;
+  if (threads() == 1 || chunks == 1) {
+    for (uint32_t i = 0; i < count; i++) func(i);
+    return;
+  }
+
+  // Un job por hilo que va tomando bloques: reparte igual de bien que un job por bloque, con menos colas
+  std::atomic<uint32_t> next{0};
+  auto body = [&] {
+    for (uint32_t begin = next.fetch_add(grain, std::memory_order_relaxed); begin < count;
+         begin = next.fetch_add(grain, std::memory_order_relaxed)) {
+      const uint32_t end = std::min(begin + grain, count);
+      for (uint32_t i = begin; i < end; i++) func(i);
+    }
+  };
+
+  JobCounter counter;
+  const uint32_t helpers = std::min(chunks, threads()) - 1;
+  for (uint32_t i = 0; i < helpers; i++) run(body, &counter, "JobSystem::parallelFor");
+
+  // Los jobs usan variables de este frame de la pila: hay que esperarlos aunque falle el bloque propio
+  std::exception_ptr error;
+  try {
+    body();
+  } catch (...) {
+    error = std::current_exception();
+    next.store(count, std::memory_order_relaxed);
+  }
+  try {
+    wait(counter);
+  } catch (...) {
+    if (!error) error = std::current_exception();
+  }
+  if (error) std::rethrow_exception(error);
+}
+
+uint32_t JobSystem::runMainThreadJobs() {
+  G3D_PROFILE_SCOPE("JobSystem::runMainThreadJobs");
+  // Casi todos los frames no hay nada: una deque vacía ya reserva memoria, así que ni se construye
+  {
+    std::lock_guard<std::mutex> lock(mainMutex);
+    if (mainJobs.empty() && !orphanError) return 0;
+  }
+
+  std::deque<job> jobs;
+  {
+    std::lock_guard<std::mutex> lock(mainMutex);
+    jobs.swap(mainJobs);
+  }
+
+  // Los que se encolen mientras tanto quedan para la próxima vez
+  for (job& work : jobs) execute(work, 0, false);
+
+  std::exception_ptr error;
+  {
+    std::lock_guard<std::mutex> lock(mainMutex);
+    std::swap(error, orphanError);
+  }
+  if (error) std::rethrow_exception(error);
+  return static_cast<uint32_t>(jobs.size());
+}
+
+void JobSystem::endFrame() {
+  const uint64_t end = now();
+  std::lock_guard<std::mutex> lock(statsMutex);
+  const double seconds = (end - frameStart) * 1e-9;
+  frameStart = end;
+
+  for (size_t i = 0; i < workers.size(); i++) {
+    worker& w = *workers[i];
+    const uint64_t executed = w.executed.load(std::memory_order_relaxed);
+    const uint64_t stolen = w.stolen.load(std::memory_order_relaxed);
+    const uint64_t busy = w.busy.load(std::memory_order_relaxed);
+
+    WorkerStats& stats = lastFrame[i];
+    stats.jobs = executed - w.lastExecuted;
+    stats.stolen = stolen - w.lastStolen;
+    stats.busy = (busy - w.lastBusy) * 1e-9;
+    stats.utilization = seconds > 0 ? std::min(stats.busy / seconds, 1.) : 0;
+
+    w.lastExecuted = executed;
+    w.lastStolen = stolen;
+    w.lastBusy = busy;
+  }
+}
+
+std::vector<WorkerStats> JobSystem::stats() const {
+  std::lock_guard<std::mutex> lock(statsMutex);
+  return lastFrame;
+}
+
+uint32_t JobSystem::currentWorker() const { return currentSystem == this ? currentIndex : 0; }
+
+void JobSystem::push(uint32_t index, job&& work) {
+  // `queued` sube antes de encolar: un hilo despierto puede no encontrar el job todavía, pero nunca
+  // puede haber un job sin contar
+  queued.fetch_add(1, std::memory_order_release);
+  {
+    worker& w = *workers[index];
+    std::lock_guard<std::mutex> lock(w.mutex);
+    w.jobs.push_back(std::move(work));
+  }
+
+  { std::lock_guard<std::mutex> lock(sleepMutex); }
+  wake.notify_one();
+}
+
+bool JobSystem::pop(uint32_t index, job& work, bool& stolen) {
+  const uint32_t count = threads();
+  for (uint32_t i = 0; i < count; i++) {
+    worker& w = *workers[(index + i) % count];
+    std::lock_guard<std::mutex> lock(w.mutex);
+    if (w.jobs.empty()) continue;
+
+    // La cola propia se usa como pila; las ajenas, como cola, así se roban los jobs más grandes
+    if (i == 0) {
+      work = std::move(w.jobs.back());
+      w.jobs.pop_back();
+    } else {
+      work = std::move(w.jobs.front());
+      w.jobs.pop_front();
+    }
+    queued.fetch_sub(1, std::memory_order_relaxed);
+    stolen = i != 0;
+    return true;
+  }
+  return false;
+}
+
+bool JobSystem::popMainThread(job& work) {
+  std::lock_guard<std::mutex> lock(mainMutex);
+  if (mainJobs.empty()) return false;
+  work = std::move(mainJobs.front());
+  mainJobs.pop_front();
+  return true;
+}
+
+void JobSystem::execute(job& work, uint32_t index, bool stolen) {
+  const uint64_t start = now();
+  try {
+    G3D_PROFILE_SCOPE(work.name);
+    work.func();
+  } catch (...) {
+    if (work.counter) {
+      std::lock_guard<std::mutex> lock(work.counter->mutex);
+      if (!work.counter->error) work.counter->error = std::current_exception();
+    } else {
+      std::lock_guard<std::mutex> lock(mainMutex);
+      if (!orphanError) orphanError = std::current_exception();
+    }
+  }
+
+  worker& w = *workers[index];
+  w.busy.fetch_add(now() - start, std::memory_order_relaxed);
+  w.executed.fetch_add(1, std::memory_order_relaxed);
+  count(G3D_COUNTER_JOBS);
+  if (stolen) {
+    w.stolen.fetch_add(1, std::memory_order_relaxed);
+    count(G3D_COUNTER_JOBS_STOLEN);
+  }
+
+  if (work.counter) finish(*work.counter);
+}
+
+void JobSystem::finish(JobCounter& counter) {
+  std::vector<JobCounter::continuation> ready;
+  {
+    std::lock_guard<std::mutex> lock(counter.mutex);
+    if (counter.g_pending.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+    ready.swap(counter.continuations);
+  }
+
+  // Desde acá el contador puede no existir más
+  const uint32_t index = currentWorker();
+  for (JobCounter::continuation& next : ready) push(index, {std::move(next.func), next.counter, next.name});
+
+  { std::lock_guard<std::mutex> lock(sleepMutex); }
+  wake.notify_all();
+}
+
+void JobSystem::workerLoop(uint32_t index) {
+  currentSystem = this;
+  currentIndex = index;
+
+  for (;;) {
+    job work;
+    bool stolen = false;
+    if (pop(index, work, stolen)) {
+      execute(work, index, stolen);
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(sleepMutex);
+    wake.wait(lock, [this] { return stopping || queued.load(std::memory_order_acquire) > 0; });
+    if (stopping && queued.load(std::memory_order_acquire) == 0) return;
+  }
+}
+
+}  // namespace util
+}  // namespace graph3d
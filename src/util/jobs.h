@@ -0,0 +1,157 @@
+#ifndef GRAPH3D_UTIL_JOBS_H_
+#define GRAPH3D_UTIL_JOBS_H_
+
+// Sistema de jobs con robo de trabajo.
+//
+// Cada hilo tiene su propia cola: saca del final lo último que encoló (los datos siguen en su caché) y, cuando
+// se queda sin trabajo, roba del principio de la cola de otro. El hilo principal también tiene cola y trabaja
+// mientras espera en wait(), así que threads() cuenta a todos.
+// Lo que tiene que correr en el hilo principal (GL, en la práctica) va a una cola aparte, runOnMainThread(),
+// que el main loop vacía una vez por frame.
+//
+// Las dependencias se arman con contadores: run() suma uno al contador del job y lo resta al terminar,
+// wait() espera a que llegue a cero y after() encola un job recién cuando otro contador llega a cero.
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace graph3d {
+namespace util {
+
+class JobSystem;
+
+// Trabajo pendiente de un grupo de jobs. Tiene que vivir hasta que wait() vuelva (o hasta que done() sea true).
+// Si un job del grupo lanza una excepción, wait() la vuelve a lanzar
+class JobCounter {
+  friend class JobSystem;
+
+  struct continuation {
+    std::function<void()> func;
+    JobCounter* counter;
+    const char* name;
+  };
+
+  std::atomic<uint32_t> g_pending{0};
+  std::mutex mutex;
+  std::vector<continuation> continuations;
+  std::exception_ptr error;
+
+ public:
+  JobCounter& operator=(const JobCounter&) = delete;
+  JobCounter(const JobCounter&) = delete;
+  JobCounter() {}
+
+  uint32_t pending() const { return g_pending.load(std::memory_order_acquire); }
+  bool done() const { return pending() == 0; }
+};
+
+// Uso de un hilo durante el último frame (entre dos endFrame())
+struct WorkerStats {
+  uint64_t jobs = 0;
+  uint64_t stolen = 0;       // Jobs sacados de la cola de otro hilo
+  double busy = 0;           // Segundos ejecutando jobs
+  double utilization = 0;    // busy / duración del frame
+};
+
+class JobSystem {
+ public:
+  /// Singleton. G3D_JOB_THREADS fija la cantidad de hilos; por defecto, uno por núcleo
+  static JobSystem& getInstance();
+
+ private:
+  struct job {
+    std::function<void()> func;
+    JobCounter* counter;
+    const char* name;
+  };
+
+  struct worker {
+    std::mutex mutex;
+    std::deque<job> jobs;
+
+    std::atomic<uint64_t> executed{0}, stolen{0}, busy{0};
+    uint64_t lastExecuted = 0, lastStolen = 0, lastBusy = 0;
+  };
+
+ private:
+  // El 0 es del hilo principal y de cualquier hilo que no sea del sistema
+  std::vector<std::unique_ptr<worker>> workers;
+  std::vector<std::thread> threadsPool;
+
+  std::atomic<uint32_t> queued{0};
+  std::mutex sleepMutex;
+  std::condition_variable wake;
+  bool stopping = false;
+
+  std::mutex mainMutex;
+  std::deque<job> mainJobs;
+  std::thread::id mainThread;
+
+  // Excepciones de jobs sin contador: salen en el hilo principal, en runMainThreadJobs()
+  std::exception_ptr orphanError;
+
+  mutable std::mutex statsMutex;
+  std::vector<WorkerStats> lastFrame;
+  uint64_t frameStart;
+
+ public:
+  JobSystem& operator=(const JobSystem&) = delete;
+  JobSystem(const JobSystem&) = delete;
+
+  /// 0 = un hilo por núcleo. El hilo que lo crea queda como hilo principal
+  explicit JobSystem(uint32_t threads = 0);
+  ~JobSystem();
+
+  /// Hilos que ejecutan jobs, contando al principal
+  uint32_t threads() const { return static_cast<uint32_t>(workers.size()); }
+
+  /// Encola `func`. Con `counter`, lo suma al grupo; `name` es la zona del profiler (debe ser un literal)
+  void run(std::function<void()> func, JobCounter* counter = nullptr, const char* name = "JobSystem::job");
+
+  /// Encola `func` cuando `dependency` llegue a cero (enseguida, si ya está en cero)
+  void after(JobCounter& dependency, std::function<void()> func, JobCounter* counter = nullptr,
+             const char* name = "JobSystem::job");
+
+  /// Encola `func` para el hilo principal. Se ejecuta en el próximo runMainThreadJobs() o wait() de ese hilo
+  void runOnMainThread(std::function<void()> func, JobCounter* counter = nullptr,
+                       const char* name = "JobSystem::mainThreadJob");
+
+  /// Ejecuta jobs hasta que `counter` llegue a cero, y relanza la primera excepción del grupo
+  void wait(JobCounter& counter);
+
+  /// Llama a func(0..count-1) repartido entre todos los hilos, de a `grain` índices, y espera a que termine
+  void parallelFor(uint32_t count, const std::function<void(uint32_t)>& func, uint32_t grain = 1);
+
+  /// Ejecuta los jobs encolados para el hilo principal. Sólo desde ese hilo
+  uint32_t runMainThreadJobs();
+
+  bool isMainThread() const { return std::this_thread::get_id() == mainThread; }
+
+  /// Cierra el frame de las estadísticas por hilo
+  void endFrame();
+
+  /// Estadísticas del último frame, una por hilo (la 0 es la del principal)
+  std::vector<WorkerStats> stats() const;
+
+ private:
+  uint32_t currentWorker() const;
+  void push(uint32_t index, job&& work);
+  bool pop(uint32_t index, job& work, bool& stolen);
+  bool popMainThread(job& work);
+  void execute(job& work, uint32_t index, bool stolen);
+  void finish(JobCounter& counter);
+  void workerLoop(uint32_t index);
+};
+
+}  // namespace util
+}  // namespace graph3d
+
+#endif
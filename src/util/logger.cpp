@@ -0,0 +1,205 @@
+#include <util/logger.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+namespace graph3d {
+namespace util {
+namespace logger {
+
+namespace {
+
+// Cola acotada de múltiples productores y un único consumidor (Vyukov).
+// Las líneas largas ocupan varios slots consecutivos, reservados juntos; sólo el último lleva `last`
+class line_ring {
+ public:
+  static constexpr size_t capacity = 1024;
+  static constexpr size_t chunkSize = 240;
+
+ private:
+  struct slot {
+    std::atomic<uint64_t> sequence;
+    uint16_t size;
+    bool last;
+    char data[chunkSize];
+  };
+
+  slot slots[capacity];
+  std::atomic<uint64_t> enqueuePos{0};
+  uint64_t dequeuePos = 0;
+
+ public:
+  line_ring() {
+    for (size_t i = 0; i < capacity; i++) slots[i].sequence.store(i, std::memory_order_relaxed);
+  }
+
+  /// Encola una línea entera. Los slots se reservan todos juntos, con un solo CAS, así las líneas largas
+  /// de distintos hilos no se intercalan. Devuelve false si no hay lugar para toda la línea
+  bool push(const char* data, size_t size) {
+    const size_t count = chunks(size);
+    uint64_t pos = enqueuePos.load(std::memory_order_relaxed);
+    for (;;) {
+      int64_t diff = 0;
+      for (size_t i = 0; i < count && diff == 0; i++) {
+        const uint64_t sequence = slots[(pos + i) & (capacity - 1)].sequence.load(std::memory_order_acquire);
+        diff = static_cast<int64_t>(sequence) - static_cast<int64_t>(pos + i);
+      }
+
+      if (diff == 0) {
+        if (enqueuePos.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed)) break;
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = enqueuePos.load(std::memory_order_relaxed);
+      }
+    }
+
+    for (size_t i = 0; i < count; i++) {
+      slot& cell = slots[(pos + i) & (capacity - 1)];
+      const uint16_t chunk = static_cast<uint16_t>(std::min(size, chunkSize));
+      std::memcpy(cell.data, data, chunk);
+      cell.size = chunk;
+      cell.last = i + 1 == count;
+      cell.sequence.store(pos + i + 1, std::memory_order_release);
+      data += chunk;
+      size -= chunk;
+    }
+    return true;
+  }
+
+  /// Slots que ocupa una línea de `size` bytes (una vacía también ocupa uno)
+  static size_t chunks(size_t size) { return std::max<size_t>(1, (size + chunkSize - 1) / chunkSize); }
+
+  template <typename Consumer>
+  bool pop(Consumer&& consumer) {
+    slot& cell = slots[dequeuePos & (capacity - 1)];
+    if (cell.sequence.load(std::memory_order_acquire) != dequeuePos + 1) return false;
+
+    consumer(cell.data, cell.size, cell.last);
+    cell.sequence.store(dequeuePos + capacity, std::memory_order_release);
+    dequeuePos++;
+    return true;
+  }
+
+  uint64_t pushed() const { return enqueuePos.load(std::memory_order_acquire); }
+};
+
+class async_writer {
+  line_ring ring;
+  std::atomic<uint64_t> written{0};
+  std::atomic<bool> running{true};
+  std::atomic<bool> sleeping{false};
+
+  std::mutex mutex;
+  std::condition_variable wakeup;
+  std::thread thread;
+
+  std::terminate_handler previousTerminate;
+
+ public:
+  async_writer() {
+    thread = std::thread(&async_writer::run, this);
+    previousTerminate = std::set_terminate(&async_writer::onTerminate);
+  }
+
+  ~async_writer() {
+    running.store(false, std::memory_order_release);
+    notify();
+    thread.join();
+  }
+
+  static async_writer& getInstance() {
+    static async_writer instance;
+    return instance;
+  }
+
+ public:
+  void write(const char* line, size_t size) {
+    // Una línea que no entra en la cola entera nunca encontraría lugar: se corta
+    size = std::min(size, line_ring::capacity * line_ring::chunkSize);
+
+    while (!ring.push(line, size)) {
+      notify();
+      std::this_thread::yield();
+    }
+
+    if (sleeping.load(std::memory_order_acquire)) notify();
+  }
+
+  void flush() {
+    // El hilo escritor no puede esperarse a sí mismo: vacía la cola directamente (es el único consumidor)
+    if (std::this_thread::get_id() == thread.get_id()) {
+      drain();
+      std::clog.flush();
+      return;
+    }
+
+    const uint64_t target = ring.pushed();
+    while (written.load(std::memory_order_acquire) < target) {
+      notify();
+      std::this_thread::yield();
+    }
+    std::clog.flush();
+  }
+
+ private:
+  void notify() {
+    std::lock_guard<std::mutex> lock(mutex);
+    wakeup.notify_one();
+  }
+
+  bool drain() {
+    bool any = false;
+    while (ring.pop([](const char* data, uint16_t size, bool last) {
+      std::clog.write(data, size);
+      if (last) std::clog.put('\n');
+    })) {
+      written.fetch_add(1, std::memory_order_release);
+      any = true;
+    }
+    return any;
+  }
+
+  void run() {
+    while (running.load(std::memory_order_acquire)) {
+      if (drain()) continue;
+
+      // No se fuerza el flush por línea, sólo cuando la cola queda vacía
+      std::clog.flush();
+
+      std::unique_lock<std::mutex> lock(mutex);
+      sleeping.store(true, std::memory_order_release);
+      wakeup.wait_for(lock, std::chrono::milliseconds(10));
+      sleeping.store(false, std::memory_order_release);
+    }
+
+    drain();
+    std::clog.flush();
+  }
+
+  // Puede dispararse en cualquier hilo, también en el escritor: flush() no lo espera en ese caso
+  static void onTerminate() {
+    async_writer& writer = getInstance();
+    writer.flush();
+    if (writer.previousTerminate) writer.previousTerminate();
+    std::abort();
+  }
+};
+
+}  // namespace
+
+void write(const char* line, size_t size) { async_writer::getInstance().write(line, size); }
+
+void flush() { async_writer::getInstance().flush(); }
+
+}  // namespace logger
+}  // namespace util
+}  // namespace graph3d
@@ -1,19 +1,111 @@
 #ifndef GRAPH3D_UTIL_LOGGER_H_
 #define GRAPH3D_UTIL_LOGGER_H_
 
-#include <iostream>
+#include <cstddef>
+#include <memory>
+#include <ostream>
+#include <streambuf>
 #include <string>
+#include <vector>
 
 extern int graph3d_log_level;
 
 namespace graph3d {
 namespace util {
+namespace logger {
 
-inline void log(const std::string info, int level = 4) {
-  if (graph3d_log_level >= level) std::clog << info << std::endl;
+// Las líneas se arman en un buffer por hilo, que conserva su capacidad entre líneas,
+// y se entregan a un hilo escritor que es el único que toca std::clog
+class line_buffer : public std::streambuf {
+  std::string line;
+
+ protected:
+  int_type overflow(int_type ch) override {
+    if (!traits_type::eq_int_type(ch, traits_type::eof())) line.push_back(traits_type::to_char_type(ch));
+    return ch;
+  }
+
+  std::streamsize xsputn(const char* str, std::streamsize count) override {
+    line.append(str, static_cast<size_t>(count));
+    return count;
+  }
+
+ public:
+  std::string& str() { return line; }
+};
+
+struct line_stream {
+  line_buffer buffer;
+  std::ostream stream{&buffer};
+};
+
+/// Encola una línea completa (sin el salto de línea final)
+void write(const char* line, size_t size);
+
+// Un G3D_LOG puede ejecutarse mientras se arma otro (una función llamada desde el mensaje que también loguea):
+// cada nivel de anidamiento tiene su propio buffer, así el de afuera no pierde lo que ya escribió
+class line_stack {
+  std::vector<std::unique_ptr<line_stream>> streams;
+  size_t depth = 0;
+
+ public:
+  line_stream& push() {
+    if (depth == streams.size()) streams.emplace_back(new line_stream());
+    line_stream& lineStream = *streams[depth++];
+    lineStream.buffer.str().clear();
+    lineStream.stream.clear();
+    return lineStream;
+  }
+
+  void pop() { depth--; }
+};
+
+inline line_stack& getLineStack() {
+  thread_local line_stack lineStack;
+  return lineStack;
+}
+
+/// Una línea en construcción: se escribe con commit() y el buffer se libera al salir del scope
+class line_scope {
+  line_stream& lineStream;
+
+ public:
+  line_scope() : lineStream(getLineStack().push()) {}
+  ~line_scope() { getLineStack().pop(); }
+  line_scope& operator=(const line_scope&) = delete;
+  line_scope(const line_scope&) = delete;
+
+  std::ostream& stream() { return lineStream.stream; }
+
+  void commit() {
+    const std::string& line = lineStream.buffer.str();
+    write(line.data(), line.size());
+  }
+};
+
+/// Bloquea hasta que todo lo encolado hasta ahora esté escrito en std::clog
+void flush();
+
+}  // namespace logger
+
+inline bool logEnabled(int level) { return graph3d_log_level >= level; }
+
+inline void log(const std::string& info, int level = 4) {
+  if (logEnabled(level)) logger::write(info.data(), info.size());
 }
 
 }  // namespace util
 }  // namespace graph3d
 
-#endif
\ No newline at end of file
+// El mensaje se evalúa sólo si el nivel está habilitado:
+//   G3D_LOG(3, "> Cargar shader: " << path.generic_string());
+#define G3D_LOG(level, message)                         \
+  do {                                                  \
+    if (::graph3d::util::logEnabled(level)) {           \
+      ::graph3d::util::logger::line_scope g3dLogLine;   \
+      g3dLogLine.stream() << message;                   \
+      g3dLogLine.commit();                              \
+    }                                                   \
+  } while (0)
+
+#endif
@@ -0,0 +1,149 @@
+#include <util/lz4.h>
+
+#include <cstring>
+
+namespace graph3d {
+namespace util {
+
+namespace {
+
+constexpr size_t minMatch = 4;
+constexpr size_t lastLiterals = 5;  // El bloque termina con al menos 5 literales
+constexpr size_t matchFence = 12;   // y la última repetición empieza al menos 12 bytes antes del final
+constexpr size_t maxOffset = 65535;
+constexpr int hashBits = 12;
+
+uint32_t read32(const uint8_t* p) {
+  uint32_t value;
+  std::memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+uint32_t hashSequence(uint32_t sequence) { return (sequence * 2654435761u) >> (32 - hashBits); }
+
+// Largo de 4 bits en el token y, si no alcanza, el resto en bytes de 255
+uint8_t* writeLength(uint8_t* op, size_t length) {
+  for (length -= 15; length >= 255; length -= 255) *op++ = 255;
+  *op++ = static_cast<uint8_t>(length);
+  return op;
+}
+
+bool readLength(const uint8_t*& ip, const uint8_t* end, size_t& length) {
+  uint8_t byte;
+  do {
+    if (ip >= end) return false;
+    byte = *ip++;
+    length += byte;
+  } while (byte == 255);
+  return true;
+}
+
+// Peor caso de una secuencia: token, largos extendidos, literales y offset
+size_t sequenceBound(size_t literals, size_t match) { return 1 + literals / 255 + 1 + literals + 2 + match / 255 + 1; }
+
+}  // namespace
+
+size_t lz4Bound(size_t size) { return size + size / 255 + 16; }
+
+size_t lz4MaxDecompressed(size_t size) { return size * 255; }
+
+size_t lz4Compress(const uint8_t* source, size_t size, uint8_t* out, size_t capacity) {
+  const uint8_t* const end = source + size;
+  const uint8_t* anchor = source;
+  uint8_t* op = out;
+
+  if (size > matchFence) {
+    uint32_t table[1 << hashBits] = {};
+    const uint8_t* const matchLimit = end - lastLiterals;
+    const uint8_t* const fence = end - matchFence;
+    const uint8_t* ip = source + 1;
+
+    while (ip <= fence) {
+      const uint32_t sequence = read32(ip);
+      uint32_t& slot = table[hashSequence(sequence)];
+      const uint8_t* ref = source + slot;
+      slot = static_cast<uint32_t>(ip - source);
+
+      if (ref >= ip || static_cast<size_t>(ip - ref) > maxOffset || read32(ref) != sequence) {
+        // Sin repeticiones a la vista, cada vez se salta más: los datos que no comprimen se recorren rápido
+        ip += 1 + ((ip - anchor) >> 6);
+        continue;
+      }
+
+      while (ip > anchor && ref > source && ip[-1] == ref[-1]) {
+        ip--;
+        ref--;
+      }
+      const uint8_t* matchEnd = ip + minMatch;
+      for (const uint8_t* r = ref + minMatch; matchEnd < matchLimit && *matchEnd == *r; r++) matchEnd++;
+
+      const size_t literals = static_cast<size_t>(ip - anchor);
+      const size_t match = static_cast<size_t>(matchEnd - ip) - minMatch;
+      if (sequenceBound(literals, match) > static_cast<size_t>(out + capacity - op)) return 0;
+
+      uint8_t* token = op++;
+      *token = static_cast<uint8_t>((literals < 15 ? literals : 15) << 4);
+      if (literals >= 15) op = writeLength(op, literals);
+      std::memcpy(op, anchor, literals);
+      op += literals;
+
+      const size_t offset = static_cast<size_t>(ip - ref);
+      *op++ = static_cast<uint8_t>(offset);
+      *op++ = static_cast<uint8_t>(offset >> 8);
+      *token |= static_cast<uint8_t>(match < 15 ? match : 15);
+      if (match >= 15) op = writeLength(op, match);
+
+      ip = anchor = matchEnd;
+      if (ip - 2 > source) table[hashSequence(read32(ip - 2))] = static_cast<uint32_t>(ip - 2 - source);
+    }
+  }
+
+  const size_t literals = static_cast<size_t>(end - anchor);
+  if (sequenceBound(literals, 0) > static_cast<size_t>(out + capacity - op)) return 0;
+  *op++ = static_cast<uint8_t>((literals < 15 ? literals : 15) << 4);
+  if (literals >= 15) op = writeLength(op, literals);
+  if (literals) std::memcpy(op, anchor, literals);
+  op += literals;
+  return static_cast<size_t>(op - out);
+}
+
+bool lz4Decompress(const uint8_t* source, size_t sourceSize, uint8_t* out, size_t size) {
+  const uint8_t* ip = source;
+  const uint8_t* const end = source + sourceSize;
+  uint8_t* op = out;
+  uint8_t* const outEnd = out + size;
+
+  while (ip < end) {
+    const uint8_t token = *ip++;
+    size_t literals = token >> 4;
+    if (literals == 15 && !readLength(ip, end, literals)) return false;
+    if (literals > static_cast<size_t>(end - ip) || literals > static_cast<size_t>(outEnd - op)) return false;
+    if (literals) std::memcpy(op, ip, literals);
+    op += literals;
+    ip += literals;
+    if (ip == end) break;  // La última secuencia son sólo literales
+
+    if (end - ip < 2) return false;
+    const size_t offset = ip[0] | static_cast<size_t>(ip[1]) << 8;
+    ip += 2;
+    if (offset == 0 || offset > static_cast<size_t>(op - out)) return false;
+
+    size_t match = token & 15;
+    if (match == 15 && !readLength(ip, end, match)) return false;
+    match += minMatch;
+    if (match > static_cast<size_t>(outEnd - op)) return false;
+
+    // Una repetición puede pisarse a sí misma (offset < largo): ahí se copia de a un byte
+    const uint8_t* ref = op - offset;
+    if (offset >= match) {
+      std::memcpy(op, ref, match);
+      op += match;
+    } else {
+      for (size_t i = 0; i < match; i++) *op++ = *ref++;
+    }
+  }
+  return op == outEnd;
+}
+
+}  // namespace util
+}  // namespace graph3d
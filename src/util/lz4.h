@@ -0,0 +1,30 @@
+#ifndef GRAPH3D_UTIL_LZ4_H_
+#define GRAPH3D_UTIL_LZ4_H_
+
+// Compresión LZ4, formato de bloque (sin el marco de lz4 ni checksums), compatible con la biblioteca de referencia.
+//
+// El compresor es el rápido: una tabla de hash de 4 bytes y saltos cada vez más largos donde no encuentra
+// repeticiones. Descomprimir es copiar literales y repeticiones, que es lo que importa al leer recursos.
+
+#include <cstddef>
+#include <cstdint>
+
+namespace graph3d {
+namespace util {
+
+/// Bytes de salida que alcanzan para comprimir `size` bytes en el peor caso
+size_t lz4Bound(size_t size);
+
+/// Comprime `size` bytes en `out`. Devuelve los bytes escritos, o 0 si no entran en `capacity`
+size_t lz4Compress(const uint8_t* source, size_t size, uint8_t* out, size_t capacity);
+
+/// Lo más que pueden dar `size` bytes comprimidos: cada byte de un largo extendido vale 255
+size_t lz4MaxDecompressed(size_t size);
+
+/// Descomprime un bloque que tiene que dar exactamente `size` bytes. false si está dañado
+bool lz4Decompress(const uint8_t* source, size_t sourceSize, uint8_t* out, size_t size);
+
+}  // namespace util
+}  // namespace graph3d
+
+#endif
@@ -0,0 +1,100 @@
+#include <util/mapped_file.h>
+
+#include <util/asset_pack.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace graph3d {
+namespace util {
+
+std::shared_ptr<MappedFile> MappedFile::open(const std::string& path) {
+  std::string name;
+  if (std::shared_ptr<AssetPack> pack = AssetPack::find(path, name)) return pack->read(name);
+  return map(path, true);
+}
+
+std::shared_ptr<MappedFile> MappedFile::map(const std::string& path, bool readAhead) {
+  std::shared_ptr<MappedFile> file(new MappedFile());
+
+#ifdef _WIN32
+  HANDLE handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | (readAhead ? FILE_FLAG_SEQUENTIAL_SCAN : 0), nullptr);
+  if (handle == INVALID_HANDLE_VALUE) return nullptr;
+
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(handle, &size) || size.QuadPart == 0) {
+    CloseHandle(handle);
+    return nullptr;
+  }
+
+  // El mapeo mantiene el archivo abierto, así que el handle se puede cerrar enseguida
+  file->mapping = CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  CloseHandle(handle);
+  if (!file->mapping) return nullptr;
+
+  file->g_data = static_cast<const unsigned char*>(MapViewOfFile(file->mapping, FILE_MAP_READ, 0, 0, 0));
+  if (!file->g_data) return nullptr;
+  file->g_size = static_cast<size_t>(size.QuadPart);
+#else
+  const int descriptor = ::open(path.c_str(), O_RDONLY);
+  if (descriptor < 0) return nullptr;
+
+  struct stat info;
+  if (fstat(descriptor, &info) != 0 || info.st_size <= 0) {
+    ::close(descriptor);
+    return nullptr;
+  }
+
+  void* data = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, descriptor, 0);
+  ::close(descriptor);
+  if (data == MAP_FAILED) return nullptr;
+
+  // Se va a leer entero y en orden (la subida a GL): que el sistema adelante la lectura
+  if (readAhead) madvise(data, static_cast<size_t>(info.st_size), MADV_WILLNEED);
+  file->g_data = static_cast<const unsigned char*>(data);
+  file->g_size = static_cast<size_t>(info.st_size);
+#endif
+
+  return file;
+}
+
+std::shared_ptr<MappedFile> MappedFile::view(const unsigned char* data, size_t size,
+                                             std::shared_ptr<const void> owner) {
+  std::shared_ptr<MappedFile> file(new MappedFile());
+  file->g_data = data;
+  file->g_size = size;
+  file->g_owner = std::move(owner);
+  return file;
+}
+
+void MappedFile::prefetch(size_t offset, size_t size) const {
+#ifndef _WIN32
+  // madvise quiere direcciones alineadas a página
+  static const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  const size_t first = offset & ~(page - 1);
+  madvise(const_cast<unsigned char*>(g_data) + first, offset + size - first, MADV_WILLNEED);
+#else
+  (void)offset;
+  (void)size;
+#endif
+}
+
+MappedFile::~MappedFile() {
+  if (g_owner) return;
+#ifdef _WIN32
+  if (g_data) UnmapViewOfFile(g_data);
+  if (mapping) CloseHandle(mapping);
+#else
+  if (g_data) munmap(const_cast<unsigned char*>(g_data), g_size);
+#endif
+}
+
+}  // namespace util
+}  // namespace graph3d
@@ -0,0 +1,50 @@
+#ifndef GRAPH3D_UTIL_MAPPED_FILE_H_
+#define GRAPH3D_UTIL_MAPPED_FILE_H_
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace graph3d {
+namespace util {
+
+// Archivo mapeado en memoria, de sólo lectura. Las páginas las carga el sistema a medida que se leen y, como
+// están respaldadas por el archivo, las puede descartar sin escribirlas al swap.
+// Una ruta dentro de un paquete montado (util/asset_pack.h) se abre como una vista de ese paquete
+class MappedFile {
+  const unsigned char* g_data = nullptr;
+  size_t g_size = 0;
+  std::shared_ptr<const void> g_owner;  // En una vista, lo que mantiene vivos los datos (el paquete o un buffer)
+#ifdef _WIN32
+  void* mapping = nullptr;
+#endif
+
+  MappedFile() {}
+
+  friend class AssetPack;
+
+  // Con `readAhead`, pide al sistema que lea el archivo entero por adelantado
+  static std::shared_ptr<MappedFile> map(const std::string& path, bool readAhead);
+
+  // Vista de `size` bytes en `data`, que viven mientras viva `owner`
+  static std::shared_ptr<MappedFile> view(const unsigned char* data, size_t size, std::shared_ptr<const void> owner);
+
+  // Pide por adelantado las páginas de [offset, offset + size)
+  void prefetch(size_t offset, size_t size) const;
+
+ public:
+  MappedFile& operator=(const MappedFile&) = delete;
+  MappedFile(const MappedFile&) = delete;
+  ~MappedFile();
+
+  /// nullptr si el archivo no existe, está vacío o no se puede mapear
+  static std::shared_ptr<MappedFile> open(const std::string& path);
+
+  const unsigned char* data() const { return g_data; }
+  size_t size() const { return g_size; }
+};
+
+}  // namespace util
+}  // namespace graph3d
+
+#endif
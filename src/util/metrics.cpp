@@ -0,0 +1,98 @@
+#include <util/metrics.h>
+
+namespace graph3d {
+namespace util {
+
+const char* getCounterName(Counter counter) {
+  switch (counter) {
+    case G3D_COUNTER_DRAW_CALLS:
+      return "drawCalls";
+    case G3D_COUNTER_TRIANGLES:
+      return "triangles";
+    case G3D_COUNTER_VERTICES:
+      return "vertices";
+    case G3D_COUNTER_PROGRAM_BINDS:
+      return "programBinds";
+    case G3D_COUNTER_VAO_BINDS:
+      return "vaoBinds";
+    case G3D_COUNTER_TEXTURE_BINDS:
+      return "textureBinds";
+    case G3D_COUNTER_UNIFORM_UPLOADS:
+      return "uniformUploads";
+    case G3D_COUNTER_BUFFER_BYTES_UPLOADED:
+      return "bufferBytesUploaded";
+    case G3D_COUNTER_TEXTURE_BYTES_UPLOADED:
+      return "textureBytesUploaded";
+    case G3D_COUNTER_CULLED_OBJECTS:
+      return "culledObjects";
+    case G3D_COUNTER_JOBS:
+      return "jobs";
+    case G3D_COUNTER_JOBS_STOLEN:
+      return "jobsStolen";
+    default:
+      return "";
+  }
+}
+
+const char* getGaugeName(Gauge gauge) {
+  switch (gauge) {
+    case G3D_GAUGE_MODELS:
+      return "models";
+    case G3D_GAUGE_MESHES:
+      return "meshes";
+    case G3D_GAUGE_TEXTURES:
+      return "textures";
+    case G3D_GAUGE_BUFFER_MEMORY:
+      return "bufferMemory";
+    case G3D_GAUGE_TEXTURE_MEMORY:
+      return "textureMemory";
+    default:
+      return "";
+  }
+}
+
+void Metrics::endFrame(double frameTime) {
+  std::lock_guard<std::mutex> lock(mutex);
+
+  lastFrame.frame++;
+  lastFrame.frameTime = frameTime;
+  for (int i = 0; i < G3D_COUNTER_COUNT; i++) lastFrame.counters[i] = counters[i].exchange(0, std::memory_order_relaxed);
+  for (int i = 0; i < G3D_GAUGE_COUNT; i++) lastFrame.gauges[i] = gauges[i].load(std::memory_order_relaxed);
+
+  if (exportPeriod && lastFrame.frame % exportPeriod == 0) {
+    writeJson(exportFile, lastFrame);
+    exportFile << '\n';
+  }
+}
+
+MetricsSnapshot Metrics::snapshot() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return lastFrame;
+}
+
+bool Metrics::exportTo(const std::string& path, uint32_t period) {
+  std::lock_guard<std::mutex> lock(mutex);
+
+  if (exportFile.is_open()) exportFile.close();
+  exportPeriod = 0;
+  if (!period) return true;
+
+  exportFile.open(path, std::ios::out | std::ios::trunc);
+  if (!exportFile.is_open()) return false;
+
+  exportPeriod = period;
+  return true;
+}
+
+void Metrics::writeJson(std::ostream& out, const MetricsSnapshot& snapshot) {
+  out << "{\"frame\":" << snapshot.frame << ",\"frameTime\":" << snapshot.frameTime << ",\"counters\":{";
+  for (int i = 0; i < G3D_COUNTER_COUNT; i++)
+    out << (i ? "," : "") << '"' << getCounterName(static_cast<Counter>(i)) << "\":" << snapshot.counters[i];
+  out << "},\"gauges\":{";
+  for (int i = 0; i < G3D_GAUGE_COUNT; i++)
+    out << (i ? "," : "") << '"' << getGaugeName(static_cast<Gauge>(i)) << "\":" << snapshot.gauges[i];
+  out << "}}";
+}
+
+}  // namespace util
+}  // namespace graph3d
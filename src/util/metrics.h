@@ -0,0 +1,97 @@
+#ifndef GRAPH3D_UTIL_METRICS_H_
+#define GRAPH3D_UTIL_METRICS_H_
+
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+
+namespace graph3d {
+namespace util {
+
+// Contadores por frame: vuelven a cero al terminar cada frame
+enum Counter {
+  G3D_COUNTER_DRAW_CALLS,
+  G3D_COUNTER_TRIANGLES,
+  G3D_COUNTER_VERTICES,
+  G3D_COUNTER_PROGRAM_BINDS,
+  G3D_COUNTER_VAO_BINDS,
+  G3D_COUNTER_TEXTURE_BINDS,
+  G3D_COUNTER_UNIFORM_UPLOADS,
+  G3D_COUNTER_BUFFER_BYTES_UPLOADED,
+  G3D_COUNTER_TEXTURE_BYTES_UPLOADED,
+  G3D_COUNTER_CULLED_OBJECTS,
+  G3D_COUNTER_JOBS,
+  G3D_COUNTER_JOBS_STOLEN,
+  G3D_COUNTER_COUNT
+};
+
+// Gauges: valores vivos, que se mantienen entre frames
+enum Gauge {
+  G3D_GAUGE_MODELS,
+  G3D_GAUGE_MESHES,
+  G3D_GAUGE_TEXTURES,
+  G3D_GAUGE_BUFFER_MEMORY,
+  G3D_GAUGE_TEXTURE_MEMORY,
+  G3D_GAUGE_COUNT
+};
+
+const char* getCounterName(Counter counter);
+const char* getGaugeName(Gauge gauge);
+
+struct MetricsSnapshot {
+  uint64_t frame = 0;
+  double frameTime = 0;
+  uint64_t counters[G3D_COUNTER_COUNT] = {};
+  int64_t gauges[G3D_GAUGE_COUNT] = {};
+};
+
+class Metrics {
+ public:
+  /// Singleton
+  static Metrics& getInstance() {
+    static Metrics instance;
+    return instance;
+  }
+
+ private:
+  std::atomic<uint64_t> counters[G3D_COUNTER_COUNT] = {};
+  std::atomic<int64_t> gauges[G3D_GAUGE_COUNT] = {};
+
+  mutable std::mutex mutex;
+  MetricsSnapshot lastFrame;
+
+  std::ofstream exportFile;
+  uint32_t exportPeriod = 0;
+
+  Metrics() {}
+
+ public:
+  Metrics& operator=(const Metrics&) = delete;
+  Metrics(const Metrics&) = delete;
+
+ public:
+  void add(Counter counter, uint64_t amount = 1) { counters[counter].fetch_add(amount, std::memory_order_relaxed); }
+  void add(Gauge gauge, int64_t amount) { gauges[gauge].fetch_add(amount, std::memory_order_relaxed); }
+  void set(Gauge gauge, int64_t value) { gauges[gauge].store(value, std::memory_order_relaxed); }
+
+  /// Cierra el frame actual: guarda sus contadores como último snapshot y los reinicia
+  void endFrame(double frameTime);
+
+  /// Último frame completo
+  MetricsSnapshot snapshot() const;
+
+  /// Escribe un snapshot en formato JSON lines cada `period` frames. Con `period` 0 se deja de exportar
+  bool exportTo(const std::string& path, uint32_t period);
+
+  static void writeJson(std::ostream& out, const MetricsSnapshot& snapshot);
+};
+
+inline void count(Counter counter, uint64_t amount = 1) { Metrics::getInstance().add(counter, amount); }
+inline void track(Gauge gauge, int64_t amount) { Metrics::getInstance().add(gauge, amount); }
+
+}  // namespace util
+}  // namespace graph3d
+
+#endif
@@ -0,0 +1,200 @@
+#include <util/mipmaps.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include <software/simd.h>
+#include <util/jobs.h>
+#include <util/profiler.h>
+
+namespace graph3d {
+namespace util {
+
+namespace {
+
+using software::float4;
+
+constexpr int kaiserTaps = 8;
+
+const float* srgbTable() {
+  static const std::vector<float> table = [] {
+    std::vector<float> values(256);
+    for (int i = 0; i < 256; i++) {
+      const float c = i / 255.f;
+      values[i] = c <= .04045f ? c / 12.92f : std::pow((c + .055f) / 1.055f, 2.4f);
+    }
+    return values;
+  }();
+  return table.data();
+}
+
+// Con 4096 entradas, el error de redondeo queda por debajo de medio escalón de 8 bits
+const uint8_t* linearTable() {
+  static const std::vector<uint8_t> table = [] {
+    std::vector<uint8_t> values(4097);
+    for (int i = 0; i <= 4096; i++) {
+      const float c = i / 4096.f;
+      const float s = c <= .0031308f ? c * 12.92f : 1.055f * std::pow(c, 1 / 2.4f) - .055f;
+      values[i] = static_cast<uint8_t>(std::lround(std::clamp(s, 0.f, 1.f) * 255));
+    }
+    return values;
+  }();
+  return table.data();
+}
+
+// Pesos para bajar a la mitad: el texel de destino x cae entre los de origen 2x y 2x+1, a medio texel de cada uno
+const float* kaiserWeights() {
+  static const std::vector<float> weights = [] {
+    auto bessel = [](float x) {
+      float sum = 1, term = 1;
+      for (int k = 1; k < 16; k++) {
+        term *= (x / (2 * k)) * (x / (2 * k));
+        sum += term;
+      }
+      return sum;
+    };
+    const float alpha = 4, pi = 3.14159265f;
+    std::vector<float> values(kaiserTaps);
+    float total = 0;
+    for (int i = 0; i < kaiserTaps; i++) {
+      const float distance = std::fabs(i - (kaiserTaps / 2 - 1) - .5f);
+      const float x = pi * distance / 2;
+      const float sinc = x == 0 ? 1 : std::sin(x) / x;
+      const float ratio = distance / (kaiserTaps / 2);
+      const float window = bessel(alpha * std::sqrt(std::max(0.f, 1 - ratio * ratio))) / bessel(alpha);
+      values[i] = sinc * window;
+      total += values[i];
+    }
+    for (float& value : values) value /= total;
+    return values;
+  }();
+  return weights.data();
+}
+
+struct level_view {
+  const uint8_t* pixels;
+  uint32_t width, height;
+};
+
+class Downsampler {
+  const MipOptions& options;
+  const uint32_t channels;
+  const uint32_t colorChannels;  // Los primeros, que están en sRGB si options.srgb
+
+ public:
+  Downsampler(const MipOptions& options, uint32_t channels)
+      : options(options),
+        channels(channels),
+        colorChannels(options.srgb ? (channels == 2 ? 1 : std::min(channels, 3u)) : 0) {}
+
+  // Fila `y` de `target` a partir de `source`. `columns` es espacio para source.width texels
+  void row(const level_view& source, uint8_t* target, uint32_t targetWidth, uint32_t y, float4* columns) const {
+    const bool kaiser = options.filter == G3D_MIP_KAISER;
+    const int taps = kaiser ? kaiserTaps : 2;
+    const float* weights = kaiser ? kaiserWeights() : nullptr;
+    const int first = kaiser ? -(kaiserTaps / 2 - 1) : 0;
+
+    // Columnas: las filas de origen del texel de destino, combinadas
+    for (uint32_t x = 0; x < source.width; x++) columns[x] = float4::set(0);
+    for (int i = 0; i < taps; i++) {
+      const uint8_t* line = source.pixels + static_cast<size_t>(address(2 * y + first + i, source.height, kaiser)) *
+                                                source.width * channels;
+      const float4 weight = float4::set(kaiser ? weights[i] : .5f);
+      for (uint32_t x = 0; x < source.width; x++) columns[x] = columns[x] + load(line + x * channels) * weight;
+    }
+
+    // Filas
+    for (uint32_t x = 0; x < targetWidth; x++) {
+      float4 sum = float4::set(0);
+      for (int i = 0; i < taps; i++) {
+        const float4 weight = float4::set(kaiser ? weights[i] : .5f);
+        sum = sum + columns[address(2 * x + first + i, source.width, kaiser)] * weight;
+      }
+      store(sum, target + x * channels);
+    }
+  }
+
+ private:
+  // GL_REPEAT para Kaiser; con el box, un eje impar repite el último texel
+  static uint32_t address(int64_t index, uint32_t size, bool wrap) {
+    if (wrap) {
+      index %= static_cast<int64_t>(size);
+      return static_cast<uint32_t>(index < 0 ? index + size : index);
+    }
+    return static_cast<uint32_t>(std::min<int64_t>(std::max<int64_t>(index, 0), size - 1));
+  }
+
+  float4 load(const uint8_t* texel) const {
+    const float* srgb = srgbTable();
+    float values[4] = {0, 0, 0, 0};
+    for (uint32_t c = 0; c < channels; c++) values[c] = c < colorChannels ? srgb[texel[c]] : texel[c] * (1 / 255.f);
+    return float4::load(values);
+  }
+
+  void store(const float4& value, uint8_t* texel) const {
+    float values[4];
+    value.store(values);
+
+    if (options.normalMap && channels >= 3) {
+      float n[3], length = 0;
+      for (int c = 0; c < 3; c++) {
+        n[c] = values[c] * 2 - 1;
+        length += n[c] * n[c];
+      }
+      length = length > 0 ? 1 / std::sqrt(length) : 0;
+      for (int c = 0; c < 3; c++) values[c] = n[c] * length * .5f + .5f;
+    }
+
+    const uint8_t* linear = linearTable();
+    for (uint32_t c = 0; c < channels; c++) {
+      const float v = std::clamp(values[c], 0.f, 1.f);
+      texel[c] = c < colorChannels ? linear[static_cast<int>(v * 4096 + .5f)]
+                                   : static_cast<uint8_t>(v * 255 + .5f);
+    }
+  }
+};
+
+}  // namespace
+
+float srgbToLinear(uint8_t value) { return srgbTable()[value]; }
+
+uint8_t linearToSrgb(float value) { return linearTable()[static_cast<int>(std::clamp(value, 0.f, 1.f) * 4096 + .5f)]; }
+
+MipChain generateMips(const uint8_t* pixels, uint32_t width, uint32_t height, uint32_t channels,
+                      const MipOptions& options) {
+  G3D_PROFILE_SCOPE("generateMips");
+  MipChain chain;
+  size_t total = 0;
+  for (uint32_t w = width, h = height; w > 1 || h > 1;) {
+    w = std::max(w / 2, 1u);
+    h = std::max(h / 2, 1u);
+    chain.levels.push_back({total, w, h});
+    total += static_cast<size_t>(w) * h * channels;
+  }
+  chain.data.resize(total);
+
+  const Downsampler downsampler(options, channels);
+  JobSystem& jobs = JobSystem::getInstance();
+  level_view source{pixels, width, height};
+  for (const MipLevel& level : chain.levels) {
+    uint8_t* target = chain.data.data() + level.offset;
+    const size_t stride = static_cast<size_t>(level.width) * channels;
+
+    // Bloques de filas de al menos ~16K texels, así los jobs no cuestan más que el trabajo
+    const uint32_t grain = std::max(1u, 16384 / std::max(level.width, 1u));
+    jobs.parallelFor(
+        level.height,
+        [&](uint32_t y) {
+          thread_local std::vector<float4> columns;
+          if (columns.size() < source.width) columns.resize(source.width);
+          downsampler.row(source, target + y * stride, level.width, y, columns.data());
+        },
+        grain);
+
+    source = {target, level.width, level.height};
+  }
+  return chain;
+}
+
+}  // namespace util
+}  // namespace graph3d
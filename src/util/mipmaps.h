@@ -0,0 +1,52 @@
+#ifndef GRAPH3D_UTIL_MIPMAPS_H_
+#define GRAPH3D_UTIL_MIPMAPS_H_
+
+// Cadena de mipmaps en CPU, para no depender de glGenerateMipmap (que filtra en el hilo de GL y sin saber si los
+// texels están en sRGB).
+//
+// Cada nivel sale del anterior con un filtro separable: primero las columnas, después las filas, de a cuatro
+// canales por operación (software/simd.h). Las filas de cada nivel se reparten entre los hilos del sistema de jobs.
+// Los canales de color en sRGB se pasan a lineal para filtrar y vuelven a sRGB al guardar; el alfa siempre es lineal.
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace graph3d {
+namespace util {
+
+enum MipFilter {
+  G3D_MIP_BOX,     // Promedio de 2x2, como glGenerateMipmap
+  G3D_MIP_KAISER,  // Sinc con ventana de Kaiser, 8 taps por eje: más nítido, con GL_REPEAT en los bordes
+};
+
+struct MipOptions {
+  bool srgb = false;       // Color en sRGB (1 o 3 canales de color; el 2 de una imagen de 2 canales es alfa)
+  bool normalMap = false;  // Normales en [0, 1]: se renormalizan después de filtrar
+  MipFilter filter = G3D_MIP_BOX;
+};
+
+struct MipLevel {
+  size_t offset;
+  uint32_t width, height;
+};
+
+// Niveles del 1 en adelante, hasta 1x1: el 0 es la imagen original
+struct MipChain {
+  std::vector<MipLevel> levels;
+  std::vector<uint8_t> data;
+
+  size_t getMemory() const { return data.size(); }
+};
+
+/// Mipmaps de una imagen de 8 bits por canal (1 a 4 canales)
+MipChain generateMips(const uint8_t* pixels, uint32_t width, uint32_t height, uint32_t channels,
+                      const MipOptions& options);
+
+float srgbToLinear(uint8_t value);
+uint8_t linearToSrgb(float value);
+
+}  // namespace util
+}  // namespace graph3d
+
+#endif
@@ -0,0 +1,79 @@
+#include <util/profiler.h>
+
+#ifdef G3D_PROFILING
+
+#include <fstream>
+#include <iomanip>
+
+namespace graph3d {
+namespace util {
+namespace profiler {
+
+// Lista de buffers de todos los hilos. Sólo crece, así los datos de hilos
+// que ya terminaron siguen disponibles al exportar
+static std::atomic<thread_buffer*> buffers{nullptr};
+static std::atomic<uint32_t> lastThreadId{0};
+
+thread_buffer& getThreadBuffer() {
+  thread_local thread_buffer* buffer = nullptr;
+  if (buffer) return *buffer;
+
+  buffer = new thread_buffer();
+  buffer->threadId = lastThreadId.fetch_add(1, std::memory_order_relaxed);
+
+  thread_buffer* head = buffers.load(std::memory_order_relaxed);
+  do {
+    buffer->next = head;
+  } while (!buffers.compare_exchange_weak(head, buffer, std::memory_order_release, std::memory_order_relaxed));
+
+  return *buffer;
+}
+
+static void writeEscaped(std::ofstream& out, const char* str) {
+  for (; *str; ++str) {
+    if (*str == '"' || *str == '\\') out << '\\';
+    out << *str;
+  }
+}
+
+bool exportChromeTrace(const std::string& path) {
+  std::ofstream out(path);
+  if (!out.is_open()) return false;
+
+  bool first = true;
+  out << std::fixed << std::setprecision(3);
+  out << "{\"traceEvents\":[";
+
+  for (thread_buffer* buffer = buffers.load(std::memory_order_acquire); buffer; buffer = buffer->next) {
+    const uint32_t count = buffer->count.load(std::memory_order_acquire);
+
+    for (uint32_t i = 0; i < count; i++) {
+      const zone_event& event = buffer->events[i];
+      out << (first ? "\n" : ",\n") << "{\"name\":\"";
+      writeEscaped(out, event.name);
+      out << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->threadId << ",\"ts\":" << event.begin / 1000.
+          << ",\"dur\":" << (event.end - event.begin) / 1000.;
+#ifdef G3D_ALLOC_TRACKING
+      out << ",\"args\":{\"allocations\":" << event.allocations << ",\"bytes\":" << event.bytes << '}';
+#endif
+      out << '}';
+      first = false;
+    }
+
+    const uint32_t dropped = buffer->dropped.load(std::memory_order_relaxed);
+    if (dropped) {
+      out << (first ? "\n" : ",\n") << "{\"name\":\"dropped\",\"ph\":\"C\",\"pid\":1,\"tid\":" << buffer->threadId
+          << ",\"ts\":0,\"args\":{\"zones\":" << dropped << "}}";
+      first = false;
+    }
+  }
+
+  out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+  return out.good();
+}
+
+}  // namespace profiler
+}  // namespace util
+}  // namespace graph3d
+
+#endif
@@ -0,0 +1,106 @@
+#ifndef GRAPH3D_UTIL_PROFILER_H_
+#define GRAPH3D_UTIL_PROFILER_H_
+
+// Profiler de CPU por zonas.
+// G3D_PROFILE_SCOPE("nombre") mide desde su declaración hasta el final del bloque.
+// Sin G3D_PROFILING definido, las macros no generan código.
+
+#ifdef G3D_PROFILING
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#include <util/allocations.h>
+
+namespace graph3d {
+namespace util {
+namespace profiler {
+
+struct zone_event {
+  const char* name;
+  uint64_t begin;
+  uint64_t end;
+
+  // Reservas de memoria dentro de la zona (sólo con G3D_ALLOC_TRACKING)
+  uint64_t allocations;
+  uint64_t bytes;
+};
+
+// Cada hilo escribe sólo en su propio buffer, y los lectores nunca pasan de `count`,
+// por lo que registrar una zona no necesita locks
+struct thread_buffer {
+  static constexpr uint32_t capacity = 1 << 16;
+
+  zone_event events[capacity];
+  std::atomic<uint32_t> count{0};
+  std::atomic<uint32_t> dropped{0};
+  uint32_t threadId = 0;
+  thread_buffer* next = nullptr;
+};
+
+thread_buffer& getThreadBuffer();
+
+inline uint64_t now() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+inline void record(const char* name, uint64_t begin, uint64_t end, uint64_t allocations = 0, uint64_t bytes = 0) {
+  thread_buffer& buffer = getThreadBuffer();
+  uint32_t index = buffer.count.load(std::memory_order_relaxed);
+  if (index >= thread_buffer::capacity) {
+    buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  buffer.events[index] = {name, begin, end, allocations, bytes};
+  buffer.count.store(index + 1, std::memory_order_release);
+}
+
+// `name` debe vivir tanto como el profiler (un literal, en la práctica)
+class scope {
+  const char* name;
+  uint64_t begin;
+#ifdef G3D_ALLOC_TRACKING
+  allocations::counters allocs = allocations::thread();
+#endif
+
+ public:
+  scope& operator=(const scope&) = delete;
+  scope(const scope&) = delete;
+
+  explicit scope(const char* name) : name(name), begin(now()) {}
+  ~scope() {
+#ifdef G3D_ALLOC_TRACKING
+    const allocations::counters current = allocations::thread();
+    record(name, begin, now(), current.count - allocs.count, current.bytes - allocs.bytes);
+#else
+    record(name, begin, now());
+#endif
+  }
+};
+
+/// Escribe las zonas registradas hasta ahora en formato `trace_event` de Chrome
+bool exportChromeTrace(const std::string& path);
+
+}  // namespace profiler
+}  // namespace util
+}  // namespace graph3d
+
+#define G3D_PROFILE_CONCAT_IMPL(a, b) a##b
+#define G3D_PROFILE_CONCAT(a, b) G3D_PROFILE_CONCAT_IMPL(a, b)
+
+#define G3D_PROFILE_SCOPE(name) \
+  ::graph3d::util::profiler::scope G3D_PROFILE_CONCAT(g3d_profile_scope_, __LINE__)(name)
+#define G3D_PROFILE_EXPORT(path) ::graph3d::util::profiler::exportChromeTrace(path)
+
+#else
+
+#define G3D_PROFILE_SCOPE(name) ((void)0)
+#define G3D_PROFILE_EXPORT(path) ((void)0)
+
+#endif
+
+#endif
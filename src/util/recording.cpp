@@ -0,0 +1,423 @@
+#include <util/recording.h>
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <exceptions/exception.h>
+#include <exceptions/messages.h>
+#include <exceptions/warning.h>
+#include <util/logger.h>
+
+namespace graph3d {
+namespace util {
+
+static const char recordingMagic[4] = {'G', '3', 'D', 'R'};
+
+// Se escribe al cerrar cada frame, o antes si una carga grande llena el buffer
+static constexpr size_t flushThreshold = 1 << 20;
+
+Recorder* Recorder::g_active = nullptr;
+
+uint32_t getUniformComponents(UniformType type) {
+  switch (type) {
+    case G3D_UNIFORM_FLOAT:
+    case G3D_UNIFORM_INT:
+    case G3D_UNIFORM_UINT:
+      return 1;
+    case G3D_UNIFORM_VEC2:
+    case G3D_UNIFORM_IVEC2:
+    case G3D_UNIFORM_UVEC2:
+      return 2;
+    case G3D_UNIFORM_VEC3:
+    case G3D_UNIFORM_IVEC3:
+    case G3D_UNIFORM_UVEC3:
+      return 3;
+    case G3D_UNIFORM_VEC4:
+    case G3D_UNIFORM_IVEC4:
+    case G3D_UNIFORM_UVEC4:
+    case G3D_UNIFORM_MAT2:
+      return 4;
+    case G3D_UNIFORM_MAT3:
+      return 9;
+    case G3D_UNIFORM_MAT4:
+      return 16;
+    default:
+      return 0;
+  }
+}
+
+/// Recorder
+
+bool Recorder::start(const std::string& path) {
+  stop();
+
+  FILE* file = std::fopen(path.c_str(), "wb");
+  if (!file) {
+    exceptions::warning("WAR007", exceptions::format(exceptions::WAR007, path.c_str()));
+    return false;
+  }
+
+  G3D_LOG(2, "> Grabar comandos en " << path);
+  g_active = new Recorder(file);
+  return true;
+}
+
+void Recorder::stop() {
+  if (!g_active) return;
+  G3D_LOG(2, "  < Grabacion terminada: " << g_active->frames << " frames");
+  delete g_active;
+  g_active = nullptr;
+}
+
+Recorder::Recorder(FILE* file) : file(file) {
+  buffer.reserve(flushThreshold);
+  write(recordingMagic, sizeof(recordingMagic));
+  write(recordingVersion);
+}
+
+Recorder::~Recorder() {
+  flush();
+  std::fclose(file);
+}
+
+void Recorder::folder(uint8_t type, const std::string& folder) {
+  if (paused) return;
+  command(G3D_CMD_FOLDER);
+  buffer.push_back(type);
+  write(folder);
+}
+
+void Recorder::loadShader(const std::string& alias) {
+  if (paused) return;
+  command(G3D_CMD_LOAD_SHADER);
+  write(alias);
+}
+
+void Recorder::loadModel(const std::string& alias) {
+  if (paused) return;
+  command(G3D_CMD_LOAD_MODEL);
+  write(alias);
+}
+
+void Recorder::modelData(const std::string& alias, const std::vector<MeshView>& meshes) {
+  if (paused) return;
+  command(G3D_CMD_MODEL_DATA);
+  write(alias);
+  write(static_cast<uint32_t>(meshes.size()));
+  for (const MeshView& mesh : meshes) {
+    write(mesh.vertexSize);
+    write(mesh.vertexCount);
+    write(mesh.vertices, static_cast<size_t>(mesh.vertexCount) * mesh.vertexSize);
+    write(mesh.indexCount);
+    write(mesh.indices, static_cast<size_t>(mesh.indexCount) * sizeof(uint32_t));
+  }
+  if (buffer.size() >= flushThreshold) flush();
+}
+
+void Recorder::createObject(const void* object, const std::string& alias) {
+  if (paused) return;
+  getObject(object, alias);
+}
+
+void Recorder::camera(const void* camera, const glm::vec3& position, const glm::mat3& rotation, float zoom) {
+  if (paused || !camera) return;
+
+  auto it = cameraIds.find(camera);
+  if (it == cameraIds.end()) {
+    it = cameraIds.emplace(camera, static_cast<uint32_t>(cameras.size() + 1)).first;
+    cameras.push_back({position, rotation, zoom});
+  } else {
+    camera_state& state = cameras[it->second - 1];
+    if (state.position == position && state.rotation == rotation && state.zoom == zoom) return;
+    state = {position, rotation, zoom};
+  }
+
+  command(G3D_CMD_CAMERA);
+  write(it->second);
+  write(glm::value_ptr(position), sizeof(float) * 3);
+  write(glm::value_ptr(rotation), sizeof(float) * 9);
+  write(&zoom, sizeof(zoom));
+}
+
+void Recorder::viewport(const void* window, const util::dimension& size, const void* viewport, int32_t zindex,
+                        const util::bounds& bounds, uint32_t clearMask, const glm::vec4& color, const void* camera) {
+  if (paused) return;
+
+  auto windowIt = windowIds.find(window);
+  if (windowIt == windowIds.end()) {
+    windowIt = windowIds.emplace(window, static_cast<uint32_t>(windows.size() + 1)).first;
+    windows.emplace_back(-1, -1);
+  }
+  util::dimension& windowSize = windows[windowIt->second - 1];
+  if (windowSize.width != size.width || windowSize.height != size.height) {
+    windowSize = size;
+    command(G3D_CMD_WINDOW);
+    write(windowIt->second);
+    write(&size.width, sizeof(int32_t));
+    write(&size.height, sizeof(int32_t));
+  }
+
+  auto cameraIt = cameraIds.find(camera);
+  viewport_state current = {windowIt->second,
+                            cameraIt == cameraIds.end() ? 0 : cameraIt->second,
+                            zindex,
+                            {bounds.first.width, bounds.first.height, bounds.width, bounds.height},
+                            clearMask,
+                            color};
+
+  auto viewportIt = viewportIds.find(viewport);
+  bool changed = viewportIt == viewportIds.end();
+  if (changed) {
+    viewportIt = viewportIds.emplace(viewport, static_cast<uint32_t>(viewports.size() + 1)).first;
+    viewports.push_back(current);
+  } else {
+    viewport_state& state = viewports[viewportIt->second - 1];
+    changed = state.window != current.window || state.camera != current.camera || state.zindex != current.zindex ||
+              std::memcmp(state.bounds, current.bounds, sizeof(current.bounds)) || state.mask != current.mask ||
+              state.color != current.color;
+    if (changed) state = current;
+  }
+
+  if (changed) {
+    command(G3D_CMD_VIEWPORT);
+    write(viewportIt->second);
+    write(current.window);
+    write(&current.zindex, sizeof(int32_t));
+    write(current.bounds, sizeof(current.bounds));
+    write(current.mask);
+    write(glm::value_ptr(current.color), sizeof(float) * 4);
+    write(current.camera);
+  }
+
+  command(G3D_CMD_BEGIN_VIEWPORT);
+  write(viewportIt->second);
+}
+
+void Recorder::useShader(const std::string& alias, const std::vector<std::string>& keywords) {
+  if (paused) return;
+  command(G3D_CMD_USE_SHADER);
+  write(alias);
+  write(static_cast<uint32_t>(keywords.size()));
+  for (const std::string& keyword : keywords) write(keyword);
+}
+
+void Recorder::uniform(const char* name, UniformType type, const void* data) {
+  if (paused) return;
+  command(G3D_CMD_UNIFORM);
+  write(name);
+  buffer.push_back(type);
+  write(data, getUniformComponents(type) * 4);
+}
+
+void Recorder::draw(const void* object, const std::string& model, const glm::mat4& transformation) {
+  if (paused) return;
+
+  bool created;
+  const uint32_t id = getObject(object, std::string(), &created);
+  object_state& state = objects[id - 1];
+
+  if (created || state.model != model) {
+    state.model = model;
+    command(G3D_CMD_SET_MODEL);
+    write(id);
+    write(model);
+  }
+
+  if (created || state.transformation != transformation) {
+    state.transformation = transformation;
+    command(G3D_CMD_TRANSFORM);
+    write(id);
+    write(glm::value_ptr(transformation), sizeof(float) * 16);
+  }
+
+  command(G3D_CMD_DRAW);
+  write(id);
+}
+
+void Recorder::endFrame(double frameTime) {
+  command(G3D_CMD_FRAME);
+  write(&frames, sizeof(frames));
+  write(&frameTime, sizeof(frameTime));
+  frames++;
+  flush();
+}
+
+uint32_t Recorder::getObject(const void* object, const std::string& alias, bool* created) {
+  auto it = objectIds.find(object);
+  if (created) *created = it == objectIds.end();
+  if (it != objectIds.end()) return it->second;
+
+  const uint32_t id = static_cast<uint32_t>(objects.size() + 1);
+  objectIds.emplace(object, id);
+  objects.emplace_back();
+
+  command(G3D_CMD_CREATE_OBJECT);
+  write(id);
+  write(alias);
+  return id;
+}
+
+void Recorder::write(const void* data, size_t size) {
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  buffer.insert(buffer.end(), bytes, bytes + size);
+}
+
+void Recorder::write(const std::string& value) {
+  write(static_cast<uint32_t>(value.size()));
+  write(value.data(), value.size());
+}
+
+void Recorder::flush() {
+  if (buffer.empty()) return;
+  std::fwrite(buffer.data(), 1, buffer.size(), file);
+  buffer.clear();
+}
+
+/// CommandReader
+
+CommandReader::CommandReader(const std::string& path) : path(path) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file.is_open())
+    throw exceptions::exception("ERR014", exceptions::format(exceptions::ERR014, path.c_str()),
+                                "No se pudo abrir el archivo");
+  data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+  rewind();
+}
+
+void CommandReader::rewind() {
+  offset = 0;
+
+  char magic[sizeof(recordingMagic)];
+  read(magic, sizeof(magic));
+  if (std::memcmp(magic, recordingMagic, sizeof(magic)))
+    throw exceptions::exception("ERR014", exceptions::format(exceptions::ERR014, path.c_str()),
+                                "No es una grabacion de 3DGraph");
+
+  const uint32_t version = readUint();
+  if (version != recordingVersion)
+    throw exceptions::exception("ERR014", exceptions::format(exceptions::ERR014, path.c_str()),
+                                exceptions::format(exceptions::ERR014_2, version, recordingVersion));
+}
+
+bool CommandReader::next(Command& command) {
+  if (offset >= data.size()) return false;
+
+  uint8_t type;
+  read(&type, 1);
+  command.type = static_cast<CommandType>(type);
+
+  switch (command.type) {
+    case G3D_CMD_FOLDER:
+      read(&command.kind, 1);
+      command.name = readString();
+      break;
+    case G3D_CMD_LOAD_SHADER:
+    case G3D_CMD_LOAD_MODEL:
+      command.name = readString();
+      break;
+    case G3D_CMD_USE_SHADER: {
+      command.name = readString();
+      command.keywords.clear();
+      // Cada keyword ocupa al menos su largo
+      for (uint32_t count = readCount(sizeof(uint32_t)); count; count--) command.keywords.push_back(readString());
+      break;
+    }
+    case G3D_CMD_MODEL_DATA: {
+      command.name = readString();
+      // Cada mesh ocupa al menos el tamaño de vértice y las dos cantidades
+      command.meshes.resize(readCount(sizeof(uint32_t) * 3));
+      for (MeshData& mesh : command.meshes) {
+        mesh.vertexSize = readUint();
+        mesh.vertices.resize(static_cast<size_t>(readCount(mesh.vertexSize)) * mesh.vertexSize);
+        read(mesh.vertices.data(), mesh.vertices.size());
+        mesh.indices.resize(readCount(sizeof(uint32_t)));
+        read(mesh.indices.data(), mesh.indices.size() * sizeof(uint32_t));
+      }
+      break;
+    }
+    case G3D_CMD_CREATE_OBJECT:
+    case G3D_CMD_SET_MODEL:
+      command.id = readUint();
+      command.name = readString();
+      break;
+    case G3D_CMD_TRANSFORM:
+      command.id = readUint();
+      read(command.data, sizeof(float) * 16);
+      break;
+    case G3D_CMD_CAMERA:
+      command.id = readUint();
+      read(command.data, sizeof(float) * 13);
+      break;
+    case G3D_CMD_WINDOW:
+      command.id = readUint();
+      read(command.values, sizeof(int32_t) * 2);
+      break;
+    case G3D_CMD_VIEWPORT:
+      command.id = readUint();
+      command.window = readUint();
+      read(&command.zindex, sizeof(int32_t));
+      read(command.values, sizeof(command.values));
+      command.mask = readUint();
+      read(command.data, sizeof(float) * 4);
+      command.camera = readUint();
+      break;
+    case G3D_CMD_BEGIN_VIEWPORT:
+    case G3D_CMD_DRAW:
+      command.id = readUint();
+      break;
+    case G3D_CMD_UNIFORM: {
+      command.name = readString();
+      read(&command.kind, 1);
+      const uint32_t components = getUniformComponents(static_cast<UniformType>(command.kind));
+      if (!components)
+        throw exceptions::exception("ERR014", exceptions::format(exceptions::ERR014, path.c_str()),
+                                    "Tipo de uniform desconocido");
+      read(command.data, components * 4);
+      break;
+    }
+    case G3D_CMD_FRAME:
+      read(&command.frame, sizeof(command.frame));
+      read(&command.time, sizeof(command.time));
+      break;
+    default:
+      throw exceptions::exception("ERR014", exceptions::format(exceptions::ERR014, path.c_str()),
+                                  exceptions::format("Comando desconocido (%u)", type));
+  }
+  return true;
+}
+
+void CommandReader::read(void* out, size_t size) {
+  if (size > data.size() - offset)
+    throw exceptions::exception("ERR014", exceptions::format(exceptions::ERR014, path.c_str()),
+                                "La grabacion esta truncada");
+  if (size) std::memcpy(out, data.data() + offset, size);
+  offset += size;
+}
+
+uint32_t CommandReader::readUint() {
+  uint32_t value;
+  read(&value, sizeof(value));
+  return value;
+}
+
+uint32_t CommandReader::readCount(size_t elementSize) {
+  const uint32_t count = readUint();
+  if (elementSize && count > (data.size() - offset) / elementSize)
+    throw exceptions::exception("ERR014", exceptions::format(exceptions::ERR014, path.c_str()),
+                                "La grabacion esta truncada");
+  return count;
+}
+
+std::string CommandReader::readString() {
+  const uint32_t size = readCount(1);
+  std::string value(size, '\0');
+  read(&value[0], size);
+  return value;
+}
+
+}  // namespace util
+}  // namespace graph3d
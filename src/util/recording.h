@@ -0,0 +1,238 @@
+#ifndef GRAPH3D_UTIL_RECORDING_H_
+#define GRAPH3D_UTIL_RECORDING_H_
+
+// Grabación del stream de comandos del motor, para reproducir una sesión sin la aplicación original.
+// Se graba a nivel motor (cargas, objetos, transformaciones, cámaras, viewports, shaders, uniforms y draws),
+// no a nivel GL, así la misma grabación sirve para comparar versiones distintas del motor.
+//
+// Formato: "G3DR", versión (uint32) y una secuencia de comandos [tipo (uint8), datos]. Todo en little-endian,
+// que es el orden de todas las plataformas soportadas. Un comando G3D_CMD_FRAME cierra cada frame
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/mat3x3.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+#include <util/bounds.h>
+
+namespace graph3d {
+namespace util {
+
+static constexpr uint32_t recordingVersion = 2;
+
+enum CommandType : uint8_t {
+  G3D_CMD_FOLDER = 1,      // tipo de recurso, carpeta
+  G3D_CMD_LOAD_SHADER,     // alias
+  G3D_CMD_LOAD_MODEL,      // alias
+  G3D_CMD_MODEL_DATA,      // alias, mallas (vértices e índices) de un modelo creado por código
+  G3D_CMD_CREATE_OBJECT,   // id, alias
+  G3D_CMD_SET_MODEL,       // id, alias del modelo
+  G3D_CMD_TRANSFORM,       // id, matriz
+  G3D_CMD_CAMERA,          // id, posición, rotación, zoom
+  G3D_CMD_WINDOW,          // id, tamaño
+  G3D_CMD_VIEWPORT,        // id, ventana, zindex, bounds, máscara de borrado, color, cámara
+  G3D_CMD_BEGIN_VIEWPORT,  // id: los comandos que siguen se dibujan en ese viewport
+  G3D_CMD_USE_SHADER,      // alias, palabras clave de la variante
+  G3D_CMD_UNIFORM,         // nombre, tipo, valor
+  G3D_CMD_DRAW,            // id del objeto
+  G3D_CMD_FRAME            // número de frame, duración original en segundos
+};
+
+enum UniformType : uint8_t {
+  G3D_UNIFORM_FLOAT,
+  G3D_UNIFORM_INT,
+  G3D_UNIFORM_UINT,
+  G3D_UNIFORM_VEC2,
+  G3D_UNIFORM_VEC3,
+  G3D_UNIFORM_VEC4,
+  G3D_UNIFORM_IVEC2,
+  G3D_UNIFORM_IVEC3,
+  G3D_UNIFORM_IVEC4,
+  G3D_UNIFORM_UVEC2,
+  G3D_UNIFORM_UVEC3,
+  G3D_UNIFORM_UVEC4,
+  G3D_UNIFORM_MAT2,
+  G3D_UNIFORM_MAT3,
+  G3D_UNIFORM_MAT4,
+  G3D_UNIFORM_COUNT
+};
+
+/// Cantidad de componentes de 4 bytes de un uniform
+uint32_t getUniformComponents(UniformType type);
+
+// Vista de una malla para grabarla: los vértices se copian tal cual, con su tamaño
+struct MeshView {
+  const void* vertices;
+  uint32_t vertexCount, vertexSize;
+  const uint32_t* indices;
+  uint32_t indexCount;
+};
+
+struct MeshData {
+  uint32_t vertexSize = 0;
+  std::vector<uint8_t> vertices;
+  std::vector<uint32_t> indices;
+};
+
+// Un comando leído. Cada tipo usa sólo algunos campos (ver CommandType)
+struct Command {
+  CommandType type;
+
+  // Objeto, cámara, ventana o viewport
+  uint32_t id = 0;
+  uint32_t window = 0, camera = 0;
+
+  std::string name;
+  uint8_t kind = 0;
+
+  // Variante del programa de G3D_CMD_USE_SHADER
+  std::vector<std::string> keywords;
+
+  // Tamaño de la ventana, o x, y, ancho y alto del viewport
+  int32_t values[4] = {0, 0, 0, 0};
+  int32_t zindex = 0;
+  uint32_t mask = 0;
+
+  // Matriz, cámara (posición, rotación y zoom), color o valor del uniform
+  float data[16];
+
+  uint64_t frame = 0;
+  double time = 0;
+
+  std::vector<MeshData> meshes;
+};
+
+// Graba los comandos de una sesión. Se usa desde el hilo de render: los objetos se identifican por dirección
+// y sólo se escribe el estado que cambió desde la última vez
+class Recorder {
+ private:
+  static Recorder* g_active;
+
+  struct object_state {
+    std::string model;
+    glm::mat4 transformation;
+  };
+
+  struct camera_state {
+    glm::vec3 position;
+    glm::mat3 rotation;
+    float zoom;
+  };
+
+  struct viewport_state {
+    uint32_t window, camera;
+    int32_t zindex;
+    int32_t bounds[4];
+    uint32_t mask;
+    glm::vec4 color;
+  };
+
+  FILE* file;
+  std::vector<uint8_t> buffer;
+  uint64_t frames = 0;
+  uint32_t paused = 0;
+
+  std::unordered_map<const void*, uint32_t> objectIds, cameraIds, windowIds, viewportIds;
+  std::vector<object_state> objects;
+  std::vector<camera_state> cameras;
+  std::vector<util::dimension> windows;
+  std::vector<viewport_state> viewports;
+
+ public:
+  Recorder& operator=(const Recorder&) = delete;
+  Recorder(const Recorder&) = delete;
+
+  /// La grabación en curso, o nullptr
+  static Recorder* active() { return g_active; }
+
+  /// Empieza a grabar en `path`, cerrando la grabación anterior. Devuelve false si no se pudo abrir
+  static bool start(const std::string& path);
+
+  /// Termina la grabación en curso y escribe lo pendiente
+  static void stop();
+
+ public:
+  void folder(uint8_t type, const std::string& folder);
+  void loadShader(const std::string& alias);
+  void loadModel(const std::string& alias);
+  void modelData(const std::string& alias, const std::vector<MeshView>& meshes);
+
+  void createObject(const void* object, const std::string& alias);
+
+  void camera(const void* camera, const glm::vec3& position, const glm::mat3& rotation, float zoom);
+
+  /// Empieza a dibujar un viewport. El estado de la ventana y del viewport se graba sólo si cambió
+  void viewport(const void* window, const util::dimension& size, const void* viewport, int32_t zindex,
+                const util::bounds& bounds, uint32_t clearMask, const glm::vec4& color, const void* camera);
+
+  void useShader(const std::string& alias, const std::vector<std::string>& keywords);
+  void uniform(const char* name, UniformType type, const void* data);
+  void draw(const void* object, const std::string& model, const glm::mat4& transformation);
+
+  void endFrame(double frameTime);
+
+ public:
+  // Mientras dure el bloque no se graba nada (por ejemplo, los uniforms que pone el motor en un draw)
+  class pause_scope {
+    Recorder* recorder;
+
+   public:
+    pause_scope& operator=(const pause_scope&) = delete;
+    pause_scope(const pause_scope&) = delete;
+
+    pause_scope() : recorder(g_active) {
+      if (recorder) recorder->paused++;
+    }
+    ~pause_scope() {
+      if (recorder) recorder->paused--;
+    }
+  };
+
+ private:
+  explicit Recorder(FILE* file);
+  ~Recorder();
+
+  uint32_t getObject(const void* object, const std::string& alias, bool* created = nullptr);
+
+  void command(CommandType type) { buffer.push_back(type); }
+  void write(const void* data, size_t size);
+  void write(uint32_t value) { write(&value, sizeof(value)); }
+  void write(const std::string& value);
+  void flush();
+};
+
+// Lee una grabación entera a memoria, así la reproducción no toca el disco entre frames
+class CommandReader {
+ private:
+  std::vector<uint8_t> data;
+  size_t offset = 0;
+  std::string path;
+
+ public:
+  /// Lanza ERR014 si el archivo no existe o no es una grabación de una versión soportada
+  explicit CommandReader(const std::string& path);
+
+  /// Lee el próximo comando. Devuelve false al final de la grabación
+  bool next(Command& command);
+
+  /// Vuelve al primer comando
+  void rewind();
+
+ private:
+  void read(void* out, size_t size);
+  uint32_t readUint();
+  /// Lee una cantidad de elementos de `elementSize` bytes; lanza ERR014 si no entran en lo que queda del archivo
+  uint32_t readCount(size_t elementSize);
+  std::string readString();
+};
+
+}  // namespace util
+}  // namespace graph3d
+
+#endif
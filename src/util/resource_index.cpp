@@ -0,0 +1,225 @@
+#include <util/resource_index.h>
+
+#include <iterator>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <util/logger.h>
+#include <util/profiler.h>
+
+namespace graph3d {
+namespace util {
+
+namespace {
+
+// Las subcarpetas se siguen aunque sean enlaces: la profundidad corta los ciclos
+constexpr int maxDepth = 32;
+
+int depthOf(const std::string& name) {
+  int depth = 1;
+  for (char c : name) depth += c == '/';
+  return depth;
+}
+
+}  // namespace
+
+ResourceIndex::ResourceIndex(const std::string& root)
+    : g_root(root.empty() || root.back() == '/' ? root : root + '/') {
+  G3D_PROFILE_SCOPE("ResourceIndex::scan");
+  std::error_code error;
+  if (!std::filesystem::is_directory(g_root, error)) {
+    g_watched = false;
+    return;
+  }
+  scan("", 0);
+  G3D_LOG(3, "> Indexar carpeta de recursos: " << g_root << " (" << entries.size() << " entradas"
+                                                << (watched() ? "" : ", sin vigilar") << ")");
+}
+
+ResourceIndex::~ResourceIndex() {
+  closing = true;
+  // Espera a que termine un aviso en curso: los que lleguen después ya ven `closing` y no vigilan nada nuevo
+  FileWatcher& watcher = FileWatcher::getInstance();
+  watcher.unwatch(-1);
+
+  std::unordered_map<std::string, int> ids;
+  {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    ids.swap(watches);
+  }
+  for (const auto& watch : ids) watcher.unwatch(watch.second);
+}
+
+std::string ResourceIndex::key(const std::string& name) {
+  if (name.find("./") == std::string::npos && name.find('\\') == std::string::npos &&
+      name.find("//") == std::string::npos && (name.empty() || name.back() != '/'))
+    return name;
+
+  std::string normal = std::filesystem::path(name).lexically_normal().generic_string();
+  while (!normal.empty() && normal.back() == '/') normal.pop_back();
+  return normal == "." ? std::string() : normal;
+}
+
+IndexLookup ResourceIndex::find(const std::string& name, ResourceInfo* info) const {
+  if (!watched()) return G3D_INDEX_UNKNOWN;
+  const std::string normal = key(name);
+  // Lo que sale de la carpeta o es absoluto no está en el índice, pero puede existir
+  if (normal.empty() || normal.front() == '/' || normal == ".." || normal.compare(0, 3, "../") == 0 ||
+      normal.find(':') != std::string::npos)
+    return G3D_INDEX_UNKNOWN;
+
+  std::shared_lock<std::shared_mutex> lock(mutex);
+  auto it = entries.find(normal);
+  if (it == entries.end()) return G3D_INDEX_MISSING;
+  if (info) *info = it->second;
+  return G3D_INDEX_FOUND;
+}
+
+void ResourceIndex::rescan() {
+  G3D_PROFILE_SCOPE("ResourceIndex::rescan");
+  // La tabla nueva se arma aparte: vaciar la de ahora haría que las búsquedas de otros hilos den G3D_INDEX_MISSING
+  // con archivos que existen
+  entry_table_t table;
+  scan("", 0, &table);
+  {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    entries.swap(table);
+  }
+  g_version++;
+}
+
+void ResourceIndex::scan(const std::string& relative, int depth, entry_table_t* table) {
+  // Primero se vigila y después se lista: lo que se cree en el medio aparece en la lista o llega como aviso
+  watchFolder(relative);
+
+  std::vector<std::string> names;
+  std::error_code error;
+  for (std::filesystem::directory_iterator it(g_root + relative, error), end; !error && it != end;
+       it.increment(error))
+    names.push_back(relative + it->path().filename().generic_string());
+
+  std::vector<std::pair<std::string, ResourceInfo>> found;
+  std::vector<std::string> folders;
+  for (const std::string& name : names) {
+    bool exists;
+    ResourceInfo info = describe(name, exists);
+    if (!exists) continue;
+    if (info.directory) folders.push_back(name);
+    found.emplace_back(name, std::move(info));
+  }
+
+  if (table) {
+    for (auto& entry : found) (*table)[entry.first] = std::move(entry.second);
+  } else {
+    {
+      std::unique_lock<std::shared_mutex> lock(mutex);
+      for (auto& entry : found) entries[entry.first] = std::move(entry.second);
+    }
+    g_version++;
+  }
+
+  if (depth >= maxDepth) return;
+  for (const std::string& folder : folders) scan(folder + '/', depth + 1, table);
+}
+
+void ResourceIndex::watchFolder(const std::string& relative) {
+  const std::string name = key(relative);
+  {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    if (watches.count(name)) return;
+  }
+
+  FileWatcher& watcher = FileWatcher::getInstance();
+  const int id = watcher.watch(g_root + relative, [this, name](const FileEvent& event) { onEvent(name, event); });
+  if (id < 0) {
+    g_watched = false;
+    return;
+  }
+
+  // La misma carpeta puede llegar a la vez del recorrido y de un aviso: se queda un solo id
+  bool duplicate;
+  {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    duplicate = !watches.emplace(name, id).second;
+  }
+  if (duplicate) watcher.unwatch(id);
+}
+
+void ResourceIndex::forget(const std::string& name) {
+  const std::string prefix = name + '/';
+  auto inside = [&name, &prefix](const std::string& other) {
+    return other == name || other.compare(0, prefix.size(), prefix) == 0;
+  };
+
+  std::vector<int> ids;
+  {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    for (auto it = entries.begin(); it != entries.end();) it = inside(it->first) ? entries.erase(it) : std::next(it);
+    for (auto it = watches.begin(); it != watches.end();) {
+      if (!inside(it->first)) {
+        it++;
+        continue;
+      }
+      ids.push_back(it->second);
+      it = watches.erase(it);
+    }
+  }
+  for (int id : ids) FileWatcher::getInstance().unwatch(id);
+}
+
+void ResourceIndex::onEvent(const std::string& folder, const FileEvent& event) {
+  if (closing) return;
+
+  if (event.kind == G3D_FILE_OVERFLOW) {
+    // Llega una vez por carpeta vigilada: basta con la raíz
+    if (folder.empty()) rescan();
+    return;
+  }
+
+  if (event.name.empty()) {
+    // Si se borró o se movió la raíz, las rutas del índice ya no valen
+    if (folder.empty() && event.kind == G3D_FILE_REMOVED) g_watched = false;
+    return;
+  }
+
+  const std::string name = folder.empty() ? event.name : folder + '/' + event.name;
+  if (event.kind == G3D_FILE_REMOVED) {
+    forget(name);
+  } else {
+    bool exists;
+    ResourceInfo info = describe(name, exists);
+    if (!exists) {
+      forget(name);
+    } else {
+      const bool created = info.directory && event.kind == G3D_FILE_CREATED;
+      {
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        entries[name] = std::move(info);
+      }
+      // Una carpeta nueva (o movida desde afuera) puede llegar con contenido
+      if (created && depthOf(name) <= maxDepth) scan(name + '/', depthOf(name));
+    }
+  }
+  g_version++;
+}
+
+ResourceInfo ResourceIndex::describe(const std::string& name, bool& exists) const {
+  ResourceInfo info;
+  info.path = g_root + name;
+  std::error_code error;
+  const std::filesystem::file_status status = std::filesystem::status(info.path, error);
+  exists = !error && std::filesystem::exists(status);
+  if (!exists) return info;
+
+  info.directory = std::filesystem::is_directory(status);
+  if (!info.directory) {
+    info.size = std::filesystem::file_size(info.path, error);
+    if (error) info.size = 0;
+  }
+  info.modified = std::filesystem::last_write_time(info.path, error);
+  return info;
+}
+
+}  // namespace util
+}  // namespace graph3d
@@ -0,0 +1,87 @@
+#ifndef GRAPH3D_UTIL_RESOURCE_INDEX_H_
+#define GRAPH3D_UTIL_RESOURCE_INDEX_H_
+
+// Índice de una carpeta de recursos: cada archivo y subcarpeta, por ruta relativa, con su tamaño y su fecha.
+//
+// La carpeta se recorre una vez al registrarla y después el índice sigue los cambios con util::FileWatcher, así
+// buscar un recurso es una búsqueda en una tabla, sin tocar el disco. Si no se puede vigilar (otra plataforma,
+// límite de inotify, la carpeta todavía no existe) el índice no se usa: find() devuelve G3D_INDEX_UNKNOWN y hay
+// que mirar el disco como antes.
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+
+#include <util/file_watcher.h>
+
+namespace graph3d {
+namespace util {
+
+struct ResourceInfo {
+  std::string path;  // Carpeta + nombre, lista para abrir
+  uint64_t size = 0;
+  std::filesystem::file_time_type modified;
+  bool directory = false;
+};
+
+enum IndexLookup {
+  G3D_INDEX_FOUND,
+  G3D_INDEX_MISSING,
+  G3D_INDEX_UNKNOWN,  // El índice no sirve para esa ruta (no está vigilado, o la ruta sale de la carpeta)
+};
+
+class ResourceIndex {
+  typedef std::unordered_map<std::string, ResourceInfo> entry_table_t;  // Por ruta relativa, sin '/' al final
+
+  const std::string g_root;  // Con '/' al final
+
+  mutable std::shared_mutex mutex;
+  entry_table_t entries;
+  std::unordered_map<std::string, int> watches;           // Id en FileWatcher de cada carpeta, por ruta relativa
+
+  std::atomic<bool> g_watched{true};
+  std::atomic<uint64_t> g_version{0};
+  std::atomic<bool> closing{false};
+
+ public:
+  ResourceIndex& operator=(const ResourceIndex&) = delete;
+  ResourceIndex(const ResourceIndex&) = delete;
+
+  /// Recorre `root` y empieza a vigilarla
+  explicit ResourceIndex(const std::string& root);
+  ~ResourceIndex();
+
+  const std::string& root() const { return g_root; }
+
+  /// false si el índice no se mantiene al día, y entonces no se usa
+  bool watched() const { return g_watched.load(std::memory_order_acquire); }
+
+  /// Sube con cada cambio que se ve en la carpeta
+  uint64_t version() const { return g_version.load(std::memory_order_acquire); }
+
+  /// Busca `name` (relativo a la carpeta). Con G3D_INDEX_FOUND, deja los datos en `info` si no es nullptr
+  IndexLookup find(const std::string& name, ResourceInfo* info = nullptr) const;
+
+  /// Vuelve a recorrer la carpeta entera. Mientras tanto, find() sigue viendo el índice anterior
+  void rescan();
+
+  /// Nombre como queda en el índice: "./a//b\\c/" -> "a/b/c"
+  static std::string key(const std::string& name);
+
+ private:
+  // Agrega `relative` ("" o "a/b/") y todo lo que tiene adentro, vigilando cada subcarpeta. Con `table`, las
+  // entradas van ahí y no al índice
+  void scan(const std::string& relative, int depth, entry_table_t* table = nullptr);
+  void watchFolder(const std::string& relative);
+  void forget(const std::string& name);
+  void onEvent(const std::string& folder, const FileEvent& event);
+  ResourceInfo describe(const std::string& name, bool& exists) const;
+};
+
+}  // namespace util
+}  // namespace graph3d
+
+#endif
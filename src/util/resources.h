@@ -5,14 +5,19 @@
 
 #include <GLFW/glfw3.h>
 
+#include <algorithm>
 #include <filesystem>
 #include <fstream>
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include <exceptions/messages.h>
 #include <exceptions/warning.h>
+#include <util/asset_pack.h>
+#include <util/file_watcher.h>
+#include <util/resource_index.h>
 
 namespace graph3d {
 namespace util {
@@ -42,96 +47,161 @@ class ResourceManager {
   }
 
  private:
-  std::map<ResourceType, std::vector<std::string>> resourceMaps;
+  // Una carpeta registrada. Las carpetas comunes tienen índice (util/resource_index.h), compartido entre los tipos
+  // que registran la misma; los paquetes no, porque ya traen el suyo
+  struct resource_folder {
+    std::string path;
+    std::shared_ptr<ResourceIndex> index;
+  };
+
+  std::map<ResourceType, std::vector<resource_folder>> resourceMaps;
+  std::map<std::string, std::shared_ptr<ResourceIndex>> indexes;
+
+  // Los índices dejan de vigilar al destruirse: el FileWatcher se crea antes, así se destruye después
+  ResourceManager() { FileWatcher::getInstance(); }
 
  public:
+  /// `folder` también puede ser un paquete .g3dpack o una carpeta dentro de uno (util/asset_pack.h): sus entradas
+  /// se buscan en el índice, sin tocar el disco
   void addResourceFolder(ResourceType type, const std::string& folder) {
+    const std::string pack = AssetPack::packOf(folder);
+    if (!pack.empty() && !AssetPack::mount(pack)) {
+      exceptions::warning("WAR012", exceptions::format(exceptions::WAR012, folder.c_str()));
+      return;
+    }
+
     auto it = resourceMaps.find(type);
 
-    if (it == resourceMaps.end()) it = resourceMaps.emplace(type, std::vector<std::string>()).first;
+    if (it == resourceMaps.end()) it = resourceMaps.emplace(type, std::vector<resource_folder>()).first;
 
     bool path = folder.at(folder.size() - 1) == '/';
 
-    it->second.emplace_back(path ? folder : folder + '/');
+    resource_folder resource{path ? folder : folder + '/', nullptr};
+    if (pack.empty()) {
+      std::shared_ptr<ResourceIndex>& index = indexes[resource.path];
+      if (!index) index = std::make_shared<ResourceIndex>(resource.path);
+      resource.index = index;
+    }
+    it->second.push_back(std::move(resource));
+  }
+
+  /// Carpetas registradas para `type`, en orden de búsqueda. A diferencia de getResources, no avisa si no hay
+  std::vector<std::string> getFolders(ResourceType type) const {
+    std::vector<std::string> folders;
+    auto it = resourceMaps.find(type);
+    if (it != resourceMaps.end())
+      for (const resource_folder& folder : it->second) folders.push_back(folder.path);
+    return folders;
   }
 
   std::filesystem::path getResourceFilePath(ResourceType type, const std::string& filename) {
-    std::ifstream file;
-    std::vector<std::string> resources;
+    if (const std::vector<resource_folder>* resources = getResources(type)) {
+      for (const resource_folder& folder : *resources)
+        if (exists(folder, filename)) return folder.path + filename;
 
-    if (getResources(type, resources)) {
-      for (std::string& folder : resources) {
-        if (std::filesystem::exists(folder + filename)) return folder + filename;
-        exceptions::warning("WAR002", exceptions::format(exceptions::WAR002, filename));
-      }
+      exceptions::warning("WAR002", exceptions::format(exceptions::WAR002, filename.c_str()));
     }
     return "";
   }
 
   std::filesystem::path getResourceFolderPath(ResourceType type, const std::string& foldername) {
-    std::vector<std::string> resources;
     std::filesystem::path path;
 
-    if (getResources(type, resources)) {
-      for (std::string& resource : resources) {
-        path = resource + foldername;
-        if (std::filesystem::exists(path)) break;
+    if (const std::vector<resource_folder>* resources = getResources(type)) {
+      for (const resource_folder& folder : *resources) {
+        path = folder.path + foldername;
+        if (exists(folder, foldername)) break;
       }
 
-      if (path.empty()) exceptions::warning("WAR003", exceptions::format(exceptions::WAR003, foldername));
+      if (path.empty()) exceptions::warning("WAR003", exceptions::format(exceptions::WAR003, foldername.c_str()));
     }
 
     return path;
   }
 
-  std::ifstream getResourceFile(ResourceType type, const std::filesystem::path& filename) {
-    std::ifstream file;
-    std::vector<std::string> resources;
+  /// Ruta, tamaño y fecha de modificación de `filename`. false si no está en ninguna carpeta de `type`
+  bool getResourceInfo(ResourceType type, const std::string& filename, ResourceInfo& info) {
+    auto it = resourceMaps.find(type);
+    if (it == resourceMaps.end()) return false;
 
-    if (getResources(type, resources)) {
-      for (std::string& folder : resources) {
-        file.open(folder + filename);
-        if (file.is_open()) break;
-        file.clear();
+    for (const resource_folder& folder : it->second) {
+      const IndexLookup found = folder.index ? folder.index->find(filename, &info) : G3D_INDEX_UNKNOWN;
+      if (found == G3D_INDEX_FOUND) {
+        info.path = folder.path + filename;
+        return true;
       }
-
-      if (!file.is_open()) exceptions::warning("WAR002", exceptions::format(exceptions::WAR002, filename));
+      if (found == G3D_INDEX_MISSING || !exists(folder.path + filename)) continue;
+
+      // Sin índice: el archivo suelto o, en un paquete, la entrada con la fecha del paquete
+      std::error_code error;
+      std::string name;
+      info.path = folder.path + filename;
+      if (std::shared_ptr<AssetPack> pack = AssetPack::find(info.path, name)) {
+        const PackEntry* entry = pack->entry(name);
+        info.directory = !entry;
+        info.size = entry ? entry->size : 0;
+        info.modified = std::filesystem::last_write_time(pack->path(), error);
+      } else {
+        info.directory = std::filesystem::is_directory(info.path, error);
+        info.size = info.directory ? 0 : std::filesystem::file_size(info.path, error);
+        info.modified = std::filesystem::last_write_time(info.path, error);
+      }
+      return true;
     }
+    return false;
+  }
 
-    return file;
+  std::ifstream getResourceFile(ResourceType type, const std::filesystem::path& filename) {
+    std::filesystem::path path = filename;
+    return getResourceFile(type, path);
   }
 
   std::ifstream getResourceFile(ResourceType type, std::filesystem::path& filename) {
     std::ifstream file;
-    std::vector<std::string> resources;
 
-    if (getResources(type, resources)) {
-      for (std::string& folder : resources) {
-        file.open(folder + filename);
+    if (const std::vector<resource_folder>* resources = getResources(type)) {
+      for (const resource_folder& folder : *resources) {
+        if (!exists(folder, filename.generic_string())) continue;
+        file.open(folder.path + filename);
         if (file.is_open()) {
-          filename = folder + filename;
+          filename = folder.path + filename;
           break;
         }
         file.clear();
       }
 
-      if (!file.is_open()) exceptions::warning("WAR002", exceptions::format(exceptions::WAR002, filename));
+      if (!file.is_open())
+        exceptions::warning("WAR002", exceptions::format(exceptions::WAR002, filename.generic_string().c_str()));
     }
 
     return file;
   }
 
  private:
-  bool getResources(ResourceType type, std::vector<std::string>& resources) {
+  // Con un índice vigilado no se toca el disco. Dentro de un paquete montado, se busca en el índice del paquete
+  static bool exists(const resource_folder& folder, const std::string& name) {
+    const IndexLookup found = folder.index ? folder.index->find(name) : G3D_INDEX_UNKNOWN;
+    if (found != G3D_INDEX_UNKNOWN) return found == G3D_INDEX_FOUND;
+    return exists(folder.path + name);
+  }
+
+  static bool exists(const std::string& path) {
+    std::string name;
+    if (std::shared_ptr<AssetPack> pack = AssetPack::find(path, name))
+      return pack->contains(name) || pack->hasFolder(name);
+    std::error_code error;
+    return std::filesystem::exists(path, error);
+  }
+
+  const std::vector<resource_folder>* getResources(ResourceType type) const {
     auto it = resourceMaps.find(type);
 
     if (it == resourceMaps.end()) {
-      exceptions::warning("WAR001", exceptions::format(exceptions::WAR001, getResourceTypeName(type)));
-      return false;
+      exceptions::warning("WAR001", exceptions::format(exceptions::WAR001, getResourceTypeName(type).c_str()));
+      return nullptr;
     }
 
-    resources = it->second;
-    return true;
+    return &it->second;
   }
 };  // namespace util
 
@@ -156,6 +226,27 @@ std::filesystem::path getResourceFolderPath(ResourceType type, const std::string
   return ResourceManager::getInstance().getResourceFolderPath(std::forward<ResourceType>(type), foldername);
 }
 
+bool getResourceInfo(ResourceType type, const std::string& filename, ResourceInfo& info) {
+  return ResourceManager::getInstance().getResourceInfo(type, filename, info);
+}
+
+/// Archivos de `folder` (una ruta de getResourceFolderPath, que puede estar dentro de un paquete), en orden
+std::vector<std::filesystem::path> getFolderFiles(const std::filesystem::path& folder) {
+  std::vector<std::filesystem::path> files;
+  std::string name;
+  const std::string path = folder.generic_string();
+  if (std::shared_ptr<AssetPack> pack = AssetPack::find(path, name)) {
+    for (const std::string& entry : pack->list(name)) files.push_back(folder / std::filesystem::path(entry).filename());
+    return files;
+  }
+
+  std::error_code error;
+  for (const auto& file : std::filesystem::directory_iterator(folder, error))
+    if (file.is_regular_file(error)) files.push_back(file.path());
+  std::sort(files.begin(), files.end());
+  return files;
+}
+
 }  // namespace util
 }  // namespace graph3d
 
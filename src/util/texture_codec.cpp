@@ -0,0 +1,528 @@
+#include <util/texture_codec.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <thread>
+
+namespace graph3d {
+namespace util {
+
+namespace {
+
+/// Bloques
+
+// Bloque de 4x4 con los texels fuera de la imagen repetidos desde el borde
+void gatherBlock(const uint8_t* pixels, uint32_t width, uint32_t height, uint32_t channels, uint32_t bx, uint32_t by,
+                 uint8_t block[16][4]) {
+  for (uint32_t y = 0; y < 4; y++) {
+    const uint32_t py = std::min(by * 4 + y, height - 1);
+    for (uint32_t x = 0; x < 4; x++) {
+      const uint32_t px = std::min(bx * 4 + x, width - 1);
+      const uint8_t* texel = pixels + (static_cast<size_t>(py) * width + px) * channels;
+      uint8_t* out = block[y * 4 + x];
+      for (uint32_t c = 0; c < 4; c++) out[c] = c < channels ? texel[c] : (c == 3 ? 255 : 0);
+    }
+  }
+}
+
+void writeLE(uint8_t* out, uint64_t value, uint32_t bytes) {
+  for (uint32_t i = 0; i < bytes; i++) out[i] = static_cast<uint8_t>(value >> (i * 8));
+}
+
+uint64_t readLE(const uint8_t* in, uint32_t bytes) {
+  uint64_t value = 0;
+  for (uint32_t i = 0; i < bytes; i++) value |= static_cast<uint64_t>(in[i]) << (i * 8);
+  return value;
+}
+
+uint16_t pack565(const float color[3]) {
+  const int r = static_cast<int>(std::lround(std::clamp(color[0], 0.f, 255.f) * 31 / 255));
+  const int g = static_cast<int>(std::lround(std::clamp(color[1], 0.f, 255.f) * 63 / 255));
+  const int b = static_cast<int>(std::lround(std::clamp(color[2], 0.f, 255.f) * 31 / 255));
+  return static_cast<uint16_t>(r << 11 | g << 5 | b);
+}
+
+void unpack565(uint16_t color, int out[3]) {
+  const int r = color >> 11 & 31, g = color >> 5 & 63, b = color & 31;
+  out[0] = r << 3 | r >> 2;
+  out[1] = g << 2 | g >> 4;
+  out[2] = b << 3 | b >> 2;
+}
+
+// Los cuatro colores de un bloque BC1. `opaque` fuerza el modo de 4 colores (el color de BC3 no tiene el otro)
+void bc1Palette(uint16_t c0, uint16_t c1, bool opaque, int palette[4][4]) {
+  unpack565(c0, palette[0]);
+  unpack565(c1, palette[1]);
+  palette[0][3] = palette[1][3] = 255;
+  for (int i = 0; i < 3; i++) {
+    if (opaque || c0 > c1) {
+      palette[2][i] = (2 * palette[0][i] + palette[1][i]) / 3;
+      palette[3][i] = (palette[0][i] + 2 * palette[1][i]) / 3;
+    } else {
+      palette[2][i] = (palette[0][i] + palette[1][i]) / 2;
+      palette[3][i] = 0;
+    }
+  }
+  palette[2][3] = 255;
+  palette[3][3] = opaque || c0 > c1 ? 255 : 0;
+}
+
+// Extremos sobre el eje principal de los colores del bloque, con el índice del más cercano para cada texel
+void encodeColor(const uint8_t block[16][4], uint8_t* out) {
+  float mean[3] = {};
+  for (int i = 0; i < 16; i++)
+    for (int c = 0; c < 3; c++) mean[c] += block[i][c] / 16.f;
+
+  float covariance[6] = {};
+  for (int i = 0; i < 16; i++) {
+    const float r = block[i][0] - mean[0], g = block[i][1] - mean[1], b = block[i][2] - mean[2];
+    covariance[0] += r * r;
+    covariance[1] += r * g;
+    covariance[2] += r * b;
+    covariance[3] += g * g;
+    covariance[4] += g * b;
+    covariance[5] += b * b;
+  }
+
+  // Unas pocas iteraciones de la potencia alcanzan para 16 puntos
+  float axis[3] = {1, 1, 1};
+  for (int iteration = 0; iteration < 8; iteration++) {
+    const float x = covariance[0] * axis[0] + covariance[1] * axis[1] + covariance[2] * axis[2];
+    const float y = covariance[1] * axis[0] + covariance[3] * axis[1] + covariance[4] * axis[2];
+    const float z = covariance[2] * axis[0] + covariance[4] * axis[1] + covariance[5] * axis[2];
+    const float length = std::max({std::fabs(x), std::fabs(y), std::fabs(z)});
+    if (length == 0) break;
+    axis[0] = x / length;
+    axis[1] = y / length;
+    axis[2] = z / length;
+  }
+
+  float minimum = 0, maximum = 0;
+  for (int i = 0; i < 16; i++) {
+    const float t = (block[i][0] - mean[0]) * axis[0] + (block[i][1] - mean[1]) * axis[1] +
+                    (block[i][2] - mean[2]) * axis[2];
+    minimum = std::min(minimum, t);
+    maximum = std::max(maximum, t);
+  }
+
+  // Los extremos se meten un dieciseisavo: los texels de las puntas pierden poco y el resto queda más cerca
+  const float inset = (maximum - minimum) / 16;
+  float high[3], low[3];
+  const float norm = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+  for (int c = 0; c < 3; c++) {
+    high[c] = mean[c] + axis[c] * (maximum - inset) / (norm > 0 ? norm : 1);
+    low[c] = mean[c] + axis[c] * (minimum + inset) / (norm > 0 ? norm : 1);
+  }
+
+  uint16_t c0 = pack565(high), c1 = pack565(low);
+  if (c0 < c1) std::swap(c0, c1);
+
+  uint32_t indices = 0;
+  if (c0 != c1) {
+    int palette[4][4];
+    bc1Palette(c0, c1, true, palette);
+    for (int i = 0; i < 16; i++) {
+      int best = 0, bestDistance = 1 << 30;
+      for (int p = 0; p < 4; p++) {
+        int distance = 0;
+        for (int c = 0; c < 3; c++) distance += (block[i][c] - palette[p][c]) * (block[i][c] - palette[p][c]);
+        if (distance < bestDistance) {
+          bestDistance = distance;
+          best = p;
+        }
+      }
+      indices |= static_cast<uint32_t>(best) << (i * 2);
+    }
+  }
+
+  writeLE(out, c0, 2);
+  writeLE(out + 2, c1, 2);
+  writeLE(out + 4, indices, 4);
+}
+
+void decodeColor(const uint8_t* in, bool opaque, uint8_t block[16][4]) {
+  int palette[4][4];
+  bc1Palette(static_cast<uint16_t>(readLE(in, 2)), static_cast<uint16_t>(readLE(in + 2, 2)), opaque, palette);
+  const uint32_t indices = static_cast<uint32_t>(readLE(in + 4, 4));
+  for (int i = 0; i < 16; i++)
+    for (int c = 0; c < 4; c++) block[i][c] = static_cast<uint8_t>(palette[indices >> (i * 2) & 3][c]);
+}
+
+// Los ocho valores de un bloque BC4
+void bc4Palette(int v0, int v1, int palette[8]) {
+  palette[0] = v0;
+  palette[1] = v1;
+  if (v0 > v1) {
+    for (int i = 1; i < 7; i++) palette[i + 1] = ((7 - i) * v0 + i * v1) / 7;
+  } else {
+    for (int i = 1; i < 5; i++) palette[i + 1] = ((5 - i) * v0 + i * v1) / 5;
+    palette[6] = 0;
+    palette[7] = 255;
+  }
+}
+
+// Un canal del bloque, con el mínimo y el máximo como extremos
+void encodeChannel(const uint8_t block[16][4], uint32_t channel, uint8_t* out) {
+  int minimum = 255, maximum = 0;
+  for (int i = 0; i < 16; i++) {
+    minimum = std::min<int>(minimum, block[i][channel]);
+    maximum = std::max<int>(maximum, block[i][channel]);
+  }
+
+  uint64_t indices = 0;
+  if (maximum != minimum) {
+    int palette[8];
+    bc4Palette(maximum, minimum, palette);
+    for (int i = 0; i < 16; i++) {
+      int best = 0;
+      for (int p = 1; p < 8; p++)
+        if (std::abs(block[i][channel] - palette[p]) < std::abs(block[i][channel] - palette[best])) best = p;
+      indices |= static_cast<uint64_t>(best) << (i * 3);
+    }
+  }
+
+  out[0] = static_cast<uint8_t>(maximum);
+  out[1] = static_cast<uint8_t>(minimum);
+  writeLE(out + 2, indices, 6);
+}
+
+void decodeChannel(const uint8_t* in, uint32_t channel, uint8_t block[16][4]) {
+  int palette[8];
+  bc4Palette(in[0], in[1], palette);
+  const uint64_t indices = readLE(in + 2, 6);
+  for (int i = 0; i < 16; i++) block[i][channel] = static_cast<uint8_t>(palette[indices >> (i * 3) & 7]);
+}
+
+/// Contenedores
+
+// DDS_PIXELFORMAT y DDS_HEADER, sin el "DDS " del principio
+constexpr uint32_t ddsHeaderSize = 124;
+constexpr uint32_t ddsFourCC = 0x4;
+constexpr uint32_t ddsFlags = 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000 | 0x80000;  // CAPS...MIPMAPCOUNT, LINEARSIZE
+constexpr uint32_t ddsCaps = 0x1000 | 0x400000 | 0x8;                       // TEXTURE, MIPMAP, COMPLEX
+
+constexpr uint32_t fourCC(const char code[5]) {
+  return static_cast<uint32_t>(code[0]) | static_cast<uint32_t>(code[1]) << 8 | static_cast<uint32_t>(code[2]) << 16 |
+         static_cast<uint32_t>(code[3]) << 24;
+}
+
+const uint8_t ktx2Identifier[12] = {0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+
+// Más grande que cualquier textura de GL: con esto los tamaños de los niveles no desbordan
+constexpr uint32_t maxDimension = 1u << 16;
+
+// Una cadena de mipmaps completa: el tamaño y la cantidad de niveles vienen del archivo, no se confía en ellos
+bool validLevels(const CompressedImage& image, uint32_t levels) {
+  if (image.width == 0 || image.height == 0 || image.width > maxDimension || image.height > maxDimension) return false;
+  uint32_t full = 1;
+  for (uint32_t size = std::max(image.width, image.height); size > 1; size /= 2) full++;
+  return levels <= full;
+}
+
+// Niveles consecutivos desde `offset`, como en los DDS
+bool layoutLevels(CompressedImage& image, uint32_t count, size_t offset) {
+  uint32_t width = image.width, height = image.height;
+  for (uint32_t i = 0; i < count; i++) {
+    const size_t size = compressedSize(image.format, width, height);
+    if (offset > image.data.size() || size > image.data.size() - offset) return false;
+    image.levels.push_back({offset, size, width, height});
+    offset += size;
+    width = std::max(width / 2, 1u);
+    height = std::max(height / 2, 1u);
+  }
+  return true;
+}
+
+bool readDDS(CompressedImage& image) {
+  const std::vector<uint8_t>& file = image.data;
+  if (file.size() < 4 + ddsHeaderSize || readLE(&file[4], 4) != ddsHeaderSize) return false;
+  const uint8_t* header = &file[4];
+  image.height = static_cast<uint32_t>(readLE(header + 8, 4));
+  image.width = static_cast<uint32_t>(readLE(header + 12, 4));
+  const uint32_t levels = std::max(static_cast<uint32_t>(readLE(header + 24, 4)), 1u);
+  const uint32_t flags = static_cast<uint32_t>(readLE(header + 76, 4));
+  const uint32_t code = static_cast<uint32_t>(readLE(header + 80, 4));
+  if (!(flags & ddsFourCC) || !validLevels(image, levels)) return false;
+
+  size_t offset = 4 + ddsHeaderSize;
+  if (code == fourCC("DXT1"))
+    image.format = G3D_BC1;
+  else if (code == fourCC("DXT5"))
+    image.format = G3D_BC3;
+  else if (code == fourCC("ATI1") || code == fourCC("BC4U"))
+    image.format = G3D_BC4;
+  else if (code == fourCC("ATI2") || code == fourCC("BC5U"))
+    image.format = G3D_BC5;
+  else if (code == fourCC("DX10")) {
+    // DDS_HEADER_DXT10: sólo texturas 2D de una capa
+    if (file.size() < offset + 20) return false;
+    const uint32_t dxgi = static_cast<uint32_t>(readLE(&file[offset], 4));
+    if (readLE(&file[offset + 4], 4) != 3 || readLE(&file[offset + 12], 4) > 1) return false;
+    offset += 20;
+    if (dxgi == 71 || dxgi == 72)
+      image.format = G3D_BC1;
+    else if (dxgi == 77 || dxgi == 78)
+      image.format = G3D_BC3;
+    else if (dxgi == 80)
+      image.format = G3D_BC4;
+    else if (dxgi == 83)
+      image.format = G3D_BC5;
+    else if (dxgi == 98 || dxgi == 99)
+      image.format = G3D_BC7;
+    else
+      return false;
+  } else
+    return false;
+
+  return layoutLevels(image, levels, offset);
+}
+
+bool readKTX2(CompressedImage& image) {
+  const std::vector<uint8_t>& file = image.data;
+  constexpr size_t headerSize = 80;
+  if (file.size() < headerSize) return false;
+
+  const uint32_t vkFormat = static_cast<uint32_t>(readLE(&file[12], 4));
+  image.width = static_cast<uint32_t>(readLE(&file[20], 4));
+  image.height = static_cast<uint32_t>(readLE(&file[24], 4));
+  const uint32_t depth = static_cast<uint32_t>(readLE(&file[28], 4));
+  const uint32_t layers = static_cast<uint32_t>(readLE(&file[32], 4));
+  const uint32_t faces = static_cast<uint32_t>(readLE(&file[36], 4));
+  const uint32_t levels = std::max(static_cast<uint32_t>(readLE(&file[40], 4)), 1u);
+  const uint32_t supercompression = static_cast<uint32_t>(readLE(&file[44], 4));
+  if (!validLevels(image, levels) || depth > 1 || layers > 1 || faces != 1 || supercompression != 0) return false;
+
+  if (vkFormat >= 131 && vkFormat <= 134)
+    image.format = G3D_BC1;
+  else if (vkFormat == 137 || vkFormat == 138)
+    image.format = G3D_BC3;
+  else if (vkFormat == 139)
+    image.format = G3D_BC4;
+  else if (vkFormat == 141)
+    image.format = G3D_BC5;
+  else if (vkFormat == 145 || vkFormat == 146)
+    image.format = G3D_BC7;
+  else
+    return false;
+
+  // Índice de niveles: offset, tamaño y tamaño sin comprimir (uint64) de cada uno, empezando por el base
+  constexpr size_t entrySize = 24;
+  if (file.size() < headerSize + static_cast<size_t>(levels) * entrySize) return false;
+  uint32_t width = image.width, height = image.height;
+  for (uint32_t i = 0; i < levels; i++) {
+    const uint8_t* entry = &file[headerSize + static_cast<size_t>(i) * entrySize];
+    const uint64_t offset = readLE(entry, 8), size = readLE(entry + 8, 8);
+    if (size != compressedSize(image.format, width, height) || offset > file.size() || size > file.size() - offset)
+      return false;
+    image.levels.push_back({static_cast<size_t>(offset), static_cast<size_t>(size), width, height});
+    width = std::max(width / 2, 1u);
+    height = std::max(height / 2, 1u);
+  }
+  return true;
+}
+
+}  // namespace
+
+uint32_t blockBytes(BlockFormat format) { return format == G3D_BC1 || format == G3D_BC4 ? 8 : 16; }
+
+size_t compressedSize(BlockFormat format, uint32_t width, uint32_t height) {
+  return (static_cast<size_t>(width) + 3) / 4 * ((static_cast<size_t>(height) + 3) / 4) * blockBytes(format);
+}
+
+uint32_t blockChannels(BlockFormat format) {
+  switch (format) {
+    case G3D_BC4:
+      return 1;
+    case G3D_BC5:
+      return 2;
+    case G3D_BC1:
+      return 3;
+    default:
+      return 4;
+  }
+}
+
+BlockFormat blockFormatFor(uint32_t channels) {
+  if (channels == 1) return G3D_BC4;
+  if (channels == 2) return G3D_BC5;
+  if (channels == 3) return G3D_BC1;
+  return G3D_BC3;
+}
+
+void encodeBlocks(BlockFormat format, const uint8_t* pixels, uint32_t width, uint32_t height, uint32_t channels,
+                  uint8_t* out) {
+  const uint32_t blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+  uint8_t block[16][4];
+  for (uint32_t by = 0; by < blocksY; by++) {
+    for (uint32_t bx = 0; bx < blocksX; bx++, out += blockBytes(format)) {
+      gatherBlock(pixels, width, height, channels, bx, by, block);
+      switch (format) {
+        case G3D_BC1:
+          encodeColor(block, out);
+          break;
+        case G3D_BC3:
+          encodeChannel(block, 3, out);
+          encodeColor(block, out + 8);
+          break;
+        case G3D_BC4:
+          encodeChannel(block, 0, out);
+          break;
+        case G3D_BC5:
+          encodeChannel(block, 0, out);
+          encodeChannel(block, 1, out + 8);
+          break;
+        case G3D_BC7:
+          return;
+      }
+    }
+  }
+}
+
+bool decodeBlocks(BlockFormat format, const uint8_t* blocks, uint32_t width, uint32_t height, uint8_t* out) {
+  if (format == G3D_BC7) return false;
+  const uint32_t blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+  const uint32_t channels = blockChannels(format);
+  uint8_t block[16][4];
+  for (uint32_t by = 0; by < blocksY; by++) {
+    for (uint32_t bx = 0; bx < blocksX; bx++, blocks += blockBytes(format)) {
+      switch (format) {
+        case G3D_BC1:
+          decodeColor(blocks, false, block);
+          break;
+        case G3D_BC3:
+          decodeColor(blocks + 8, true, block);
+          decodeChannel(blocks, 3, block);
+          break;
+        case G3D_BC4:
+          decodeChannel(blocks, 0, block);
+          break;
+        case G3D_BC5:
+          decodeChannel(blocks, 0, block);
+          decodeChannel(blocks + 8, 1, block);
+          break;
+        case G3D_BC7:
+          return false;
+      }
+
+      for (uint32_t y = 0; y < 4 && by * 4 + y < height; y++) {
+        for (uint32_t x = 0; x < 4 && bx * 4 + x < width; x++) {
+          uint8_t* texel = out + ((static_cast<size_t>(by) * 4 + y) * width + bx * 4 + x) * channels;
+          std::memcpy(texel, block[y * 4 + x], channels);
+        }
+      }
+    }
+  }
+  return true;
+}
+
+CompressedImage compressImage(const uint8_t* pixels, uint32_t width, uint32_t height, uint32_t channels,
+                              const MipChain& mips) {
+  CompressedImage image;
+  image.format = blockFormatFor(channels);
+  image.width = width;
+  image.height = height;
+
+  image.levels.push_back({0, compressedSize(image.format, width, height), width, height});
+  size_t total = image.levels.back().size;
+  for (const MipLevel& level : mips.levels) {
+    image.levels.push_back({total, compressedSize(image.format, level.width, level.height), level.width, level.height});
+    total += image.levels.back().size;
+  }
+  image.data.resize(total);
+
+  encodeBlocks(image.format, pixels, width, height, channels, image.data.data());
+  for (size_t i = 0; i < mips.levels.size(); i++) {
+    const MipLevel& level = mips.levels[i];
+    encodeBlocks(image.format, mips.data.data() + level.offset, level.width, level.height, channels,
+                 image.data.data() + image.levels[i + 1].offset);
+  }
+  return image;
+}
+
+bool isCompressedContainer(const uint8_t* data, size_t size) {
+  return (size >= 4 && std::memcmp(data, "DDS ", 4) == 0) ||
+         (size >= sizeof(ktx2Identifier) && std::memcmp(data, ktx2Identifier, sizeof(ktx2Identifier)) == 0);
+}
+
+bool readCompressed(std::vector<uint8_t>&& file, CompressedImage& image) {
+  image = CompressedImage();
+  image.data = std::move(file);
+  const bool dds = image.data.size() >= 4 && std::memcmp(image.data.data(), "DDS ", 4) == 0;
+  if (dds ? readDDS(image) : readKTX2(image)) return true;
+
+  file = std::move(image.data);
+  image = CompressedImage();
+  return false;
+}
+
+bool writeDDS(const std::string& path, const CompressedImage& image) {
+  uint8_t header[4 + ddsHeaderSize + 20] = {'D', 'D', 'S', ' '};
+  uint8_t* dds = header + 4;
+  writeLE(dds, ddsHeaderSize, 4);
+  writeLE(dds + 4, ddsFlags, 4);
+  writeLE(dds + 8, image.height, 4);
+  writeLE(dds + 12, image.width, 4);
+  writeLE(dds + 16, image.levels.empty() ? 0 : image.levels[0].size, 4);
+  writeLE(dds + 24, image.levels.size(), 4);
+  writeLE(dds + 72, 32, 4);  // DDS_PIXELFORMAT
+  writeLE(dds + 76, ddsFourCC, 4);
+  writeLE(dds + 104, ddsCaps, 4);
+
+  size_t size = 4 + ddsHeaderSize;
+  switch (image.format) {
+    case G3D_BC1:
+      writeLE(dds + 80, fourCC("DXT1"), 4);
+      break;
+    case G3D_BC3:
+      writeLE(dds + 80, fourCC("DXT5"), 4);
+      break;
+    case G3D_BC4:
+      writeLE(dds + 80, fourCC("ATI1"), 4);
+      break;
+    case G3D_BC5:
+      writeLE(dds + 80, fourCC("ATI2"), 4);
+      break;
+    case G3D_BC7:
+      writeLE(dds + 80, fourCC("DX10"), 4);
+      writeLE(header + size, 98, 4);     // DXGI_FORMAT_BC7_UNORM
+      writeLE(header + size + 4, 3, 4);  // TEXTURE2D
+      writeLE(header + size + 12, 1, 4);
+      size += 20;
+      break;
+  }
+
+  std::error_code error;
+  const std::filesystem::path target(path);
+  if (target.has_parent_path()) std::filesystem::create_directories(target.parent_path(), error);
+  const std::string temp = path + ".tmp" + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+
+  {
+    std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) return false;
+    out.write(reinterpret_cast<const char*>(header), static_cast<std::streamsize>(size));
+    for (const CompressedLevel& level : image.levels) {
+      const char* data = reinterpret_cast<const char*>(image.data.data() + level.offset);
+      out.write(data, static_cast<std::streamsize>(level.size));
+    }
+    if (!out.good()) {
+      out.close();
+      std::filesystem::remove(temp, error);
+      return false;
+    }
+  }
+
+  std::filesystem::rename(temp, target, error);
+  if (error) {
+    std::filesystem::remove(temp, error);
+    return false;
+  }
+  return true;
+}
+
+}  // namespace util
+}  // namespace graph3d
@@ -0,0 +1,79 @@
+#ifndef GRAPH3D_UTIL_TEXTURE_CODEC_H_
+#define GRAPH3D_UTIL_TEXTURE_CODEC_H_
+
+// Texturas comprimidas por bloques (BCn) y sus contenedores.
+//
+// Cada formato guarda bloques de 4x4 texels y se elige según los canales de la imagen, así se muestrea igual que
+// la textura sin comprimir (GL_RED, GL_RG, GL_RGB o GL_RGBA):
+//   1 canal  BC4   8 bytes por bloque
+//   2        BC5  16
+//   3        BC1   8
+//   4        BC3  16 (BC1 para el color y un bloque BC4 para el alfa)
+// BC7 se lee y se sube tal cual, pero no se codifica ni se decodifica en CPU.
+//
+// Se leen DDS (DXT1, DXT5, ATI1/BC4U, ATI2/BC5U y DX10) y KTX2 sin supercompresión; se escriben DDS.
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <util/mipmaps.h>
+
+namespace graph3d {
+namespace util {
+
+enum BlockFormat { G3D_BC1, G3D_BC3, G3D_BC4, G3D_BC5, G3D_BC7 };
+
+struct CompressedLevel {
+  size_t offset, size;
+  uint32_t width, height;
+};
+
+struct CompressedImage {
+  BlockFormat format = G3D_BC1;
+  uint32_t width = 0, height = 0;
+
+  // Todos los niveles, del base al más chico, en `data`
+  std::vector<CompressedLevel> levels;
+  std::vector<uint8_t> data;
+
+  size_t getMemory() const { return data.size(); }
+};
+
+/// Bytes de un bloque de 4x4
+uint32_t blockBytes(BlockFormat format);
+
+/// Bytes de un nivel de width x height
+size_t compressedSize(BlockFormat format, uint32_t width, uint32_t height);
+
+/// Canales que salen al decodificar el formato (los mismos que se usaron para elegirlo)
+uint32_t blockChannels(BlockFormat format);
+
+/// Formato para una imagen de 1 a 4 canales
+BlockFormat blockFormatFor(uint32_t channels);
+
+/// Comprime una imagen de 8 bits por canal, filas de arriba hacia abajo. BC7 no está soportado
+void encodeBlocks(BlockFormat format, const uint8_t* pixels, uint32_t width, uint32_t height, uint32_t channels,
+                  uint8_t* out);
+
+/// Descomprime a blockChannels(format) canales por texel. Devuelve false con BC7
+bool decodeBlocks(BlockFormat format, const uint8_t* blocks, uint32_t width, uint32_t height, uint8_t* out);
+
+/// Comprime la imagen y su cadena de mipmaps (util/mipmaps.h)
+CompressedImage compressImage(const uint8_t* pixels, uint32_t width, uint32_t height, uint32_t channels,
+                              const MipChain& mips);
+
+/// true si `data` empieza como un DDS o un KTX2
+bool isCompressedContainer(const uint8_t* data, size_t size);
+
+/// Lee un DDS o un KTX2 y se queda con `file` como datos de la imagen. false si el formato no está soportado
+bool readCompressed(std::vector<uint8_t>&& file, CompressedImage& image);
+
+/// Escribe la imagen como DDS. Primero a un temporal, así nadie lee un archivo a medias
+bool writeDDS(const std::string& path, const CompressedImage& image);
+
+}  // namespace util
+}  // namespace graph3d
+
+#endif